@@ -0,0 +1,85 @@
+#!/usr/bin/env bash
+# Smoke test for the async reverse-DNS path: runs a stand-in UDP nameserver
+# that answers every PTR query with a.b.c.d -> a-b-c-d.ptr.test, then polls
+# the plugin until its resolver has answered lookups through it.
+#
+# The plugin under test must be started with the stand-in as its resolver:
+#   PlParam "dns_servers" "127.0.0.1:<dns_port>"   (or OLSRD_STATUS_DNS_SERVERS)
+#
+# usage: smoke_dns_ptr.sh <host> <port> [dns_port]   (default dns_port 15353)
+#        smoke_dns_ptr.sh --serve [dns_port]         (stand-in only, foreground)
+set -euo pipefail
+
+if [ "${1:-}" = "--serve" ]; then
+  SERVE_ONLY=1; DNS_PORT=${2:-15353}
+else
+  SERVE_ONLY=0
+  HOST=${1:-127.0.0.1}
+  PORT=${2:-11080}
+  DNS_PORT=${3:-15353}
+fi
+TIMEOUT=${TIMEOUT:-30}
+BASE="http://${HOST:-127.0.0.1}:${PORT:-11080}"
+QLOG=$(mktemp)
+
+responder() {
+  python3 - "$DNS_PORT" "$QLOG" <<'PY'
+import socket, struct, sys
+port, qlog = int(sys.argv[1]), sys.argv[2]
+s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+s.bind(("127.0.0.1", port))
+while True:
+    q, peer = s.recvfrom(512)
+    if len(q) < 17:
+        continue
+    labels, o = [], 12
+    while o < len(q) and q[o]:
+        labels.append(q[o + 1:o + 1 + q[o]].decode("ascii", "replace"))
+        o += 1 + q[o]
+    qend = o + 5
+    qtype = struct.unpack("!H", q[o + 1:o + 3])[0] if o + 3 <= len(q) else 0
+    ok = qtype == 12 and len(labels) == 6 and [l.lower() for l in labels[4:]] == ["in-addr", "arpa"]
+    with open(qlog, "a") as f:
+        f.write(".".join(labels) + "\n")
+    hdr = q[:2] + (b"\x81\x80" if ok else b"\x81\x83") + b"\x00\x01" + (b"\x00\x01" if ok else b"\x00\x00") + b"\x00\x00\x00\x00"
+    body = q[12:qend]
+    if ok:
+        name = "-".join(reversed(labels[:4])) + ".ptr.test"
+        rdata = b"".join(bytes([len(p)]) + p.encode() for p in name.split(".")) + b"\x00"
+        body += b"\xc0\x0c" + struct.pack("!HHIH", 12, 1, 300, len(rdata)) + rdata
+    s.sendto(hdr + body, peer)
+PY
+}
+
+if [ "$SERVE_ONLY" = "1" ]; then
+  echo "PTR stand-in on 127.0.0.1:${DNS_PORT} (queries logged to ${QLOG}); Ctrl-C to stop"
+  responder
+  exit 0
+fi
+
+responder &
+RPID=$!
+trap 'kill $RPID 2>/dev/null || true; rm -f "$QLOG"' EXIT
+sleep 0.5
+
+echo "PTR stand-in on 127.0.0.1:${DNS_PORT}; plugin at ${BASE} must use dns_servers 127.0.0.1:${DNS_PORT}"
+answered=0
+for _ in $(seq 1 "$TIMEOUT"); do
+  # pages that show neighbour names queue PTR lookups for unknown addresses
+  curl -sS --max-time 5 "${BASE}/status" >/dev/null 2>&1 || true
+  curl -sS --max-time 5 "${BASE}/olsr/links" >/dev/null 2>&1 || true
+  answered=$(curl -sS --max-time 5 "${BASE}/metrics" 2>/dev/null | awk '/^olsrd_status_dns_lookups_total\{outcome="answered"\}/ { print $2 }')
+  answered=${answered:-0}
+  [ "$answered" -gt 0 ] && break
+  sleep 1
+done
+
+queries=$(wc -l < "$QLOG")
+echo "stand-in saw ${queries} queries; plugin reports ${answered} answered lookups"
+if [ "$answered" -le 0 ] || [ "$queries" -le 0 ]; then
+  echo "FAIL: no PTR answers went through 127.0.0.1:${DNS_PORT}"
+  exit 1
+fi
+names=$(curl -sS --max-time 5 "${BASE}/status" | grep -o '[0-9-]*\.ptr\.test' | sort -u | head -5 || true)
+[ -n "$names" ] && echo "names in /status: $(echo $names)"
+echo "OK"
@@ -0,0 +1,161 @@
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#define ARENA_CHUNK      16384           /* first chunk of a new arena */
+#define ARENA_KEEP_MAX   (256 * 1024)    /* largest first chunk kept across resets */
+#define ARENA_POOL_MAX   16              /* arenas kept after their thread exited */
+#define ARENA_ALIGN      16
+
+struct chunk {
+  struct chunk *next;
+  size_t size, off;
+  unsigned char *mem;
+};
+
+struct arena {
+  struct chunk *head;       /* current chunk; the first chunk is at the tail */
+  size_t used, want;        /* bytes handed out; largest request seen, for regrowth */
+  unsigned long allocs;
+  arena_t *next_free;
+};
+
+static struct chunk *chunk_new(size_t size) {
+  struct chunk *c = malloc(sizeof(*c) + size + ARENA_ALIGN);
+  if (!c) return NULL;
+  c->next = NULL; c->size = size; c->off = 0;
+  uintptr_t m = (uintptr_t)(c + 1);
+  c->mem = (unsigned char *)((m + ARENA_ALIGN - 1) & ~(uintptr_t)(ARENA_ALIGN - 1));
+  return c;
+}
+
+static arena_t *arena_new(void) {
+  arena_t *a = calloc(1, sizeof(*a));
+  if (!a) return NULL;
+  a->head = chunk_new(ARENA_CHUNK);
+  if (!a->head) { free(a); return NULL; }
+  return a;
+}
+
+static void arena_destroy(arena_t *a) {
+  for (struct chunk *c = a->head, *n; c; c = n) { n = c->next; free(c); }
+  free(a);
+}
+
+void *arena_alloc(arena_t *a, size_t n) {
+  if (!a) return NULL;
+  size_t need = (n + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+  if (need < n) return NULL;
+  struct chunk *c = a->head;
+  if (c->size - c->off < need) {
+    /* chunks double so a large request needs few of them */
+    size_t sz = c->size * 2;
+    if (sz < need) sz = need;
+    struct chunk *nc = chunk_new(sz);
+    if (!nc) return NULL;
+    nc->next = c; a->head = nc; c = nc;
+  }
+  void *p = c->mem + c->off;
+  c->off += need;
+  a->used += need; a->allocs++;
+  return p;
+}
+
+size_t arena_used(const arena_t *a) { return a ? a->used : 0; }
+unsigned long arena_allocs(const arena_t *a) { return a ? a->allocs : 0; }
+
+void arena_reset(arena_t *a) {
+  if (!a) return;
+  if (a->used > a->want) a->want = a->used;
+  struct chunk *first = a->head;
+  while (first->next) { struct chunk *n = first->next; free(first); first = n; }
+  /* one chunk big enough for what recent requests used, within bounds */
+  if (first->size < a->want && first->size < ARENA_KEEP_MAX) {
+    size_t sz = a->want < ARENA_KEEP_MAX ? a->want : ARENA_KEEP_MAX;
+    struct chunk *nc = chunk_new(sz);
+    if (nc) { free(first); first = nc; }
+  }
+  first->off = 0;
+  a->head = first;
+  a->used = 0; a->allocs = 0;
+}
+
+/* --- per-thread arenas ----------------------------------------------- */
+
+static pthread_mutex_t g_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static arena_t *g_pool = NULL;
+static int g_pool_len = 0;
+static pthread_key_t g_key;
+static pthread_once_t g_key_once = PTHREAD_ONCE_INIT;
+static __thread arena_t *t_arena = NULL;
+static __thread arena_t *t_current = NULL;
+
+static void thread_arena_release(void *p) {
+  arena_t *a = p;
+  if (!a) return;
+  arena_reset(a);
+  pthread_mutex_lock(&g_pool_lock);
+  if (g_pool_len < ARENA_POOL_MAX) {
+    a->next_free = g_pool; g_pool = a; g_pool_len++;
+    pthread_mutex_unlock(&g_pool_lock);
+    return;
+  }
+  pthread_mutex_unlock(&g_pool_lock);
+  arena_destroy(a);
+}
+
+static void key_init(void) { pthread_key_create(&g_key, thread_arena_release); }
+
+arena_t *arena_thread(void) {
+  if (t_arena) return t_arena;
+  pthread_once(&g_key_once, key_init);
+  pthread_mutex_lock(&g_pool_lock);
+  arena_t *a = g_pool;
+  if (a) { g_pool = a->next_free; g_pool_len--; a->next_free = NULL; }
+  pthread_mutex_unlock(&g_pool_lock);
+  if (!a) a = arena_new();
+  if (!a) return NULL;
+  t_arena = a;
+  pthread_setspecific(g_key, a);
+  return a;
+}
+
+arena_t *arena_bind(arena_t *a) {
+  arena_t *prev = t_current;
+  t_current = a;
+  return prev;
+}
+
+arena_t *arena_current(void) { return t_current; }
+
+static int arena_owns(const arena_t *a, const void *p) {
+  for (const struct chunk *c = a->head; c; c = c->next)
+    if ((const unsigned char *)p >= c->mem && (const unsigned char *)p < c->mem + c->size) return 1;
+  return 0;
+}
+
+void *req_alloc(size_t n) {
+  return t_current ? arena_alloc(t_current, n) : malloc(n);
+}
+
+void *req_calloc(size_t n, size_t size) {
+  if (size && n > (size_t)-1 / size) return NULL;
+  if (!t_current) return calloc(n, size);
+  void *p = arena_alloc(t_current, n * size);
+  if (p) memset(p, 0, n * size);
+  return p;
+}
+
+char *req_strdup(const char *s) {
+  size_t n = strlen(s) + 1;
+  char *d = req_alloc(n);
+  if (d) memcpy(d, s, n);
+  return d;
+}
+
+void req_free(void *p) {
+  if (!p || (t_current && arena_owns(t_current, p))) return;
+  free(p);
+}
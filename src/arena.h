@@ -0,0 +1,41 @@
+#ifndef OLSRD_STATUS_ARENA_H
+#define OLSRD_STATUS_ARENA_H
+#include <stddef.h>
+
+/* Bump-pointer arena for request-scoped scratch memory.
+ * Allocations are carved from chunks and never freed one by one; the whole
+ * arena is reset when the request ends. The first chunk survives a reset and
+ * grows to what the last requests needed, so a worker in steady state does
+ * not touch the heap for scratch data at all.
+ *
+ * Each thread owns one arena (arena_thread()). The HTTP server binds it for
+ * the duration of a request; code that only sometimes runs on a request
+ * thread uses the req_* helpers, which fall back to the heap when no arena
+ * is bound.
+ */
+typedef struct arena arena_t;
+
+void *arena_alloc(arena_t *a, size_t n);
+/* Bytes handed out since the last reset (the request's peak: nothing is
+ * given back before the reset).
+ */
+size_t arena_used(const arena_t *a);
+/* Allocations served since the last reset. */
+unsigned long arena_allocs(const arena_t *a);
+void arena_reset(arena_t *a);
+
+/* This thread's arena, created on first use and recycled at thread exit. */
+arena_t *arena_thread(void);
+/* Make a the current arena of this thread (NULL unbinds); returns the previous one. */
+arena_t *arena_bind(arena_t *a);
+arena_t *arena_current(void);
+
+/* Scratch memory from the current arena, or the heap when none is bound.
+ * req_free() is a no-op for arena memory, so callers pair them like
+ * malloc/free without knowing where the block came from.
+ */
+void *req_alloc(size_t n);
+void *req_calloc(size_t n, size_t size);
+char *req_strdup(const char *s);
+void req_free(void *p);
+#endif
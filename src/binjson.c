@@ -0,0 +1,279 @@
+#include "binjson.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+
+#define BJ_MAX_DEPTH 64
+#define BJ_HEAD_MAX 5            /* container placeholder: type byte + u32 count */
+
+typedef struct {
+  const char *p, *end;
+  int fmt;
+  char *buf; size_t len, cap;
+  char *tmp; size_t tcap;        /* unescaped string scratch */
+} bj_t;
+
+enum { K_UINT, K_NEGINT, K_STR, K_ARRAY, K_MAP };
+
+static int reserve(bj_t *b, size_t n) {
+  if (b->len + n <= b->cap) return 0;
+  size_t nc = b->cap ? b->cap : 256;
+  while (nc < b->len + n) nc *= 2;
+  char *nb = realloc(b->buf, nc);
+  if (!nb) return -1;
+  b->buf = nb; b->cap = nc;
+  return 0;
+}
+
+static void put_be(unsigned char *d, uint64_t v, int bytes) {
+  for (int i = bytes - 1; i >= 0; i--) { d[i] = (unsigned char)v; v >>= 8; }
+}
+
+/* Type/length head into d (at least 9 bytes); returns its size. */
+static int head_bytes(unsigned char *d, int fmt, int kind, uint64_t n) {
+  if (fmt == BINJSON_CBOR) {
+    static const unsigned char major[] = { 0, 1, 3, 4, 5 };
+    unsigned char m = (unsigned char)(major[kind] << 5);
+    if (n < 24) { d[0] = m | (unsigned char)n; return 1; }
+    if (n <= 0xff) { d[0] = m | 24; d[1] = (unsigned char)n; return 2; }
+    if (n <= 0xffff) { d[0] = m | 25; put_be(d + 1, n, 2); return 3; }
+    if (n <= 0xffffffffu) { d[0] = m | 26; put_be(d + 1, n, 4); return 5; }
+    d[0] = m | 27; put_be(d + 1, n, 8); return 9;
+  }
+  switch (kind) {
+    case K_UINT:
+      if (n <= 0x7f) { d[0] = (unsigned char)n; return 1; }
+      if (n <= 0xff) { d[0] = 0xcc; d[1] = (unsigned char)n; return 2; }
+      if (n <= 0xffff) { d[0] = 0xcd; put_be(d + 1, n, 2); return 3; }
+      if (n <= 0xffffffffu) { d[0] = 0xce; put_be(d + 1, n, 4); return 5; }
+      d[0] = 0xcf; put_be(d + 1, n, 8); return 9;
+    case K_NEGINT: {
+      /* n encodes -1 - value, as in CBOR */
+      int64_t v = -1 - (int64_t)n;
+      if (v >= -32) { d[0] = (unsigned char)(0xe0 | (v & 0x1f)); return 1; }
+      if (v >= INT8_MIN) { d[0] = 0xd0; d[1] = (unsigned char)v; return 2; }
+      if (v >= INT16_MIN) { d[0] = 0xd1; put_be(d + 1, (uint64_t)v, 2); return 3; }
+      if (v >= INT32_MIN) { d[0] = 0xd2; put_be(d + 1, (uint64_t)v, 4); return 5; }
+      d[0] = 0xd3; put_be(d + 1, (uint64_t)v, 8); return 9;
+    }
+    case K_STR:
+      if (n < 32) { d[0] = (unsigned char)(0xa0 | n); return 1; }
+      if (n <= 0xff) { d[0] = 0xd9; d[1] = (unsigned char)n; return 2; }
+      if (n <= 0xffff) { d[0] = 0xda; put_be(d + 1, n, 2); return 3; }
+      d[0] = 0xdb; put_be(d + 1, n, 4); return 5;
+    case K_ARRAY:
+      if (n < 16) { d[0] = (unsigned char)(0x90 | n); return 1; }
+      if (n <= 0xffff) { d[0] = 0xdc; put_be(d + 1, n, 2); return 3; }
+      d[0] = 0xdd; put_be(d + 1, n, 4); return 5;
+    default:
+      if (n < 16) { d[0] = (unsigned char)(0x80 | n); return 1; }
+      if (n <= 0xffff) { d[0] = 0xde; put_be(d + 1, n, 2); return 3; }
+      d[0] = 0xdf; put_be(d + 1, n, 4); return 5;
+  }
+}
+
+static int put_head(bj_t *b, int kind, uint64_t n) {
+  if (reserve(b, 9) != 0) return -1;
+  b->len += (size_t)head_bytes((unsigned char *)b->buf + b->len, b->fmt, kind, n);
+  return 0;
+}
+
+static int put_raw(bj_t *b, const void *d, size_t n) {
+  if (reserve(b, n) != 0) return -1;
+  memcpy(b->buf + b->len, d, n); b->len += n;
+  return 0;
+}
+
+static int put_byte(bj_t *b, unsigned cbor, unsigned msgpack) {
+  unsigned char c = (unsigned char)(b->fmt == BINJSON_CBOR ? cbor : msgpack);
+  return put_raw(b, &c, 1);
+}
+
+static void skip_ws(bj_t *b) {
+  while (b->p < b->end && (*b->p == ' ' || *b->p == '\t' || *b->p == '\r' || *b->p == '\n')) b->p++;
+}
+
+static int hex4(const char *s, unsigned *out) {
+  unsigned v = 0;
+  for (int i = 0; i < 4; i++) {
+    char c = s[i]; v <<= 4;
+    if (c >= '0' && c <= '9') v |= (unsigned)(c - '0');
+    else if (c >= 'a' && c <= 'f') v |= (unsigned)(c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F') v |= (unsigned)(c - 'A' + 10);
+    else return -1;
+  }
+  *out = v;
+  return 0;
+}
+
+static size_t utf8_put(char *d, unsigned cp) {
+  if (cp < 0x80) { d[0] = (char)cp; return 1; }
+  if (cp < 0x800) { d[0] = (char)(0xc0 | (cp >> 6)); d[1] = (char)(0x80 | (cp & 0x3f)); return 2; }
+  if (cp < 0x10000) { d[0] = (char)(0xe0 | (cp >> 12)); d[1] = (char)(0x80 | ((cp >> 6) & 0x3f)); d[2] = (char)(0x80 | (cp & 0x3f)); return 3; }
+  d[0] = (char)(0xf0 | (cp >> 18)); d[1] = (char)(0x80 | ((cp >> 12) & 0x3f));
+  d[2] = (char)(0x80 | ((cp >> 6) & 0x3f)); d[3] = (char)(0x80 | (cp & 0x3f));
+  return 4;
+}
+
+/* Strings without escapes are copied straight through; the others are
+ * unescaped into the scratch buffer first (never longer than the source).
+ */
+static int enc_string(bj_t *b) {
+  const char *s = ++b->p, *q = s;
+  int escaped = 0;
+  while (q < b->end && *q != '"') {
+    if (*q == '\\') { escaped = 1; q++; }
+    q++;
+  }
+  if (q >= b->end) return -1;
+  size_t raw = (size_t)(q - s);
+  b->p = q + 1;
+  if (!escaped) return put_head(b, K_STR, raw) == 0 && put_raw(b, s, raw) == 0 ? 0 : -1;
+  if (raw > b->tcap) {
+    char *nt = realloc(b->tmp, raw);
+    if (!nt) return -1;
+    b->tmp = nt; b->tcap = raw;
+  }
+  size_t n = 0;
+  for (const char *c = s; c < q; c++) {
+    if (*c != '\\') { b->tmp[n++] = *c; continue; }
+    switch (*++c) {
+      case '"': b->tmp[n++] = '"'; break;
+      case '\\': b->tmp[n++] = '\\'; break;
+      case '/': b->tmp[n++] = '/'; break;
+      case 'b': b->tmp[n++] = '\b'; break;
+      case 'f': b->tmp[n++] = '\f'; break;
+      case 'n': b->tmp[n++] = '\n'; break;
+      case 'r': b->tmp[n++] = '\r'; break;
+      case 't': b->tmp[n++] = '\t'; break;
+      case 'u': {
+        unsigned cp, lo;
+        if (q - c < 5 || hex4(c + 1, &cp) != 0) return -1;
+        c += 4;
+        if (cp >= 0xd800 && cp < 0xdc00 && q - c >= 7 && c[1] == '\\' && c[2] == 'u' && hex4(c + 3, &lo) == 0 && lo >= 0xdc00 && lo < 0xe000) {
+          cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+          c += 6;
+        } else if (cp >= 0xd800 && cp < 0xe000) cp = 0xfffd;
+        n += utf8_put(b->tmp + n, cp);
+        break;
+      }
+      default: return -1;
+    }
+  }
+  return put_head(b, K_STR, n) == 0 && put_raw(b, b->tmp, n) == 0 ? 0 : -1;
+}
+
+static int enc_number(bj_t *b) {
+  char num[64]; size_t n = 0; int is_int = 1;
+  while (b->p < b->end && n < sizeof(num) - 1) {
+    char c = *b->p;
+    if (c == '.' || c == 'e' || c == 'E') is_int = 0;
+    else if (!(c == '-' || c == '+' || (c >= '0' && c <= '9'))) break;
+    num[n++] = c; b->p++;
+  }
+  num[n] = 0;
+  if (n == 0 || n == sizeof(num) - 1) return -1;
+  char *e;
+  if (is_int) {
+    errno = 0;
+    if (num[0] == '-') {
+      long long v = strtoll(num, &e, 10);
+      if (*e == 0 && errno == 0) return v < 0 ? put_head(b, K_NEGINT, (uint64_t)(-1 - v)) : put_head(b, K_UINT, 0);
+    } else {
+      unsigned long long v = strtoull(num, &e, 10);
+      if (*e == 0 && errno == 0) return put_head(b, K_UINT, v);
+    }
+  }
+  double d = strtod(num, &e);
+  if (*e != 0) return -1;
+  unsigned char o[9];
+  float f = (float)d;
+  if ((double)f == d) {
+    uint32_t u; memcpy(&u, &f, 4);
+    o[0] = b->fmt == BINJSON_CBOR ? 0xfa : 0xca; put_be(o + 1, u, 4);
+    return put_raw(b, o, 5);
+  }
+  uint64_t u; memcpy(&u, &d, 8);
+  o[0] = b->fmt == BINJSON_CBOR ? 0xfb : 0xcb; put_be(o + 1, u, 8);
+  return put_raw(b, o, 9);
+}
+
+static int enc_literal(bj_t *b, const char *word, unsigned cbor, unsigned msgpack) {
+  size_t n = strlen(word);
+  if ((size_t)(b->end - b->p) < n || memcmp(b->p, word, n) != 0) return -1;
+  b->p += n;
+  return put_byte(b, cbor, msgpack);
+}
+
+static int enc_value(bj_t *b, int depth);
+
+/* Arrays and maps: reserve the largest head, encode the members, then write
+ * the real head and slide the members down over the unused bytes.
+ */
+static int enc_container(bj_t *b, int depth, int map) {
+  if (depth >= BJ_MAX_DEPTH) return -1;
+  char close = map ? '}' : ']';
+  b->p++;
+  if (reserve(b, BJ_HEAD_MAX) != 0) return -1;
+  size_t at = b->len;
+  b->len += BJ_HEAD_MAX;
+  uint64_t count = 0;
+  skip_ws(b);
+  if (b->p < b->end && *b->p == close) b->p++;
+  else for (;;) {
+    if (map) {
+      skip_ws(b);
+      if (b->p >= b->end || *b->p != '"' || enc_string(b) != 0) return -1;
+      skip_ws(b);
+      if (b->p >= b->end || *b->p++ != ':') return -1;
+    }
+    if (enc_value(b, depth + 1) != 0) return -1;
+    count++;
+    skip_ws(b);
+    if (b->p >= b->end) return -1;
+    char c = *b->p++;
+    if (c == close) break;
+    if (c != ',') return -1;
+  }
+  if (count > 0xffffffffu) return -1;
+  unsigned char h[9];
+  int hn = head_bytes(h, b->fmt, map ? K_MAP : K_ARRAY, count);
+  size_t body = b->len - at - BJ_HEAD_MAX;
+  if (hn < BJ_HEAD_MAX) memmove(b->buf + at + hn, b->buf + at + BJ_HEAD_MAX, body);
+  memcpy(b->buf + at, h, (size_t)hn);
+  b->len = at + (size_t)hn + body;
+  return 0;
+}
+
+static int enc_value(bj_t *b, int depth) {
+  skip_ws(b);
+  if (b->p >= b->end) return -1;
+  switch (*b->p) {
+    case '{': return enc_container(b, depth, 1);
+    case '[': return enc_container(b, depth, 0);
+    case '"': return enc_string(b);
+    case 't': return enc_literal(b, "true", 0xf5, 0xc3);
+    case 'f': return enc_literal(b, "false", 0xf4, 0xc2);
+    case 'n': return enc_literal(b, "null", 0xf6, 0xc0);
+    default: return enc_number(b);
+  }
+}
+
+int binjson_encode(const char *json, size_t len, int fmt, char **out, size_t *outlen) {
+  if (!json || !out || !outlen || (fmt != BINJSON_CBOR && fmt != BINJSON_MSGPACK)) return -1;
+  bj_t b = { .p = json, .end = json + len, .fmt = fmt };
+  /* binary output is rarely larger than half the text */
+  if (reserve(&b, len / 2 + 16) != 0) return -1;
+  int rc = enc_value(&b, 0);
+  if (rc == 0) { skip_ws(&b); if (b.p < b.end && *b.p) rc = -1; }
+  free(b.tmp);
+  if (rc != 0) { free(b.buf); return -1; }
+  *out = b.buf; *outlen = b.len;
+  return 0;
+}
+
+const char *binjson_mime(int fmt) {
+  return fmt == BINJSON_CBOR ? "application/cbor" : "application/msgpack";
+}
@@ -0,0 +1,19 @@
+#ifndef OLSRD_STATUS_BINJSON_H
+#define OLSRD_STATUS_BINJSON_H
+#include <stddef.h>
+
+/* Compact binary encodings of a JSON document. The JSON text produced by the
+ * endpoints is transcoded in one pass without building a tree: containers get
+ * definite lengths (patched in when they close), integers use the smallest
+ * integer form, other numbers a float32 when that is exact and float64
+ * otherwise, and strings are unescaped to UTF-8.
+ */
+enum { BINJSON_CBOR = 1, BINJSON_MSGPACK = 2 };
+
+/* Encode len bytes of JSON as fmt into a malloc'ed buffer. Returns 0, or -1
+ * for malformed input (or nesting deeper than 64) and allocation failures.
+ */
+int binjson_encode(const char *json, size_t len, int fmt, char **out, size_t *outlen);
+/* "application/cbor" or "application/msgpack". */
+const char *binjson_mime(int fmt);
+#endif
@@ -0,0 +1,113 @@
+/* binjson: byte-exact CBOR and MessagePack for the integer, string, float and
+ * container forms, back-patched heads on containers past the short form,
+ * and malformed or too deeply nested input refused. Run with `make test`.
+ */
+#include "binjson.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int g_fail;
+
+#define CHECK(cond, ...) do { if (!(cond)) { fprintf(stderr, __VA_ARGS__); fputc('\n', stderr); g_fail++; } } while (0)
+
+static const char *fmt_name(int fmt) { return fmt == BINJSON_CBOR ? "cbor" : "msgpack"; }
+
+/* want is hex, spaces ignored */
+static void expect(const char *json, int fmt, const char *want) {
+  unsigned char w[256]; size_t wn = 0;
+  for (const char *h = want; *h; ) {
+    if (*h == ' ') { h++; continue; }
+    unsigned v; sscanf(h, "%2x", &v); w[wn++] = (unsigned char)v; h += 2;
+  }
+  char *out = NULL; size_t n = 0;
+  int rc = binjson_encode(json, strlen(json), fmt, &out, &n);
+  CHECK(rc == 0, "%s %s: encode failed", fmt_name(fmt), json);
+  if (rc == 0) {
+    int same = n == wn && memcmp(out, w, n) == 0;
+    if (!same) {
+      fprintf(stderr, "%s %s: got", fmt_name(fmt), json);
+      for (size_t i = 0; i < n; i++) fprintf(stderr, " %02x", (unsigned char)out[i]);
+      fputc('\n', stderr);
+    }
+    CHECK(same, "%s %s: want %s", fmt_name(fmt), json, want);
+  }
+  free(out);
+}
+
+static void refuse(const char *json) {
+  for (int fmt = BINJSON_CBOR; fmt <= BINJSON_MSGPACK; fmt++) {
+    char *out = NULL; size_t n = 0;
+    CHECK(binjson_encode(json, strlen(json), fmt, &out, &n) == -1 && !out, "%s: accepted %.40s", fmt_name(fmt), json);
+  }
+}
+
+static void test_scalars(void) {
+  expect("[1, -1, 24, -25, 300]", BINJSON_CBOR, "85 01 20 1818 3818 19012c");
+  expect("[1, -1, 24, -25, 300]", BINJSON_MSGPACK, "95 01 ff 18 e7 cd012c");
+  expect("[4294967296,-129]", BINJSON_CBOR, "82 1b0000000100000000 3880");
+  expect("[4294967296,-129]", BINJSON_MSGPACK, "92 cf0000000100000000 d1ff7f");
+  expect("-9223372036854775808", BINJSON_CBOR, "3b7fffffffffffffff");
+  expect("-9223372036854775808", BINJSON_MSGPACK, "d38000000000000000");
+  /* float32 only when exact; 1e3 is a float, not an integer */
+  expect("[0.5,0.1,1e3]", BINJSON_CBOR, "83 fa3f000000 fb3fb999999999999a fa447a0000");
+  expect("[0.5,0.1,1e3]", BINJSON_MSGPACK, "93 ca3f000000 cb3fb999999999999a ca447a0000");
+  expect("[true,false,null]", BINJSON_CBOR, "83 f5 f4 f6");
+  expect("[true,false,null]", BINJSON_MSGPACK, "93 c3 c2 c0");
+}
+
+static void test_strings(void) {
+  expect("{\"k\":\"v\\u00e9\",\"t\":true}", BINJSON_CBOR, "a2 616b 6376c3a9 6174 f5");
+  expect("{\"k\":\"v\\u00e9\",\"t\":true}", BINJSON_MSGPACK, "82 a16b a376c3a9 a174 c3");
+  expect("\"\\ud83d\\ude00\"", BINJSON_CBOR, "64f09f9880");
+  expect("\"\\ud83d\\ude00\"", BINJSON_MSGPACK, "a4f09f9880");
+  /* a lone surrogate becomes U+FFFD */
+  expect("\"\\ud83d\"", BINJSON_CBOR, "63efbfbd");
+  expect("\"a\\\"\\\\\\/\\n\"", BINJSON_MSGPACK, "a5 61 22 5c 2f 0a");
+}
+
+static void test_containers(void) {
+  char json[512]; size_t o = 0;
+  char cb[512], mp[512]; size_t co = 0, mo = 0;
+  json[o++] = '[';
+  co += (size_t)sprintf(cb + co, "981e");
+  mo += (size_t)sprintf(mp + mo, "dc001e");
+  for (int i = 0; i < 30; i++) {
+    o += (size_t)sprintf(json + o, "%s%d", i ? "," : "", i);
+    co += (size_t)sprintf(cb + co, i < 24 ? "%02x" : "18%02x", i);
+    mo += (size_t)sprintf(mp + mo, "%02x", i);
+  }
+  json[o++] = ']'; json[o] = 0;
+  expect(json, BINJSON_CBOR, cb);
+  expect(json, BINJSON_MSGPACK, mp);
+  expect(" { \"e\" : { } , \"a\" : [ ] } ", BINJSON_CBOR, "a2 6165 a0 6161 80");
+  expect(" { \"e\" : { } , \"a\" : [ ] } ", BINJSON_MSGPACK, "82 a165 80 a161 90");
+}
+
+static void test_refused(void) {
+  refuse("[1,");
+  refuse("{\"a\" 1}");
+  refuse("{1:2}");
+  refuse("[1]x");
+  refuse("\"\\q\"");
+  refuse("\"open");
+  refuse("tru");
+  refuse("[1 2]");
+  char deep[200];
+  memset(deep, '[', 64); memset(deep + 64, ']', 64); deep[128] = 0;
+  char *out = NULL; size_t n = 0;
+  CHECK(binjson_encode(deep, 128, BINJSON_CBOR, &out, &n) == 0 && n == 64, "64 levels should encode");
+  free(out);
+  memset(deep, '[', 65); memset(deep + 65, ']', 65); deep[130] = 0;
+  refuse(deep);
+}
+
+int main(void) {
+  test_scalars();
+  test_strings();
+  test_containers();
+  test_refused();
+  if (g_fail) { fprintf(stderr, "binjson_test: %d failure(s)\n", g_fail); return 1; }
+  printf("binjson_test: ok\n");
+  return 0;
+}
@@ -5,223 +5,342 @@
 #include <ctype.h>
 #include <dirent.h>
 #include <unistd.h>
-#include <sys/stat.h>
+#include <stdarg.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <linux/if_bridge.h>
 #include "util.h"
+#include "neigh_cache.h"
+#include "json_writer.h"
+
+/* Bridge/port view for /connections. The topology is read from /sys once per
+ * render and indexed by ifindex; MACs are attributed to ports from the bridge
+ * FDB (neighbour table, AF_BRIDGE) and joined to IPv4 ARP rows by MAC, so the
+ * cost is a few sorts rather than bridges x ports x ARP rows. Without the
+ * netlink table the FDB comes from /sys/class/net/<bridge>/brforward and ARP
+ * from /proc/net/arp.
+ */
+
+typedef struct { char *p; size_t len, cap; int oom; } sbuf_t;
+
+static void sb_printf(sbuf_t *b, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static void sb_printf(sbuf_t *b, const char *fmt, ...) {
+  if (b->oom) return;
+  for (;;) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(b->p + b->len, b->cap - b->len, fmt, ap);
+    va_end(ap);
+    if (n < 0) { b->oom = 1; return; }
+    if ((size_t)n < b->cap - b->len) { b->len += (size_t)n; return; }
+    size_t nc = b->cap * 2;
+    while (nc < b->len + (size_t)n + 1) nc *= 2;
+    char *np = realloc(b->p, nc);
+    if (!np) { b->oom = 1; return; }
+    b->p = np; b->cap = nc;
+  }
+}
+
+/* s as a quoted JSON string */
+static void sb_str(sbuf_t *b, const char *s) {
+  if (!b->oom && jw_escape_append(&b->p, &b->len, &b->cap, s, strlen(s)) != 0) b->oom = 1;
+}
+
+static int sb_init(sbuf_t *b) {
+  b->len = 0; b->oom = 0; b->cap = 8192;
+  b->p = malloc(b->cap);
+  if (!b->p) return -1;
+  b->p[0] = 0;
+  return 0;
+}
+
+static int sb_finish(sbuf_t *b, char **out, size_t *outlen) {
+  if (b->oom) { free(b->p); return -1; }
+  *out = b->p; *outlen = b->len;
+  return 0;
+}
+
+typedef struct { int ifindex; char name[IF_NAMESIZE]; int port0, nports; } bridge_t;
+typedef struct { int ifindex, br, port_no; char name[IF_NAMESIZE]; int mac0, nmac, pair0, npair; } port_t;
+typedef struct { int port; char mac[18]; } mac_attr_t;
+typedef struct { int mac; const char *ip; } mac_ip_t;
+typedef struct { int ifindex, br, port; } if_slot_t;   /* port < 0: the bridge device */
+
+typedef struct {
+  bridge_t *br; int nbr;
+  port_t *port; int nport;
+  if_slot_t *slot; unsigned nslot;       /* open addressing on ifindex */
+  neigh_entry_t *arp; int narp;          /* IPv4 rows with a MAC, sorted by MAC */
+  mac_attr_t *mac; int nmac;             /* sorted by (port, MAC), unique */
+  mac_ip_t *pair; int npair;             /* grouped by port, then MAC */
+} topo_t;
 
 static void strtoupper(char *s){ for(;*s;++s) *s=toupper((unsigned char)*s); }
 
-struct arp_row { char ip[64], mac[64], dev[64]; };
+static int grow(void **v, int n, int *cap, size_t elem) {
+  if (n < *cap) return 0;
+  int nc = *cap ? *cap * 2 : 16;
+  void *nv = realloc(*v, elem * (size_t)nc);
+  if (!nv) return -1;
+  *v = nv; *cap = nc;
+  return 0;
+}
 
-static int list_bridges(char out[][64], int max){
-  int c = 0;
+static const if_slot_t *if_lookup(const topo_t *t, int ifindex) {
+  if (!t->nslot || ifindex <= 0) return NULL;
+  for (unsigned h = (unsigned)ifindex * 2654435761u & (t->nslot - 1);; h = (h + 1) & (t->nslot - 1)) {
+    if (t->slot[h].ifindex == ifindex) return &t->slot[h];
+    if (!t->slot[h].ifindex) return NULL;
+  }
+}
+
+static void if_insert(topo_t *t, int ifindex, int br, int port) {
+  if (ifindex <= 0) return;
+  unsigned h = (unsigned)ifindex * 2654435761u & (t->nslot - 1);
+  while (t->slot[h].ifindex && t->slot[h].ifindex != ifindex) h = (h + 1) & (t->nslot - 1);
+  t->slot[h].ifindex = ifindex; t->slot[h].br = br; t->slot[h].port = port;
+}
+
+/* Bridges named br* (as before) and their ports, from /sys/class/net. */
+static int load_bridges(topo_t *t) {
+  int cbr = 0, cport = 0;
   DIR *d = opendir("/sys/class/net");
   if (!d) return 0;
   struct dirent *de;
-  while ((de = readdir(d)) && c < max) {
-    if (strncmp(de->d_name, "br", 2) == 0) {
-  size_t need = strlen("/sys/class/net/") + strlen(de->d_name) + strlen("/bridge") + 1;
-  char *p = (char*)malloc(need);
-      if (!p) continue;
-      snprintf(p, need, "/sys/class/net/%s/bridge", de->d_name);
-      struct stat st;
-      if (stat(p, &st) == 0) {
-  snprintf(out[c], sizeof(out[0]), "%.63s", de->d_name);
-        c++;
-      }
-      free(p);
+  while ((de = readdir(d))) {
+    if (strncmp(de->d_name, "br", 2) != 0 || strlen(de->d_name) >= IF_NAMESIZE) continue;
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "/sys/class/net/%s/brif", de->d_name);
+    DIR *pd = opendir(path);
+    if (!pd) continue;   /* not a bridge */
+    if (grow((void **)&t->br, t->nbr, &cbr, sizeof(*t->br)) != 0) { closedir(pd); break; }
+    bridge_t *b = &t->br[t->nbr];
+    snprintf(b->name, sizeof(b->name), "%.*s", IF_NAMESIZE - 1, de->d_name);
+    b->ifindex = (int)if_nametoindex(b->name);
+    b->port0 = t->nport; b->nports = 0;
+    struct dirent *pe;
+    while ((pe = readdir(pd))) {
+      if (pe->d_name[0] == '.' || strlen(pe->d_name) >= IF_NAMESIZE) continue;
+      if (grow((void **)&t->port, t->nport, &cport, sizeof(*t->port)) != 0) break;
+      port_t *p = &t->port[t->nport++];
+      memset(p, 0, sizeof(*p));
+      snprintf(p->name, sizeof(p->name), "%.*s", IF_NAMESIZE - 1, pe->d_name);
+      p->ifindex = (int)if_nametoindex(p->name);
+      p->br = t->nbr;
+      p->port_no = -1;
+      char pn[PATH_MAX + IF_NAMESIZE + 16];
+      snprintf(pn, sizeof(pn), "%s/%s/port_no", path, p->name);
+      FILE *f = fopen(pn, "r");
+      if (f) { if (fscanf(f, "%i", &p->port_no) != 1) p->port_no = -1; fclose(f); }
+      b->nports++;
     }
+    closedir(pd);
+    t->nbr++;
   }
   closedir(d);
-  return c;
+  unsigned need = 16;
+  while (need < (unsigned)(t->nbr + t->nport) * 2) need *= 2;
+  t->slot = calloc(need, sizeof(*t->slot));
+  if (!t->slot) return -1;
+  t->nslot = need;
+  for (int i = 0; i < t->nbr; i++) if_insert(t, t->br[i].ifindex, i, -1);
+  for (int i = 0; i < t->nport; i++) if_insert(t, t->port[i].ifindex, t->port[i].br, i);
+  return 0;
 }
 
-static int bridge_ports(const char *br, char out[][64], int max){
-  int c = 0;
-  size_t need = strlen("/sys/class/net/") + strlen(br) + strlen("/brif") + 1;
-  char *dir = (char*)malloc(need);
-  if (!dir) return 0;
-  snprintf(dir, need, "/sys/class/net/%s/brif", br);
-  DIR *d = opendir(dir);
-  if (!d) { free(dir); return 0; }
-  struct dirent *de;
-  while ((de = readdir(d)) && c < max) {
-  if (de->d_name[0] == '.') continue;
-  snprintf(out[c], sizeof(out[0]), "%.63s", de->d_name);
-    c++;
+static int cmp_arp_mac(const void *a, const void *b) {
+  return strcmp(((const neigh_entry_t *)a)->mac, ((const neigh_entry_t *)b)->mac);
+}
+
+static int cmp_attr(const void *a, const void *b) {
+  const mac_attr_t *x = a, *y = b;
+  if (x->port != y->port) return x->port < y->port ? -1 : 1;
+  return strcmp(x->mac, y->mac);
+}
+
+/* First ARP row with this MAC (rows are sorted by MAC), or narp. */
+static int arp_lower_bound(const topo_t *t, const char *mac) {
+  int lo = 0, hi = t->narp;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (strcmp(t->arp[mid].mac, mac) < 0) lo = mid + 1; else hi = mid;
   }
-  closedir(d);
-  free(dir);
-  return c;
-}
-
-static int load_arp(struct arp_row *rows, int max){
-  FILE *f=fopen("/proc/net/arp","r"); if(!f) return 0;
-  char line[512]; int c=0; if(!fgets(line,sizeof(line),f)){ fclose(f); return 0; } // header
-  while(fgets(line,sizeof(line),f) && c<max){
-    char ip[64], mac[64], dev[64];
-    if (sscanf(line,"%63s %*s %*s %63s %*s %63s", ip, mac, dev)==3){
-  snprintf(rows[c].ip, sizeof(rows[c].ip), "%s", ip);
-  snprintf(rows[c].mac, sizeof(rows[c].mac), "%s", mac);
-  strtoupper(rows[c].mac);
-  snprintf(rows[c].dev, sizeof(rows[c].dev), "%s", dev);
-  c++;
+  return lo;
+}
+
+static int add_mac(topo_t *t, int *cmac, int port, const char *mac) {
+  if (grow((void **)&t->mac, t->nmac, cmac, sizeof(*t->mac)) != 0) return -1;
+  t->mac[t->nmac].port = port;
+  snprintf(t->mac[t->nmac].mac, sizeof(t->mac[0].mac), "%s", mac);
+  strtoupper(t->mac[t->nmac].mac);
+  t->nmac++;
+  return 0;
+}
+
+/* The FDB as brctl showmacs reads it: struct __fdb_entry records keyed by
+ * port number, for when the netlink table is unavailable.
+ */
+static void fdb_from_sysfs(topo_t *t, int *cmac) {
+  for (int b = 0; b < t->nbr; b++) {
+    const bridge_t *br = &t->br[b];
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "/sys/class/net/%s/brforward", br->name);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) continue;
+    struct __fdb_entry fe[128];
+    ssize_t n;
+    while ((n = read(fd, fe, sizeof(fe))) > 0) {
+      for (size_t i = 0; i < (size_t)n / sizeof(fe[0]); i++) {
+        if (fe[i].is_local) continue;
+        int no = fe[i].port_no | fe[i].port_hi << 8;
+        for (int p = br->port0; p < br->port0 + br->nports; p++) {
+          if (t->port[p].port_no != no) continue;
+          const unsigned char *m = fe[i].mac_addr;
+          char mac[18];
+          snprintf(mac, sizeof(mac), "%02x:%02x:%02x:%02x:%02x:%02x", m[0], m[1], m[2], m[3], m[4], m[5]);
+          if (add_mac(t, cmac, p, mac) != 0) { close(fd); return; }
+          break;
+        }
+      }
     }
-  } fclose(f); return c;
+    close(fd);
+  }
+}
+
+static int topo_build(topo_t *t) {
+  memset(t, 0, sizeof(*t));
+  if (load_bridges(t) != 0) return -1;
+
+  /* IPv4 neighbours with a MAC (what /proc/net/arp lists) */
+  int n = neigh_cache_snapshot(AF_INET, &t->arp);
+  if (n < 0) n = neigh_proc_arp(&t->arp);
+  for (int i = 0; i < n; i++) {
+    if (!t->arp[i].mac[0] || t->arp[i].state == NUD_NOARP) continue;
+    t->arp[t->narp] = t->arp[i];
+    strtoupper(t->arp[t->narp].mac);
+    t->narp++;
+  }
+  qsort(t->arp, (size_t)t->narp, sizeof(*t->arp), cmp_arp_mac);
+  if (!t->nbr) return 0;
+
+  /* MAC -> port from the FDB; ARP rows sitting directly on a port count too */
+  int cmac = 0;
+  neigh_entry_t *fdb = NULL;
+  int nf = neigh_cache_snapshot(AF_BRIDGE, &fdb);
+  if (nf < 0) { nf = 0; fdb_from_sysfs(t, &cmac); }
+  for (int i = 0; i < nf + t->narp; i++) {
+    const neigh_entry_t *e = i < nf ? &fdb[i] : &t->arp[i - nf];
+    if (i < nf && (e->state & NUD_PERMANENT)) continue;   /* the bridge's own addresses */
+    const if_slot_t *s = if_lookup(t, e->ifindex);
+    if (!s || s->port < 0) continue;
+    if (i < nf && t->br[s->br].ifindex != e->master) continue;
+    if (add_mac(t, &cmac, s->port, e->mac) != 0) break;
+  }
+  free(fdb);
+  qsort(t->mac, (size_t)t->nmac, sizeof(*t->mac), cmp_attr);
+  int u = 0;
+  for (int i = 0; i < t->nmac; i++)
+    if (!u || cmp_attr(&t->mac[u - 1], &t->mac[i]) != 0) t->mac[u++] = t->mac[i];
+  t->nmac = u;
+
+  /* join each attributed MAC to the ARP rows of the same bridge */
+  int cpair = 0;
+  for (int i = 0; i < t->nmac; i++) {
+    port_t *p = &t->port[t->mac[i].port];
+    if (!p->nmac) { p->mac0 = i; p->pair0 = t->npair; }
+    p->nmac++;
+    for (int a = arp_lower_bound(t, t->mac[i].mac); a < t->narp && strcmp(t->arp[a].mac, t->mac[i].mac) == 0; a++) {
+      const if_slot_t *s = if_lookup(t, t->arp[a].ifindex);
+      if (!s || s->br != p->br) continue;
+      if (grow((void **)&t->pair, t->npair, &cpair, sizeof(*t->pair)) != 0) break;
+      t->pair[t->npair].mac = i;
+      t->pair[t->npair].ip = t->arp[a].ip;
+      t->npair++;
+      p->npair++;
+    }
+  }
+  return 0;
+}
+
+static void topo_free(topo_t *t) {
+  free(t->br); free(t->port); free(t->slot); free(t->arp); free(t->mac); free(t->pair);
 }
 
 int render_connections_plain(char **buf_out, size_t *len_out) __attribute__((visibility("default")));
 __attribute__((used, visibility("default")))
 int render_connections_plain(char **buf_out, size_t *len_out){
-  char *buf = NULL; size_t cap = 8192; size_t len = 0;
-  buf = (char*)malloc(cap);
-  if (!buf) return -1;
-  #define APPEND(fmt,...) do{ \
-    char t[1024]; \
-    int _app_n = snprintf(t, sizeof(t), fmt, ##__VA_ARGS__); \
-    /* snprintf returns the number of characters that would have been written; cap copy to buffer size-1 */ \
-    if (_app_n >= (int)sizeof(t)) _app_n = (int)sizeof(t) - 1; \
-    if (_app_n > 0) { \
-      if (len + (size_t)_app_n + 1 > cap) { \
-        while (cap < len + (size_t)_app_n + 1) cap *= 2; \
-        char *nb2 = (char*)realloc(buf, cap); \
-        if (!nb2) { free(buf); return -1; } \
-        buf = nb2; \
-      } \
-      memcpy(buf + len, t, (size_t)_app_n); \
-      len += (size_t)_app_n; \
-      buf[len] = 0; \
-    } \
-  } while(0)
-
-  char bridges[32][64]; int nb = list_bridges(bridges, 32);
-  fprintf(stderr, "[render_connections] listed %d bridges\n", nb);
-  struct arp_row *arps = NULL; int na = 0;
-  /* allocate arp rows on heap to avoid large stack usage */
-  arps = (struct arp_row*)malloc(sizeof(*arps) * 1024);
-  if (arps) {
-    na = load_arp(arps, 1024);
-  } else {
-    /* fallback: try to load into a small stack array if malloc fails */
-    struct arp_row tmp_arps[64]; na = load_arp(tmp_arps, 64);
-    if (na > 0) {
-      /* copy to heap for consistent free semantics */
-      arps = (struct arp_row*)malloc(sizeof(*arps) * na);
-      if (arps) memcpy(arps, tmp_arps, sizeof(*arps) * na);
-    }
-  }
-  fprintf(stderr, "[render_connections] loaded %d arp rows (arps=%p)\n", na, (void*)arps);
-
-  APPEND("# connections (plugin)\n");
-  if (nb>0){
-  for (int i = 0; i < nb; i++) {
-      /* allocate ports array on heap to avoid large stack frames */
-      char (*ports)[64] = (char(*)[64])malloc(sizeof(char[64][64]));
-      int np = 0;
-      if (ports) {
-        np = bridge_ports(bridges[i], ports, 64);
-    fprintf(stderr, "[render_connections] bridge %s has %d ports\n", bridges[i], np);
-        for (int p = 0; p < np; p++) {
-          for (int a = 0; a < na; a++) {
-            if (arps && strcmp(arps[a].dev, ports[p]) == 0) {
-              APPEND(" . %s\t%s\t%s\n", bridges[i], ports[p], arps[a].mac);
-            }
-          }
-        }
-        for (int a = 0; a < na; a++) {
-          for (int p = 0; p < np; p++) {
-            if (arps && strcmp(arps[a].dev, ports[p]) == 0) {
-              APPEND(" ~ %s\t%s\t%s\n", ports[p], arps[a].mac, arps[a].ip);
-            }
-          }
-        }
-      }
-      APPEND("_\n");
-      if (ports) free(ports);
+  topo_t t; sbuf_t b;
+  if (sb_init(&b) != 0) return -1;
+  if (topo_build(&t) != 0) { topo_free(&t); free(b.p); return -1; }
+  sb_printf(&b, "# connections (plugin)\n");
+  if (t.nbr > 0) {
+    for (int i = 0; i < t.nbr; i++) {
+      const bridge_t *br = &t.br[i];
+      for (int p = br->port0; p < br->port0 + br->nports; p++)
+        for (int m = t.port[p].mac0; m < t.port[p].mac0 + t.port[p].nmac; m++)
+          sb_printf(&b, " . %s\t%s\t%s\n", br->name, t.port[p].name, t.mac[m].mac);
+      for (int p = br->port0; p < br->port0 + br->nports; p++)
+        for (int k = t.port[p].pair0; k < t.port[p].pair0 + t.port[p].npair; k++)
+          sb_printf(&b, " ~ %s\t%s\t%s\n", t.port[p].name, t.mac[t.pair[k].mac].mac, t.pair[k].ip);
+      sb_printf(&b, "_\n");
     }
   } else {
-    for (int a = 0; a < na; a++) {
-      if (arps) APPEND(" ~ %s\t%s\t%s\n", arps[a].dev, arps[a].mac, arps[a].ip);
-    }
+    for (int a = 0; a < t.narp; a++) sb_printf(&b, " ~ %s\t%s\t%s\n", t.arp[a].dev, t.arp[a].mac, t.arp[a].ip);
   }
+  topo_free(&t);
+  return sb_finish(&b, buf_out, len_out);
+}
 
-  *buf_out = buf; *len_out = len;
-  if (arps) free(arps);
-  return 0;
+static int cmp_str_ptr(const void *a, const void *b) {
+  return strcmp(*(const char *const *)a, *(const char *const *)b);
 }
 
 /* Render connections as JSON for consumption by the web UI */
 int render_connections_json(char **buf_out, size_t *len_out) __attribute__((visibility("default")));
 int render_connections_json(char **buf_out, size_t *len_out){
-  char *buf = NULL; size_t cap = 8192; size_t len = 0;
-  buf = (char*)malloc(cap);
-  if (!buf) return -1;
-  #define JAPPEND(fmt,...) do{ \
-    char t[1024]; \
-    int _app_n = snprintf(t, sizeof(t), fmt, ##__VA_ARGS__); \
-    if (_app_n >= (int)sizeof(t)) _app_n = (int)sizeof(t) - 1; \
-    if (_app_n > 0) { \
-      if (len + (size_t)_app_n + 1 > cap) { \
-        while (cap < len + (size_t)_app_n + 1) cap *= 2; \
-        char *nb2 = (char*)realloc(buf, cap); \
-        if (!nb2) { free(buf); return -1; } \
-        buf = nb2; \
-      } \
-      memcpy(buf + len, t, (size_t)_app_n); \
-      len += (size_t)_app_n; \
-      buf[len] = 0; \
-    } \
-  } while(0)
-
-  JAPPEND("{\"ports\":[");
-  char bridges[32][64]; int nb = list_bridges(bridges, 32);
-  struct arp_row *arps = NULL; int na = 0;
-  arps = (struct arp_row*)malloc(sizeof(*arps) * 1024);
-  if (arps) na = load_arp(arps, 1024);
-
+  topo_t t; sbuf_t b;
+  if (sb_init(&b) != 0) return -1;
+  if (topo_build(&t) != 0) { topo_free(&t); free(b.p); return -1; }
+  const char **ips = malloc(sizeof(*ips) * (size_t)(t.npair ? t.npair : 1));
+  if (!ips) { topo_free(&t); free(b.p); return -1; }
+  sb_printf(&b, "{\"ports\":[");
   int first_port = 1;
-  if (nb>0){
-    for (int i = 0; i < nb; i++) {
-      char (*ports)[64] = (char(*)[64])malloc(sizeof(char[64][64]));
-      int np = 0;
-      if (ports) {
-        np = bridge_ports(bridges[i], ports, 64);
-        for (int p = 0; p < np; p++) {
-          /* collect macs and ips for this port */
-          int mac_count = 0; int ip_count = 0;
-          char macs[64][64]; char ips[64][64];
-          for (int a = 0; a < na; a++) {
-            if (arps && strcmp(arps[a].dev, ports[p]) == 0) {
-              /* add mac */
-              int dup = 0; for (int k=0;k<mac_count;k++) if (strcmp(macs[k], arps[a].mac)==0) dup=1;
-              if (!dup) { snprintf(macs[mac_count], sizeof(macs[0]), "%s", arps[a].mac); mac_count++; }
-              /* add ip */
-              int dup2 = 0; for (int k=0;k<ip_count;k++) if (strcmp(ips[k], arps[a].ip)==0) dup2=1;
-              if (!dup2) { snprintf(ips[ip_count], sizeof(ips[0]), "%s", arps[a].ip); ip_count++; }
-            }
-          }
-          if (!first_port) JAPPEND(",");
-          JAPPEND("{\"port\":\"%s\",\"bridge\":\"%s\",\"macs\":[", ports[p], bridges[i]);
-          for (int m=0;m<mac_count;m++){ if (m) JAPPEND(","); JAPPEND("\"%s\"", macs[m]); }
-          JAPPEND("] ,\"ips\":[");
-          for (int m=0;m<ip_count;m++){ if (m) JAPPEND(","); JAPPEND("\"%s\"", ips[m]); }
-          JAPPEND("] ,\"notes\":\"\"}");
-          first_port = 0;
-        }
-      }
-      if (ports) free(ports);
+  if (t.nbr > 0) {
+    for (int p = 0; p < t.nport; p++) {
+      const port_t *pt = &t.port[p];
+      sb_printf(&b, "%s{\"port\":", first_port ? "" : ",");
+      sb_str(&b, pt->name);
+      sb_printf(&b, ",\"bridge\":");
+      sb_str(&b, t.br[pt->br].name);
+      sb_printf(&b, ",\"macs\":[");
+      for (int m = 0; m < pt->nmac; m++) { if (m) sb_printf(&b, ","); sb_str(&b, t.mac[pt->mac0 + m].mac); }
+      /* one IP may sit behind several MACs of a port */
+      int ni = 0;
+      for (int k = 0; k < pt->npair; k++) ips[ni++] = t.pair[pt->pair0 + k].ip;
+      qsort(ips, (size_t)ni, sizeof(*ips), cmp_str_ptr);
+      sb_printf(&b, "],\"ips\":[");
+      for (int k = 0, out = 0; k < ni; k++)
+        if (!k || strcmp(ips[k - 1], ips[k]) != 0) { if (out++) sb_printf(&b, ","); sb_str(&b, ips[k]); }
+      sb_printf(&b, "],\"notes\":\"\"}");
+      first_port = 0;
     }
   } else {
     /* no bridges: iterate arp rows and expose ports as device entries */
-    for (int a = 0; a < na; a++) {
-      if (!first_port) JAPPEND(",");
-      JAPPEND("{\"port\":\"%s\",\"bridge\":\"\",\"macs\":[\"%s\"],\"ips\":[\"%s\"],\"notes\":\"\"}", arps[a].dev, arps[a].mac, arps[a].ip);
+    for (int a = 0; a < t.narp; a++) {
+      sb_printf(&b, "%s{\"port\":", first_port ? "" : ",");
+      sb_str(&b, t.arp[a].dev);
+      sb_printf(&b, ",\"bridge\":\"\",\"macs\":[");
+      sb_str(&b, t.arp[a].mac);
+      sb_printf(&b, "],\"ips\":[");
+      sb_str(&b, t.arp[a].ip);
+      sb_printf(&b, "],\"notes\":\"\"}");
       first_port = 0;
     }
   }
-
-  JAPPEND("]}\n");
-  *buf_out = buf; *len_out = len;
-  if (arps) free(arps);
-  return 0;
+  sb_printf(&b, "]}\n");
+  free(ips);
+  topo_free(&t);
+  return sb_finish(&b, buf_out, len_out);
 }
-
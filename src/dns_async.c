@@ -0,0 +1,354 @@
+#include "dns_async.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/* Lookups live in a fixed slot table: QUEUED -> SENT -> (freed | FAILED).
+ * FAILED slots double as the negative cache so an unknown address is not
+ * re-queried on every page load; successful names go to the caller's cache.
+ */
+#define DNS_SLOTS     1024
+#define DNS_MAX_NS    4
+#define DNS_MSG_MAX   1232
+
+enum { SLOT_FREE = 0, SLOT_QUEUED, SLOT_SENT, SLOT_FAILED };
+
+struct dns_slot {
+  uint32_t ip;          /* network byte order */
+  uint8_t  state;
+  uint8_t  tries;
+  uint16_t id;
+  uint64_t deadline;    /* monotonic ms: attempt deadline (SENT) or retry time (FAILED) */
+};
+
+static struct {
+  pthread_mutex_t lock;
+  pthread_t thread;
+  volatile int running;
+  int sock;
+  int wake[2];
+  struct sockaddr_in ns[DNS_MAX_NS];
+  int nns;
+  int timeout_ms, attempts, max_inflight, negative_ttl;
+  dns_async_result_cb cb;
+  void *user;
+  uint64_t rng;
+  struct dns_slot slot[DNS_SLOTS];
+  dns_async_stats_t st;
+} D = { .lock = PTHREAD_MUTEX_INITIALIZER, .sock = -1, .wake = { -1, -1 } };
+
+static uint64_t mono_ms(void) {
+  struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static uint16_t next_id(void) {
+  /* xorshift64; seeded from /dev/urandom so IDs are not guessable */
+  D.rng ^= D.rng << 13; D.rng ^= D.rng >> 7; D.rng ^= D.rng << 17;
+  return (uint16_t)(D.rng >> 24);
+}
+
+static int add_server(const char *spec) {
+  if (D.nns >= DNS_MAX_NS) return 0;
+  char host[64]; snprintf(host, sizeof(host), "%s", spec);
+  int port = 53;
+  char *colon = strchr(host, ':');
+  if (colon) { *colon = '\0'; port = atoi(colon + 1); if (port <= 0 || port > 65535) return 0; }
+  struct sockaddr_in *sa = &D.ns[D.nns];
+  memset(sa, 0, sizeof(*sa));
+  sa->sin_family = AF_INET; sa->sin_port = htons((uint16_t)port);
+  if (inet_pton(AF_INET, host, &sa->sin_addr) != 1) return 0; /* IPv6 nameservers are not used */
+  D.nns++;
+  return 1;
+}
+
+static void load_resolv_conf(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f) return;
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+    char *p = line; while (isspace((unsigned char)*p)) p++;
+    if (*p == '#' || *p == ';') continue;
+    if (strncmp(p, "nameserver", 10) == 0 && isspace((unsigned char)p[10])) {
+      char addr[64];
+      if (sscanf(p + 10, "%63s", addr) == 1 && !strchr(addr, ':')) add_server(addr);
+    } else if (strncmp(p, "options", 7) == 0 && isspace((unsigned char)p[7])) {
+      char *t;
+      if (!D.timeout_ms && (t = strstr(p, "timeout:"))) D.timeout_ms = atoi(t + 8) * 1000;
+      if (!D.attempts && (t = strstr(p, "attempts:"))) D.attempts = atoi(t + 9);
+    }
+  }
+  fclose(f);
+}
+
+/* "4.3.2.1.in-addr.arpa" in wire format; returns encoded length. */
+static size_t encode_ptr_qname(uint32_t ip_n, unsigned char *out) {
+  const unsigned char *b = (const unsigned char *)&ip_n;
+  size_t o = 0;
+  for (int i = 3; i >= 0; i--) {
+    char lab[4]; int n = snprintf(lab, sizeof(lab), "%u", b[i]);
+    out[o++] = (unsigned char)n; memcpy(out + o, lab, (size_t)n); o += (size_t)n;
+  }
+  out[o++] = 7; memcpy(out + o, "in-addr", 7); o += 7;
+  out[o++] = 4; memcpy(out + o, "arpa", 4); o += 4;
+  out[o++] = 0;
+  return o;
+}
+
+/* Decode a (possibly compressed) name to dotted text. Returns the offset just
+ * past the name at its original position, or -1 on a malformed message.
+ */
+static int read_name(const unsigned char *m, size_t len, size_t off, char *out, size_t outlen) {
+  size_t o = 0; int next = -1, jumps = 0;
+  for (;;) {
+    if (off >= len) return -1;
+    unsigned c = m[off];
+    if ((c & 0xC0) == 0xC0) {
+      if (off + 1 >= len || ++jumps > 16) return -1;
+      if (next < 0) next = (int)off + 2;
+      off = ((c & 0x3F) << 8) | m[off + 1];
+      continue;
+    }
+    if (c & 0xC0) return -1;
+    if (c == 0) { if (next < 0) next = (int)off + 1; break; }
+    if (off + 1 + c > len) return -1;
+    if (out) {
+      if (o && o + 1 < outlen) out[o++] = '.';
+      for (unsigned i = 0; i < c && o + 1 < outlen; i++) out[o++] = (char)m[off + 1 + i];
+    }
+    off += 1 + c;
+  }
+  if (out && outlen) out[o < outlen ? o : outlen - 1] = '\0';
+  return next;
+}
+
+static void send_query(struct dns_slot *s, uint64_t now) {
+  unsigned char q[64];
+  s->id = next_id();
+  q[0] = (unsigned char)(s->id >> 8); q[1] = (unsigned char)s->id;
+  q[2] = 0x01; q[3] = 0x00;                 /* RD */
+  q[4] = 0; q[5] = 1;                       /* QDCOUNT */
+  memset(q + 6, 0, 6);
+  size_t o = 12 + encode_ptr_qname(s->ip, q + 12);
+  q[o++] = 0; q[o++] = 12;                  /* PTR */
+  q[o++] = 0; q[o++] = 1;                   /* IN */
+  const struct sockaddr_in *ns = &D.ns[s->tries % D.nns];
+  s->tries++;
+  s->state = SLOT_SENT;
+  s->deadline = now + (uint64_t)D.timeout_ms;
+  D.st.sent++;
+  /* a failed sendto just runs into the deadline and moves to the next server */
+  (void)sendto(D.sock, q, o, MSG_DONTWAIT, (const struct sockaddr *)ns, sizeof(*ns));
+}
+
+struct dns_done { uint32_t ip; uint32_t ttl; char name[256]; int ok; };
+
+static void fail_or_retry(struct dns_slot *s, uint64_t now, struct dns_done *done, int *ndone) {
+  D.st.inflight--;
+  if (s->tries < (unsigned)(D.attempts * D.nns)) { s->state = SLOT_QUEUED; D.st.queued++; return; }
+  D.st.failed++;
+  s->state = SLOT_FAILED; s->deadline = now + (uint64_t)D.negative_ttl * 1000u;
+  done[*ndone].ip = s->ip; done[*ndone].ok = 0; done[*ndone].name[0] = '\0'; done[*ndone].ttl = 0; (*ndone)++;
+}
+
+static void handle_reply(const unsigned char *m, size_t len, const struct sockaddr_in *from, uint64_t now,
+                         struct dns_done *done, int *ndone) {
+  if (len < 12 || !(m[2] & 0x80)) return;
+  uint16_t id = (uint16_t)((m[0] << 8) | m[1]);
+  int rcode = m[3] & 0x0F;
+  unsigned qd = (unsigned)((m[4] << 8) | m[5]), an = (unsigned)((m[6] << 8) | m[7]);
+  if (qd != 1) return;
+  char qname[256];
+  int off = read_name(m, len, 12, qname, sizeof(qname));
+  if (off < 0 || (size_t)off + 4 > len) return;
+  off += 4;
+  for (int i = 0; i < DNS_SLOTS; i++) {
+    struct dns_slot *s = &D.slot[i];
+    if (s->state != SLOT_SENT || s->id != id) continue;
+    /* the reply must come from the server this attempt was sent to and echo our question */
+    const struct sockaddr_in *ns = &D.ns[(s->tries - 1) % D.nns];
+    if (from->sin_addr.s_addr != ns->sin_addr.s_addr || from->sin_port != ns->sin_port) continue;
+    unsigned char want[32]; char wname[64];
+    encode_ptr_qname(s->ip, want);
+    if (read_name(want, sizeof(want), 0, wname, sizeof(wname)) < 0 || strcasecmp(wname, qname) != 0) continue;
+    if (rcode != 0 && rcode != 3) { fail_or_retry(s, now, done, ndone); return; } /* SERVFAIL/REFUSED: next server */
+    char name[256]; name[0] = '\0'; uint32_t ttl = 0;
+    size_t p = (size_t)off;
+    for (unsigned a = 0; rcode == 0 && a < an && !name[0]; a++) {
+      int r = read_name(m, len, p, NULL, 0);
+      if (r < 0 || (size_t)r + 10 > len) break;
+      p = (size_t)r;
+      unsigned type = (unsigned)((m[p] << 8) | m[p + 1]);
+      ttl = ((uint32_t)m[p + 4] << 24) | ((uint32_t)m[p + 5] << 16) | ((uint32_t)m[p + 6] << 8) | m[p + 7];
+      unsigned rdlen = (unsigned)((m[p + 8] << 8) | m[p + 9]);
+      p += 10;
+      if (p + rdlen > len) break;
+      if (type == 12 && read_name(m, len, p, name, sizeof(name)) < 0) name[0] = '\0';
+      p += rdlen;
+    }
+    D.st.inflight--;
+    if (name[0]) {
+      D.st.answered++;
+      s->state = SLOT_FREE;
+      done[*ndone].ok = 1; snprintf(done[*ndone].name, sizeof(done[*ndone].name), "%s", name);
+    } else {
+      D.st.failed++;
+      s->state = SLOT_FAILED; s->deadline = now + (uint64_t)D.negative_ttl * 1000u;
+      done[*ndone].ok = 0; done[*ndone].name[0] = '\0';
+    }
+    done[*ndone].ip = s->ip; done[*ndone].ttl = ttl; (*ndone)++;
+    return;
+  }
+}
+
+static void deliver(struct dns_done *done, int n) {
+  for (int i = 0; i < n; i++) {
+    char ip[INET_ADDRSTRLEN];
+    struct in_addr a; a.s_addr = done[i].ip;
+    if (!inet_ntop(AF_INET, &a, ip, sizeof(ip))) continue;
+    if (D.cb) D.cb(ip, done[i].ok ? done[i].name : NULL, done[i].ttl, D.user);
+  }
+}
+
+static void *resolver_thread(void *arg) {
+  (void)arg;
+  struct dns_done *done = malloc(sizeof(*done) * 64);
+  if (!done) return NULL;
+  while (D.running) {
+    uint64_t now = mono_ms();
+    uint64_t wake_at = now + 1000;
+    int ndone = 0;
+    pthread_mutex_lock(&D.lock);
+    for (int i = 0; i < DNS_SLOTS && ndone < 64; i++) {
+      struct dns_slot *s = &D.slot[i];
+      if (s->state == SLOT_SENT && s->deadline <= now) { D.st.timeouts++; fail_or_retry(s, now, done, &ndone); }
+    }
+    for (int i = 0; i < DNS_SLOTS && D.st.inflight < (unsigned)D.max_inflight; i++) {
+      struct dns_slot *s = &D.slot[i];
+      if (s->state != SLOT_QUEUED) continue;
+      D.st.queued--; D.st.inflight++;
+      send_query(s, now);
+    }
+    for (int i = 0; i < DNS_SLOTS; i++)
+      if (D.slot[i].state == SLOT_SENT && D.slot[i].deadline < wake_at) wake_at = D.slot[i].deadline;
+    pthread_mutex_unlock(&D.lock);
+    deliver(done, ndone);
+
+    struct pollfd pfd[2] = { { D.sock, POLLIN, 0 }, { D.wake[0], POLLIN, 0 } };
+    int timeout = wake_at > now ? (int)(wake_at - now) : 0;
+    if (poll(pfd, 2, timeout) <= 0) continue;
+    if (pfd[1].revents & POLLIN) { char b[64]; while (read(D.wake[0], b, sizeof(b)) > 0) {} }
+    if (pfd[0].revents & POLLIN) {
+      unsigned char m[DNS_MSG_MAX];
+      ndone = 0;
+      now = mono_ms();
+      for (;;) {
+        struct sockaddr_in from; socklen_t fl = sizeof(from);
+        ssize_t n = recvfrom(D.sock, m, sizeof(m), MSG_DONTWAIT, (struct sockaddr *)&from, &fl);
+        if (n < 0) break;
+        pthread_mutex_lock(&D.lock);
+        handle_reply(m, (size_t)n, &from, now, done, &ndone);
+        pthread_mutex_unlock(&D.lock);
+        if (ndone >= 64) { deliver(done, ndone); ndone = 0; }
+      }
+      deliver(done, ndone);
+    }
+  }
+  free(done);
+  return NULL;
+}
+
+int dns_async_start(const dns_async_config_t *cfg) {
+  if (D.running) return 0;
+  D.nns = 0; D.timeout_ms = 0; D.attempts = 0;
+  memset(&D.st, 0, sizeof(D.st));
+  memset(D.slot, 0, sizeof(D.slot));
+  if (cfg && cfg->servers && cfg->servers[0]) {
+    char *list = strdup(cfg->servers);
+    if (!list) return -1;
+    for (char *save = NULL, *t = strtok_r(list, ", \t", &save); t; t = strtok_r(NULL, ", \t", &save)) add_server(t);
+    free(list);
+  } else {
+    load_resolv_conf(cfg && cfg->resolv_conf && cfg->resolv_conf[0] ? cfg->resolv_conf : "/etc/resolv.conf");
+    if (D.nns == 0) add_server("127.0.0.1"); /* resolv.conf(5) default */
+  }
+  if (D.nns == 0) return -1;
+  if (cfg && cfg->timeout_ms > 0) D.timeout_ms = cfg->timeout_ms;
+  if (cfg && cfg->attempts > 0) D.attempts = cfg->attempts;
+  if (D.timeout_ms <= 0) D.timeout_ms = 1000;
+  if (D.attempts <= 0) D.attempts = 2;
+  if (D.attempts > 5) D.attempts = 5;
+  D.max_inflight = cfg && cfg->max_inflight > 0 ? cfg->max_inflight : 64;
+  D.negative_ttl = cfg && cfg->negative_ttl > 0 ? cfg->negative_ttl : 60;
+  D.cb = cfg ? cfg->cb : NULL; D.user = cfg ? cfg->user : NULL;
+  D.st.servers = (unsigned)D.nns;
+
+  int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+  if (fd < 0 || read(fd, &D.rng, sizeof(D.rng)) != (ssize_t)sizeof(D.rng)) D.rng = (uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32);
+  if (fd >= 0) close(fd);
+  if (!D.rng) D.rng = 0x9E3779B97F4A7C15ull;
+
+  D.sock = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+  if (D.sock < 0) return -1;
+  if (pipe2(D.wake, O_CLOEXEC | O_NONBLOCK) != 0) { close(D.sock); D.sock = -1; return -1; }
+  D.running = 1;
+  if (pthread_create(&D.thread, NULL, resolver_thread, NULL) != 0) {
+    D.running = 0; close(D.sock); close(D.wake[0]); close(D.wake[1]);
+    D.sock = D.wake[0] = D.wake[1] = -1;
+    return -1;
+  }
+  return 0;
+}
+
+void dns_async_stop(void) {
+  if (!D.running) return;
+  D.running = 0;
+  ssize_t w = write(D.wake[1], "x", 1); (void)w;
+  pthread_join(D.thread, NULL);
+  close(D.sock); close(D.wake[0]); close(D.wake[1]);
+  D.sock = D.wake[0] = D.wake[1] = -1;
+}
+
+int dns_async_running(void) { return D.running; }
+
+int dns_async_submit(const char *ip) {
+  struct in_addr a;
+  if (!ip || !D.running || inet_pton(AF_INET, ip, &a) != 1) return -1;
+  uint64_t now = mono_ms();
+  int free_i = -1, rc;
+  pthread_mutex_lock(&D.lock);
+  for (int i = 0; i < DNS_SLOTS; i++) {
+    struct dns_slot *s = &D.slot[i];
+    if (s->state == SLOT_FAILED && s->deadline <= now) s->state = SLOT_FREE; /* negative entry expired */
+    if (s->state == SLOT_FREE) { if (free_i < 0) free_i = i; continue; }
+    if (s->ip == a.s_addr) { D.st.suppressed++; pthread_mutex_unlock(&D.lock); return 0; }
+  }
+  if (free_i < 0) { D.st.dropped++; rc = -1; }
+  else {
+    struct dns_slot *s = &D.slot[free_i];
+    s->ip = a.s_addr; s->state = SLOT_QUEUED; s->tries = 0;
+    D.st.queued++; D.st.submitted++;
+    rc = 1;
+  }
+  pthread_mutex_unlock(&D.lock);
+  if (rc == 1) { ssize_t w = write(D.wake[1], "x", 1); (void)w; }
+  return rc;
+}
+
+void dns_async_get_stats(dns_async_stats_t *st) {
+  if (!st) return;
+  pthread_mutex_lock(&D.lock);
+  *st = D.st;
+  pthread_mutex_unlock(&D.lock);
+}
@@ -0,0 +1,52 @@
+#ifndef OLSRD_STATUS_DNS_ASYNC_H
+#define OLSRD_STATUS_DNS_ASYNC_H
+#include <stddef.h>
+#include <stdint.h>
+
+/* Asynchronous IPv4 reverse (PTR) resolver.
+ * One background thread owns a UDP socket, sends queries straight to the
+ * configured nameservers, keeps many of them in flight and hands results to
+ * a callback. Callers only ever enqueue; nothing here blocks a request.
+ */
+
+/* Called from the resolver thread. name is NULL when the lookup failed
+ * (NXDOMAIN, SERVFAIL, no PTR record or every attempt timed out).
+ */
+typedef void (*dns_async_result_cb)(const char *ip, const char *name, uint32_t ttl, void *user);
+
+typedef struct {
+  const char *resolv_conf;  /* default /etc/resolv.conf */
+  const char *servers;      /* optional "ip[:port],..." list; overrides resolv_conf */
+  int timeout_ms;           /* per attempt; 0 = resolv.conf "timeout:" or 1000 */
+  int attempts;             /* 0 = resolv.conf "attempts:" or 2 */
+  int max_inflight;         /* outstanding queries on the wire; 0 = 64 */
+  int negative_ttl;         /* seconds a failed address is not re-queried; 0 = 60 */
+  dns_async_result_cb cb;
+  void *user;
+} dns_async_config_t;
+
+typedef struct {
+  unsigned long submitted;  /* addresses accepted into the queue */
+  unsigned long sent;       /* datagrams sent, retries included */
+  unsigned long answered;   /* PTR names delivered */
+  unsigned long failed;     /* NXDOMAIN / error / no PTR in answer */
+  unsigned long timeouts;   /* attempts that hit their deadline */
+  unsigned long dropped;    /* submissions refused because the table was full */
+  unsigned long suppressed; /* submissions skipped: pending or recently failed */
+  unsigned int  queued;
+  unsigned int  inflight;
+  unsigned int  servers;
+} dns_async_stats_t;
+
+/* Returns 0 when the resolver thread is running, -1 if no usable nameserver
+ * or the socket/thread could not be created.
+ */
+int dns_async_start(const dns_async_config_t *cfg);
+void dns_async_stop(void);
+int dns_async_running(void);
+/* Queue a PTR lookup for a dotted IPv4 address. Returns 1 if queued,
+ * 0 if already pending or recently failed, -1 on bad input / not running / full.
+ */
+int dns_async_submit(const char *ip);
+void dns_async_get_stats(dns_async_stats_t *st);
+#endif
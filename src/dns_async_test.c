@@ -0,0 +1,186 @@
+/* dns_async against an in-process UDP nameserver: PTR answers with and
+ * without compression, NXDOMAIN, replies with the wrong ID, truncated and
+ * looping records, a CNAME ahead of the PTR, and a server list longer than
+ * any fixed buffer. Run with `make test`.
+ */
+#include "dns_async.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+static int g_fail;
+
+#define CHECK(cond, ...) do { if (!(cond)) { fprintf(stderr, __VA_ARGS__); fputc('\n', stderr); g_fail++; } } while (0)
+
+/* --- stand-in nameserver; behaviour is picked by the address' last octet -- */
+
+static int g_ns_sock;
+static volatile int g_ns_stop;
+
+static size_t put_name(unsigned char *m, size_t o, const char *dotted) {
+  while (*dotted) {
+    size_t n = strcspn(dotted, ".");
+    m[o++] = (unsigned char)n; memcpy(m + o, dotted, n); o += n;
+    dotted += n; if (*dotted == '.') dotted++;
+  }
+  m[o++] = 0;
+  return o;
+}
+
+static size_t put_rr(unsigned char *m, size_t o, unsigned type, uint32_t ttl) {
+  m[o++] = 0xC0; m[o++] = 12;               /* owner: the question name */
+  m[o++] = 0; m[o++] = (unsigned char)type;
+  m[o++] = 0; m[o++] = 1;
+  m[o++] = (unsigned char)(ttl >> 24); m[o++] = (unsigned char)(ttl >> 16); m[o++] = (unsigned char)(ttl >> 8); m[o++] = (unsigned char)ttl;
+  return o;
+}
+
+static void set_rdlen(unsigned char *m, size_t at, size_t n) { m[at] = (unsigned char)(n >> 8); m[at + 1] = (unsigned char)n; }
+
+static void *ns_thread(void *arg) {
+  (void)arg;
+  unsigned char q[512], m[512];
+  while (!g_ns_stop) {
+    struct pollfd p = { g_ns_sock, POLLIN, 0 };
+    if (poll(&p, 1, 50) <= 0) continue;
+    struct sockaddr_in from; socklen_t fl = sizeof(from);
+    ssize_t n = recvfrom(g_ns_sock, q, sizeof(q), 0, (struct sockaddr *)&from, &fl);
+    if (n < 17) continue;
+    /* first label of d.c.b.a.in-addr.arpa is the last octet */
+    int last = atoi((const char *)q + 13);
+    size_t qend = 12;
+    while (qend < (size_t)n && q[qend]) qend += 1 + q[qend];
+    qend += 5;
+    memcpy(m, q, qend);
+    m[2] = 0x81; m[3] = 0x80;                 /* QR RD RA, NOERROR */
+    m[6] = m[7] = m[8] = m[9] = m[10] = m[11] = 0;
+    size_t o = qend, rd;
+    switch (last) {
+      case 1:                                   /* plain PTR */
+        m[7] = 1;
+        o = put_rr(m, o, 12, 300); rd = o; o += 2;
+        o = put_name(m, o, "one.mesh.test"); set_rdlen(m, rd, o - rd - 2);
+        break;
+      case 2:                                   /* NXDOMAIN */
+        m[3] = 0x83;
+        break;
+      case 3:                                   /* wrong ID only: must time out */
+        m[0] ^= 0x55;
+        m[7] = 1;
+        o = put_rr(m, o, 12, 300); rd = o; o += 2;
+        o = put_name(m, o, "spoofed.test"); set_rdlen(m, rd, o - rd - 2);
+        break;
+      case 4:                                   /* rdlength past the end */
+        m[7] = 1;
+        o = put_rr(m, o, 12, 300); set_rdlen(m, o, 200); o += 2;
+        o = put_name(m, o, "cut");
+        break;
+      case 5:                                   /* rdata points at itself */
+        m[7] = 1;
+        o = put_rr(m, o, 12, 300); set_rdlen(m, o, 2); o += 2;
+        m[o] = (unsigned char)(0xC0 | (o >> 8)); m[o + 1] = (unsigned char)o; o += 2;
+        break;
+      case 6:                                   /* CNAME, then PTR compressed onto it */
+        m[7] = 2;
+        o = put_rr(m, o, 5, 60); rd = o; o += 2;
+        { size_t cname = o; o = put_name(m, o, "six.alias.test"); set_rdlen(m, rd, o - rd - 2);
+          o = put_rr(m, o, 12, 120); rd = o; o += 2;
+          m[o++] = 3; memcpy(m + o, "six", 3); o += 3;
+          m[o++] = (unsigned char)(0xC0 | (cname + 4) >> 8); m[o++] = (unsigned char)(cname + 4); /* "alias.test" */
+          set_rdlen(m, rd, o - rd - 2); }
+        break;
+      default:
+        m[3] = 0x82;                            /* SERVFAIL */
+        break;
+    }
+    sendto(g_ns_sock, m, o, 0, (struct sockaddr *)&from, fl);
+  }
+  return NULL;
+}
+
+/* --- results --------------------------------------------------------------- */
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static char g_name[8][256];
+static uint32_t g_ttl[8];
+static int g_done[8];
+
+static void on_result(const char *ip, const char *name, uint32_t ttl, void *user) {
+  (void)user;
+  int last = atoi(strrchr(ip, '.') + 1);
+  if (last < 0 || last >= 8) return;
+  pthread_mutex_lock(&g_lock);
+  snprintf(g_name[last], sizeof(g_name[last]), "%s", name ? name : "(null)");
+  g_ttl[last] = ttl;
+  g_done[last]++;
+  pthread_mutex_unlock(&g_lock);
+}
+
+static int all_done(int from, int to) {
+  pthread_mutex_lock(&g_lock);
+  int ok = 1;
+  for (int i = from; i <= to; i++) if (!g_done[i]) ok = 0;
+  pthread_mutex_unlock(&g_lock);
+  return ok;
+}
+
+int main(void) {
+  g_ns_sock = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in sa; memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET; sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t sl = sizeof(sa);
+  if (g_ns_sock < 0 || bind(g_ns_sock, (struct sockaddr *)&sa, sizeof(sa)) < 0 || getsockname(g_ns_sock, (struct sockaddr *)&sa, &sl) < 0) {
+    perror("dns_async_test: bind");
+    return 1;
+  }
+  pthread_t th;
+  pthread_create(&th, NULL, ns_thread, NULL);
+
+  /* 400 separators ahead of the only real server */
+  char servers[512];
+  memset(servers, ',', 400);
+  snprintf(servers + 400, sizeof(servers) - 400, "127.0.0.1:%u", (unsigned)ntohs(sa.sin_port));
+  dns_async_config_t cfg = { .servers = servers, .timeout_ms = 150, .attempts = 1, .negative_ttl = 60, .cb = on_result };
+  CHECK(dns_async_start(&cfg) == 0, "dns_async_start failed");
+  dns_async_stats_t st;
+  dns_async_get_stats(&st);
+  CHECK(st.servers == 1, "servers: want 1 got %u (long list truncated?)", st.servers);
+
+  for (int i = 1; i <= 7; i++) {
+    char ip[32]; snprintf(ip, sizeof(ip), "10.9.8.%d", i);
+    CHECK(dns_async_submit(ip) == 1, "submit %s failed", ip);
+  }
+  CHECK(dns_async_submit("not-an-ip") == -1, "bad address should be refused");
+  for (int i = 0; i < 300 && !all_done(1, 7); i++) usleep(10000);
+
+  pthread_mutex_lock(&g_lock);
+  CHECK(strcmp(g_name[1], "one.mesh.test") == 0 && g_ttl[1] == 300, "plain PTR: got %s ttl %u", g_name[1], g_ttl[1]);
+  CHECK(strcmp(g_name[2], "(null)") == 0, "NXDOMAIN: got %s", g_name[2]);
+  CHECK(strcmp(g_name[3], "(null)") == 0, "wrong ID must be ignored: got %s", g_name[3]);
+  CHECK(strcmp(g_name[4], "(null)") == 0, "truncated rdata: got %s", g_name[4]);
+  CHECK(strcmp(g_name[5], "(null)") == 0, "pointer loop: got %s", g_name[5]);
+  CHECK(strcmp(g_name[6], "six.alias.test") == 0 && g_ttl[6] == 120, "CNAME then PTR: got %s ttl %u", g_name[6], g_ttl[6]);
+  CHECK(strcmp(g_name[7], "(null)") == 0, "SERVFAIL: got %s", g_name[7]);
+  for (int i = 1; i <= 7; i++) CHECK(g_done[i] == 1, "10.9.8.%d: %d callbacks", i, g_done[i]);
+  pthread_mutex_unlock(&g_lock);
+
+  dns_async_get_stats(&st);
+  CHECK(st.answered == 2 && st.failed == 5 && st.timeouts >= 1, "stats: answered %lu failed %lu timeouts %lu", st.answered, st.failed, st.timeouts);
+  /* failed addresses are negatively cached */
+  CHECK(dns_async_submit("10.9.8.2") == 0, "negative cache: resubmit should be suppressed");
+
+  dns_async_stop();
+  g_ns_stop = 1;
+  pthread_join(th, NULL);
+  close(g_ns_sock);
+  if (g_fail) { fprintf(stderr, "dns_async_test: %d failure(s)\n", g_fail); return 1; }
+  printf("dns_async_test: ok\n");
+  return 0;
+}
@@ -0,0 +1,474 @@
+#include "exec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/prctl.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+#define EXEC_MAX_OUTPUT (1024 * 1024)   /* same cap the popen() version had */
+#define EXEC_MAX_CMDS   32
+#define EXEC_MSG_MAX    4096
+#define HELPER_MAX_JOBS 64
+
+/* ---- per-command statistics and resolved paths ---- */
+
+struct exec_cmd {
+  exec_cmd_stats_t st;
+  char path[256];                  /* resolved absolute path, "" until found */
+};
+
+static struct exec_cmd g_cmds[EXEC_MAX_CMDS];
+static int g_ncmds = 0;
+static pthread_mutex_t g_cmds_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned long long now_us(void) {
+  struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000ULL + (unsigned long long)ts.tv_nsec / 1000ULL;
+}
+
+static const char *base_name(const char *p) { const char *s = strrchr(p, '/'); return s ? s + 1 : p; }
+
+/* Caller holds g_cmds_lock. Commands past the table size share one slot. */
+static struct exec_cmd *cmd_slot(const char *argv0) {
+  const char *name = base_name(argv0);
+  for (int i = 0; i < g_ncmds; i++) if (strcmp(g_cmds[i].st.name, name) == 0) return &g_cmds[i];
+  if (g_ncmds == EXEC_MAX_CMDS) return &g_cmds[EXEC_MAX_CMDS - 1];
+  struct exec_cmd *c = &g_cmds[g_ncmds++];
+  snprintf(c->st.name, sizeof(c->st.name), "%s", g_ncmds == EXEC_MAX_CMDS ? "other" : name);
+  return c;
+}
+
+/* What `which` would find, plus the sbin directories olsrd's PATH often lacks. */
+static int search_path(const char *name, char *out, size_t outlen) {
+  const char *env = getenv("PATH");
+  char dirs[1024];
+  snprintf(dirs, sizeof(dirs), "%s:/usr/sbin:/sbin:/usr/bin:/bin", (env && env[0]) ? env : "/usr/local/bin");
+  for (char *save = NULL, *d = strtok_r(dirs, ":", &save); d; d = strtok_r(NULL, ":", &save)) {
+    if ((size_t)snprintf(out, outlen, "%s/%s", d[0] ? d : ".", name) >= outlen) continue;
+    if (access(out, X_OK) == 0) return 0;
+  }
+  return -1;
+}
+
+static int resolve(const char *argv0, char *out, size_t outlen) {
+  if (strchr(argv0, '/')) { snprintf(out, outlen, "%s", argv0); return 0; }
+  pthread_mutex_lock(&g_cmds_lock);
+  struct exec_cmd *c = cmd_slot(argv0);
+  int have = c->path[0] && strcmp(base_name(c->path), argv0) == 0;
+  if (have) snprintf(out, outlen, "%s", c->path);
+  pthread_mutex_unlock(&g_cmds_lock);
+  if (have) return 0;
+  if (search_path(argv0, out, outlen) != 0) return -1;
+  pthread_mutex_lock(&g_cmds_lock);
+  c = cmd_slot(argv0);
+  snprintf(c->path, sizeof(c->path), "%s", out);
+  pthread_mutex_unlock(&g_cmds_lock);
+  return 0;
+}
+
+static void record(const char *argv0, int rc, unsigned long long us) {
+  pthread_mutex_lock(&g_cmds_lock);
+  struct exec_cmd *c = cmd_slot(argv0);
+  c->st.runs++;
+  if (rc == EXEC_TIMEOUT) c->st.timeouts++;
+  else if (rc != 0) { c->st.failures++; c->path[0] = '\0'; } /* re-resolve next time */
+  c->st.total_us += us;
+  if (us > c->st.max_us) c->st.max_us = us;
+  pthread_mutex_unlock(&g_cmds_lock);
+}
+
+int exec_get_stats(exec_cmd_stats_t *out, int max) {
+  pthread_mutex_lock(&g_cmds_lock);
+  int n = g_ncmds < max ? g_ncmds : max;
+  for (int i = 0; i < n; i++) out[i] = g_cmds[i].st;
+  pthread_mutex_unlock(&g_cmds_lock);
+  return n;
+}
+
+/* ---- spawning ---- */
+
+/* posix_spawn is clone(CLONE_VM|CLONE_VFORK) on glibc and musl: no page tables
+ * are copied however large the caller is. Signal state is reset so the child
+ * does not inherit olsrd's ignored SIGPIPE or a thread's blocked mask.
+ */
+static int spawn_child(const char *path, char *const argv[], int flags, int outfd, pid_t *pid) {
+  posix_spawn_file_actions_t fa;
+  posix_spawnattr_t at;
+  if (posix_spawn_file_actions_init(&fa) != 0) return -1;
+  if (posix_spawnattr_init(&at) != 0) { posix_spawn_file_actions_destroy(&fa); return -1; }
+  posix_spawn_file_actions_addopen(&fa, 0, "/dev/null", O_RDONLY, 0);
+  posix_spawn_file_actions_adddup2(&fa, outfd, 1);
+  if (flags & EXEC_STDERR) posix_spawn_file_actions_adddup2(&fa, outfd, 2);
+  else posix_spawn_file_actions_addopen(&fa, 2, "/dev/null", O_WRONLY, 0);
+  sigset_t none, all;
+  sigemptyset(&none); sigfillset(&all);
+  posix_spawnattr_setsigmask(&at, &none);
+  posix_spawnattr_setsigdefault(&at, &all);
+  short sf = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+#ifdef POSIX_SPAWN_USEVFORK
+  sf |= POSIX_SPAWN_USEVFORK;
+#endif
+  posix_spawnattr_setflags(&at, sf);
+  int rc = posix_spawn(pid, path, &fa, &at, argv, environ);
+  posix_spawnattr_destroy(&at);
+  posix_spawn_file_actions_destroy(&fa);
+  if (rc != 0) { errno = rc; return -1; }
+  return 0;
+}
+
+/* Read rfd until EOF or the deadline. Output past the cap is drained and
+ * dropped so the child never blocks on a full pipe. 0 on EOF, EXEC_TIMEOUT.
+ */
+static int collect(int rfd, unsigned long long deadline, char **buf, size_t *len, size_t *cap) {
+  char tmp[4096];
+  for (;;) {
+    unsigned long long now = now_us();
+    if (now >= deadline) return EXEC_TIMEOUT;
+    struct pollfd p = { .fd = rfd, .events = POLLIN };
+    int pr = poll(&p, 1, (int)((deadline - now + 999) / 1000));
+    if (pr < 0) { if (errno == EINTR) continue; return EXEC_ERR; }
+    if (pr == 0) continue;
+    ssize_t n = read(rfd, tmp, sizeof(tmp));
+    if (n < 0) { if (errno == EINTR || errno == EAGAIN) continue; return EXEC_ERR; }
+    if (n == 0) return 0;
+    size_t room = EXEC_MAX_OUTPUT - 1 - *len;
+    size_t take = (size_t)n < room ? (size_t)n : room;
+    if (!take) continue;
+    if (*len + take + 1 > *cap) {
+      size_t nc = *cap ? *cap * 2 : 8192;
+      while (nc < *len + take + 1) nc *= 2;
+      if (nc > EXEC_MAX_OUTPUT) nc = EXEC_MAX_OUTPUT;
+      char *nb = realloc(*buf, nc);
+      if (!nb) return EXEC_ERR;
+      *buf = nb; *cap = nc;
+    }
+    memcpy(*buf + *len, tmp, take);
+    *len += take;
+  }
+}
+
+/* Reap a direct child, killing it if it is still around at the deadline. */
+static int reap(pid_t pid, unsigned long long deadline, int killed, int *status) {
+  if (killed) kill(pid, SIGKILL);
+  for (;;) {
+    pid_t w = waitpid(pid, status, killed ? 0 : WNOHANG);
+    if (w == pid) return killed ? EXEC_TIMEOUT : 0;
+    if (w < 0 && errno == EINTR) continue;
+    if (w < 0) { *status = 0; return killed ? EXEC_TIMEOUT : 0; } /* SIGCHLD ignored: already reaped */
+    if (now_us() >= deadline) { killed = 1; kill(pid, SIGKILL); continue; }
+    struct timespec ts = { 0, 1000000 }; nanosleep(&ts, NULL);
+  }
+}
+
+/* ---- pre-forked helper ---- */
+
+/* g_helper_lock covers the control socket from lookup through sendmsg, so a
+ * caller that sees EPIPE cannot close an fd another thread is sending on.
+ */
+static int g_helper_fd = -1;
+static pid_t g_helper_pid = -1;
+static pthread_mutex_t g_helper_lock = PTHREAD_MUTEX_INITIALIZER;
+
+struct helper_req { uint32_t flags, argc; };   /* followed by path\0 argv[0]\0 ... */
+struct helper_rep { int32_t rc, status; };
+
+struct helper_job { pid_t pid; int reply, killed; };
+
+static void helper_reply(int fd, int rc, int status) {
+  struct helper_rep rep = { rc, status };
+  if (send(fd, &rep, sizeof(rep), MSG_NOSIGNAL) < 0) { /* caller already gone */ }
+  close(fd);
+}
+
+/* Everything from here down runs in the forked helper, which may have been
+ * forked from a multi-threaded olsrd: only async-signal-safe calls and raw
+ * syscalls, no stdio, malloc, opendir or posix_spawn (its file actions
+ * allocate).
+ */
+static void helper_close_fds(int keep) {
+#ifdef SYS_close_range
+  if (syscall(SYS_close_range, 3, keep - 1, 0) == 0 && syscall(SYS_close_range, keep + 1, ~0U, 0) == 0) return;
+#endif
+  int dfd = open("/proc/self/fd", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dfd < 0) return;
+  char buf[1024];
+  long n;
+  while ((n = syscall(SYS_getdents64, dfd, buf, sizeof(buf))) > 0) {
+    for (long off = 0; off < n; ) {
+      struct dirent64 *e = (struct dirent64 *)(buf + off);
+      off += e->d_reclen;
+      int fd = 0;
+      const char *c = e->d_name;
+      if (*c < '0' || *c > '9') continue;
+      while (*c >= '0' && *c <= '9') fd = fd * 10 + (*c++ - '0');
+      if (fd > 2 && fd != keep && fd != dfd) close(fd);
+    }
+  }
+  close(dfd);
+}
+
+static int fd_above_stdio(int fd) {
+  return fd < 0 || fd > 2 ? fd : fcntl(fd, F_DUPFD, 3);
+}
+
+/* vfork + execve: the helper is single threaded and the child only touches
+ * descriptors and its signal mask before exec. Dispositions are already
+ * SIG_DFL in the helper; SIGCHLD is unblocked here.
+ */
+static int helper_exec_child(const char *path, char *const argv[], int flags, int outfd, pid_t *pid) {
+  pid_t p = vfork();
+  if (p < 0) return -1;
+  if (p == 0) {
+    int o = fd_above_stdio(outfd);
+    int nul = fd_above_stdio(open("/dev/null", O_RDWR));
+    if (o < 0 || nul < 0) _exit(127);
+    if (dup2(nul, 0) < 0 || dup2(o, 1) < 0 || dup2((flags & EXEC_STDERR) ? o : nul, 2) < 0) _exit(127);
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, NULL);
+    execve(path, argv, environ);
+    _exit(127);
+  }
+  *pid = p;
+  return 0;
+}
+
+static void helper_spawn(int ctl, struct helper_job *jobs, int *njobs) {
+  char msg[EXEC_MSG_MAX + 1];
+  char cbuf[CMSG_SPACE(2 * sizeof(int))];
+  struct iovec iov = { msg, EXEC_MSG_MAX };
+  struct msghdr mh; memset(&mh, 0, sizeof(mh));
+  mh.msg_iov = &iov; mh.msg_iovlen = 1; mh.msg_control = cbuf; mh.msg_controllen = sizeof(cbuf);
+  ssize_t n = recvmsg(ctl, &mh, MSG_CMSG_CLOEXEC);
+  if (n <= 0) {
+    if (n < 0 && errno == EINTR) return;
+    for (int i = 0; i < *njobs; i++) kill(jobs[i].pid, SIGKILL);
+    _exit(0);   /* the plugin closed its end or olsrd went away */
+  }
+  int fds[2] = { -1, -1 };
+  struct cmsghdr *cm = CMSG_FIRSTHDR(&mh);
+  if (cm && cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS && cm->cmsg_len == CMSG_LEN(2 * sizeof(int)))
+    memcpy(fds, CMSG_DATA(cm), sizeof(fds));
+  if (fds[0] < 0 || fds[1] < 0) { if (fds[0] >= 0) close(fds[0]); if (fds[1] >= 0) close(fds[1]); return; }
+  msg[n] = '\0';
+  struct helper_req req;
+  char *path = NULL, *argv[64];
+  int ok = (size_t)n > sizeof(req);
+  if (ok) {
+    memcpy(&req, msg, sizeof(req));
+    char *p = msg + sizeof(req), *end = msg + n;
+    ok = req.argc > 0 && req.argc < 64;
+    for (uint32_t i = 0; ok && i <= req.argc; i++) {   /* path first, then argv */
+      if (p >= end) { ok = 0; break; }
+      if (i) argv[i - 1] = p; else path = p;
+      p += strlen(p) + 1;
+    }
+    if (ok) argv[req.argc] = NULL;
+  }
+  pid_t pid;
+  if (!ok || *njobs == HELPER_MAX_JOBS || helper_exec_child(path, argv, (int)req.flags, fds[1], &pid) != 0) {
+    close(fds[1]);
+    helper_reply(fds[0], EXEC_ERR, 0);
+    return;
+  }
+  close(fds[1]);
+  jobs[*njobs].pid = pid; jobs[*njobs].reply = fds[0]; jobs[*njobs].killed = 0; (*njobs)++;
+}
+
+static void helper_main(int ctl) {
+  prctl(PR_SET_NAME, "olsrd-exec", 0, 0, 0);
+  for (int s = 1; s < NSIG; s++) if (s != SIGKILL && s != SIGSTOP) signal(s, SIG_DFL);
+  helper_close_fds(ctl);
+  sigset_t chld; sigemptyset(&chld); sigaddset(&chld, SIGCHLD);
+  sigprocmask(SIG_SETMASK, &chld, NULL);
+  int sfd = signalfd(-1, &chld, SFD_CLOEXEC | SFD_NONBLOCK);
+  if (sfd < 0) _exit(1);
+  struct helper_job jobs[HELPER_MAX_JOBS];
+  int njobs = 0;
+  for (;;) {
+    struct pollfd p[HELPER_MAX_JOBS + 2];
+    p[0].fd = ctl; p[0].events = POLLIN;
+    p[1].fd = sfd; p[1].events = POLLIN;
+    /* once a job is killed its reply socket stays hung up until the reap;
+     * a negative fd keeps poll from reporting it again meanwhile */
+    for (int i = 0; i < njobs; i++) { p[i + 2].fd = jobs[i].killed ? -1 : jobs[i].reply; p[i + 2].events = POLLIN; p[i + 2].revents = 0; }
+    if (poll(p, (nfds_t)njobs + 2, -1) < 0) { if (errno == EINTR) continue; _exit(1); }
+    /* a readable or hung-up reply socket means the caller gave up: kill it */
+    for (int i = 0; i < njobs; i++)
+      if (p[i + 2].revents && !jobs[i].killed) { kill(jobs[i].pid, SIGKILL); jobs[i].killed = 1; }
+    if (p[1].revents) {
+      struct signalfd_siginfo si;
+      while (read(sfd, &si, sizeof(si)) == (ssize_t)sizeof(si)) { }
+      int st; pid_t w;
+      while ((w = waitpid(-1, &st, WNOHANG)) > 0) {
+        for (int i = 0; i < njobs; i++) {
+          if (jobs[i].pid != w) continue;
+          helper_reply(jobs[i].reply, 0, st);
+          jobs[i] = jobs[--njobs];
+          break;
+        }
+      }
+    }
+    if (p[0].revents) helper_spawn(ctl, jobs, &njobs);
+  }
+}
+
+int exec_helper_start(void) {
+  pthread_mutex_lock(&g_helper_lock);
+  if (g_helper_fd >= 0) { pthread_mutex_unlock(&g_helper_lock); return 0; }
+  int sv[2];
+  if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) != 0) { pthread_mutex_unlock(&g_helper_lock); return -1; }
+  pid_t pid = fork();
+  if (pid < 0) { close(sv[0]); close(sv[1]); pthread_mutex_unlock(&g_helper_lock); return -1; }
+  if (pid == 0) { close(sv[0]); helper_main(sv[1]); _exit(0); }
+  close(sv[1]);
+  g_helper_fd = sv[0];
+  g_helper_pid = pid;
+  pthread_mutex_unlock(&g_helper_lock);
+  return 0;
+}
+
+void exec_helper_stop(void) {
+  pthread_mutex_lock(&g_helper_lock);
+  int fd = g_helper_fd;
+  pid_t pid = g_helper_pid;
+  g_helper_fd = -1;
+  g_helper_pid = -1;
+  pthread_mutex_unlock(&g_helper_lock);
+  if (fd >= 0) close(fd);
+  if (pid <= 0) return;   /* also reaps a helper that died and was dropped on EPIPE */
+  /* EOF on the control socket makes the helper exit; give it a moment */
+  for (int i = 0; i < 100; i++) {
+    if (waitpid(pid, NULL, WNOHANG) != 0) return;
+    struct timespec ts = { 0, 5000000 }; nanosleep(&ts, NULL);
+  }
+  kill(pid, SIGKILL);
+  waitpid(pid, NULL, 0);
+}
+
+int exec_helper_running(void) {
+  pthread_mutex_lock(&g_helper_lock);
+  int up = g_helper_fd >= 0;
+  pthread_mutex_unlock(&g_helper_lock);
+  return up;
+}
+
+/* Hand the request to the helper. Returns the reply socket, or -1 to make the
+ * caller spawn directly.
+ */
+static int helper_submit(const char *path, const char *const argv[], int flags, int outfd) {
+  if (!exec_helper_running()) return -1;
+  char msg[EXEC_MSG_MAX];
+  struct helper_req req = { (uint32_t)flags, 0 };
+  size_t off = sizeof(req), l = strlen(path) + 1;
+  if (l > sizeof(msg) - off) return -1;
+  memcpy(msg + off, path, l); off += l;
+  for (; argv[req.argc]; req.argc++) {
+    l = strlen(argv[req.argc]) + 1;
+    if (req.argc >= 63 || l > sizeof(msg) - off) return -1;
+    memcpy(msg + off, argv[req.argc], l); off += l;
+  }
+  memcpy(msg, &req, sizeof(req));
+  int rp[2];
+  if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, rp) != 0) return -1;
+  int fds[2] = { rp[1], outfd };
+  char cbuf[CMSG_SPACE(sizeof(fds))];
+  memset(cbuf, 0, sizeof(cbuf));
+  struct iovec iov = { msg, off };
+  struct msghdr mh; memset(&mh, 0, sizeof(mh));
+  mh.msg_iov = &iov; mh.msg_iovlen = 1; mh.msg_control = cbuf; mh.msg_controllen = sizeof(cbuf);
+  struct cmsghdr *cm = CMSG_FIRSTHDR(&mh);
+  cm->cmsg_level = SOL_SOCKET; cm->cmsg_type = SCM_RIGHTS; cm->cmsg_len = CMSG_LEN(sizeof(fds));
+  memcpy(CMSG_DATA(cm), fds, sizeof(fds));
+  pthread_mutex_lock(&g_helper_lock);
+  int ctl = g_helper_fd, gone = 0;
+  ssize_t s = ctl >= 0 ? sendmsg(ctl, &mh, MSG_NOSIGNAL) : -1;
+  if (s < 0 && ctl >= 0 && (errno == EPIPE || errno == ECONNRESET || errno == ENOTCONN)) {
+    g_helper_fd = -1; close(ctl); gone = 1;
+  }
+  pthread_mutex_unlock(&g_helper_lock);
+  close(rp[1]);
+  if (s < 0) {
+    close(rp[0]);
+    if (gone) fprintf(stderr, "[status-plugin] exec helper gone, spawning directly\n");
+    return -1;
+  }
+  return rp[0];
+}
+
+/* Wait for the helper's exit report. Closing the socket early asks it to kill. */
+static int helper_wait(int rfd, unsigned long long deadline, int *status) {
+  struct helper_rep rep;
+  for (;;) {
+    unsigned long long now = now_us();
+    if (now >= deadline) break;
+    struct pollfd p = { .fd = rfd, .events = POLLIN };
+    int pr = poll(&p, 1, (int)((deadline - now + 999) / 1000));
+    if (pr < 0 && errno == EINTR) continue;
+    if (pr <= 0) break;
+    ssize_t n = recv(rfd, &rep, sizeof(rep), 0);
+    close(rfd);
+    if (n != (ssize_t)sizeof(rep)) return EXEC_ERR;
+    *status = rep.status;
+    return rep.rc == 0 ? 0 : EXEC_ERR;
+  }
+  close(rfd);
+  return EXEC_TIMEOUT;
+}
+
+int exec_argv(const char *const argv[], int flags, int timeout_ms, char **out, size_t *outlen, int *exit_code) {
+  if (out) *out = NULL;
+  if (outlen) *outlen = 0;
+  if (exit_code) *exit_code = -1;
+  if (!argv || !argv[0] || !out) return EXEC_ERR;
+  unsigned long long t0 = now_us();
+  unsigned long long deadline = t0 + (unsigned long long)(timeout_ms > 0 ? timeout_ms : 10000) * 1000ULL;
+  char path[256];
+  if (resolve(argv[0], path, sizeof(path)) != 0) { record(argv[0], EXEC_ERR, 0); return EXEC_ERR; }
+  int pp[2];
+  if (pipe2(pp, O_CLOEXEC) != 0) { record(argv[0], EXEC_ERR, 0); return EXEC_ERR; }
+  pid_t pid = -1;
+  int rfd = helper_submit(path, argv, flags, pp[1]);
+  if (rfd < 0 && spawn_child(path, (char *const *)argv, flags, pp[1], &pid) != 0) {
+    close(pp[0]); close(pp[1]);
+    record(argv[0], EXEC_ERR, now_us() - t0);
+    return EXEC_ERR;
+  }
+  close(pp[1]);
+  char *buf = NULL; size_t len = 0, cap = 0;
+  int rc = collect(pp[0], deadline, &buf, &len, &cap);
+  close(pp[0]);
+  int status = 0;
+  if (rfd >= 0) {
+    if (rc == 0) rc = helper_wait(rfd, deadline, &status);
+    else close(rfd);
+  } else {
+    int r = reap(pid, deadline, rc != 0, &status);
+    if (rc == 0) rc = r;
+  }
+  if (rc == EXEC_ERR && !buf) { record(argv[0], rc, now_us() - t0); return rc; }
+  if (!buf) buf = malloc(1);
+  if (!buf) { record(argv[0], EXEC_ERR, now_us() - t0); return EXEC_ERR; }
+  buf[len] = '\0';
+  *out = buf;
+  if (outlen) *outlen = len;
+  if (rc == 0 && exit_code) *exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+  record(argv[0], rc, now_us() - t0);
+  return rc;
+}
@@ -0,0 +1,37 @@
+#ifndef OLSRD_STATUS_EXEC_H
+#define OLSRD_STATUS_EXEC_H
+#include <stddef.h>
+
+/* Shell-free command runner. argv is executed directly via posix_spawn (or by
+ * the pre-forked helper when it is running), stdout is captured through a
+ * pipe and the child is SIGKILLed once timeout_ms has elapsed.
+ */
+enum {
+  EXEC_STDERR = 1   /* capture stderr together with stdout (like 2>&1) */
+};
+
+#define EXEC_ERR     (-1)   /* could not spawn */
+#define EXEC_TIMEOUT (-2)   /* killed at the deadline; *out holds partial output */
+
+/* Bare names are resolved over $PATH plus the sbin directories. Returns 0 when
+ * the command ran to completion (exit status in *exit_code if given), otherwise
+ * EXEC_ERR or EXEC_TIMEOUT. *out is NUL terminated and must be freed.
+ */
+int exec_argv(const char *const argv[], int flags, int timeout_ms, char **out, size_t *outlen, int *exit_code);
+
+/* Fork the spawn helper. Call early, before the plugin starts any thread, so
+ * the helper's address space stays small. Returns 0 if the helper is up.
+ */
+int exec_helper_start(void);
+void exec_helper_stop(void);
+int exec_helper_running(void);
+
+typedef struct {
+  char name[32];                  /* basename of argv[0] */
+  unsigned long runs, failures, timeouts;
+  unsigned long long total_us, max_us;
+} exec_cmd_stats_t;
+
+/* Copy up to max per-command entries; returns the number copied. */
+int exec_get_stats(exec_cmd_stats_t *out, int max);
+#endif
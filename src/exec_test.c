@@ -0,0 +1,110 @@
+/* exec: many threads running commands through the spawn helper at once, a
+ * caller timing out (the helper must kill that job once and keep serving),
+ * and the helper dying under load (callers fall back to spawning directly).
+ * Run with `make test`.
+ */
+#include "exec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+static int g_fail;
+
+#define CHECK(cond, ...) do { if (!(cond)) { fprintf(stderr, __VA_ARGS__); fputc('\n', stderr); g_fail++; } } while (0)
+
+#define NTHREADS 8
+#define NRUNS    40
+
+static int g_killed;
+static int g_bad_after_kill;
+
+static long now_ms(void) {
+  struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static int run_echo(int t, int i) {
+  char word[32]; snprintf(word, sizeof(word), "t%d-%d", t, i);
+  const char *argv[] = { "echo", word, NULL };
+  char *out = NULL; size_t n = 0; int code = -1;
+  int rc = exec_argv(argv, 0, 5000, &out, &n, &code);
+  int ok = rc == 0 && code == 0 && n == strlen(word) + 1 && strncmp(out, word, strlen(word)) == 0;
+  free(out);
+  return ok;
+}
+
+static void *worker(void *arg) {
+  int t = (int)(long)arg, bad = 0;
+  for (int i = 0; i < NRUNS; i++) {
+    int killed = __atomic_load_n(&g_killed, __ATOMIC_SEQ_CST);
+    /* a run already handed to the helper when it died may fail; later ones not */
+    if (!run_echo(t, i) && killed) bad++;
+  }
+  __atomic_add_fetch(&g_bad_after_kill, bad, __ATOMIC_SEQ_CST);
+  return NULL;
+}
+
+/* The helper is our only child named olsrd-exec. */
+static pid_t find_helper(void) {
+  DIR *d = opendir("/proc");
+  if (!d) return -1;
+  struct dirent *e;
+  pid_t found = -1;
+  while (found < 0 && (e = readdir(d)) != NULL) {
+    char path[64], comm[32]; int ppid = 0; pid_t pid = atoi(e->d_name);
+    if (pid <= 0) continue;
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    FILE *f = fopen(path, "r");
+    if (!f) continue;
+    if (fscanf(f, "%*d (%31[^)]) %*c %d", comm, &ppid) == 2 && ppid == getpid() && strcmp(comm, "olsrd-exec") == 0) found = pid;
+    fclose(f);
+  }
+  closedir(d);
+  return found;
+}
+
+static void test_timeout(void) {
+  const char *argv[] = { "sleep", "5", NULL };
+  char *out = NULL;
+  long t0 = now_ms();
+  int rc = exec_argv(argv, 0, 100, &out, NULL, NULL);
+  free(out);
+  CHECK(rc == EXEC_TIMEOUT, "sleep: want EXEC_TIMEOUT, got %d", rc);
+  CHECK(now_ms() - t0 < 1000, "sleep: timeout took %ld ms", now_ms() - t0);
+  /* the helper reaps the killed job and keeps serving */
+  CHECK(run_echo(99, 0), "echo after a timed-out job failed");
+  CHECK(exec_helper_running(), "helper went away after a timeout");
+}
+
+int main(void) {
+  CHECK(exec_helper_start() == 0, "exec_helper_start failed");
+  pid_t helper = find_helper();
+  CHECK(helper > 0, "helper process not found");
+
+  test_timeout();
+
+  pthread_t th[NTHREADS];
+  for (long t = 0; t < NTHREADS; t++) pthread_create(&th[t], NULL, worker, (void *)t);
+  usleep(20000);
+  if (helper > 0) { __atomic_store_n(&g_killed, 1, __ATOMIC_SEQ_CST); kill(helper, SIGKILL); }
+  for (int t = 0; t < NTHREADS; t++) pthread_join(th[t], NULL);
+  CHECK(g_bad_after_kill <= NTHREADS, "%d runs failed after the helper died", g_bad_after_kill);
+  CHECK(!exec_helper_running(), "dead helper still reported running");
+  CHECK(run_echo(100, 0), "direct spawn after the helper died failed");
+
+  exec_cmd_stats_t st[8];
+  int n = exec_get_stats(st, 8), runs = 0;
+  for (int i = 0; i < n; i++) if (strcmp(st[i].name, "echo") == 0) runs = (int)st[i].runs;
+  CHECK(runs == NTHREADS * NRUNS + 2, "echo runs: want %d got %d", NTHREADS * NRUNS + 2, runs);
+
+  exec_helper_stop();
+  CHECK(find_helper() < 0, "helper not reaped by exec_helper_stop");
+  if (g_fail) { fprintf(stderr, "exec_test: %d failure(s)\n", g_fail); return 1; }
+  printf("exec_test: ok\n");
+  return 0;
+}
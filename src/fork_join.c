@@ -0,0 +1,162 @@
+#include "fork_join.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+#define FJ_MAX_WORKERS 16
+#define FJ_QUEUE       64           /* queued tasks before spawns run inline */
+
+struct fj_group {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  int refs;                 /* caller + tasks not yet returned */
+  int ntasks, pending;
+  unsigned char done[FJ_GROUP_MAX];
+  void (*release)(void *ud);
+  void *ud;
+};
+
+struct fj_task { fj_group_t *g; int idx; fj_task_fn fn; void *arg; };
+
+static struct {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  pthread_t thread[FJ_MAX_WORKERS];
+  int nthreads;
+  volatile int running;
+  struct fj_task q[FJ_QUEUE];
+  int head, count;
+  fj_stats_t st;
+} P = { .lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER };
+
+static void group_unref(fj_group_t *g) {
+  pthread_mutex_lock(&g->lock);
+  int last = --g->refs == 0;
+  pthread_mutex_unlock(&g->lock);
+  if (!last) return;
+  if (g->release) g->release(g->ud);
+  pthread_cond_destroy(&g->cond);
+  pthread_mutex_destroy(&g->lock);
+  free(g);
+}
+
+static void task_run(struct fj_task *t) {
+  t->fn(t->arg);
+  fj_group_t *g = t->g;
+  pthread_mutex_lock(&g->lock);
+  g->done[t->idx] = 1;
+  g->pending--;
+  pthread_cond_broadcast(&g->cond);
+  pthread_mutex_unlock(&g->lock);
+  group_unref(g);
+}
+
+static void *worker(void *arg) {
+  (void)arg;
+  pthread_mutex_lock(&P.lock);
+  for (;;) {
+    /* drain the queue even when stopping so no group is left referenced */
+    while (P.count == 0 && P.running) pthread_cond_wait(&P.cond, &P.lock);
+    if (P.count == 0) break;
+    struct fj_task t = P.q[P.head];
+    P.head = (P.head + 1) % FJ_QUEUE; P.count--;
+    P.st.busy++;
+    pthread_mutex_unlock(&P.lock);
+    task_run(&t);
+    pthread_mutex_lock(&P.lock);
+    P.st.busy--;
+  }
+  pthread_mutex_unlock(&P.lock);
+  return NULL;
+}
+
+int fj_start(int workers) {
+  if (workers <= 0) return -1;
+  if (workers > FJ_MAX_WORKERS) workers = FJ_MAX_WORKERS;
+  pthread_mutex_lock(&P.lock);
+  if (P.running) { pthread_mutex_unlock(&P.lock); return 0; }
+  P.running = 1; P.head = P.count = 0; P.nthreads = 0;
+  pthread_mutex_unlock(&P.lock);
+  for (int i = 0; i < workers; i++) {
+    if (pthread_create(&P.thread[P.nthreads], NULL, worker, NULL) != 0) break;
+    P.nthreads++;
+  }
+  pthread_mutex_lock(&P.lock);
+  P.st.workers = P.nthreads;
+  if (P.nthreads == 0) P.running = 0;
+  pthread_mutex_unlock(&P.lock);
+  return P.nthreads > 0 ? 0 : -1;
+}
+
+void fj_stop(void) {
+  pthread_mutex_lock(&P.lock);
+  if (!P.running) { pthread_mutex_unlock(&P.lock); return; }
+  P.running = 0;
+  pthread_cond_broadcast(&P.cond);
+  pthread_mutex_unlock(&P.lock);
+  for (int i = 0; i < P.nthreads; i++) pthread_join(P.thread[i], NULL);
+  pthread_mutex_lock(&P.lock);
+  P.nthreads = 0; P.st.workers = 0;
+  pthread_mutex_unlock(&P.lock);
+}
+
+fj_group_t *fj_group_new(void (*release)(void *ud), void *ud) {
+  fj_group_t *g = calloc(1, sizeof(*g));
+  if (!g) return NULL;
+  pthread_mutex_init(&g->lock, NULL);
+  pthread_cond_init(&g->cond, NULL);
+  g->refs = 1; g->release = release; g->ud = ud;
+  return g;
+}
+
+int fj_spawn(fj_group_t *g, fj_task_fn fn, void *arg) {
+  pthread_mutex_lock(&g->lock);
+  if (g->ntasks >= FJ_GROUP_MAX) { pthread_mutex_unlock(&g->lock); return -1; }
+  struct fj_task t = { g, g->ntasks++, fn, arg };
+  g->pending++; g->refs++;
+  pthread_mutex_unlock(&g->lock);
+  pthread_mutex_lock(&P.lock);
+  if (P.running && P.count < FJ_QUEUE) {
+    P.q[(P.head + P.count) % FJ_QUEUE] = t; P.count++;
+    P.st.spawned++;
+    pthread_cond_signal(&P.cond);
+    pthread_mutex_unlock(&P.lock);
+  } else {
+    P.st.inlined++;
+    pthread_mutex_unlock(&P.lock);
+    task_run(&t);
+  }
+  return t.idx;
+}
+
+int fj_wait(fj_group_t *g, int timeout_ms) {
+  struct timespec dl; clock_gettime(CLOCK_REALTIME, &dl);
+  dl.tv_sec += timeout_ms / 1000; dl.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+  if (dl.tv_nsec >= 1000000000L) { dl.tv_sec++; dl.tv_nsec -= 1000000000L; }
+  pthread_mutex_lock(&g->lock);
+  while (g->pending > 0)
+    if (pthread_cond_timedwait(&g->cond, &g->lock, &dl) == ETIMEDOUT) break;
+  int left = g->pending;
+  pthread_mutex_unlock(&g->lock);
+  if (left > 0) { pthread_mutex_lock(&P.lock); P.st.late += (unsigned long)left; pthread_mutex_unlock(&P.lock); }
+  return left;
+}
+
+int fj_done(fj_group_t *g, int idx) {
+  if (idx < 0 || idx >= FJ_GROUP_MAX) return 0;
+  pthread_mutex_lock(&g->lock);
+  int d = g->done[idx];
+  pthread_mutex_unlock(&g->lock);
+  return d;
+}
+
+void fj_group_put(fj_group_t *g) { if (g) group_unref(g); }
+
+void fj_get_stats(fj_stats_t *st) {
+  pthread_mutex_lock(&P.lock);
+  *st = P.st;
+  st->queued = (unsigned int)P.count;
+  pthread_mutex_unlock(&P.lock);
+}
@@ -0,0 +1,40 @@
+#ifndef OLSRD_STATUS_FORK_JOIN_H
+#define OLSRD_STATUS_FORK_JOIN_H
+
+/* Bounded fork-join executor.
+ * A fixed set of worker threads runs tasks from one FIFO. A request spawns
+ * its independent pieces into a group, waits for them up to a deadline and
+ * merges the results itself. The group lives until its last task returned,
+ * so work still running at the deadline finishes in the background instead
+ * of being cancelled.
+ */
+typedef void (*fj_task_fn)(void *arg);
+typedef struct fj_group fj_group_t;
+
+#define FJ_GROUP_MAX 32            /* tasks per group */
+
+typedef struct {
+  unsigned long spawned;    /* tasks handed to the workers */
+  unsigned long inlined;    /* tasks run on the caller: pool stopped or queue full */
+  unsigned long late;       /* tasks still pending when fj_wait() gave up */
+  unsigned int  queued, busy;
+  int workers;
+} fj_stats_t;
+
+/* Returns 0 when the workers are running, -1 otherwise (tasks then run
+ * inline on the spawning thread).
+ */
+int fj_start(int workers);
+void fj_stop(void);
+
+/* release(ud) runs once the caller dropped the group and every task returned. */
+fj_group_t *fj_group_new(void (*release)(void *ud), void *ud);
+/* Run fn(arg). Returns the task's index in the group, or -1 when the group is full. */
+int fj_spawn(fj_group_t *g, fj_task_fn fn, void *arg);
+/* Wait until every task finished or timeout_ms passed; returns the number still pending. */
+int fj_wait(fj_group_t *g, int timeout_ms);
+/* 1 when task idx has returned. */
+int fj_done(fj_group_t *g, int idx);
+void fj_group_put(fj_group_t *g);
+void fj_get_stats(fj_stats_t *st);
+#endif
@@ -1,4 +1,5 @@
 #include "httpd.h"
+#include "arena.h"
 #include <pthread.h>
 #include <sys/stat.h>
 #include <stdlib.h>
@@ -29,6 +30,7 @@ extern int g_log_request_debug;
 typedef struct http_handler_node {
   char route[64];
   http_handler_fn fn;
+  http_route_arena_stats_t arena;   /* guarded by g_route_stats_lock */
   struct http_handler_node *next;
 } http_handler_node_t;
 
@@ -37,6 +39,7 @@ static pthread_t g_srv_th;
 static int g_run = 0;
 static char g_asset_root[512] = {0};
 static http_handler_node_t *g_handlers = NULL;
+static pthread_mutex_t g_route_stats_lock = PTHREAD_MUTEX_INITIALIZER;
 /* control whether per-request access logging is enabled (env OLSRD_STATUS_ACCESS_LOG=0 disables) */
 static int g_log_access = 1;
 /* simple allow-list storage */
@@ -205,6 +208,15 @@ int http_server_register_handler(const char *route, http_handler_fn fn) {
   return 0;
 }
 
+void http_route_arena_stats(void (*cb)(const char *route, const http_route_arena_stats_t *st, void *ud), void *ud) {
+  for (http_handler_node_t *n = g_handlers; n; n = n->next) {
+    pthread_mutex_lock(&g_route_stats_lock);
+    http_route_arena_stats_t st = n->arena;
+    pthread_mutex_unlock(&g_route_stats_lock);
+    cb(n->route, &st, ud);
+  }
+}
+
 void http_send_status(http_request_t *r, int code, const char *status) {
   /* Buffer the status line and common headers to reduce syscalls. Caller will flush via http_printf/http_write. */
   int n = snprintf(r->hdr_buf, sizeof(r->hdr_buf),
@@ -222,6 +234,11 @@ void http_send_status(http_request_t *r, int code, const char *status) {
   }
 }
 
+void http_end_response(http_request_t *r) {
+  if (r->hdr_pending) http_write(r, "", 0);
+  shutdown(r->fd, SHUT_WR);
+}
+
 void http_write(http_request_t *r, const char *buf, size_t len) {
   if (r->hdr_pending) {
     struct iovec iov[2];
@@ -420,6 +437,8 @@ static void *connection_worker(void *arg) {
   char *path = sp1+1;
   char *q = strchr(path, '?'); if (q) { *q = 0; size_t qlen = strnlen(q+1, sizeof(r->query)-1); if (qlen >= sizeof(r->query)-1) qlen = sizeof(r->query)-1; memcpy(r->query, q+1, qlen); r->query[qlen]=0; urldecode(r->query); }
   size_t plen = strnlen(path, sizeof(r->path)-1); if (plen >= sizeof(r->path)-1) plen = sizeof(r->path)-1; memcpy(r->path, path, plen); r->path[plen]=0;
+  /* Accept (for binary encodings of JSON endpoints); copied before the Host parse cuts the header block */
+  const char *acch = strcasestr(sp2+1, "\nAccept:"); if (acch) { acch += 8; while (*acch==' ' || *acch=='\t') acch++; size_t alen = strcspn(acch, "\r\n"); if (alen >= sizeof(r->accept)) alen = sizeof(r->accept)-1; memcpy(r->accept, acch, alen); r->accept[alen]=0; }
   char *hosth = strcasestr(sp2+1, "\nHost:"); if (hosth) { hosth += 6; while (*hosth==' ' || *hosth=='\t') hosth++; char *e = strpbrk(hosth, "\r\n"); if (e) *e = 0; size_t hlen = strnlen(hosth, sizeof(r->host)-1); if (hlen >= sizeof(r->host)-1) hlen = sizeof(r->host)-1; memcpy(r->host, hosth, hlen); r->host[hlen]=0; }
   /* Request line: only emit when per-request debug is enabled */
   if (g_log_request_debug) fprintf(stderr, "[httpd] request: %s %s from %s query='%s' host='%s'\n", r->method, r->path, r->client_ip, r->query, r->host);
@@ -440,7 +459,20 @@ static void *connection_worker(void *arg) {
     if (strcmp(nptr->route, r->path) == 0) {
       handled = 1;
       if (!http_is_client_allowed(r->client_ip)) { if (g_log_access) fprintf(stderr, "[httpd] client %s not allowed to access %s\n", r->client_ip, nptr->route); struct linger _lg2 = {1,0}; setsockopt(cfd, SOL_SOCKET, SO_LINGER, &_lg2, sizeof(_lg2)); close(cfd); http_request_free(r); return NULL; }
+      r->arena = arena_thread();
+      arena_t *prev = arena_bind(r->arena);
       nptr->fn(r);
+      arena_bind(prev);
+      if (r->arena) {
+        size_t used = arena_used(r->arena);
+        pthread_mutex_lock(&g_route_stats_lock);
+        nptr->arena.requests++;
+        nptr->arena.bytes_total += used;
+        nptr->arena.allocs_total += arena_allocs(r->arena);
+        if (used > nptr->arena.bytes_peak) nptr->arena.bytes_peak = used;
+        pthread_mutex_unlock(&g_route_stats_lock);
+        arena_reset(r->arena);
+      }
       break;
     }
     nptr = nptr->next;
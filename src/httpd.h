@@ -8,17 +8,24 @@
 extern "C" {
 #endif
 
+struct arena;
+
 typedef struct http_request {
   int fd;
   char method[8];
   char path[512];
   char query[512];
   char host[128];
+  char accept[128];        /* Accept header, truncated; "" when absent */
   char client_ip[64];
   /* small buffered header area to batch status+headers into one syscall */
   char hdr_buf[1024];
   size_t hdr_len;
   int hdr_pending;
+  /* request-scoped scratch (the worker thread's arena, also bound as its
+   * current arena); reset once the handler returned
+   */
+  struct arena *arena;
 } http_request_t;
 
 typedef int (*http_handler_fn)(http_request_t *r);
@@ -31,6 +38,19 @@ void http_send_status(http_request_t *r, int code, const char *status);
 void http_write(http_request_t *r, const char *buf, size_t len);
 int  http_printf(http_request_t *r, const char *fmt, ...);
 int  http_send_file(http_request_t *r, const char *asset_root, const char *relpath, const char *mime);
+/* The response is complete: signal EOF to the client now (responses carry no
+ * Content-Length) so the handler can keep working, e.g. revalidating a cache.
+ */
+void http_end_response(http_request_t *r);
+
+/* Scratch arena usage per registered route, for /metrics. */
+typedef struct {
+  unsigned long requests;
+  unsigned long long bytes_total;   /* sum over requests of the arena bytes used */
+  unsigned long long allocs_total;
+  size_t bytes_peak;                /* largest single request */
+} http_route_arena_stats_t;
+void http_route_arena_stats(void (*cb)(const char *route, const http_route_arena_stats_t *st, void *ud), void *ud);
 
 /* Access control: allow registering CIDRs or address/mask pairs; if no
  * networks registered, access is allowed for all clients. Returns 0 on
@@ -0,0 +1,233 @@
+#include "json_scan.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define JS_HAVE_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__)
+#define JS_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define JS_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+/* --- scalar reference ------------------------------------------------ */
+
+static size_t scalar_special(const char *s, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    unsigned char c = (unsigned char)s[i];
+    if (c < 0x20 || c == '"' || c == '\\') return i;
+  }
+  return n;
+}
+
+static size_t scalar_structural(const char *s, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    char c = s[i];
+    if (c == '"' || c == '\\' || c == '{' || c == '}' || c == '[' || c == ']') return i;
+  }
+  return n;
+}
+
+/* --- SWAR: eight bytes per step in a general purpose register --------- */
+
+#define ONES  0x0101010101010101ULL
+#define HIGHS 0x8080808080808080ULL
+#define LOWS  0x7f7f7f7f7f7f7f7fULL
+
+/* 0x80 in every byte of x that is zero. Exact per byte (no borrows between
+ * lanes), so the first hit is right on big-endian MIPS too.
+ */
+static inline uint64_t swar_zero(uint64_t x) {
+  return ~(((x & LOWS) + LOWS) | x | LOWS);
+}
+
+static inline uint64_t swar_eq(uint64_t x, unsigned char c) { return swar_zero(x ^ (ONES * c)); }
+
+/* 0x80 in every byte below 0x20 */
+static inline uint64_t swar_ctrl(uint64_t x) {
+  return ~(((x & LOWS) + ONES * 0x60) | x) & HIGHS;
+}
+
+static inline size_t swar_first(uint64_t m) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return (size_t)__builtin_clzll(m) >> 3;
+#else
+  return (size_t)__builtin_ctzll(m) >> 3;
+#endif
+}
+
+static size_t swar_special(const char *s, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint64_t x; memcpy(&x, s + i, 8);
+    uint64_t m = swar_eq(x, '"') | swar_eq(x, '\\') | swar_ctrl(x);
+    if (m) return i + swar_first(m);
+  }
+  return i + scalar_special(s + i, n - i);
+}
+
+static size_t swar_structural(const char *s, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint64_t x; memcpy(&x, s + i, 8);
+    /* '[' | 0x20 == '{' and ']' | 0x20 == '}' */
+    uint64_t lo = x | (ONES * 0x20);
+    uint64_t m = swar_eq(x, '"') | swar_eq(x, '\\') | swar_eq(lo, '{') | swar_eq(lo, '}');
+    if (m) return i + swar_first(m);
+  }
+  return i + scalar_structural(s + i, n - i);
+}
+
+/* --- SSE2 ------------------------------------------------------------- */
+#ifdef JS_HAVE_SSE2
+static size_t sse2_special(const char *s, size_t n) {
+  const __m128i q = _mm_set1_epi8('"'), bs = _mm_set1_epi8('\\'), c1f = _mm_set1_epi8(0x1f);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(const void *)(s + i));
+    __m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(v, c1f), v);   /* v <= 0x1f */
+    __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, q), _mm_cmpeq_epi8(v, bs)), ctl);
+    int bits = _mm_movemask_epi8(m);
+    if (bits) return i + (size_t)__builtin_ctz((unsigned)bits);
+  }
+  return i + scalar_special(s + i, n - i);
+}
+
+static size_t sse2_structural(const char *s, size_t n) {
+  const __m128i q = _mm_set1_epi8('"'), bs = _mm_set1_epi8('\\'), sp = _mm_set1_epi8(0x20);
+  const __m128i ob = _mm_set1_epi8('{'), cb = _mm_set1_epi8('}');
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(const void *)(s + i));
+    __m128i lo = _mm_or_si128(v, sp);
+    __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, q), _mm_cmpeq_epi8(v, bs)),
+                             _mm_or_si128(_mm_cmpeq_epi8(lo, ob), _mm_cmpeq_epi8(lo, cb)));
+    int bits = _mm_movemask_epi8(m);
+    if (bits) return i + (size_t)__builtin_ctz((unsigned)bits);
+  }
+  return i + scalar_structural(s + i, n - i);
+}
+#endif
+
+/* --- AVX2 (compiled for the target, used only when the CPU has it) ---- */
+#ifdef JS_HAVE_AVX2
+__attribute__((target("avx2")))
+static size_t avx2_special(const char *s, size_t n) {
+  const __m256i q = _mm256_set1_epi8('"'), bs = _mm256_set1_epi8('\\'), c1f = _mm256_set1_epi8(0x1f);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(const void *)(s + i));
+    __m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(v, c1f), v);
+    __m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, q), _mm256_cmpeq_epi8(v, bs)), ctl);
+    unsigned bits = (unsigned)_mm256_movemask_epi8(m);
+    if (bits) return i + (size_t)__builtin_ctz(bits);
+  }
+  return i + sse2_special(s + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static size_t avx2_structural(const char *s, size_t n) {
+  const __m256i q = _mm256_set1_epi8('"'), bs = _mm256_set1_epi8('\\'), sp = _mm256_set1_epi8(0x20);
+  const __m256i ob = _mm256_set1_epi8('{'), cb = _mm256_set1_epi8('}');
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(const void *)(s + i));
+    __m256i lo = _mm256_or_si256(v, sp);
+    __m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, q), _mm256_cmpeq_epi8(v, bs)),
+                                _mm256_or_si256(_mm256_cmpeq_epi8(lo, ob), _mm256_cmpeq_epi8(lo, cb)));
+    unsigned bits = (unsigned)_mm256_movemask_epi8(m);
+    if (bits) return i + (size_t)__builtin_ctz(bits);
+  }
+  return i + sse2_structural(s + i, n - i);
+}
+#endif
+
+/* --- NEON ------------------------------------------------------------- */
+#ifdef JS_HAVE_NEON
+/* first set lane of a 0x00/0xff byte mask, or 16 */
+static inline size_t neon_first(uint8x16_t m) {
+  /* narrow to four bits per lane */
+  uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+  return bits ? (size_t)__builtin_ctzll(bits) >> 2 : 16;
+}
+
+static size_t neon_special(const char *s, size_t n) {
+  const uint8x16_t q = vdupq_n_u8('"'), bs = vdupq_n_u8('\\'), sp = vdupq_n_u8(0x20);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t v = vld1q_u8((const uint8_t *)s + i);
+    uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(v, q), vceqq_u8(v, bs)), vcltq_u8(v, sp));
+    size_t k = neon_first(m);
+    if (k < 16) return i + k;
+  }
+  return i + scalar_special(s + i, n - i);
+}
+
+static size_t neon_structural(const char *s, size_t n) {
+  const uint8x16_t q = vdupq_n_u8('"'), bs = vdupq_n_u8('\\'), sp = vdupq_n_u8(0x20);
+  const uint8x16_t ob = vdupq_n_u8('{'), cb = vdupq_n_u8('}');
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t v = vld1q_u8((const uint8_t *)s + i);
+    uint8x16_t lo = vorrq_u8(v, sp);
+    uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(v, q), vceqq_u8(v, bs)), vorrq_u8(vceqq_u8(lo, ob), vceqq_u8(lo, cb)));
+    size_t k = neon_first(m);
+    if (k < 16) return i + k;
+  }
+  return i + scalar_structural(s + i, n - i);
+}
+#endif
+
+/* --- selection -------------------------------------------------------- */
+
+static js_kernel_t g_kernels[5];
+static int g_nkernels;
+static const js_kernel_t *g_active;
+static pthread_once_t g_once = PTHREAD_ONCE_INIT;
+
+static void select_kernel(void) {
+  int n = 0;
+  g_kernels[n++] = (js_kernel_t){ "scalar", scalar_special, scalar_structural };
+  g_kernels[n++] = (js_kernel_t){ "swar", swar_special, swar_structural };
+#ifdef JS_HAVE_SSE2
+  g_kernels[n++] = (js_kernel_t){ "sse2", sse2_special, sse2_structural };
+#endif
+#ifdef JS_HAVE_AVX2
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) g_kernels[n++] = (js_kernel_t){ "avx2", avx2_special, avx2_structural };
+#endif
+#ifdef JS_HAVE_NEON
+  g_kernels[n++] = (js_kernel_t){ "neon", neon_special, neon_structural };
+#endif
+  g_nkernels = n;
+  /* the last one registered is the widest */
+  const js_kernel_t *k = &g_kernels[n - 1];
+  const char *force = getenv("OLSRD_STATUS_SCAN_KERNEL");
+  if (force && *force)
+    for (int i = 0; i < n; i++) if (strcmp(g_kernels[i].name, force) == 0) k = &g_kernels[i];
+  __atomic_store_n(&g_active, k, __ATOMIC_RELEASE);
+}
+
+static const js_kernel_t *active(void) {
+  const js_kernel_t *k = __atomic_load_n(&g_active, __ATOMIC_ACQUIRE);
+  if (k) return k;
+  pthread_once(&g_once, select_kernel);
+  return g_active;
+}
+
+size_t js_find_special(const char *s, size_t n) { return active()->special(s, n); }
+size_t js_find_structural(const char *s, size_t n) { return active()->structural(s, n); }
+const char *js_kernel_name(void) { return active()->name; }
+
+int js_kernels(const js_kernel_t **out) {
+  active();
+  if (out) *out = g_kernels;
+  return g_nkernels;
+}
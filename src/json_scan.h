@@ -0,0 +1,31 @@
+#ifndef OLSRD_STATUS_JSON_SCAN_H
+#define OLSRD_STATUS_JSON_SCAN_H
+#include <stddef.h>
+
+/* Vectorized "find the next interesting byte" kernels for the JSON paths.
+ *
+ *   js_find_special()    next '"', '\\' or control byte (< 0x20, NUL included):
+ *                        where a string ends or needs escaping
+ *   js_find_structural() next '"', '\\', '{', '}', '[' or ']':
+ *                        where brace matching has to look
+ *
+ * Both return the index of the first such byte in s[0..n), or n. The
+ * implementation (AVX2, SSE2, NEON, 64-bit SWAR or scalar) is picked on first
+ * use from what the build and the CPU support; OLSRD_STATUS_SCAN_KERNEL=<name>
+ * forces one of the available kernels.
+ */
+size_t js_find_special(const char *s, size_t n);
+size_t js_find_structural(const char *s, size_t n);
+
+typedef size_t (*js_scan_fn)(const char *s, size_t n);
+typedef struct {
+  const char *name;
+  js_scan_fn special;
+  js_scan_fn structural;
+} js_kernel_t;
+
+/* Kernels usable on this CPU, the scalar reference first; returns the count. */
+int js_kernels(const js_kernel_t **out);
+/* Name of the kernel the dispatchers use. */
+const char *js_kernel_name(void);
+#endif
@@ -0,0 +1,111 @@
+/* Every scan kernel available on this CPU must agree with the scalar
+ * reference, for all lengths around the vector widths, all alignments and
+ * every position of the first hit.  Run with `make test`.
+ */
+#include "json_scan.h"
+#include "json_writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int g_fail;
+
+#define CHECK(cond, ...) do { if (!(cond)) { fprintf(stderr, __VA_ARGS__); fputc('\n', stderr); g_fail++; } } while (0)
+
+static unsigned long g_seed = 12345;
+static unsigned rnd(void) { g_seed = g_seed * 6364136223846793005UL + 1442695040888963407UL; return (unsigned)(g_seed >> 33); }
+
+/* bytes that are special for one kernel family or close to it */
+static const unsigned char k_interesting[] = {
+  0x00, 0x01, 0x09, 0x0a, 0x1f, 0x20, '"', '\\', '{', '}', '[', ']', 0x3b, 0x3d, 0x5c ^ 0x20, 0x7f, 0x80, 0x9f, 0xa0, 0xdb, 0xfb, 0xfd, 0xff,
+};
+
+static void fill_clean(unsigned char *b, size_t n) {
+  static const char alpha[] = "abcdefghijklmnopqrstuvwxyz0123456789 .,:-_/";
+  for (size_t i = 0; i < n; i++) b[i] = (unsigned char)alpha[rnd() % (sizeof(alpha) - 1)];
+}
+
+static void compare(const js_kernel_t *ref, const js_kernel_t *k, const unsigned char *b, size_t n, const char *what) {
+  const char *s = (const char *)b;
+  size_t want = ref->special(s, n), got = k->special(s, n);
+  CHECK(want == got, "%s special %s n=%zu: want %zu got %zu", k->name, what, n, want, got);
+  want = ref->structural(s, n); got = k->structural(s, n);
+  CHECK(want == got, "%s structural %s n=%zu: want %zu got %zu", k->name, what, n, want, got);
+}
+
+static void test_kernels(void) {
+  const js_kernel_t *ks;
+  int nk = js_kernels(&ks);
+  CHECK(nk >= 2 && strcmp(ks[0].name, "scalar") == 0, "kernel table starts with scalar (%d kernels)", nk);
+  printf("kernels:");
+  for (int i = 0; i < nk; i++) printf(" %s", ks[i].name);
+  printf(" (active: %s)\n", js_kernel_name());
+
+  unsigned char *buf = malloc(256 + 64);
+  for (int ki = 1; ki < nk; ki++) {
+    for (size_t align = 0; align < 32; align++) {
+      unsigned char *b = buf + align;
+      for (size_t n = 0; n <= 200; n++) {
+        fill_clean(b, n);
+        compare(&ks[0], &ks[ki], b, n, "clean");
+        /* each interesting byte at each position (and past the end) */
+        for (size_t pos = 0; pos < n + 2 && pos < 100; pos++) {
+          for (size_t c = 0; c < sizeof(k_interesting); c++) {
+            fill_clean(b, n + 2);
+            b[pos] = k_interesting[c];
+            compare(&ks[0], &ks[ki], b, n, "single");
+          }
+        }
+      }
+    }
+    /* random noise, many hits */
+    for (int it = 0; it < 20000; it++) {
+      size_t n = rnd() % 256, align = rnd() % 32;
+      for (size_t i = 0; i < n; i++) buf[align + i] = (unsigned char)rnd();
+      compare(&ks[0], &ks[ki], buf + align, n, "random");
+    }
+  }
+  free(buf);
+}
+
+static void test_escape(void) {
+  const char in[] = "plain \"quoted\" back\\slash\nnl\ttab\x01" "ctl\x1f" " end \xc3\xa4";
+  const char want[] = "\"plain \\\"quoted\\\" back\\\\slash\\nnl\\ttab\\u0001ctl\\u001f end \xc3\xa4\"";
+  char *b = malloc(4); size_t len = 0, cap = 4;
+  CHECK(jw_escape_append(&b, &len, &cap, in, sizeof(in) - 1) == 0, "escape append failed");
+  CHECK(len == sizeof(want) - 1 && memcmp(b, want, len) == 0, "escape: got %s", b);
+  free(b);
+}
+
+static void test_writer(void) {
+  jw_t w; char *out; size_t len;
+  jw_init(&w, 8);
+  jw_begin_obj(&w);
+  JW_KEY(&w, "a"); jw_u64(&w, 0);
+  JW_KEY(&w, "b"); jw_i64(&w, -1234567890123LL);
+  JW_KEY(&w, "c"); jw_begin_arr(&w); jw_f2(&w, 1.005); jw_f2(&w, -0.004); jw_fixed(&w, 2.5, 0); jw_end_arr(&w);
+  JW_KEY(&w, "d"); jw_begin_arr(&w); jw_end_arr(&w);
+  JW_KEY(&w, "e"); jw_begin_obj(&w); JW_KEY(&w, "x"); jw_null(&w); jw_end_obj(&w);
+  JW_KEY(&w, "f"); jw_u64_str(&w, 18446744073709551615ULL);
+  JW_KEY(&w, "g"); jw_bool(&w, 1);
+  jw_end_obj(&w);
+  CHECK(jw_finish(&w, &out, &len, NULL) == 0, "writer error");
+  const char *want = "{\"a\":0,\"b\":-1234567890123,\"c\":[1.00,0.00,3],\"d\":[],\"e\":{\"x\":null},\"f\":\"18446744073709551615\",\"g\":true}";
+  CHECK(out && strcmp(out, want) == 0, "writer: got %s", out ? out : "(null)");
+  free(out);
+
+  /* unbalanced close is sticky and frees the buffer */
+  jw_init(&w, 0);
+  jw_end_obj(&w);
+  jw_str(&w, "x");
+  CHECK(jw_finish(&w, &out, &len, NULL) == -1 && out == NULL, "unbalanced writer should fail");
+}
+
+int main(void) {
+  test_kernels();
+  test_escape();
+  test_writer();
+  if (g_fail) { fprintf(stderr, "json_scan_test: %d failure(s)\n", g_fail); return 1; }
+  printf("json_scan_test: ok\n");
+  return 0;
+}
@@ -0,0 +1,216 @@
+#include "json_writer.h"
+#include "json_scan.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+static const char k_digits2[] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+  "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+static int grow(char **buf, size_t *len, size_t *cap, size_t extra) {
+  size_t need = *len + extra + 1;
+  if (need <= *cap) return 0;
+  size_t nc = *cap ? *cap : 256;
+  while (nc < need) { if (nc > ((size_t)-1) / 2) return -1; nc *= 2; }
+  char *nb = realloc(*buf, nc);
+  if (!nb) return -1;
+  *buf = nb; *cap = nc;
+  return 0;
+}
+
+static int reserve(jw_t *w, size_t extra) {
+  if (w->err) return -1;
+  if (grow(&w->buf, &w->len, &w->cap, extra) != 0) { w->err = 1; return -1; }
+  return 0;
+}
+
+static void put(jw_t *w, const char *s, size_t n) {
+  if (reserve(w, n) != 0) return;
+  memcpy(w->buf + w->len, s, n);
+  w->len += n; w->buf[w->len] = 0;
+}
+
+/* separator before a value or key at the current level */
+static void sep(jw_t *w) {
+  if (w->after_key) { w->after_key = 0; return; }
+  if (w->has_items[w->depth]) put(w, ",", 1);
+  w->has_items[w->depth] = 1;
+}
+
+int jw_init(jw_t *w, size_t cap_hint) {
+  memset(w, 0, sizeof(*w));
+  w->cap = cap_hint ? cap_hint : 1024;
+  w->buf = malloc(w->cap);
+  if (!w->buf) { w->cap = 0; w->err = 1; return -1; }
+  w->buf[0] = 0;
+  return 0;
+}
+
+void jw_resume(jw_t *w, char *buf, size_t len, size_t cap) {
+  memset(w, 0, sizeof(*w));
+  w->buf = buf; w->len = len; w->cap = cap;
+  if (!buf) w->err = 1;
+}
+
+int jw_finish(jw_t *w, char **buf, size_t *len, size_t *cap) {
+  if (w->err) {
+    free(w->buf);
+    w->buf = NULL; w->len = w->cap = 0;
+  }
+  if (buf) *buf = w->buf;
+  if (len) *len = w->len;
+  if (cap) *cap = w->cap;
+  return w->err ? -1 : 0;
+}
+
+static void open_(jw_t *w, char c) {
+  sep(w);
+  if (w->depth >= JW_MAX_DEPTH) { w->err = 1; return; }
+  put(w, &c, 1);
+  w->has_items[++w->depth] = 0;
+}
+
+static void close_(jw_t *w, char c) {
+  if (w->depth <= 0) { w->err = 1; return; }
+  w->depth--; w->after_key = 0;
+  put(w, &c, 1);
+}
+
+void jw_begin_obj(jw_t *w) { open_(w, '{'); }
+void jw_end_obj(jw_t *w) { close_(w, '}'); }
+void jw_begin_arr(jw_t *w) { open_(w, '['); }
+void jw_end_arr(jw_t *w) { close_(w, ']'); }
+
+void jw_keyn(jw_t *w, const char *k, size_t n) {
+  w->after_key = 0;
+  sep(w);
+  if (reserve(w, n + 3) != 0) return;
+  char *o = w->buf + w->len;
+  *o++ = '"'; memcpy(o, k, n); o += n; *o++ = '"'; *o++ = ':';
+  w->len += n + 3; w->buf[w->len] = 0;
+  w->after_key = 1;
+}
+
+void jw_key(jw_t *w, const char *k) { jw_keyn(w, k, strlen(k)); }
+
+size_t jw_clean_run(const char *s, size_t n) {
+  return js_find_special(s, n);
+}
+
+int jw_escape_append(char **buf, size_t *len, size_t *cap, const char *s, size_t n) {
+  /* worst case every byte becomes \u00XX; reserve per run instead */
+  if (grow(buf, len, cap, n + 2) != 0) return -1;
+  (*buf)[(*len)++] = '"';
+  size_t i = 0;
+  while (i < n) {
+    size_t run = jw_clean_run(s + i, n - i);
+    if (run) {
+      if (grow(buf, len, cap, run + 1) != 0) return -1;
+      memcpy(*buf + *len, s + i, run);
+      *len += run; i += run;
+      if (i >= n) break;
+    }
+    unsigned char c = (unsigned char)s[i++];
+    char e[6]; size_t el = 2;
+    e[0] = '\\';
+    switch (c) {
+      case '"': e[1] = '"'; break;
+      case '\\': e[1] = '\\'; break;
+      case '\b': e[1] = 'b'; break;
+      case '\f': e[1] = 'f'; break;
+      case '\n': e[1] = 'n'; break;
+      case '\r': e[1] = 'r'; break;
+      case '\t': e[1] = 't'; break;
+      default:
+        e[1] = 'u'; e[2] = '0'; e[3] = '0';
+        e[4] = "0123456789abcdef"[c >> 4]; e[5] = "0123456789abcdef"[c & 15];
+        el = 6;
+    }
+    if (grow(buf, len, cap, el + 1) != 0) return -1;
+    memcpy(*buf + *len, e, el); *len += el;
+  }
+  if (grow(buf, len, cap, 1) != 0) return -1;
+  (*buf)[(*len)++] = '"';
+  (*buf)[*len] = 0;
+  return 0;
+}
+
+void jw_strn(jw_t *w, const char *s, size_t n) {
+  sep(w);
+  if (w->err) return;
+  if (jw_escape_append(&w->buf, &w->len, &w->cap, s ? s : "", s ? n : 0) != 0) w->err = 1;
+}
+
+void jw_str(jw_t *w, const char *s) { jw_strn(w, s, s ? strlen(s) : 0); }
+
+size_t jw_utoa(char *dst, uint64_t v) {
+  char t[20]; char *p = t + sizeof(t);
+  while (v >= 100) {
+    unsigned d = (unsigned)(v % 100); v /= 100;
+    p -= 2; memcpy(p, k_digits2 + d * 2, 2);
+  }
+  if (v >= 10) { p -= 2; memcpy(p, k_digits2 + v * 2, 2); }
+  else *--p = (char)('0' + v);
+  size_t n = (size_t)(t + sizeof(t) - p);
+  memcpy(dst, p, n);
+  return n;
+}
+
+void jw_u64(jw_t *w, uint64_t v) {
+  char d[20];
+  sep(w);
+  put(w, d, jw_utoa(d, v));
+}
+
+void jw_i64(jw_t *w, int64_t v) {
+  char d[21]; size_t n = 0;
+  sep(w);
+  uint64_t u = (uint64_t)v;
+  if (v < 0) { d[n++] = '-'; u = 0 - u; }
+  n += jw_utoa(d + n, u);
+  put(w, d, n);
+}
+
+void jw_u64_str(jw_t *w, uint64_t v) {
+  char d[22];
+  sep(w);
+  d[0] = '"';
+  size_t n = 1 + jw_utoa(d + 1, v);
+  d[n++] = '"';
+  put(w, d, n);
+}
+
+void jw_fixed(jw_t *w, double v, int decimals) {
+  static const double k_pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+  if (decimals < 0) decimals = 0;
+  if (decimals > 6) decimals = 6;
+  if (!isfinite(v)) { jw_null(w); return; }
+  sep(w);
+  char d[48]; size_t n = 0;
+  double a = fabs(v) * k_pow10[decimals] + 0.5;
+  if (a >= 9007199254740992.0) {
+    /* beyond exact integers in a double: let printf handle it */
+    int k = snprintf(d, sizeof(d), "%.*f", decimals, v);
+    if (k > 0) put(w, d, (size_t)k < sizeof(d) ? (size_t)k : sizeof(d) - 1);
+    return;
+  }
+  uint64_t scaled = (uint64_t)a;
+  uint64_t ip = scaled / (uint64_t)k_pow10[decimals], fp = scaled % (uint64_t)k_pow10[decimals];
+  if (v < 0 && scaled) d[n++] = '-';
+  n += jw_utoa(d + n, ip);
+  if (decimals) {
+    d[n++] = '.';
+    for (int i = decimals - 1; i >= 0; i--) { d[n + (size_t)i] = (char)('0' + fp % 10); fp /= 10; }
+    n += (size_t)decimals;
+  }
+  put(w, d, n);
+}
+
+void jw_bool(jw_t *w, int v) { sep(w); if (v) put(w, "true", 4); else put(w, "false", 5); }
+void jw_null(jw_t *w) { sep(w); put(w, "null", 4); }
+void jw_raw(jw_t *w, const char *json, size_t n) { sep(w); put(w, json, n); }
+void jw_members(jw_t *w, const char *json, size_t n) { if (n) jw_raw(w, json, n); }
+void jw_text(jw_t *w, const char *s, size_t n) { put(w, s, n); }
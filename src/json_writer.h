@@ -0,0 +1,77 @@
+#ifndef OLSRD_STATUS_JSON_WRITER_H
+#define OLSRD_STATUS_JSON_WRITER_H
+#include <stddef.h>
+#include <stdint.h>
+
+/* Typed JSON writer.
+ * Emitters call jw_key()/jw_str()/jw_u64()/... instead of formatting text:
+ * commas are inserted automatically from the nesting state, numbers are
+ * formatted without printf and strings are escaped by copying clean runs
+ * in bulk. Errors (allocation, nesting too deep) are sticky, so emitters
+ * write unconditionally and check once in jw_finish().
+ *
+ * The buffer is the same malloc'ed char* / len / cap triple json_buf_append()
+ * grows, so a writer can take over a partially built body (jw_resume) and
+ * hand it back (jw_finish).
+ */
+#define JW_MAX_DEPTH 32
+
+typedef struct {
+  char *buf;
+  size_t len, cap;
+  int err;
+  int depth;
+  int after_key;                    /* next value belongs to the key just written */
+  unsigned char has_items[JW_MAX_DEPTH + 1];
+} jw_t;
+
+int jw_init(jw_t *w, size_t cap_hint);
+/* Continue writing into an existing buffer; nothing is open yet. */
+void jw_resume(jw_t *w, char *buf, size_t len, size_t cap);
+/* Returns 0 and leaves buf/len/cap in the caller's variables (NUL-terminated),
+ * or -1 after an error, in which case the buffer has been freed.
+ */
+int jw_finish(jw_t *w, char **buf, size_t *len, size_t *cap);
+
+void jw_begin_obj(jw_t *w);
+void jw_end_obj(jw_t *w);
+void jw_begin_arr(jw_t *w);
+void jw_end_arr(jw_t *w);
+
+/* Object key; must be a clean literal (no characters needing escapes). */
+void jw_keyn(jw_t *w, const char *k, size_t n);
+void jw_key(jw_t *w, const char *k);
+/* Key from a string literal, with its length computed at compile time. */
+#define JW_KEY(w, lit) jw_keyn((w), "" lit, sizeof(lit) - 1)
+
+void jw_str(jw_t *w, const char *s);            /* NULL writes "" */
+void jw_strn(jw_t *w, const char *s, size_t n);
+void jw_u64(jw_t *w, uint64_t v);
+void jw_i64(jw_t *w, int64_t v);
+/* v with exactly `decimals` (0..6) fraction digits, rounded half away from
+ * zero; NaN/Inf become null.
+ */
+void jw_fixed(jw_t *w, double v, int decimals);
+#define jw_f2(w, v) jw_fixed((w), (v), 2)
+void jw_bool(jw_t *w, int v);
+void jw_null(jw_t *w);
+/* A complete, already serialized JSON value. */
+void jw_raw(jw_t *w, const char *json, size_t n);
+/* Serialized members ("a":1,"b":2) or array items spliced into the open
+ * container as if written one by one.
+ */
+void jw_members(jw_t *w, const char *json, size_t n);
+/* Layout bytes (whitespace) written verbatim, with no separator. */
+void jw_text(jw_t *w, const char *s, size_t n);
+/* An integer as a JSON string ("42"), for schemas that carry counts as text. */
+void jw_u64_str(jw_t *w, uint64_t v);
+
+/* Decimal digits of v into dst (at least 20 bytes); returns the length. */
+size_t jw_utoa(char *dst, uint64_t v);
+/* Append the quoted, escaped form of s[0..n) to a json_buf_append-style
+ * buffer. Returns 0 or -1 when the buffer could not grow.
+ */
+int jw_escape_append(char **buf, size_t *len, size_t *cap, const char *s, size_t n);
+/* Length of the leading run of s[0..n) that needs no escaping. */
+size_t jw_clean_run(const char *s, size_t n);
+#endif
@@ -0,0 +1,302 @@
+#include "lq_history.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define LQH_MAGIC 0x3148514cu   /* "LQH1" */
+#define LQH_VERSION 1
+#define LQH_EXPIRE_S (7 * 86400)
+
+typedef struct {
+  uint32_t t, n[4];
+  uint32_t sum[4];         /* lq, nlq, cost, routes over the known values */
+} acc_t;
+
+typedef struct {
+  char ip[46];
+  time_t last_seen;
+  int head[LQH_NTIERS], count[LQH_NTIERS];
+  acc_t acc[LQH_NTIERS];   /* [0] unused */
+  lqh_point_t raw[LQH_RAW_POINTS];
+  lqh_point_t m5[LQH_5M_POINTS];
+  lqh_point_t h1[LQH_1H_POINTS];
+} nb_t;
+
+static const int tier_cap[LQH_NTIERS] = { LQH_RAW_POINTS, LQH_5M_POINTS, LQH_1H_POINTS };
+static const int tier_period[LQH_NTIERS] = { 0, 300, 3600 };
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_cv = PTHREAD_COND_INITIALIZER;
+static pthread_t g_thread;
+static int g_running = 0, g_stop = 0, g_interval = 30, g_flush_s = 3600, g_dirty = 0;
+static char g_path[512];
+static int (*g_collect)(lqh_sample_t **out);
+static nb_t *g_nb[LQH_MAX_NEIGHBORS];
+static int g_nnb = 0;
+static lqh_stats_t g_stats;
+
+static lqh_point_t *tier_buf(nb_t *n, int tier) {
+  return tier == LQH_TIER_RAW ? n->raw : tier == LQH_TIER_5M ? n->m5 : n->h1;
+}
+
+static void push(nb_t *n, int tier, const lqh_point_t *p) {
+  tier_buf(n, tier)[n->head[tier]] = *p;
+  n->head[tier] = (n->head[tier] + 1) % tier_cap[tier];
+  if (n->count[tier] < tier_cap[tier]) n->count[tier]++;
+  if (tier != LQH_TIER_RAW) g_dirty = 1;
+}
+
+static void acc_close(nb_t *n, int tier) {
+  acc_t *a = &n->acc[tier];
+  if (!a->n[0] && !a->n[1] && !a->n[2] && !a->n[3]) return;
+  lqh_point_t p = { .t = a->t };
+  uint16_t *f[4] = { &p.lq, &p.nlq, &p.cost, &p.routes };
+  for (int k = 0; k < 4; k++) *f[k] = a->n[k] ? (uint16_t)((a->sum[k] + a->n[k] / 2) / a->n[k]) : LQH_NONE;
+  push(n, tier, &p);
+  memset(a, 0, sizeof(*a));
+}
+
+static void add_point(nb_t *n, const lqh_point_t *p) {
+  push(n, LQH_TIER_RAW, p);
+  const uint16_t v[4] = { p->lq, p->nlq, p->cost, p->routes };
+  for (int tier = 1; tier < LQH_NTIERS; tier++) {
+    acc_t *a = &n->acc[tier];
+    uint32_t start = p->t - p->t % (uint32_t)tier_period[tier];
+    if (a->t != start) { acc_close(n, tier); a->t = start; }
+    for (int k = 0; k < 4; k++) if (v[k] != LQH_NONE) { a->sum[k] += v[k]; a->n[k]++; }
+  }
+}
+
+static nb_t *find_nb(const char *ip) {
+  for (int i = 0; i < g_nnb; i++) if (strcmp(g_nb[i]->ip, ip) == 0) return g_nb[i];
+  return NULL;
+}
+
+/* New slot for ip; when full, the neighbour seen least recently makes room,
+ * unless it was already seen in this sample: then ip is refused, so more than
+ * LQH_MAX_NEIGHBORS links cannot keep evicting each other's history.
+ */
+static nb_t *add_nb(const char *ip, time_t now) {
+  nb_t *n = NULL;
+  if (g_nnb == LQH_MAX_NEIGHBORS) {
+    int old = 0;
+    for (int i = 1; i < g_nnb; i++) if (g_nb[i]->last_seen < g_nb[old]->last_seen) old = i;
+    if (g_nb[old]->last_seen >= now) return NULL;
+    n = g_nb[old];
+    memset(n, 0, sizeof(*n));
+  } else {
+    n = calloc(1, sizeof(*n));
+    if (!n) return NULL;
+    g_nb[g_nnb++] = n;
+  }
+  snprintf(n->ip, sizeof(n->ip), "%s", ip);
+  return n;
+}
+
+static void record(time_t now, const lqh_sample_t *s, int count) {
+  for (int i = 0; i < count; i++) {
+    if (!s[i].ip[0]) continue;
+    nb_t *n = find_nb(s[i].ip);
+    if (!n && !(n = add_nb(s[i].ip, now))) continue;
+    if (n->last_seen == now) continue;   /* duplicate link to the same neighbour */
+    n->last_seen = now;
+    lqh_point_t p = { .t = (uint32_t)now, .lq = lqh_q_ratio(s[i].lq), .nlq = lqh_q_ratio(s[i].nlq), .cost = lqh_q_cost(s[i].cost),
+                      .routes = s[i].routes < 0 ? LQH_NONE : s[i].routes >= 65534 ? 65534 : (uint16_t)s[i].routes };
+    add_point(n, &p);
+  }
+  for (int i = g_nnb - 1; i >= 0; i--) {
+    nb_t *n = g_nb[i];
+    if (now - n->last_seen <= LQH_EXPIRE_S) continue;
+    free(n);
+    g_nb[i] = g_nb[--g_nnb];
+    g_dirty = 1;
+  }
+}
+
+/* File layout: header, then per neighbour its ip, last_seen and the two
+ * averaged rings with their accumulators. Raw samples are not kept.
+ */
+struct lqh_hdr { uint32_t magic, version, count, cap5m, cap1h; };
+struct lqh_rec {
+  char ip[46];
+  uint16_t pad;
+  int64_t last_seen;
+  int32_t head[2], count[2];
+  acc_t acc[2];
+};
+
+static int save_file(void) {
+  char tmp[600];
+  if ((size_t)snprintf(tmp, sizeof(tmp), "%s.tmp.%ld", g_path, (long)getpid()) >= sizeof(tmp)) return -1;
+  int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) return -1;
+  FILE *f = fdopen(fd, "wb");
+  if (!f) { close(fd); unlink(tmp); return -1; }
+  struct lqh_hdr h = { LQH_MAGIC, LQH_VERSION, (uint32_t)g_nnb, LQH_5M_POINTS, LQH_1H_POINTS };
+  int ok = fwrite(&h, sizeof(h), 1, f) == 1;
+  for (int i = 0; ok && i < g_nnb; i++) {
+    const nb_t *n = g_nb[i];
+    struct lqh_rec r;
+    memset(&r, 0, sizeof(r));
+    memcpy(r.ip, n->ip, sizeof(r.ip));
+    r.last_seen = n->last_seen;
+    for (int k = 0; k < 2; k++) { r.head[k] = n->head[k + 1]; r.count[k] = n->count[k + 1]; r.acc[k] = n->acc[k + 1]; }
+    ok = fwrite(&r, sizeof(r), 1, f) == 1 && fwrite(n->m5, sizeof(n->m5), 1, f) == 1 && fwrite(n->h1, sizeof(n->h1), 1, f) == 1;
+  }
+  if (fflush(f) != 0 || fsync(fd) != 0) ok = 0;
+  if (fclose(f) != 0) ok = 0;
+  if (!ok || rename(tmp, g_path) != 0) { unlink(tmp); return -1; }
+  return 0;
+}
+
+static void load_file(void) {
+  FILE *f = fopen(g_path, "rb");
+  if (!f) return;
+  struct lqh_hdr h;
+  if (fread(&h, sizeof(h), 1, f) != 1 || h.magic != LQH_MAGIC || h.version != LQH_VERSION ||
+      h.cap5m != LQH_5M_POINTS || h.cap1h != LQH_1H_POINTS || h.count > LQH_MAX_NEIGHBORS) { fclose(f); return; }
+  for (uint32_t i = 0; i < h.count; i++) {
+    struct lqh_rec r;
+    nb_t *n = calloc(1, sizeof(*n));
+    if (!n) break;
+    if (fread(&r, sizeof(r), 1, f) != 1 || fread(n->m5, sizeof(n->m5), 1, f) != 1 || fread(n->h1, sizeof(n->h1), 1, f) != 1) { free(n); break; }
+    int sane = 1;
+    for (int k = 0; k < 2; k++)
+      if (r.head[k] < 0 || r.head[k] >= tier_cap[k + 1] || r.count[k] < 0 || r.count[k] > tier_cap[k + 1]) sane = 0;
+    r.ip[sizeof(r.ip) - 1] = 0;
+    if (!sane || !r.ip[0] || find_nb(r.ip)) { free(n); continue; }
+    memcpy(n->ip, r.ip, sizeof(n->ip));
+    n->last_seen = (time_t)r.last_seen;
+    for (int k = 0; k < 2; k++) { n->head[k + 1] = r.head[k]; n->count[k + 1] = r.count[k]; n->acc[k + 1] = r.acc[k]; }
+    g_nb[g_nnb++] = n;
+  }
+  fclose(f);
+}
+
+/* Called with g_lock held. Writes are flush_s apart and small (a few KiB per
+ * neighbour), so readers briefly waiting on one is fine.
+ */
+static void maybe_flush(time_t now, int force) {
+  if (!g_path[0] || !g_dirty) return;
+  if (!force && g_stats.last_flush && now - g_stats.last_flush < g_flush_s) return;
+  int rc = save_file();
+  g_stats.last_flush = now;
+  if (rc == 0) { g_stats.flushes++; g_dirty = 0; }
+  else {
+    g_stats.flush_errors++;
+    fprintf(stderr, "[status-plugin] lq history: write to %s failed: %s\n", g_path, strerror(errno));
+  }
+}
+
+static void *lqh_thread(void *arg) {
+  (void)arg;
+  pthread_mutex_lock(&g_lock);
+  while (!g_stop) {
+    pthread_mutex_unlock(&g_lock);
+    lqh_sample_t *s = NULL;
+    int n = g_collect ? g_collect(&s) : -1;
+    time_t now = time(NULL);
+    pthread_mutex_lock(&g_lock);
+    if (n >= 0) { record(now, s, n); g_stats.samples++; }
+    maybe_flush(now, 0);
+    free(s);
+    struct timespec until; clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += g_interval;
+    while (!g_stop && pthread_cond_timedwait(&g_cv, &g_lock, &until) != ETIMEDOUT) { }
+  }
+  pthread_mutex_unlock(&g_lock);
+  return NULL;
+}
+
+int lqh_start(int interval_s, const char *path, int flush_s, int (*collect)(lqh_sample_t **out)) {
+  if (g_running || interval_s <= 0) return -1;
+  pthread_mutex_lock(&g_lock);
+  g_interval = interval_s; g_flush_s = flush_s > 0 ? flush_s : 3600; g_collect = collect; g_stop = 0;
+  snprintf(g_path, sizeof(g_path), "%s", path ? path : "");
+  memset(&g_stats, 0, sizeof(g_stats));
+  if (g_path[0]) load_file();
+  /* nothing new to write until a bucket closes */
+  g_dirty = 0; g_stats.last_flush = time(NULL);
+  pthread_mutex_unlock(&g_lock);
+  if (pthread_create(&g_thread, NULL, lqh_thread, NULL) != 0) return -1;
+  g_running = 1;
+  return 0;
+}
+
+void lqh_stop(void) {
+  if (!g_running) return;
+  pthread_mutex_lock(&g_lock);
+  g_stop = 1;
+  pthread_cond_broadcast(&g_cv);
+  pthread_mutex_unlock(&g_lock);
+  pthread_join(g_thread, NULL);
+  pthread_mutex_lock(&g_lock);
+  maybe_flush(time(NULL), 1);
+  for (int i = 0; i < g_nnb; i++) free(g_nb[i]);
+  g_nnb = 0;
+  g_running = 0;
+  pthread_mutex_unlock(&g_lock);
+}
+
+int lqh_tier_seconds(int tier) {
+  return tier == LQH_TIER_RAW ? g_interval : tier_period[tier];
+}
+
+int lqh_tier_for_range(long range_s) {
+  for (int tier = 0; tier < LQH_NTIERS; tier++)
+    if ((long)lqh_tier_seconds(tier) * tier_cap[tier] >= range_s) return tier;
+  return LQH_NTIERS - 1;
+}
+
+int lqh_query(const char *ip, int tier, time_t since, lqh_point_t **out) {
+  *out = NULL;
+  if (tier < 0 || tier >= LQH_NTIERS) return -1;
+  pthread_mutex_lock(&g_lock);
+  nb_t *n = find_nb(ip);
+  if (!n) { pthread_mutex_unlock(&g_lock); return -1; }
+  lqh_point_t *v = malloc(sizeof(*v) * (size_t)(n->count[tier] ? n->count[tier] : 1));
+  if (!v) { pthread_mutex_unlock(&g_lock); return -1; }
+  int c = 0, cap = tier_cap[tier];
+  const lqh_point_t *b = tier_buf(n, tier);
+  for (int i = n->count[tier]; i > 0; i--) {
+    const lqh_point_t *p = &b[(n->head[tier] + cap - i) % cap];
+    if ((time_t)p->t >= since) v[c++] = *p;
+  }
+  pthread_mutex_unlock(&g_lock);
+  *out = v;
+  return c;
+}
+
+int lqh_neighbors(lqh_neighbor_t **out) {
+  *out = NULL;
+  pthread_mutex_lock(&g_lock);
+  if (!g_running) { pthread_mutex_unlock(&g_lock); return -1; }
+  lqh_neighbor_t *v = calloc((size_t)(g_nnb ? g_nnb : 1), sizeof(*v));
+  if (!v) { pthread_mutex_unlock(&g_lock); return -1; }
+  for (int i = 0; i < g_nnb; i++) {
+    const nb_t *n = g_nb[i];
+    memcpy(v[i].ip, n->ip, sizeof(v[i].ip));
+    v[i].last_seen = n->last_seen;
+    for (int k = 0; k < LQH_NTIERS; k++) v[i].points[k] = n->count[k];
+    if (n->count[LQH_TIER_RAW]) v[i].last = n->raw[(n->head[LQH_TIER_RAW] + LQH_RAW_POINTS - 1) % LQH_RAW_POINTS];
+    else { v[i].last.lq = v[i].last.nlq = v[i].last.cost = v[i].last.routes = LQH_NONE; }
+  }
+  int c = g_nnb;
+  pthread_mutex_unlock(&g_lock);
+  *out = v;
+  return c;
+}
+
+void lqh_get_stats(lqh_stats_t *st) {
+  if (!st) return;
+  pthread_mutex_lock(&g_lock);
+  *st = g_stats;
+  st->interval = g_running ? g_interval : 0;
+  st->neighbors = g_nnb;
+  st->memory_bytes = (size_t)g_nnb * sizeof(nb_t);
+  pthread_mutex_unlock(&g_lock);
+}
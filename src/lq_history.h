@@ -0,0 +1,69 @@
+#ifndef OLSRD_STATUS_LQ_HISTORY_H
+#define OLSRD_STATUS_LQ_HISTORY_H
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Per-neighbour link quality history. A thread samples every neighbour's LQ,
+ * NLQ, cost and route count on a fixed cadence into three rings per
+ * neighbour: raw samples, 5-minute and 1-hour averages. Values are stored as
+ * 16-bit fixed point (lq/nlq in 1/65534, cost in 1/256, LQH_NONE = unknown).
+ * The averaged tiers can be written to a file on a long interval, only when
+ * a bucket closed since the last write, and are reloaded at start.
+ */
+#define LQH_MAX_NEIGHBORS 128
+#define LQH_RAW_POINTS 240
+#define LQH_5M_POINTS 288     /* 24 h */
+#define LQH_1H_POINTS 168     /* 7 days */
+#define LQH_NONE 0xFFFF
+
+enum { LQH_TIER_RAW = 0, LQH_TIER_5M = 1, LQH_TIER_1H = 2, LQH_NTIERS = 3 };
+
+typedef struct {
+  uint32_t t;              /* sample time, or bucket start for averages */
+  uint16_t lq, nlq, cost, routes;
+} lqh_point_t;
+
+/* One neighbour as seen by a collection pass; negative values are unknown. */
+typedef struct {
+  char ip[46];
+  double lq, nlq, cost;
+  int routes;
+} lqh_sample_t;
+
+typedef struct {
+  char ip[46];
+  time_t last_seen;
+  lqh_point_t last;
+  int points[LQH_NTIERS];
+} lqh_neighbor_t;
+
+typedef struct {
+  unsigned long samples, flushes, flush_errors;
+  time_t last_flush;
+  int interval, neighbors;
+  size_t memory_bytes;
+} lqh_stats_t;
+
+/* collect fills a malloc'ed array of the current neighbours and returns its
+ * length (or -1); it runs on the history thread every interval_s seconds.
+ * path may be empty (no persistence); flush_s is the minimum write spacing.
+ */
+int lqh_start(int interval_s, const char *path, int flush_s, int (*collect)(lqh_sample_t **out));
+void lqh_stop(void);
+/* Seconds per point of a tier (the raw tier uses the sampling interval). */
+int lqh_tier_seconds(int tier);
+/* Smallest tier whose ring spans range_s seconds (the coarsest otherwise). */
+int lqh_tier_for_range(long range_s);
+/* Points of one neighbour and tier newer than since, oldest first, in a
+ * malloc'ed array. Returns the count, -1 for an unknown neighbour.
+ */
+int lqh_query(const char *ip, int tier, time_t since, lqh_point_t **out);
+int lqh_neighbors(lqh_neighbor_t **out);
+void lqh_get_stats(lqh_stats_t *st);
+
+static inline uint16_t lqh_q_ratio(double v) { return v < 0 ? LQH_NONE : v >= 1 ? 65534 : (uint16_t)(v * 65534 + 0.5); }
+static inline uint16_t lqh_q_cost(double v) { return v < 0 ? LQH_NONE : v * 256 >= 65534 ? 65534 : (uint16_t)(v * 256 + 0.5); }
+static inline double lqh_ratio(uint16_t q) { return q == LQH_NONE ? -1 : q / 65534.0; }
+static inline double lqh_cost(uint16_t q) { return q == LQH_NONE ? -1 : q / 256.0; }
+#endif
@@ -0,0 +1,98 @@
+/* lq_history: more neighbours than slots must not churn the ones already
+ * tracked, and a damaged history file must be ignored. Run with `make test`.
+ */
+#include "lq_history.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static int g_fail;
+
+#define CHECK(cond, ...) do { if (!(cond)) { fprintf(stderr, __VA_ARGS__); fputc('\n', stderr); g_fail++; } } while (0)
+
+#define NSAMPLES (LQH_MAX_NEIGHBORS + 40)
+static int g_collected;
+
+static int collect_many(lqh_sample_t **out) {
+  lqh_sample_t *s = calloc(NSAMPLES, sizeof(*s));
+  if (!s) return -1;
+  for (int i = 0; i < NSAMPLES; i++) {
+    snprintf(s[i].ip, sizeof(s[i].ip), "10.0.%d.%d", i / 250, 1 + i % 250);
+    s[i].lq = 0.5; s[i].nlq = 0.75; s[i].cost = 2.5; s[i].routes = i;
+  }
+  *out = s;
+  __atomic_add_fetch(&g_collected, 1, __ATOMIC_SEQ_CST);
+  return NSAMPLES;
+}
+
+static void wait_collected(int n) {
+  for (int i = 0; i < 400 && __atomic_load_n(&g_collected, __ATOMIC_SEQ_CST) < n; i++) usleep(10000);
+  usleep(50000); /* the pass records after collect returns */
+}
+
+static void test_overflow(void) {
+  CHECK(lqh_start(1, "", 3600, collect_many) == 0, "lqh_start failed");
+  wait_collected(2);
+  lqh_neighbor_t *v = NULL;
+  int n = lqh_neighbors(&v);
+  CHECK(n == LQH_MAX_NEIGHBORS, "neighbours: want %d got %d", LQH_MAX_NEIGHBORS, n);
+  /* the first LQH_MAX_NEIGHBORS got slots and kept their history */
+  for (int i = 0; i < n; i++) {
+    int idx = -1, a, b;
+    if (sscanf(v[i].ip, "10.0.%d.%d", &a, &b) == 2) idx = a * 250 + b - 1;
+    CHECK(idx >= 0 && idx < LQH_MAX_NEIGHBORS, "unexpected neighbour %s kept", v[i].ip);
+    CHECK(v[i].points[LQH_TIER_RAW] >= 2, "%s lost its history (%d raw points)", v[i].ip, v[i].points[LQH_TIER_RAW]);
+  }
+  free(v);
+
+  lqh_point_t *p = NULL;
+  int c = lqh_query("10.0.0.5", LQH_TIER_RAW, 0, &p);
+  CHECK(c >= 2, "query: want >= 2 points, got %d", c);
+  if (c > 0) {
+    CHECK(p[0].routes == 4 && p[0].lq == lqh_q_ratio(0.5) && p[0].nlq == lqh_q_ratio(0.75) && p[0].cost == lqh_q_cost(2.5),
+          "query: wrong point %u/%u/%u/%u", p[0].lq, p[0].nlq, p[0].cost, p[0].routes);
+  }
+  free(p);
+  CHECK(lqh_query("10.0.1.1", LQH_TIER_RAW, 0, &p) == -1, "refused neighbour should be unknown");
+  free(p);
+  lqh_stop();
+}
+
+static int collect_none(lqh_sample_t **out) { *out = NULL; return 0; }
+
+static void test_bad_file(void) {
+  char path[] = "/tmp/lqh_test_XXXXXX";
+  int fd = mkstemp(path);
+  CHECK(fd >= 0, "mkstemp failed");
+  if (fd < 0) return;
+  /* right magic, absurd count, then nothing */
+  const unsigned hdr[5] = { 0x3148514cu, 1, 100000, LQH_5M_POINTS, LQH_1H_POINTS };
+  CHECK(write(fd, hdr, sizeof(hdr)) == (ssize_t)sizeof(hdr), "write failed");
+  close(fd);
+  CHECK(lqh_start(60, path, 3600, collect_none) == 0, "lqh_start failed");
+  lqh_neighbor_t *v = NULL;
+  CHECK(lqh_neighbors(&v) == 0, "bad file should load nothing");
+  free(v);
+  lqh_stop();
+
+  /* plausible count, truncated records */
+  fd = open(path, O_WRONLY | O_TRUNC);
+  const unsigned hdr2[5] = { 0x3148514cu, 1, 3, LQH_5M_POINTS, LQH_1H_POINTS };
+  CHECK(write(fd, hdr2, sizeof(hdr2)) == (ssize_t)sizeof(hdr2) && write(fd, "10.0.0.1", 8) == 8, "write failed");
+  close(fd);
+  CHECK(lqh_start(60, path, 3600, collect_none) == 0, "lqh_start failed");
+  CHECK(lqh_neighbors(&v) == 0, "truncated file should load nothing");
+  free(v);
+  lqh_stop();
+  unlink(path);
+}
+
+int main(void) {
+  test_overflow();
+  test_bad_file();
+  if (g_fail) { fprintf(stderr, "lq_history_test: %d failure(s)\n", g_fail); return 1; }
+  printf("lq_history_test: ok\n");
+  return 0;
+}
@@ -0,0 +1,224 @@
+#include "lru_cache.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+/* Each shard is a chained hash table plus an intrusive doubly linked list in
+ * recency order (head = most recently used). Key and value live in one
+ * allocation after the node header.
+ */
+struct lru_node {
+  struct lru_node *hnext;           /* hash chain */
+  struct lru_node *prev, *next;     /* recency list */
+  uint64_t h;
+  time_t expires;
+  unsigned char negative;
+  unsigned char refreshing;         /* a stale reader has claimed the refresh */
+  size_t klen, vlen;
+  char data[];                      /* key '\0' value '\0' */
+};
+
+struct lru_shard {
+  pthread_mutex_t lock;
+  struct lru_node **bucket;
+  size_t nbuckets, count, cap;
+  struct lru_node *head, *tail;
+  unsigned long hits, misses, stale_hits, negative_hits, evictions, inserts;
+};
+
+struct lru_cache {
+  struct lru_shard *shard;
+  unsigned nshards;
+  int ttl, negative_ttl, stale_ttl;
+};
+
+static uint64_t key_hash(const char *k, size_t *len) {
+  uint64_t h = UINT64_C(1469598103934665603);
+  const unsigned char *p = (const unsigned char *)k;
+  for (; *p; ++p) h = (h ^ *p) * UINT64_C(1099511628211);
+  *len = (size_t)(p - (const unsigned char *)k);
+  return h;
+}
+
+lru_cache_t *lru_cache_create(size_t capacity, int shards, int ttl, int negative_ttl, int stale_ttl) {
+  if (capacity == 0) capacity = 1;
+  unsigned n = 1;
+  while (n < (unsigned)(shards > 0 ? shards : 1) && n < 256) n <<= 1;
+  while (n > 1 && capacity / n == 0) n >>= 1;
+  lru_cache_t *c = calloc(1, sizeof(*c));
+  if (!c) return NULL;
+  c->shard = calloc(n, sizeof(*c->shard));
+  if (!c->shard) { free(c); return NULL; }
+  c->nshards = n; c->ttl = ttl; c->negative_ttl = negative_ttl; c->stale_ttl = stale_ttl;
+  for (unsigned i = 0; i < n; i++) {
+    struct lru_shard *s = &c->shard[i];
+    s->cap = capacity / n + (i < capacity % n ? 1 : 0);
+    s->nbuckets = 8; while (s->nbuckets < s->cap) s->nbuckets <<= 1;
+    s->bucket = calloc(s->nbuckets, sizeof(*s->bucket));
+    pthread_mutex_init(&s->lock, NULL);
+    if (!s->bucket) { c->nshards = i + 1; lru_cache_destroy(c); return NULL; }
+  }
+  return c;
+}
+
+void lru_cache_destroy(lru_cache_t *c) {
+  if (!c) return;
+  for (unsigned i = 0; i < c->nshards; i++) {
+    struct lru_shard *s = &c->shard[i];
+    for (struct lru_node *e = s->head; e; ) { struct lru_node *nx = e->next; free(e); e = nx; }
+    free(s->bucket);
+    pthread_mutex_destroy(&s->lock);
+  }
+  free(c->shard);
+  free(c);
+}
+
+/* shard from the high bits, bucket from the low bits */
+static struct lru_shard *shard_for(lru_cache_t *c, uint64_t h) { return &c->shard[(h >> 48) & (c->nshards - 1)]; }
+
+static struct lru_node **find_slot(struct lru_shard *s, uint64_t h, const char *key, size_t klen) {
+  struct lru_node **pp = &s->bucket[h & (s->nbuckets - 1)];
+  for (; *pp; pp = &(*pp)->hnext)
+    if ((*pp)->h == h && (*pp)->klen == klen && memcmp((*pp)->data, key, klen) == 0) return pp;
+  return pp;
+}
+
+static void list_unlink(struct lru_shard *s, struct lru_node *e) {
+  if (e->prev) e->prev->next = e->next; else s->head = e->next;
+  if (e->next) e->next->prev = e->prev; else s->tail = e->prev;
+  e->prev = e->next = NULL;
+}
+
+static void list_push_front(struct lru_shard *s, struct lru_node *e) {
+  e->prev = NULL; e->next = s->head;
+  if (s->head) s->head->prev = e; else s->tail = e;
+  s->head = e;
+}
+
+static void remove_node(struct lru_shard *s, struct lru_node *e) {
+  struct lru_node **pp = find_slot(s, e->h, e->data, e->klen);
+  if (*pp == e) *pp = e->hnext;
+  list_unlink(s, e);
+  s->count--;
+  free(e);
+}
+
+/* Look up under the shard lock; on a usable entry returns it with the status. */
+static int lookup_locked(lru_cache_t *c, struct lru_shard *s, uint64_t h, const char *key, size_t klen,
+                         struct lru_node **out, int *revalidate) {
+  struct lru_node *e = *find_slot(s, h, key, klen);
+  time_t now = time(NULL);
+  if (revalidate) *revalidate = 0;
+  if (!e) { s->misses++; return LRU_MISS; }
+  if (e->negative) {
+    if (now < e->expires) { s->negative_hits++; return LRU_NEGATIVE; }
+    remove_node(s, e); s->misses++; return LRU_MISS;
+  }
+  int st = LRU_HIT;
+  if (now >= e->expires) {
+    if (now >= e->expires + c->stale_ttl) { remove_node(s, e); s->misses++; return LRU_MISS; }
+    st = LRU_STALE; s->stale_hits++;
+    if (!e->refreshing) { e->refreshing = 1; if (revalidate) *revalidate = 1; }
+  } else s->hits++;
+  list_unlink(s, e); list_push_front(s, e);
+  *out = e;
+  return st;
+}
+
+int lru_cache_get(lru_cache_t *c, const char *key, char *out, size_t outlen, int *revalidate) {
+  if (revalidate) *revalidate = 0;
+  if (!c || !key || !out || outlen == 0) return LRU_MISS;
+  size_t klen; uint64_t h = key_hash(key, &klen);
+  struct lru_shard *s = shard_for(c, h);
+  pthread_mutex_lock(&s->lock);
+  struct lru_node *e = NULL;
+  int st = lookup_locked(c, s, h, key, klen, &e, revalidate);
+  if (e) {
+    size_t n = e->vlen < outlen - 1 ? e->vlen : outlen - 1;
+    memcpy(out, e->data + e->klen + 1, n); out[n] = '\0';
+  }
+  pthread_mutex_unlock(&s->lock);
+  return st;
+}
+
+int lru_cache_get_dup(lru_cache_t *c, const char *key, char **out, size_t *outlen, int *revalidate) {
+  if (revalidate) *revalidate = 0;
+  if (!c || !key || !out) return LRU_MISS;
+  *out = NULL; if (outlen) *outlen = 0;
+  size_t klen; uint64_t h = key_hash(key, &klen);
+  struct lru_shard *s = shard_for(c, h);
+  pthread_mutex_lock(&s->lock);
+  struct lru_node *e = NULL;
+  int st = lookup_locked(c, s, h, key, klen, &e, revalidate);
+  if (e) {
+    *out = malloc(e->vlen + 1);
+    if (*out) { memcpy(*out, e->data + e->klen + 1, e->vlen + 1); if (outlen) *outlen = e->vlen; }
+    else st = LRU_MISS;
+  }
+  pthread_mutex_unlock(&s->lock);
+  return st;
+}
+
+static void put_entry(lru_cache_t *c, const char *key, const char *val, size_t vlen, int negative, int ttl) {
+  if (!c || !key) return;
+  size_t klen; uint64_t h = key_hash(key, &klen);
+  struct lru_node *n = malloc(sizeof(*n) + klen + 1 + vlen + 1);
+  if (!n) return;
+  n->h = h; n->klen = klen; n->vlen = vlen; n->negative = (unsigned char)negative; n->refreshing = 0;
+  n->expires = time(NULL) + ttl;
+  memcpy(n->data, key, klen + 1);
+  if (vlen) memcpy(n->data + klen + 1, val, vlen);
+  n->data[klen + 1 + vlen] = '\0';
+  struct lru_shard *s = shard_for(c, h);
+  pthread_mutex_lock(&s->lock);
+  struct lru_node **pp = find_slot(s, h, key, klen);
+  if (negative && *pp && !(*pp)->negative && time(NULL) < (*pp)->expires + c->stale_ttl) {
+    /* a failed refresh: keep serving the old name, let the next reader retry */
+    (*pp)->refreshing = 0;
+    pthread_mutex_unlock(&s->lock);
+    free(n);
+    return;
+  }
+  if (*pp) { struct lru_node *old = *pp; n->hnext = old->hnext; *pp = n; list_unlink(s, old); free(old); }
+  else { n->hnext = NULL; *pp = n; s->count++; }
+  list_push_front(s, n);
+  s->inserts++;
+  while (s->count > s->cap && s->tail) { remove_node(s, s->tail); s->evictions++; }
+  pthread_mutex_unlock(&s->lock);
+}
+
+void lru_cache_put(lru_cache_t *c, const char *key, const char *val, size_t vlen, int ttl) {
+  if (!c || !val) return;
+  put_entry(c, key, val, vlen, 0, ttl > 0 ? ttl : c->ttl);
+}
+
+void lru_cache_put_negative(lru_cache_t *c, const char *key) {
+  if (!c || c->negative_ttl <= 0) { lru_cache_refresh_failed(c, key); return; }
+  put_entry(c, key, "", 0, 1, c->negative_ttl);
+}
+
+void lru_cache_refresh_failed(lru_cache_t *c, const char *key) {
+  if (!c || !key) return;
+  size_t klen; uint64_t h = key_hash(key, &klen);
+  struct lru_shard *s = shard_for(c, h);
+  pthread_mutex_lock(&s->lock);
+  struct lru_node *e = *find_slot(s, h, key, klen);
+  if (e) e->refreshing = 0;
+  pthread_mutex_unlock(&s->lock);
+}
+
+void lru_cache_get_stats(lru_cache_t *c, lru_cache_stats_t *st) {
+  if (!st) return;
+  memset(st, 0, sizeof(*st));
+  if (!c) return;
+  for (unsigned i = 0; i < c->nshards; i++) {
+    struct lru_shard *s = &c->shard[i];
+    pthread_mutex_lock(&s->lock);
+    st->hits += s->hits; st->misses += s->misses; st->stale_hits += s->stale_hits;
+    st->negative_hits += s->negative_hits; st->evictions += s->evictions; st->inserts += s->inserts;
+    st->entries += s->count; st->capacity += s->cap;
+    pthread_mutex_unlock(&s->lock);
+  }
+}
@@ -0,0 +1,44 @@
+#ifndef OLSRD_STATUS_LRU_CACHE_H
+#define OLSRD_STATUS_LRU_CACHE_H
+#include <stddef.h>
+
+/* Sharded string -> string cache with per-shard locks and true LRU eviction.
+ * Entries carry a positive or negative ("known not to exist") TTL; a positive
+ * entry past its TTL is still served for stale_ttl seconds while one caller
+ * refreshes it (stale-while-revalidate).
+ */
+typedef struct lru_cache lru_cache_t;
+
+enum {
+  LRU_MISS = 0,     /* not cached (or fully expired) */
+  LRU_HIT,          /* fresh value copied out */
+  LRU_STALE,        /* expired value copied out; see *revalidate */
+  LRU_NEGATIVE      /* cached absence: do not look it up again yet */
+};
+
+typedef struct {
+  unsigned long hits, misses, stale_hits, negative_hits, evictions, inserts;
+  size_t entries, capacity;
+} lru_cache_stats_t;
+
+/* capacity is the total entry count across shards (shards rounded up to a power of two). */
+lru_cache_t *lru_cache_create(size_t capacity, int shards, int ttl, int negative_ttl, int stale_ttl);
+void lru_cache_destroy(lru_cache_t *c);
+/* Copy the value into out. For LRU_STALE, *revalidate (if given) is set to 1 for
+ * exactly one caller per stale period so only that caller refreshes the entry.
+ */
+int lru_cache_get(lru_cache_t *c, const char *key, char *out, size_t outlen, int *revalidate);
+/* Like lru_cache_get but returns a malloc'ed copy of the full value. */
+int lru_cache_get_dup(lru_cache_t *c, const char *key, char **out, size_t *outlen, int *revalidate);
+/* Insert or replace; ttl <= 0 uses the cache default. */
+void lru_cache_put(lru_cache_t *c, const char *key, const char *val, size_t vlen, int ttl);
+/* Cache an absence. A positive entry (fresh or stale) is kept: a failed
+ * refresh only releases its claim, so the old value is served until it ages out.
+ */
+void lru_cache_put_negative(lru_cache_t *c, const char *key);
+/* Give up a refresh claimed through *revalidate without a new value, so the
+ * next stale reader can try again.
+ */
+void lru_cache_refresh_failed(lru_cache_t *c, const char *key);
+void lru_cache_get_stats(lru_cache_t *c, lru_cache_stats_t *st);
+#endif
@@ -0,0 +1,111 @@
+/* lru_cache: LRU order and eviction, negative entries, stale-while-revalidate
+ * with a single refresher, failed refreshes, and a threaded mix of gets and
+ * puts on shared keys. Run with `make test`; takes a few seconds for the TTLs.
+ */
+#include "lru_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+static int g_fail;
+
+#define CHECK(cond, ...) do { if (!(cond)) { fprintf(stderr, __VA_ARGS__); fputc('\n', stderr); g_fail++; } } while (0)
+
+static void put_str(lru_cache_t *c, const char *k, const char *v) { lru_cache_put(c, k, v, strlen(v), 0); }
+
+static void test_lru_order(void) {
+  lru_cache_t *c = lru_cache_create(3, 1, 60, 60, 60);
+  char out[32];
+  put_str(c, "a", "1"); put_str(c, "b", "2"); put_str(c, "c", "3");
+  CHECK(lru_cache_get(c, "a", out, sizeof(out), NULL) == LRU_HIT && strcmp(out, "1") == 0, "a: want hit 1");
+  put_str(c, "d", "4");                 /* evicts b, the least recently used */
+  CHECK(lru_cache_get(c, "b", out, sizeof(out), NULL) == LRU_MISS, "b should have been evicted");
+  CHECK(lru_cache_get(c, "a", out, sizeof(out), NULL) == LRU_HIT, "a should survive");
+  put_str(c, "a", "one");               /* replace in place */
+  char *dup = NULL; size_t n = 0;
+  CHECK(lru_cache_get_dup(c, "a", &dup, &n, NULL) == LRU_HIT && dup && n == 3 && strcmp(dup, "one") == 0, "get_dup: want one");
+  free(dup);
+  CHECK(lru_cache_get(c, "a", out, 3, NULL) == LRU_HIT && strcmp(out, "on") == 0, "short buffer: got %s", out);
+  lru_cache_put_negative(c, "x");
+  CHECK(lru_cache_get(c, "x", out, sizeof(out), NULL) == LRU_NEGATIVE, "x: want negative");
+  lru_cache_stats_t st; lru_cache_get_stats(c, &st);
+  CHECK(st.entries == 3 && st.capacity == 3 && st.evictions == 2, "stats: entries %zu cap %zu evictions %lu", st.entries, st.capacity, st.evictions);
+  lru_cache_destroy(c);
+}
+
+static void test_stale(void) {
+  lru_cache_t *c = lru_cache_create(16, 4, 1, 60, 60);
+  char out[32];
+  int rv = 0;
+  put_str(c, "10.0.0.1", "old.name");
+  sleep(2);                              /* past the 1 s TTL, inside the stale window */
+  CHECK(lru_cache_get(c, "10.0.0.1", out, sizeof(out), &rv) == LRU_STALE && rv == 1 && strcmp(out, "old.name") == 0, "first stale reader should refresh");
+  CHECK(lru_cache_get(c, "10.0.0.1", out, sizeof(out), &rv) == LRU_STALE && rv == 0, "second stale reader must not refresh");
+
+  /* the refresh failed: no negative entry over the name, and the claim is released */
+  lru_cache_put_negative(c, "10.0.0.1");
+  CHECK(lru_cache_get(c, "10.0.0.1", out, sizeof(out), &rv) == LRU_STALE && rv == 1 && strcmp(out, "old.name") == 0, "failed refresh: want the old name and a new claim");
+  lru_cache_refresh_failed(c, "10.0.0.1");
+  CHECK(lru_cache_get(c, "10.0.0.1", out, sizeof(out), &rv) == LRU_STALE && rv == 1, "refresh_failed should release the claim");
+
+  put_str(c, "10.0.0.1", "new.name");
+  CHECK(lru_cache_get(c, "10.0.0.1", out, sizeof(out), &rv) == LRU_HIT && rv == 0 && strcmp(out, "new.name") == 0, "refreshed: want new.name");
+  lru_cache_destroy(c);
+
+  /* without a stale window an expired name is simply gone */
+  c = lru_cache_create(16, 1, 1, 1, 0);
+  put_str(c, "k", "v");
+  lru_cache_put_negative(c, "n");
+  sleep(2);
+  CHECK(lru_cache_get(c, "k", out, sizeof(out), &rv) == LRU_MISS, "expired entry: want miss");
+  CHECK(lru_cache_get(c, "n", out, sizeof(out), &rv) == LRU_MISS, "expired negative: want miss");
+  lru_cache_put_negative(c, "k");
+  CHECK(lru_cache_get(c, "k", out, sizeof(out), &rv) == LRU_NEGATIVE, "negative over a missing entry");
+  lru_cache_destroy(c);
+}
+
+#define NTHREADS 8
+#define NKEYS 64
+
+static lru_cache_t *g_shared;
+
+static void *hammer(void *arg) {
+  unsigned seed = (unsigned)(size_t)arg;
+  char k[16], v[32], out[32];
+  for (int i = 0; i < 20000; i++) {
+    seed = seed * 1103515245u + 12345u;
+    int key = (int)(seed >> 16) % NKEYS;
+    snprintf(k, sizeof(k), "k%d", key);
+    switch ((seed >> 8) % 4) {
+      case 0: snprintf(v, sizeof(v), "v%d", key); put_str(g_shared, k, v); break;
+      case 1: lru_cache_put_negative(g_shared, k); break;
+      default: {
+        int st = lru_cache_get(g_shared, k, out, sizeof(out), NULL);
+        snprintf(v, sizeof(v), "v%d", key);
+        if (st == LRU_HIT || st == LRU_STALE) CHECK(strcmp(out, v) == 0, "%s: got %s", k, out);
+      }
+    }
+  }
+  return NULL;
+}
+
+static void test_threads(void) {
+  g_shared = lru_cache_create(NKEYS / 2, 4, 60, 60, 60);
+  pthread_t th[NTHREADS];
+  for (int i = 0; i < NTHREADS; i++) pthread_create(&th[i], NULL, hammer, (void *)(size_t)(i + 1));
+  for (int i = 0; i < NTHREADS; i++) pthread_join(th[i], NULL);
+  lru_cache_stats_t st; lru_cache_get_stats(g_shared, &st);
+  CHECK(st.entries <= st.capacity, "entries %zu over capacity %zu", st.entries, st.capacity);
+  lru_cache_destroy(g_shared);
+}
+
+int main(void) {
+  test_lru_order();
+  test_stale();
+  test_threads();
+  if (g_fail) { fprintf(stderr, "lru_cache_test: %d failure(s)\n", g_fail); return 1; }
+  printf("lru_cache_test: ok\n");
+  return 0;
+}
@@ -0,0 +1,416 @@
+#include "neigh_cache.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/neighbour.h>
+
+typedef struct {
+  neigh_entry_t e;
+  unsigned gen;            /* dump generation that last confirmed the entry */
+  int next;                /* bucket chain, -1 = end */
+  int anext;               /* address-only chain (neigh_cache_lookup), -1 = end */
+} slot_t;
+
+static pthread_rwlock_t g_lock = PTHREAD_RWLOCK_INITIALIZER;
+static slot_t *g_ent = NULL;       /* dense: g_n used of g_cap */
+static int g_n = 0, g_cap = 0;
+static int *g_bucket = NULL;       /* g_nbucket heads, power of two */
+static int *g_abucket = NULL;      /* same size, keyed on (family, address) only */
+static int g_nbucket = 0;
+static unsigned g_gen = 0;
+static neigh_cache_stats_t g_stats;
+
+static pthread_t g_thread;
+static int g_running = 0, g_nl = -1, g_stopfd = -1;
+
+/* if_indextoname() is an ioctl; a dump asks for the same few names over and over */
+static struct { int ifindex; char name[IF_NAMESIZE]; } g_ifn[16];
+
+static void ifname_of(int ifindex, char *out, size_t outlen) {
+  unsigned h = (unsigned)ifindex % (sizeof(g_ifn) / sizeof(g_ifn[0]));
+  if (g_ifn[h].ifindex != ifindex) {
+    char tmp[IF_NAMESIZE];
+    if (!if_indextoname((unsigned)ifindex, tmp)) snprintf(tmp, sizeof(tmp), "if%d", ifindex);
+    g_ifn[h].ifindex = ifindex;
+    snprintf(g_ifn[h].name, sizeof(g_ifn[h].name), "%s", tmp);
+  }
+  snprintf(out, outlen, "%s", g_ifn[h].name);
+}
+
+static unsigned key_hash(int ifindex, int family, const unsigned char *addr) {
+  unsigned h = 2166136261u;
+  h = (h ^ (unsigned)ifindex) * 16777619u;
+  h = (h ^ (unsigned)family) * 16777619u;
+  for (int i = 0; i < 16; i++) h = (h ^ addr[i]) * 16777619u;
+  return h;
+}
+
+static int *slot_link(int i) {
+  const neigh_entry_t *e = &g_ent[i].e;
+  int *l = &g_bucket[key_hash(e->ifindex, e->family, e->addr) & (unsigned)(g_nbucket - 1)];
+  while (*l != i) l = &g_ent[*l].next;
+  return l;
+}
+
+static int *addr_link(int i) {
+  const neigh_entry_t *e = &g_ent[i].e;
+  int *l = &g_abucket[key_hash(0, e->family, e->addr) & (unsigned)(g_nbucket - 1)];
+  while (*l != i) l = &g_ent[*l].anext;
+  return l;
+}
+
+static void link_slot(int i) {
+  const neigh_entry_t *e = &g_ent[i].e;
+  int *head = &g_bucket[key_hash(e->ifindex, e->family, e->addr) & (unsigned)(g_nbucket - 1)];
+  g_ent[i].next = *head; *head = i;
+  head = &g_abucket[key_hash(0, e->family, e->addr) & (unsigned)(g_nbucket - 1)];
+  g_ent[i].anext = *head; *head = i;
+}
+
+static int find(int ifindex, int family, const unsigned char *addr) {
+  if (!g_nbucket) return -1;
+  for (int i = g_bucket[key_hash(ifindex, family, addr) & (unsigned)(g_nbucket - 1)]; i >= 0; i = g_ent[i].next) {
+    const neigh_entry_t *e = &g_ent[i].e;
+    if (e->ifindex == ifindex && e->family == family && memcmp(e->addr, addr, 16) == 0) return i;
+  }
+  return -1;
+}
+
+static int rehash(int nbucket) {
+  int *b = malloc(sizeof(*b) * (size_t)nbucket * 2);
+  if (!b) return -1;
+  free(g_bucket); g_bucket = b; g_abucket = b + nbucket; g_nbucket = nbucket;
+  for (int i = 0; i < nbucket * 2; i++) b[i] = -1;
+  for (int i = 0; i < g_n; i++) link_slot(i);
+  return 0;
+}
+
+static void remove_at(int i) {
+  *slot_link(i) = g_ent[i].next;
+  *addr_link(i) = g_ent[i].anext;
+  int last = g_n - 1;
+  if (i != last) {
+    *slot_link(last) = i;
+    *addr_link(last) = i;
+    g_ent[i] = g_ent[last];
+  }
+  g_n--;
+  g_stats.version++;
+}
+
+/* Insert or update; returns -1 only when the table cannot grow. */
+static int upsert(const neigh_entry_t *ne) {
+  int i = find(ne->ifindex, ne->family, ne->addr);
+  if (i >= 0) {
+    neigh_entry_t *e = &g_ent[i].e;
+    if (e->state != ne->state || e->master != ne->master || strcmp(e->mac, ne->mac) != 0 || strcmp(e->dev, ne->dev) != 0) {
+      *e = *ne;
+      g_stats.version++;
+    }
+    g_ent[i].gen = g_gen;
+    return 0;
+  }
+  if (g_n == g_cap) {
+    int ncap = g_cap ? g_cap * 2 : 64;
+    slot_t *n = realloc(g_ent, sizeof(*n) * (size_t)ncap);
+    if (!n) return -1;
+    g_ent = n; g_cap = ncap;
+  }
+  if (g_n >= g_nbucket && rehash(g_nbucket ? g_nbucket * 2 : 64) != 0) return -1;
+  i = g_n++;
+  g_ent[i].e = *ne;
+  g_ent[i].gen = g_gen;
+  link_slot(i);
+  g_stats.version++;
+  return 0;
+}
+
+/* Drop entries a completed dump did not report (missed while overrun). */
+static void sweep(void) {
+  for (int i = g_n - 1; i >= 0; i--)
+    if (g_ent[i].gen != g_gen) remove_at(i);
+}
+
+static void apply(const struct nlmsghdr *h) {
+  const struct ndmsg *nd = NLMSG_DATA(h);
+  if (h->nlmsg_len < NLMSG_LENGTH(sizeof(*nd))) return;
+  if (nd->ndm_family != AF_INET && nd->ndm_family != AF_INET6 && nd->ndm_family != AF_BRIDGE) return;
+  neigh_entry_t ne;
+  memset(&ne, 0, sizeof(ne));
+  ne.ifindex = nd->ndm_ifindex;
+  ne.family = nd->ndm_family;
+  ne.state = nd->ndm_state;
+  int have_key = 0;
+  int alen = (int)(h->nlmsg_len - NLMSG_LENGTH(sizeof(*nd)));
+  for (const struct rtattr *a = (const struct rtattr *)((const char *)nd + NLMSG_ALIGN(sizeof(*nd))); RTA_OK(a, alen); a = RTA_NEXT(a, alen)) {
+    size_t plen = RTA_PAYLOAD(a);
+    const unsigned char *p = RTA_DATA(a);
+    if (a->rta_type == NDA_DST && ne.family != AF_BRIDGE && plen == (ne.family == AF_INET ? 4u : 16u)) {
+      memcpy(ne.addr, p, plen);
+      have_key = 1;
+    } else if (a->rta_type == NDA_LLADDR && plen == 6) {
+      snprintf(ne.mac, sizeof(ne.mac), "%02x:%02x:%02x:%02x:%02x:%02x", p[0], p[1], p[2], p[3], p[4], p[5]);
+      /* an FDB entry is identified by MAC and VLAN on its port */
+      if (ne.family == AF_BRIDGE) { memcpy(ne.addr, p, 6); have_key = 1; }
+    } else if (a->rta_type == NDA_MASTER && plen == 4) {
+      memcpy(&ne.master, p, 4);
+    } else if (a->rta_type == NDA_VLAN && plen == 2) {
+      memcpy(&ne.vlan, p, 2);
+    }
+  }
+  if (!have_key) return;
+  /* FDB rows without a master are the multicast lists of plain devices */
+  if (ne.family == AF_BRIDGE && !ne.master) return;
+  if (ne.family == AF_BRIDGE) memcpy(ne.addr + 6, &ne.vlan, 2);
+  else inet_ntop(ne.family, ne.addr, ne.ip, sizeof(ne.ip));
+  ifname_of(ne.ifindex, ne.dev, sizeof(ne.dev));
+  pthread_rwlock_wrlock(&g_lock);
+  if (h->nlmsg_type == RTM_DELNEIGH) {
+    int i = find(ne.ifindex, ne.family, ne.addr);
+    if (i >= 0) remove_at(i);
+  } else {
+    upsert(&ne);
+  }
+  g_stats.entries = g_n;
+  pthread_rwlock_unlock(&g_lock);
+}
+
+/* A full resync is two dumps: AF_UNSPEC (ARP/NDP) does not include the
+ * bridge FDB, which is asked for separately with AF_BRIDGE.
+ */
+static int request_dump(unsigned seq, int family) {
+  struct { struct nlmsghdr h; struct ndmsg nd; } req;
+  memset(&req, 0, sizeof(req));
+  req.h.nlmsg_len = NLMSG_LENGTH(sizeof(req.nd));
+  req.h.nlmsg_type = RTM_GETNEIGH;
+  req.h.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  req.h.nlmsg_seq = seq;
+  req.nd.ndm_family = (unsigned char)family;
+  struct sockaddr_nl k = { .nl_family = AF_NETLINK };
+  if (sendto(g_nl, &req, req.h.nlmsg_len, 0, (struct sockaddr *)&k, sizeof(k)) < 0) return -1;
+  if (family == AF_BRIDGE) return 0;
+  memset(g_ifn, 0, sizeof(g_ifn));
+  pthread_rwlock_wrlock(&g_lock);
+  g_gen++;
+  g_stats.dumps++;
+  pthread_rwlock_unlock(&g_lock);
+  return 0;
+}
+
+static void *neigh_thread(void *arg) {
+  (void)arg;
+  size_t bufsz = 64 * 1024;
+  char *buf = malloc(bufsz);
+  if (!buf) return NULL;
+  unsigned seq = 1;
+  /* dumping: 0 idle, 1 neighbours, 2 FDB */
+  int dumping = request_dump(seq, AF_UNSPEC) == 0, redump = !dumping;
+  for (;;) {
+    struct pollfd pf[2] = { { .fd = g_nl, .events = POLLIN }, { .fd = g_stopfd, .events = POLLIN } };
+    /* a failed dump request is retried once a second */
+    if (poll(pf, 2, redump && !dumping ? 1000 : -1) < 0 && errno != EINTR) break;
+    if (pf[1].revents) break;
+    for (;;) {
+      ssize_t n = recv(g_nl, buf, bufsz, MSG_DONTWAIT);
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        if (errno == ENOBUFS) {
+          /* events were dropped: the table is stale until a fresh dump completes */
+          pthread_rwlock_wrlock(&g_lock); g_stats.overruns++; pthread_rwlock_unlock(&g_lock);
+          redump = 1;
+          continue;
+        }
+        break;
+      }
+      int len = (int)n;
+      for (const struct nlmsghdr *h = (const struct nlmsghdr *)buf; NLMSG_OK(h, len); h = NLMSG_NEXT(h, len)) {
+        if (h->nlmsg_type == NLMSG_DONE || h->nlmsg_type == NLMSG_ERROR) {
+          if (dumping && h->nlmsg_seq == seq) {
+            if (dumping == 1 && h->nlmsg_type == NLMSG_DONE) {
+              dumping = request_dump(++seq, AF_BRIDGE) == 0 ? 2 : 0;
+              if (!dumping) redump = 1;
+            } else if (dumping == 2) {
+              /* an FDB dump error just means no bridge support */
+              dumping = 0;
+              pthread_rwlock_wrlock(&g_lock); sweep(); g_stats.entries = g_n; pthread_rwlock_unlock(&g_lock);
+            } else {
+              dumping = 0;
+              redump = 1;
+            }
+          }
+          continue;
+        }
+        if (h->nlmsg_type == RTM_NEWNEIGH || h->nlmsg_type == RTM_DELNEIGH) {
+          if (!h->nlmsg_seq) {
+            pthread_rwlock_wrlock(&g_lock); g_stats.events++; pthread_rwlock_unlock(&g_lock);
+          }
+          apply(h);
+        }
+      }
+    }
+    if (redump && !dumping) {
+      dumping = request_dump(++seq, AF_UNSPEC) == 0;
+      if (dumping) redump = 0;
+    }
+  }
+  free(buf);
+  return NULL;
+}
+
+int neigh_cache_start(void) {
+  if (g_running) return 0;
+  int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+  if (fd < 0) return -1;
+  int rcv = 1 << 20;
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcv, sizeof(rcv));
+  struct sockaddr_nl sa = { .nl_family = AF_NETLINK, .nl_groups = RTMGRP_NEIGH };
+  if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0) { close(fd); return -1; }
+  int efd = eventfd(0, EFD_CLOEXEC);
+  if (efd < 0) { close(fd); return -1; }
+  g_nl = fd; g_stopfd = efd;
+  pthread_rwlock_wrlock(&g_lock);
+  memset(&g_stats, 0, sizeof(g_stats));
+  g_stats.version = 1;
+  pthread_rwlock_unlock(&g_lock);
+  if (pthread_create(&g_thread, NULL, neigh_thread, NULL) != 0) {
+    close(fd); close(efd); g_nl = g_stopfd = -1;
+    return -1;
+  }
+  pthread_rwlock_wrlock(&g_lock);
+  g_running = 1;
+  pthread_rwlock_unlock(&g_lock);
+  return 0;
+}
+
+void neigh_cache_stop(void) {
+  if (!g_running) return;
+  uint64_t one = 1;
+  if (write(g_stopfd, &one, sizeof(one)) < 0) { }
+  pthread_join(g_thread, NULL);
+  close(g_nl); close(g_stopfd); g_nl = g_stopfd = -1;
+  pthread_rwlock_wrlock(&g_lock);
+  free(g_ent); g_ent = NULL; g_n = g_cap = 0;
+  free(g_bucket); g_bucket = g_abucket = NULL; g_nbucket = 0;
+  g_running = 0;
+  pthread_rwlock_unlock(&g_lock);
+}
+
+int neigh_cache_snapshot(int family, neigh_entry_t **out) {
+  *out = NULL;
+  pthread_rwlock_rdlock(&g_lock);
+  if (!g_running) { pthread_rwlock_unlock(&g_lock); return -1; }
+  neigh_entry_t *v = malloc(sizeof(*v) * (size_t)(g_n ? g_n : 1));
+  if (!v) { pthread_rwlock_unlock(&g_lock); return -1; }
+  int c = 0;
+  for (int i = 0; i < g_n; i++)
+    if (!family || g_ent[i].e.family == family) v[c++] = g_ent[i].e;
+  pthread_rwlock_unlock(&g_lock);
+  *out = v;
+  return c;
+}
+
+/* /proc/net/arp: IP address, HW type, Flags, HW address, Mask, Device */
+int neigh_proc_arp(neigh_entry_t **out) {
+  *out = NULL;
+  FILE *f = fopen("/proc/net/arp", "r");
+  if (!f) return -1;
+  char line[256];
+  int n = 0, cap = 0;
+  neigh_entry_t *v = NULL;
+  if (!fgets(line, sizeof(line), f)) { fclose(f); return -1; }
+  while (fgets(line, sizeof(line), f)) {
+    char ip[46], hw[18], dev[16];
+    unsigned flags;
+    if (sscanf(line, "%45s %*s %x %17s %*s %15s", ip, &flags, hw, dev) != 4) continue;
+    if (n == cap) {
+      int nc = cap ? cap * 2 : 64;
+      neigh_entry_t *nv = realloc(v, sizeof(*v) * (size_t)nc);
+      if (!nv) break;
+      v = nv; cap = nc;
+    }
+    neigh_entry_t *e = &v[n];
+    memset(e, 0, sizeof(*e));
+    if (inet_pton(AF_INET, ip, e->addr) != 1) continue;
+    e->family = AF_INET;
+    e->ifindex = (int)if_nametoindex(dev);
+    /* ATF_PERM 0x04, ATF_COM 0x02; incomplete rows list 00:00:00:00:00:00 */
+    e->state = (flags & 0x04) ? NUD_PERMANENT : (flags & 0x02) ? NUD_REACHABLE : NUD_INCOMPLETE;
+    snprintf(e->ip, sizeof(e->ip), "%s", ip);
+    if (e->state != NUD_INCOMPLETE) snprintf(e->mac, sizeof(e->mac), "%s", hw);
+    snprintf(e->dev, sizeof(e->dev), "%s", dev);
+    n++;
+  }
+  fclose(f);
+  if (!v && !(v = malloc(sizeof(*v)))) return -1;
+  *out = v;
+  return n;
+}
+
+static int proc_arp_lookup(const char *ip, neigh_entry_t *out) {
+  neigh_entry_t *v = NULL;
+  int n = neigh_proc_arp(&v), found = 0;
+  for (int i = 0; i < n && !found; i++)
+    if (v[i].mac[0] && strcmp(v[i].ip, ip) == 0) { if (out) *out = v[i]; found = 1; }
+  free(v);
+  return found;
+}
+
+int neigh_cache_lookup(const char *ip, neigh_entry_t *out) {
+  unsigned char a[16] = {0};
+  int family = strchr(ip, ':') ? AF_INET6 : AF_INET;
+  if (inet_pton(family, ip, a) != 1) return 0;
+  int found = 0;
+  pthread_rwlock_rdlock(&g_lock);
+  if (!g_running) {
+    pthread_rwlock_unlock(&g_lock);
+    return family == AF_INET ? proc_arp_lookup(ip, out) : 0;
+  }
+  for (int i = g_nbucket ? g_abucket[key_hash(0, family, a) & (unsigned)(g_nbucket - 1)] : -1; i >= 0 && !found; i = g_ent[i].anext) {
+    const neigh_entry_t *e = &g_ent[i].e;
+    /* INCOMPLETE/FAILED entries carry no link-layer address and do not count */
+    if (e->family == family && memcmp(e->addr, a, 16) == 0 && e->mac[0] && e->state != NUD_NOARP) { if (out) *out = *e; found = 1; }
+  }
+  pthread_rwlock_unlock(&g_lock);
+  return found;
+}
+
+unsigned long neigh_cache_version(void) {
+  pthread_rwlock_rdlock(&g_lock);
+  unsigned long v = g_running ? g_stats.version : 0;
+  pthread_rwlock_unlock(&g_lock);
+  return v;
+}
+
+const char *neigh_state_name(unsigned state) {
+  switch (state) {
+    case NUD_INCOMPLETE: return "INCOMPLETE";
+    case NUD_REACHABLE: return "REACHABLE";
+    case NUD_STALE: return "STALE";
+    case NUD_DELAY: return "DELAY";
+    case NUD_PROBE: return "PROBE";
+    case NUD_FAILED: return "FAILED";
+    case NUD_NOARP: return "NOARP";
+    case NUD_PERMANENT: return "PERMANENT";
+    default: return "NONE";
+  }
+}
+
+void neigh_cache_get_stats(neigh_cache_stats_t *st) {
+  if (!st) return;
+  pthread_rwlock_rdlock(&g_lock);
+  *st = g_stats;
+  st->entries = g_n;
+  st->running = g_running;
+  pthread_rwlock_unlock(&g_lock);
+}
@@ -0,0 +1,51 @@
+#ifndef OLSRD_STATUS_NEIGH_CACHE_H
+#define OLSRD_STATUS_NEIGH_CACHE_H
+#include <stddef.h>
+#include <linux/neighbour.h>
+
+/* In-memory copy of the kernel neighbour (ARP/NDP) table and the bridge
+ * forwarding databases. A netlink thread dumps RTM_GETNEIGH once and then
+ * applies RTM_NEWNEIGH/RTM_DELNEIGH events (re-dumping if the socket
+ * overflows), so readers get a copy of the table without touching /proc or
+ * spawning `ip neigh`. Entries are keyed by (ifindex, family, address); the
+ * table grows as needed.
+ */
+typedef struct {
+  int ifindex;             /* AF_BRIDGE: the bridge port */
+  int family;              /* AF_INET, AF_INET6 or AF_BRIDGE (FDB entry) */
+  unsigned char addr[16];  /* AF_BRIDGE: MAC and VLAN */
+  unsigned short state;    /* NUD_*; NUD_PERMANENT marks the bridge's own addresses in the FDB */
+  unsigned short vlan;     /* AF_BRIDGE, 0 = none */
+  int master;              /* AF_BRIDGE: bridge ifindex */
+  char ip[46];             /* "" for FDB entries */
+  char mac[18];            /* "aa:bb:cc:dd:ee:ff", "" without a link-layer address */
+  char dev[16];
+} neigh_entry_t;
+
+typedef struct {
+  unsigned long events, dumps, overruns;
+  unsigned long version;   /* bumped on every change to the table */
+  int entries;
+  int running;
+} neigh_cache_stats_t;
+
+int neigh_cache_start(void);
+void neigh_cache_stop(void);
+/* Copy the entries of one family (0 = all) into a malloc'ed array the
+ * caller frees. Returns the count, or -1 when the table is not available.
+ */
+int neigh_cache_snapshot(int family, neigh_entry_t **out);
+/* The IPv4 table parsed from /proc/net/arp, for callers to fall back on when
+ * neigh_cache_snapshot() returns -1; same ownership and return convention.
+ */
+int neigh_proc_arp(neigh_entry_t **out);
+/* Find the entry for a literal address on any interface; 1 when found. Reads
+ * /proc/net/arp for IPv4 while the table is not running.
+ */
+int neigh_cache_lookup(const char *ip, neigh_entry_t *out);
+/* Table version, for callers caching something derived from it; 0 = not running. */
+unsigned long neigh_cache_version(void);
+/* "REACHABLE", "STALE", ... as printed by `ip neigh`. */
+const char *neigh_state_name(unsigned state);
+void neigh_cache_get_stats(neigh_cache_stats_t *st);
+#endif
@@ -0,0 +1,59 @@
+/* neigh_cache against the live kernel table: every IPv4 row /proc/net/arp
+ * shows with an address is found through the netlink copy, by snapshot and by
+ * lookup, and lookups fall back to /proc/net/arp once the cache is stopped.
+ * Run with `make test`.
+ */
+#include "neigh_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+static int g_fail;
+
+#define CHECK(cond, ...) do { if (!(cond)) { fprintf(stderr, __VA_ARGS__); fputc('\n', stderr); g_fail++; } } while (0)
+
+static int in_snapshot(const neigh_entry_t *v, int n, const neigh_entry_t *want) {
+  for (int i = 0; i < n; i++)
+    if (strcmp(v[i].ip, want->ip) == 0 && strcmp(v[i].mac, want->mac) == 0 && strcmp(v[i].dev, want->dev) == 0) return 1;
+  return 0;
+}
+
+int main(void) {
+  neigh_entry_t *arp = NULL, *v = NULL, e;
+  int na = neigh_proc_arp(&arp);
+  CHECK(na >= 0, "/proc/net/arp unreadable");
+  CHECK(neigh_cache_snapshot(AF_INET, &v) == -1 && !v, "snapshot before start should be unavailable");
+  CHECK(neigh_cache_lookup("not-an-ip", &e) == 0, "bad address should not be found");
+
+  if (neigh_cache_start() != 0) {
+    printf("neigh_cache_test: netlink unavailable, fallback only\n");
+  } else {
+    /* the first dump is asynchronous */
+    neigh_cache_stats_t st;
+    for (int i = 0; i < 200; i++) { neigh_cache_get_stats(&st); if (st.dumps && st.version) break; usleep(10000); }
+    CHECK(neigh_cache_version() != 0 || na == 0, "version did not move after the dump");
+    int n = neigh_cache_snapshot(AF_INET, &v);
+    CHECK(n >= 0, "snapshot failed");
+    for (int i = 0; i < na; i++) {
+      if (!arp[i].mac[0]) continue;
+      CHECK(in_snapshot(v, n, &arp[i]), "%s %s %s missing from the snapshot", arp[i].ip, arp[i].mac, arp[i].dev);
+      CHECK(neigh_cache_lookup(arp[i].ip, &e) == 1 && strcmp(e.mac, arp[i].mac) == 0, "lookup %s failed", arp[i].ip);
+    }
+    for (int i = 0; i < n; i++) CHECK(v[i].family == AF_INET && v[i].ip[0], "non-IPv4 row in AF_INET snapshot");
+    free(v); v = NULL;
+    CHECK(neigh_cache_lookup("203.0.113.254", &e) == 0, "unknown address found");
+    neigh_cache_stop();
+    CHECK(neigh_cache_version() == 0, "version should read 0 once stopped");
+  }
+
+  /* stopped: IPv4 lookups read /proc/net/arp */
+  for (int i = 0; i < na; i++)
+    if (arp[i].mac[0]) CHECK(neigh_cache_lookup(arp[i].ip, &e) == 1 && strcmp(e.dev, arp[i].dev) == 0, "fallback lookup %s failed", arp[i].ip);
+  CHECK(neigh_cache_lookup("::1", &e) == 0, "IPv6 has no fallback");
+  free(arp);
+  if (g_fail) { fprintf(stderr, "neigh_cache_test: %d failure(s)\n", g_fail); return 1; }
+  printf("neigh_cache_test: ok (%d ARP rows)\n", na);
+  return 0;
+}
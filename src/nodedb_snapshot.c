@@ -0,0 +1,239 @@
+#include "nodedb_snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* File layout (native byte order, the magic doubles as an endianness check):
+ *   struct snap_hdr | struct snap_entry[count] | char pool[pool_len]
+ * Entries are sorted by prefix length (longest first), then by network, so a
+ * lookup is one binary search per distinct prefix length.
+ */
+#define NODEDB_SNAP_MAGIC   0x42444e4fu /* "ONDB" */
+#define NODEDB_SNAP_VERSION 1
+
+struct snap_hdr {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t hdr_size;
+  uint32_t count;
+  uint32_t pool_len;
+  uint64_t hash;     /* FNV-1a over entries + pool; checksum and change detector */
+  int64_t  created;
+};
+
+struct snap_entry {
+  uint32_t net;
+  uint32_t name_off;
+  uint16_t name_len;
+  uint8_t  plen;
+  uint8_t  pad;
+};
+
+struct nodedb_index {
+  unsigned char *base;
+  size_t size;
+  int mapped;
+  const struct snap_hdr *hdr;
+  const struct snap_entry *ent;
+  const char *pool;
+  uint32_t grp[34]; /* grp[32-plen] .. grp[32-plen+1] spans entries with that plen */
+};
+
+static uint64_t fnv1a64(const void *p, size_t n, uint64_t h) {
+  const unsigned char *s = p;
+  for (size_t i = 0; i < n; i++) h = (h ^ s[i]) * UINT64_C(1099511628211);
+  return h;
+}
+
+static uint32_t plen_mask(int plen) {
+  return plen <= 0 ? 0 : (plen >= 32 ? 0xFFFFFFFFu : ~((1u << (32 - plen)) - 1u));
+}
+
+static void index_set_views(nodedb_index_t *ix) {
+  ix->hdr = (const struct snap_hdr *)(const void *)ix->base;
+  ix->ent = (const struct snap_entry *)(const void *)(ix->base + sizeof(struct snap_hdr));
+  ix->pool = (const char *)(ix->base + sizeof(struct snap_hdr) + (size_t)ix->hdr->count * sizeof(struct snap_entry));
+  uint32_t i = 0;
+  for (int g = 0; g <= 32; g++) {
+    ix->grp[g] = i;
+    while (i < ix->hdr->count && ix->ent[i].plen == 32 - g) i++;
+  }
+  ix->grp[33] = i;
+}
+
+struct build_ent { uint32_t net; int plen; size_t seq; const char *name; size_t name_len; };
+
+static int build_ent_cmp(const void *a, const void *b) {
+  const struct build_ent *x = a, *y = b;
+  if (x->plen != y->plen) return y->plen - x->plen;
+  if (x->net != y->net) return x->net < y->net ? -1 : 1;
+  return (x->seq > y->seq) - (x->seq < y->seq);
+}
+
+nodedb_index_t *nodedb_index_build(const struct nodedb_prefix *v, size_t n) {
+  struct build_ent *b = calloc(n ? n : 1, sizeof(*b));
+  if (!b) return NULL;
+  for (size_t i = 0; i < n; i++) {
+    int plen = v[i].plen < 0 ? 0 : (v[i].plen > 32 ? 32 : v[i].plen);
+    b[i].plen = plen; b[i].net = v[i].net & plen_mask(plen); b[i].seq = i;
+    b[i].name = v[i].name; b[i].name_len = v[i].name_len > 0xFFFF ? 0xFFFF : v[i].name_len;
+  }
+  qsort(b, n, sizeof(*b), build_ent_cmp);
+  /* drop duplicates, keeping the last occurrence (matches JSON object semantics) */
+  size_t m = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (m && b[m-1].plen == b[i].plen && b[m-1].net == b[i].net) b[m-1] = b[i];
+    else b[m++] = b[i];
+  }
+  /* string pool with de-duplication: many prefixes share a node name */
+  size_t pool_cap = 4096, pool_len = 0;
+  char *pool = malloc(pool_cap);
+  size_t hcap = 64; while (hcap < m * 2) hcap <<= 1;
+  uint32_t *slots = calloc(hcap, sizeof(*slots)); /* stores offset+1 into name_refs */
+  struct snap_entry *ents = calloc(m ? m : 1, sizeof(*ents));
+  struct { uint32_t off; uint16_t len; } *refs = calloc(m ? m : 1, sizeof(*refs));
+  size_t nrefs = 0;
+  if (!pool || !slots || !ents || !refs) { free(b); free(pool); free(slots); free(ents); free(refs); return NULL; }
+  for (size_t i = 0; i < m; i++) {
+    uint64_t h = fnv1a64(b[i].name, b[i].name_len, UINT64_C(1469598103934665603));
+    size_t s = (size_t)h & (hcap - 1);
+    uint32_t off = 0; int found = 0;
+    while (slots[s]) {
+      size_t r = slots[s] - 1;
+      if (refs[r].len == b[i].name_len && memcmp(pool + refs[r].off, b[i].name, b[i].name_len) == 0) { off = refs[r].off; found = 1; break; }
+      s = (s + 1) & (hcap - 1);
+    }
+    if (!found) {
+      if (pool_len + b[i].name_len > pool_cap) {
+        while (pool_len + b[i].name_len > pool_cap) pool_cap *= 2;
+        char *np = realloc(pool, pool_cap);
+        if (!np) { free(b); free(pool); free(slots); free(ents); free(refs); return NULL; }
+        pool = np;
+      }
+      off = (uint32_t)pool_len;
+      memcpy(pool + pool_len, b[i].name, b[i].name_len); pool_len += b[i].name_len;
+      refs[nrefs].off = off; refs[nrefs].len = (uint16_t)b[i].name_len; nrefs++;
+      slots[s] = (uint32_t)nrefs;
+    }
+    ents[i].net = b[i].net; ents[i].plen = (uint8_t)b[i].plen;
+    ents[i].name_off = off; ents[i].name_len = (uint16_t)b[i].name_len;
+  }
+  free(b); free(slots); free(refs);
+
+  size_t esz = m * sizeof(struct snap_entry);
+  size_t total = sizeof(struct snap_hdr) + esz + pool_len;
+  nodedb_index_t *ix = calloc(1, sizeof(*ix));
+  unsigned char *base = malloc(total);
+  if (!ix || !base) { free(ix); free(base); free(ents); free(pool); return NULL; }
+  struct snap_hdr hdr; memset(&hdr, 0, sizeof(hdr));
+  hdr.magic = NODEDB_SNAP_MAGIC; hdr.version = NODEDB_SNAP_VERSION; hdr.hdr_size = (uint16_t)sizeof(hdr);
+  hdr.count = (uint32_t)m; hdr.pool_len = (uint32_t)pool_len; hdr.created = (int64_t)time(NULL);
+  memcpy(base + sizeof(hdr), ents, esz);
+  memcpy(base + sizeof(hdr) + esz, pool, pool_len);
+  hdr.hash = fnv1a64(base + sizeof(hdr), esz + pool_len, UINT64_C(1469598103934665603));
+  memcpy(base, &hdr, sizeof(hdr));
+  free(ents); free(pool);
+  ix->base = base; ix->size = total; ix->mapped = 0;
+  index_set_views(ix);
+  return ix;
+}
+
+nodedb_index_t *nodedb_index_load(const char *path) {
+  if (!path || !path[0]) return NULL;
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return NULL;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(struct snap_hdr)) { close(fd); return NULL; }
+  /* names from here end up in every page: only trust a file nobody else could have written */
+  if (!S_ISREG(st.st_mode) || (st.st_uid != 0 && st.st_uid != geteuid()) || (st.st_mode & (S_IWGRP | S_IWOTH))) { close(fd); return NULL; }
+  size_t size = (size_t)st.st_size;
+  void *m = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (m == MAP_FAILED) return NULL;
+  const struct snap_hdr *h = m;
+  /* bound count and pool_len by the file first so the sum cannot wrap a 32-bit size_t */
+  size_t body = size - sizeof(*h);
+  int ok = h->magic == NODEDB_SNAP_MAGIC && h->version == NODEDB_SNAP_VERSION && h->hdr_size == sizeof(struct snap_hdr) &&
+           h->count <= body / sizeof(struct snap_entry) && h->pool_len == body - (size_t)h->count * sizeof(struct snap_entry);
+  if (ok) ok = fnv1a64((const unsigned char *)m + sizeof(*h), size - sizeof(*h), UINT64_C(1469598103934665603)) == h->hash;
+  if (ok) {
+    const struct snap_entry *e = (const struct snap_entry *)(const void *)((const unsigned char *)m + sizeof(*h));
+    for (uint32_t i = 0; ok && i < h->count; i++) {
+      if (e[i].plen > 32 || (uint64_t)e[i].name_off + e[i].name_len > h->pool_len) ok = 0;
+      if (i && (e[i].plen > e[i-1].plen || (e[i].plen == e[i-1].plen && e[i].net <= e[i-1].net))) ok = 0;
+    }
+  }
+  nodedb_index_t *ix = ok ? calloc(1, sizeof(*ix)) : NULL;
+  if (!ix) { munmap(m, size); return NULL; }
+  ix->base = m; ix->size = size; ix->mapped = 1;
+  index_set_views(ix);
+  return ix;
+}
+
+int nodedb_index_save(const nodedb_index_t *ix, const char *path) {
+  if (!ix || !path || !path[0]) return -1;
+  /* skip the write (and the flash wear) when the file already has this content */
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd >= 0) {
+    struct snap_hdr cur;
+    ssize_t n = read(fd, &cur, sizeof(cur));
+    close(fd);
+    if (n == (ssize_t)sizeof(cur) && cur.magic == NODEDB_SNAP_MAGIC && cur.version == NODEDB_SNAP_VERSION &&
+        cur.hash == ix->hdr->hash && cur.count == ix->hdr->count && cur.pool_len == ix->hdr->pool_len) return 0;
+  }
+  char tmp[1024];
+  if ((size_t)snprintf(tmp, sizeof(tmp), "%s.tmp.%ld", path, (long)getpid()) >= sizeof(tmp)) return -1;
+  /* the default lives in its own directory, created on first save */
+  char *slash = strrchr(tmp, '/');
+  if (slash && slash != tmp) {
+    *slash = '\0';
+    if (mkdir(tmp, 0755) != 0 && errno != EEXIST) return -1;
+    *slash = '/';
+  }
+  fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) return -1;
+  size_t off = 0;
+  while (off < ix->size) {
+    ssize_t w = write(fd, ix->base + off, ix->size - off);
+    if (w <= 0) { close(fd); unlink(tmp); return -1; }
+    off += (size_t)w;
+  }
+  if (fsync(fd) != 0 || close(fd) != 0) { unlink(tmp); return -1; }
+  if (rename(tmp, path) != 0) { unlink(tmp); return -1; }
+  return 1;
+}
+
+void nodedb_index_free(nodedb_index_t *ix) {
+  if (!ix) return;
+  if (ix->mapped) munmap(ix->base, ix->size); else free(ix->base);
+  free(ix);
+}
+
+int nodedb_index_lookup(const nodedb_index_t *ix, uint32_t ip, char *out, size_t outlen) {
+  if (!ix || !out || outlen == 0) return 0;
+  out[0] = '\0';
+  for (int g = 0; g <= 32; g++) {
+    uint32_t lo = ix->grp[g], hi = ix->grp[g+1];
+    if (lo == hi) continue;
+    uint32_t key = ip & plen_mask(32 - g);
+    while (lo < hi) {
+      uint32_t mid = lo + (hi - lo) / 2;
+      if (ix->ent[mid].net < key) lo = mid + 1; else hi = mid;
+    }
+    if (lo < ix->grp[g+1] && ix->ent[lo].net == key) {
+      size_t L = ix->ent[lo].name_len; if (L >= outlen) L = outlen - 1;
+      memcpy(out, ix->pool + ix->ent[lo].name_off, L); out[L] = '\0';
+      return 1;
+    }
+  }
+  return 0;
+}
+
+size_t nodedb_index_count(const nodedb_index_t *ix) { return ix ? ix->hdr->count : 0; }
+uint64_t nodedb_index_hash(const nodedb_index_t *ix) { return ix ? ix->hdr->hash : 0; }
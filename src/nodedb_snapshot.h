@@ -0,0 +1,36 @@
+#ifndef OLSRD_STATUS_NODEDB_SNAPSHOT_H
+#define OLSRD_STATUS_NODEDB_SNAPSHOT_H
+#include <stddef.h>
+#include <stdint.h>
+
+/* Compact node_db name index: a flat IPv4 prefix table plus a string pool.
+ * The in-memory layout is byte-identical to the on-disk snapshot so a saved
+ * file can be mmap'ed and used directly at startup.
+ */
+typedef struct nodedb_index nodedb_index_t;
+
+/* One prefix -> name mapping used to build an index. name is not NUL-terminated. */
+struct nodedb_prefix {
+  uint32_t net;       /* host byte order */
+  int plen;           /* 0..32 */
+  const char *name;
+  size_t name_len;
+};
+
+/* Build an index from prefixes (duplicates: the last one wins). Returns NULL on OOM. */
+nodedb_index_t *nodedb_index_build(const struct nodedb_prefix *v, size_t n);
+/* Map a snapshot file read-only; returns NULL if missing, truncated, corrupt,
+ * or writable by anyone but root and the current user.
+ */
+nodedb_index_t *nodedb_index_load(const char *path);
+/* Write atomically (temp file + rename) unless the file already holds the same
+ * content hash; the parent directory is created if missing. Returns 1 when
+ * written, 0 when skipped as unchanged, -1 on error.
+ */
+int nodedb_index_save(const nodedb_index_t *ix, const char *path);
+void nodedb_index_free(nodedb_index_t *ix);
+/* Longest-prefix lookup for an IPv4 address in host byte order. Returns 1 if found. */
+int nodedb_index_lookup(const nodedb_index_t *ix, uint32_t ip, char *out, size_t outlen);
+size_t nodedb_index_count(const nodedb_index_t *ix);
+uint64_t nodedb_index_hash(const nodedb_index_t *ix);
+#endif
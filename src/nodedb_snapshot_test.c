@@ -0,0 +1,107 @@
+/* nodedb_snapshot: longest-prefix lookups, a save/load round trip, and
+ * snapshot files that must be refused (bad magic, flipped bytes, counts that
+ * do not fit the file, group/world-writable). Run with `make test`.
+ */
+#include "nodedb_snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static int g_fail;
+
+#define CHECK(cond, ...) do { if (!(cond)) { fprintf(stderr, __VA_ARGS__); fputc('\n', stderr); g_fail++; } } while (0)
+
+#define IP(a, b, c, d) ((uint32_t)(a) << 24 | (uint32_t)(b) << 16 | (uint32_t)(c) << 8 | (uint32_t)(d))
+
+static const char *name_of(const nodedb_index_t *ix, uint32_t ip) {
+  static char out[64];
+  return nodedb_index_lookup(ix, ip, out, sizeof(out)) ? out : "-";
+}
+
+static void check_lookups(const nodedb_index_t *ix, const char *what) {
+  CHECK(strcmp(name_of(ix, IP(10, 1, 2, 3)), "host") == 0, "%s: /32 got %s", what, name_of(ix, IP(10, 1, 2, 3)));
+  CHECK(strcmp(name_of(ix, IP(10, 1, 2, 4)), "net24") == 0, "%s: /24 got %s", what, name_of(ix, IP(10, 1, 2, 4)));
+  CHECK(strcmp(name_of(ix, IP(10, 1, 9, 9)), "net16") == 0, "%s: /16 got %s", what, name_of(ix, IP(10, 1, 9, 9)));
+  CHECK(strcmp(name_of(ix, IP(10, 2, 0, 1)), "-") == 0, "%s: miss got %s", what, name_of(ix, IP(10, 2, 0, 1)));
+  CHECK(strcmp(name_of(ix, IP(172, 16, 0, 1)), "dup-last") == 0, "%s: duplicate got %s", what, name_of(ix, IP(172, 16, 0, 1)));
+}
+
+static int write_file(const char *path, const void *p, size_t n, mode_t mode) {
+  unlink(path);
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, mode);
+  if (fd < 0) return -1;
+  ssize_t w = write(fd, p, n);
+  close(fd);
+  chmod(path, mode);
+  return w == (ssize_t)n ? 0 : -1;
+}
+
+static unsigned char *read_file(const char *path, size_t *n) {
+  FILE *f = fopen(path, "rb");
+  if (!f) return NULL;
+  unsigned char *buf = malloc(1 << 16);
+  *n = buf ? fread(buf, 1, 1 << 16, f) : 0;
+  fclose(f);
+  return buf;
+}
+
+int main(void) {
+  const struct nodedb_prefix v[] = {
+    { IP(10, 1, 0, 0), 16, "net16", 5 },
+    { IP(10, 1, 2, 0), 24, "net24", 5 },
+    { IP(10, 1, 2, 3), 32, "host", 4 },
+    { IP(172, 16, 0, 0), 12, "dup-first", 9 },
+    { IP(172, 16, 0, 0), 12, "dup-last", 8 },
+  };
+  nodedb_index_t *ix = nodedb_index_build(v, sizeof(v) / sizeof(v[0]));
+  CHECK(ix && nodedb_index_count(ix) == 4, "build: want 4 prefixes, got %zu", nodedb_index_count(ix));
+  check_lookups(ix, "built");
+
+  char dir[] = "/tmp/nodedb_test_XXXXXX";
+  CHECK(mkdtemp(dir) != NULL, "mkdtemp failed");
+  char path[256];
+  snprintf(path, sizeof(path), "%s/sub/nodedb.bin", dir);
+  CHECK(nodedb_index_save(ix, path) == 1, "save into a missing directory failed");
+  CHECK(nodedb_index_save(ix, path) == 0, "unchanged save should be skipped");
+  nodedb_index_t *ld = nodedb_index_load(path);
+  CHECK(ld && nodedb_index_hash(ld) == nodedb_index_hash(ix), "round trip: load failed or hash differs");
+  if (ld) check_lookups(ld, "loaded");
+  nodedb_index_free(ld);
+
+  size_t n = 0;
+  unsigned char *good = read_file(path, &n), *bad = malloc(n ? n : 1);
+  char badpath[256];
+  snprintf(badpath, sizeof(badpath), "%s/bad.bin", dir);
+  if (good && bad && n > 32) {
+    /* header: magic u32, version u16, hdr_size u16, count u32, pool_len u32, hash u64, created i64 */
+    memcpy(bad, good, n); bad[0] ^= 0xFF;
+    CHECK(write_file(badpath, bad, n, 0644) == 0 && !nodedb_index_load(badpath), "bad magic accepted");
+    memcpy(bad, good, n); bad[n - 1] ^= 0x20;
+    CHECK(write_file(badpath, bad, n, 0644) == 0 && !nodedb_index_load(badpath), "checksum mismatch accepted");
+    memcpy(bad, good, n);
+    uint32_t huge = 0x15555556u;   /* count * 12 wraps to 8 in 32 bits */
+    memcpy(bad + 8, &huge, 4);
+    CHECK(write_file(badpath, bad, n, 0644) == 0 && !nodedb_index_load(badpath), "count past the file accepted");
+    memcpy(bad, good, n);
+    CHECK(write_file(badpath, bad, n - 1, 0644) == 0 && !nodedb_index_load(badpath), "truncated file accepted");
+    CHECK(write_file(badpath, good, n, 0666) == 0 && !nodedb_index_load(badpath), "world-writable file accepted");
+    CHECK(write_file(badpath, good, n, 0644) == 0, "write failed");
+    nodedb_index_t *ok = nodedb_index_load(badpath);
+    CHECK(ok != NULL, "intact copy refused");
+    nodedb_index_free(ok);
+  } else {
+    CHECK(0, "could not read back %s", path);
+  }
+  CHECK(!nodedb_index_load("/nonexistent/nodedb.bin") && !nodedb_index_load(""), "missing file accepted");
+  free(good); free(bad);
+  unlink(badpath); unlink(path);
+  snprintf(badpath, sizeof(badpath), "%s/sub", dir);
+  rmdir(badpath); rmdir(dir);
+  nodedb_index_free(ix);
+  if (g_fail) { fprintf(stderr, "nodedb_snapshot_test: %d failure(s)\n", g_fail); return 1; }
+  printf("nodedb_snapshot_test: ok\n");
+  return 0;
+}
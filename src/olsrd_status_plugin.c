@@ -5,6 +5,7 @@
 #include "status_log.h"
 #include <stddef.h>
 #include <ctype.h>
+#include <math.h>
 #include <stdint.h>
 #include <dirent.h>
 #include <sys/stat.h>
@@ -23,6 +24,12 @@
 #include <sys/select.h>
 #include <pthread.h>
 #include <signal.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <glob.h>
 #if defined(__APPLE__) || defined(__linux__)
 #ifdef __GLIBC__
 #include <execinfo.h>
@@ -38,6 +45,22 @@
 
 #include "httpd.h"
 #include "util.h"
+#include "nodedb_snapshot.h"
+#include "dns_async.h"
+#include "lru_cache.h"
+#include "procscan.h"
+#include "exec.h"
+#include "traceroute.h"
+#include "trace_monitor.h"
+#include "neigh_cache.h"
+#include "traffic.h"
+#include "lq_history.h"
+#include "binjson.h"
+#include "fork_join.h"
+#include "payload.h"
+#include "arena.h"
+#include "json_writer.h"
+#include "json_scan.h"
 #include "olsrd_plugin.h"
 #include "ubnt_discover.h"
 
@@ -52,18 +75,127 @@
 
 #include <stdarg.h>
 
-/* Thread-safe IP -> hostname resolver using getnameinfo */
-static int resolve_ip_to_hostname(const char *ip, char *out, size_t outlen) {
-  if (!ip || !out || outlen == 0) return -1;
+/* Async PTR resolver: PlParam dns_async (default on) / dns_servers, env
+ * OLSRD_STATUS_DNS_ASYNC / OLSRD_STATUS_DNS_SERVERS when no PlParam is given.
+ */
+static int  g_dns_async = 1;
+static char g_dns_servers[512] = "";
+static int  g_cfg_dns_async_set = 0;
+static int  g_cfg_dns_servers_set = 0;
+
+/* Pre-forked spawn helper for external commands: PlParam exec_helper (default
+ * off) or env OLSRD_STATUS_EXEC_HELPER when no PlParam is given.
+ */
+static int  g_exec_helper = 0;
+static int  g_cfg_exec_helper_set = 0;
+/* traceroute probes hop by hop; past this the partial path is reported */
+#define TRACEROUTE_DEADLINE_MS 20000
+/* the in-process tracer probes all hops at once and shares one deadline */
+#define NATIVE_TRACE_TIMEOUT_MS 3000
+/* Background uplink traceroute: PlParams uplink_trace_interval (seconds, 0 =
+ * trace on request as before) and uplink_trace_history (samples kept), or env
+ * OLSRD_STATUS_UPLINK_TRACE_INTERVAL / OLSRD_STATUS_UPLINK_TRACE_HISTORY.
+ */
+static int  g_uplink_trace_interval = 60;
+static int  g_uplink_trace_history = 32;
+static int  g_cfg_uplink_trace_interval_set = 0, g_cfg_uplink_trace_history_set = 0;
+/* Interface traffic sampler period in seconds (PlParam traffic_interval, env
+ * OLSRD_STATUS_TRAFFIC_INTERVAL) behind /traffic.json; 0 turns it off.
+ */
+static int  g_traffic_interval = 1;
+static int  g_cfg_traffic_interval_set = 0;
+/* Per-neighbour link quality history (PlParams lq_history_interval, _path,
+ * _flush; env OLSRD_STATUS_LQ_HISTORY_*). Interval 0 disables it; an empty
+ * path keeps the history in memory only.
+ */
+static int  g_lq_history_interval = 30;
+static int  g_lq_history_flush = 3600;
+static char g_lq_history_path[512] = "";
+static int  g_cfg_lq_history_interval_set = 0, g_cfg_lq_history_flush_set = 0, g_cfg_lq_history_path_set = 0;
+/* Reuse /status section fragments within their TTL (PlParam
+ * status_section_cache, env OLSRD_STATUS_SECTION_CACHE; 0 = always compute).
+ */
+static int  g_status_section_cache = 1;
+static int  g_cfg_status_section_cache_set = 0;
+/* Stale /status sections are computed concurrently on status_workers threads
+ * (0 = sequentially on the request thread); sections still running after
+ * status_deadline_ms are served from their previous fragment and listed in
+ * "stale_sections". Env OLSRD_STATUS_WORKERS / OLSRD_STATUS_DEADLINE_MS.
+ */
+static int  g_status_workers = 4;
+static int  g_status_deadline_ms = 1500;
+static int  g_cfg_status_workers_set = 0, g_cfg_status_deadline_ms_set = 0;
+
+/* Hostname cache (IP -> name) shared by reverse DNS and node_db fallbacks.
+ * Sizes/TTLs: PlParams host_cache_size, host_cache_ttl, host_cache_negative_ttl,
+ * host_cache_stale_ttl or the matching OLSRD_STATUS_HOST_CACHE_* env vars.
+ */
+static lru_cache_t *g_host_cache = NULL;
+static int g_host_cache_size = 2048;
+static int g_host_cache_ttl = 300;
+static int g_host_cache_negative_ttl = 60;
+static int g_host_cache_stale_ttl = 600;
+static int g_cfg_host_cache_size_set = 0, g_cfg_host_cache_ttl_set = 0;
+static int g_cfg_host_cache_negative_ttl_set = 0, g_cfg_host_cache_stale_ttl_set = 0;
+/* node_db names by IP for lookup_hostname_cached, apart from g_host_cache so
+ * they are never served (or refreshed) as reverse DNS; same size and TTLs.
+ */
+static lru_cache_t *g_nodedb_name_cache = NULL;
+
+/* OLSRd JSON proxy cache (/olsrd.json?q=...): small LRU, full-size values. */
+static lru_cache_t *g_olsr_cache = NULL;
+#define OLSR_CACHE_TTL 60
+
+
+static int resolve_ip_blocking(const char *ip, char *out, size_t outlen) {
   struct sockaddr_in sa; memset(&sa, 0, sizeof(sa)); sa.sin_family = AF_INET;
   if (inet_pton(AF_INET, ip, &sa.sin_addr) != 1) return -1;
   char host[NI_MAXHOST]; host[0] = '\0';
-  int rc = getnameinfo((struct sockaddr*)&sa, sizeof(sa), host, sizeof(host), NULL, 0, 0);
-  if (rc != 0) return -1;
+  int rc = getnameinfo((struct sockaddr*)&sa, sizeof(sa), host, sizeof(host), NULL, 0, NI_NAMEREQD);
+  if (rc != 0) { lru_cache_put_negative(g_host_cache, ip); return -1; }
+  lru_cache_put(g_host_cache, ip, host, strlen(host), 0);
   snprintf(out, outlen, "%s", host);
   return 0;
 }
 
+/* IP -> hostname. With the async resolver running this never blocks: it answers
+ * from the hostname cache or queues a PTR query and fails so the caller shows
+ * the IP until the name arrives. Otherwise falls back to blocking getnameinfo.
+ * Stale names are served while one caller refreshes them.
+ */
+static int resolve_ip_to_hostname(const char *ip, char *out, size_t outlen) {
+  if (!ip || !out || outlen == 0) return -1;
+  int revalidate = 0;
+  int st = lru_cache_get(g_host_cache, ip, out, outlen, &revalidate);
+  if (st == LRU_HIT) return 0;
+  if (st == LRU_NEGATIVE) { out[0] = '\0'; return -1; }
+  if (st == LRU_STALE) {
+    if (revalidate) {
+      if (dns_async_running()) { if (dns_async_submit(ip) != 1) lru_cache_refresh_failed(g_host_cache, ip); }
+      else { char fresh[NI_MAXHOST]; if (resolve_ip_blocking(ip, fresh, sizeof(fresh)) == 0) snprintf(out, outlen, "%s", fresh); }
+    }
+    return 0;
+  }
+  if (dns_async_running()) { dns_async_submit(ip); return -1; }
+  return resolve_ip_blocking(ip, out, outlen);
+}
+
+/* Cache-only variant for per-hop names: never blocks, a miss is queued for the
+ * async resolver (when running) and shows up on a later request.
+ */
+static int resolve_ip_cached(const char *ip, char *out, size_t outlen) {
+  if (!ip || !ip[0] || !out || outlen == 0) return -1;
+  int revalidate = 0;
+  int st = lru_cache_get(g_host_cache, ip, out, outlen, &revalidate);
+  if (st == LRU_HIT || st == LRU_STALE) {
+    if (revalidate && (!dns_async_running() || dns_async_submit(ip) != 1)) lru_cache_refresh_failed(g_host_cache, ip);
+    return 0;
+  }
+  out[0] = '\0';
+  if (st == LRU_MISS && dns_async_running()) dns_async_submit(ip);
+  return -1;
+}
+
 /* Runtime check for UBNT debug env var. Prefer environment toggle so operators
  * can enable verbose UBNT discovery traces without recompiling. Returns 1 when
  * OLSRD_STATUS_UBNT_DEBUG is truthy (1,y,Y), otherwise 0.
@@ -108,8 +240,10 @@ static int g_cfg_fetch_backoff_set = 0;
 static char   g_nodedb_url[512] = "https://ff.cybercomm.at/node_db.json"; /* override via plugin param nodedb_url */
 static int    g_nodedb_ttl = 300; /* seconds */
 static time_t g_nodedb_last_fetch = 0; /* epoch of last successful fetch */
-static char  *g_nodedb_cached = NULL; /* malloc'ed JSON blob */
-static size_t g_nodedb_cached_len = 0;
+/* Current node_db blob (guarded by g_nodedb_lock). Replaced, never modified:
+ * readers that write it out take a reference and drop the lock first.
+ */
+static payload_t *g_nodedb = NULL;
 static pthread_mutex_t g_nodedb_lock = PTHREAD_MUTEX_INITIALIZER;
 static int g_nodedb_worker_running = 0;
 /* Serialize/coordinate concurrent fetches so multiple callers don't race or
@@ -122,6 +256,32 @@ static int g_nodedb_fetch_in_progress = 0;
 /* If set to 1, write a copy of the node_db to disk (disabled by default to protect flash) */
 static int g_nodedb_write_disk = 0;
 
+/* HTTP validators from the last full nodedb response (guarded by g_nodedb_lock).
+ * Sent back as If-None-Match/If-Modified-Since so unchanged data costs a 304.
+ */
+static char g_nodedb_etag[128] = "";
+static char g_nodedb_last_modified[64] = "";
+/* Conditional fetch accounting (guarded by g_nodedb_lock) */
+static unsigned long g_nodedb_fetch_requests = 0;     /* completed HTTP exchanges */
+static unsigned long g_nodedb_fetch_full = 0;         /* 200 responses with a body */
+static unsigned long g_nodedb_fetch_not_modified = 0; /* 304 responses */
+static unsigned long g_nodedb_fetch_unchanged = 0;    /* 200 but byte-identical to cache */
+static unsigned long long g_nodedb_fetch_bytes = 0;   /* bytes transferred (headers + body) */
+/* per-entry diff of the last accepted update against the previous copy */
+static unsigned long g_nodedb_diff_added = 0;
+static unsigned long g_nodedb_diff_removed = 0;
+static unsigned long g_nodedb_diff_changed = 0;
+static unsigned long g_nodedb_diff_bytes = 0;         /* serialized size of added+changed values */
+static unsigned long g_nodedb_entries = 0;
+
+/* Prefix -> name index derived from the node_db (guarded by g_nodedb_lock).
+ * Persisted as a binary snapshot so names are available right after startup,
+ * before the first network fetch completes. Empty path disables persistence.
+ */
+static nodedb_index_t *g_nodedb_index = NULL;
+static char g_nodedb_snapshot_path[512] = "/var/lib/olsrd-status/nodedb.bin";
+static int g_cfg_nodedb_snapshot_set = 0;
+
 /* Configurable startup wait (seconds) for initial DNS/network readiness. */
 static int g_nodedb_startup_wait = 30;
 
@@ -292,9 +452,9 @@ static char *filter_devices_array(const char *in, int lite, int drop_empty, size
   out[len++]=']'; out[len]='\0'; if (out_len) *out_len = len; return out;
 }
 /* ARP JSON cache */
-static char *g_arp_cache = NULL;          /* malloc'ed JSON array string */
-static size_t g_arp_cache_len = 0;        /* strlen(g_arp_cache) */
+static payload_t *g_arp_cache = NULL;     /* JSON array */
 static time_t g_arp_cache_ts = 0;         /* last build timestamp */
+static unsigned long g_arp_cache_ver = 0; /* neigh_cache_version() the JSON was built from */
 static int g_arp_cache_ttl_s = 5;         /* default small TTL; configurable later */
 static pthread_mutex_t g_arp_cache_lock = PTHREAD_MUTEX_INITIALIZER;
 /* debug toggle: when set, emit extra per-request debug lines for specific endpoints (env/plugin param) */
@@ -372,102 +532,126 @@ static int g_fetch_worker_running = 0;
 static int g_fetch_wait_timeout = 30;
 
 /* --- endpoint coalescing helper ---
- * Simple per-endpoint serializer that optionally caches the last payload for a short TTL.
- * It allows multiple concurrent HTTP requests for the same endpoint to avoid duplicating
- * expensive work (external commands, broadcasts). Concurrent callers either get a
- * recent cached response or wait for the in-flight worker to finish and then use its result.
+ * One refresh at a time per endpoint; the last good payload is kept as an
+ * immutable refcounted buffer. Within its TTL every caller gets a reference
+ * to it. Once it expired the first caller answers with it, ends the response
+ * and rebuilds it (stale-while-revalidate); the others keep getting the old
+ * one until the new one is published. Only a cold (or too stale) endpoint
+ * makes callers wait for the one building it, and at most wait_ms, after
+ * which they build their own. key tells apart bodies of one endpoint that
+ * depend on the request (target, fields); a different key is a miss.
  */
 typedef struct {
   pthread_mutex_t m;
   pthread_cond_t cv;
   int busy;
-  char *cached;
-  size_t cached_len;
+  payload_t *cached;
+  char key[192];
   time_t ts;
   int ttl;
+  unsigned long hits, stale, waits, timeouts, builds;
 } endpoint_coalesce_t;
 
+/* begin() outcomes: serve *out; serve *out, then rebuild and finish();
+ * build and finish(); build without owning the refresh (wait timed out).
+ */
+enum { CO_HIT, CO_REVALIDATE, CO_BUILD, CO_BUILD_ALONE };
+
+/* first-fill wait and how old a payload may get before it is no longer served */
+static int g_coalesce_wait_ms = 3000;
+static int g_coalesce_max_stale = 60;
+
 static void endpoint_coalesce_init(endpoint_coalesce_t *e, int ttl) {
   if (!e) return;
+  memset(e, 0, sizeof(*e));
   pthread_mutex_init(&e->m, NULL);
   pthread_cond_init(&e->cv, NULL);
-  e->busy = 0;
-  e->cached = NULL;
-  e->cached_len = 0;
-  e->ts = 0;
   e->ttl = ttl;
 }
 
-/* Try to start work: if returns 1 and *out != NULL => caller should immediately return cached payload (caller owns *out)
- * If returns 0 => caller should perform the heavy work and later call endpoint_coalesce_finish().
- */
-static int endpoint_coalesce_try_start(endpoint_coalesce_t *e, char **out, size_t *outlen) {
-  if (!e || !out) return 0;
-  time_t now = time(NULL);
+static int endpoint_coalesce_begin(endpoint_coalesce_t *e, const char *key, payload_t **out) {
+  *out = NULL;
+  if (!key) key = "";
   pthread_mutex_lock(&e->m);
-  if (e->cached && e->cached_len > 0 && (now - e->ts) <= e->ttl) {
-    *out = malloc(e->cached_len + 1);
-    if (*out) {
-      memcpy(*out, e->cached, e->cached_len + 1);
-      if (outlen) *outlen = e->cached_len;
-      pthread_mutex_unlock(&e->m);
-      return 1;
-    }
-  }
-
-  /* ARP fallback opt-in via env (0=off,1=on) */
-  /* ARP fallback opt-in via env is now parsed at plugin init to emit a concise startup message. */
-  if (e->busy) {
-    while (e->busy) pthread_cond_wait(&e->cv, &e->m);
-    if (e->cached && e->cached_len > 0 && (time(NULL) - e->ts) <= e->ttl) {
-      *out = malloc(e->cached_len + 1);
-      if (*out) {
-        memcpy(*out, e->cached, e->cached_len + 1);
-        if (outlen) *outlen = e->cached_len;
-        pthread_mutex_unlock(&e->m);
-        return 1;
-      }
-    }
+  time_t now = time(NULL);
+  int match = e->cached && strcmp(e->key, key) == 0;
+  if (match && now - e->ts <= e->ttl) { e->hits++; *out = payload_ref(e->cached); pthread_mutex_unlock(&e->m); return CO_HIT; }
+  if (match && now - e->ts <= e->ttl + g_coalesce_max_stale) {
+    e->stale++; *out = payload_ref(e->cached);
+    int co = e->busy ? CO_HIT : CO_REVALIDATE;
+    e->busy = 1;
     pthread_mutex_unlock(&e->m);
-    return 0;
+    return co;
   }
-  e->busy = 1;
+  if (e->busy) {
+    struct timespec dl; clock_gettime(CLOCK_REALTIME, &dl);
+    dl.tv_sec += g_coalesce_wait_ms / 1000; dl.tv_nsec += (long)(g_coalesce_wait_ms % 1000) * 1000000L;
+    if (dl.tv_nsec >= 1000000000L) { dl.tv_sec++; dl.tv_nsec -= 1000000000L; }
+    e->waits++;
+    while (e->busy)
+      if (pthread_cond_timedwait(&e->cv, &e->m, &dl) == ETIMEDOUT) break;
+    if (e->cached && strcmp(e->key, key) == 0 && time(NULL) - e->ts <= e->ttl + g_coalesce_max_stale) {
+      *out = payload_ref(e->cached); pthread_mutex_unlock(&e->m); return CO_HIT;
+    }
+    if (e->busy) { e->timeouts++; pthread_mutex_unlock(&e->m); return CO_BUILD_ALONE; }
+  }
+  e->busy = 1; e->builds++;
   pthread_mutex_unlock(&e->m);
-  return 0;
+  return CO_BUILD;
 }
 
-/* Finish work: provide malloc'd payload newbuf (ownership transferred). The helper will copy into cache
- * and free newbuf. If newbuf==NULL the cache is cleared.
+/* Publish p (the reference is taken over; NULL = the build failed and the
+ * last good payload stays) and release the refresh if co owned it.
  */
-static void endpoint_coalesce_finish(endpoint_coalesce_t *e, char *newbuf, size_t newlen) {
-  if (!e) { if (newbuf) free(newbuf); return; }
+static void endpoint_coalesce_finish(endpoint_coalesce_t *e, int co, const char *key, payload_t *p) {
   pthread_mutex_lock(&e->m);
-  if (e->cached) { free(e->cached); e->cached = NULL; e->cached_len = 0; }
-  if (newbuf && newlen > 0) {
-    e->cached = malloc(newlen + 1);
-    if (e->cached) {
-      memcpy(e->cached, newbuf, newlen + 1);
-      e->cached_len = newlen;
-      e->ts = time(NULL);
-    }
-  }
-  if (newbuf) free(newbuf);
-  e->busy = 0;
-  pthread_cond_broadcast(&e->cv);
+  payload_t *old = NULL;
+  if (p && p->len > 0) {
+    old = e->cached; e->cached = p; p = NULL;
+    snprintf(e->key, sizeof(e->key), "%s", key ? key : "");
+    e->ts = time(NULL);
+  }
+  if (co == CO_BUILD || co == CO_REVALIDATE) { e->busy = 0; pthread_cond_broadcast(&e->cv); }
   pthread_mutex_unlock(&e->m);
+  payload_unref(old);
+  payload_unref(p);
 }
 
 /* Per-endpoint coalesce instances */
 static endpoint_coalesce_t g_traceroute_co;
 static endpoint_coalesce_t g_discover_co;
 static endpoint_coalesce_t g_devices_co;
+static endpoint_coalesce_t g_status_co;
+static endpoint_coalesce_t g_status_lite_co;
+static endpoint_coalesce_t g_trace_target_co;   /* /traceroute?target=, keyed by its query */
+static endpoint_coalesce_t g_discover_raw_co;   /* /discover */
 /* Coalescer TTLs (seconds) - defaults mirror previous hardcoded values */
 static int g_coalesce_devices_ttl = 5;
 static int g_coalesce_discover_ttl = 300;
 static int g_coalesce_traceroute_ttl = 5;
+static int g_coalesce_status_ttl = 1;
 /* configuration-set flags intentionally omitted: coalescer TTLs accept env/PlParam but do not track PlParam precedence here */
 /* --- end coalescing helper --- */
 
+/* --- binary encodings of JSON endpoints ---
+ * Clients sending Accept: application/cbor or application/msgpack get the
+ * JSON body transcoded (binjson.c). Transcoding parses the text again, so it
+ * is only offered where the body is a shared payload that outlives the
+ * request (coalescer entries, the node_db blob): the last encoding per
+ * endpoint and format is kept with the generation of the payload it was made
+ * from and reused until that payload is replaced.
+ */
+enum { ENC_STATUS = 0, ENC_STATUS_LITE, ENC_DEVICES, ENC_NODEDB, ENC_SLOTS };
+typedef struct {
+  unsigned long gen;
+  char *body;
+  size_t len;
+} enc_cache_t;
+static pthread_mutex_t g_enc_lock = PTHREAD_MUTEX_INITIALIZER;
+static enc_cache_t g_enc_cache[ENC_SLOTS][2];   /* [slot][fmt - 1] */
+static unsigned long g_enc_hits = 0, g_enc_misses = 0, g_enc_errors = 0;
+/* --- end binary encodings --- */
+
 /* Debug counters for diagnostics */
 /* Debug counters for diagnostics: use C11 atomics when available for lock-free updates */
 #if HAVE_C11_ATOMICS
@@ -524,8 +708,7 @@ static void enqueue_fetch_request(int force, int wait, int type);
 static void *fetch_worker_thread(void *arg);
 
 /* Devices cache populated by background worker to avoid blocking HTTP handlers */
-static char *g_devices_cache = NULL; /* JSON array string (malloc'd) */
-static size_t g_devices_cache_len = 0;
+static payload_t *g_devices_cache = NULL; /* normalized JSON array */
 static time_t g_devices_cache_ts = 0;
 static pthread_mutex_t g_devices_cache_lock = PTHREAD_MUTEX_INITIALIZER;
 static int g_devices_worker_running = 0;
@@ -598,14 +781,15 @@ static char *extract_first_json_value(const char *s) {
   char close = (open == '{') ? '}' : ']';
   int depth = 0;
   int in_str = 0;
-  int escaped = 0;
-  const char *q = p;
-  while (*q) {
+  const char *q = p, *end = p + strlen(p);
+  /* jump between quotes, backslashes and brackets; nothing else matters */
+  while (q < end) {
+    q += js_find_structural(q, (size_t)(end - q));
+    if (q >= end) break;
     char c = *q;
     if (in_str) {
-      if (escaped) { escaped = 0; }
-      else if (c == '\\') { escaped = 1; }
-      else if (c == '"') { in_str = 0; }
+      if (c == '\\') { q += 2; continue; }
+      if (c == '"') in_str = 0;
     } else {
       if (c == '"') { in_str = 1; }
       else if (c == open) { depth++; }
@@ -616,6 +800,7 @@ static char *extract_first_json_value(const char *s) {
     }
     q++;
   }
+  if (q > end) q = end;
   if (depth != 0) return NULL; /* unbalanced, give up */
   size_t len = (size_t)(q - p);
   char *out = malloc(len + 1);
@@ -626,37 +811,40 @@ static char *extract_first_json_value(const char *s) {
 }
 
 
-/* Global short-lived cache for local HTTP calls (thread-safe, small TTL) */
+/* Global short-lived cache for local HTTP calls (thread-safe, small TTL).
+ * Bodies are shared payloads: a hit hands out a reference, not a copy.
+ */
 #define LOCAL_CACHE_ENTRIES 64
 #define LOCAL_CACHE_TTL_SEC 1
-typedef struct { char *url; char *body; size_t len; time_t ts; } local_cache_entry_t;
+typedef struct { char *url; payload_t *body; time_t ts; } local_cache_entry_t;
 static local_cache_entry_t g_local_cache[LOCAL_CACHE_ENTRIES];
 static pthread_mutex_t g_local_cache_lock = PTHREAD_MUTEX_INITIALIZER;
 
-static int cached_util_http_get_url_local(const char *url, char **out, size_t *outlen, int timeout_sec) {
-  if (!url || !out || !outlen) return -1;
+/* Fetch url through the cache; returns a reference or NULL on failure. */
+static payload_t *local_http_get(const char *url, int timeout_sec) {
+  if (!url) return NULL;
   time_t nowt = time(NULL);
   pthread_mutex_lock(&g_local_cache_lock);
   for (int i = 0; i < LOCAL_CACHE_ENTRIES; ++i) {
     if (g_local_cache[i].url && strcmp(g_local_cache[i].url, url) == 0) {
       if (nowt - g_local_cache[i].ts <= LOCAL_CACHE_TTL_SEC) {
-        *out = malloc(g_local_cache[i].len + 1);
-        if (!*out) { pthread_mutex_unlock(&g_local_cache_lock); return -1; }
-        memcpy(*out, g_local_cache[i].body, g_local_cache[i].len + 1);
-        *outlen = g_local_cache[i].len;
+        payload_t *p = payload_get(&g_local_cache[i].body);
         pthread_mutex_unlock(&g_local_cache_lock);
-        return 0;
+        return p;
       }
       free(g_local_cache[i].url); g_local_cache[i].url = NULL;
-      free(g_local_cache[i].body); g_local_cache[i].body = NULL;
-      g_local_cache[i].len = 0; g_local_cache[i].ts = 0;
+      payload_swap(&g_local_cache[i].body, NULL);
+      g_local_cache[i].ts = 0;
     }
   }
   pthread_mutex_unlock(&g_local_cache_lock);
 
   char *tmp = NULL; size_t tlen = 0;
   int rc = util_http_get_url_local(url, &tmp, &tlen, timeout_sec);
-  if (rc != 0 || !tmp) { if (tmp) { free(tmp); } return rc; }
+  if (rc != 0 || !tmp) { free(tmp); return NULL; }
+  payload_t *p = payload_adopt(tmp, tlen);
+  char *key = strdup(url);
+  if (!p || !key) { free(key); return p; }
 
   pthread_mutex_lock(&g_local_cache_lock);
   int sel = 0; time_t oldest = nowt;
@@ -664,22 +852,23 @@ static int cached_util_http_get_url_local(const char *url, char **out, size_t *o
     if (!g_local_cache[i].url) { sel = i; break; }
     if (g_local_cache[i].ts < oldest) { oldest = g_local_cache[i].ts; sel = i; }
   }
-  if (g_local_cache[sel].url) free(g_local_cache[sel].url);
-  if (g_local_cache[sel].body) free(g_local_cache[sel].body);
-  g_local_cache[sel].url = strdup(url);
-  g_local_cache[sel].body = malloc(tlen + 1);
-  if (g_local_cache[sel].body) {
-    memcpy(g_local_cache[sel].body, tmp, tlen + 1);
-    g_local_cache[sel].len = tlen;
-    g_local_cache[sel].ts = nowt;
-  } else {
-    free(g_local_cache[sel].url); g_local_cache[sel].url = NULL;
-    g_local_cache[sel].len = 0; g_local_cache[sel].ts = 0;
-  }
+  free(g_local_cache[sel].url);
+  g_local_cache[sel].url = key;
+  payload_swap(&g_local_cache[sel].body, payload_ref(p));
+  g_local_cache[sel].ts = nowt;
   pthread_mutex_unlock(&g_local_cache_lock);
+  return p;
+}
 
-  *out = tmp; *outlen = tlen;
-  return 0;
+/* Compatibility form for callers that own (and free) their buffer. */
+static int cached_util_http_get_url_local(const char *url, char **out, size_t *outlen, int timeout_sec) {
+  if (!url || !out || !outlen) return -1;
+  payload_t *p = local_http_get(url, timeout_sec);
+  if (!p) return -1;
+  *out = malloc(p->len + 1);
+  if (*out) { memcpy(*out, p->data, p->len + 1); *outlen = p->len; }
+  payload_unref(p);
+  return *out ? 0 : -1;
 }
 
 /* Use cached wrapper in this compilation unit */
@@ -856,9 +1045,9 @@ static void fetch_discover_once(void) {
        * hostname, product, etc.). Storing normalized JSON avoids mismatches
        * between cached and inline responses.
        */
+  payload_t *np = payload_adopt(normalized, nlen);
   pthread_mutex_lock(&g_devices_cache_lock);
-  if (g_devices_cache) free(g_devices_cache);
-  g_devices_cache = normalized; g_devices_cache_len = nlen; g_devices_cache_ts = time(NULL);
+  if (np) { payload_swap(&g_devices_cache, np); g_devices_cache_ts = time(NULL); }
   pthread_mutex_unlock(&g_devices_cache_lock);
   /* Also emit into the UBNT/trace ring so runtime ubnt-debug consumers see it */
   if (ubnt_debug_enabled()) plugin_log_trace("ubnt: got device data from ubnt-discover (worker %zu bytes)", nlen);
@@ -999,23 +1188,43 @@ static void sigsegv_handler(int sig) {
 char g_traceroute_path[PATHLEN] = "";
 char g_olsrd_path[PATHLEN] = "";
 
+/* Equivalent of `which traceroute`, searched in-process over $PATH. */
 static void detect_traceroute_binary(void) {
-  FILE *fp = popen("which traceroute", "r");
-  if (fp) {
-    char path[256] = "";
-    if (fgets(path, sizeof(path), fp)) {
-      size_t len = strlen(path);
-      while (len && (path[len-1] == '\n' || path[len-1] == '\r')) path[--len] = 0;
-      if (len > 0) {
-        strncpy(g_traceroute_path, path, sizeof(g_traceroute_path)-1);
-        g_traceroute_path[sizeof(g_traceroute_path)-1] = 0;
-        g_has_traceroute = 1;
-      }
+  const char *path = getenv("PATH");
+  char dirs[1024]; snprintf(dirs, sizeof(dirs), "%s", (path && path[0]) ? path : "/usr/sbin:/usr/bin:/sbin:/bin");
+  for (char *save = NULL, *d = strtok_r(dirs, ":", &save); d; d = strtok_r(NULL, ":", &save)) {
+    char cand[PATHLEN];
+    if ((size_t)snprintf(cand, sizeof(cand), "%s/traceroute", d[0] ? d : ".") >= sizeof(cand)) continue;
+    if (access(cand, X_OK) == 0) {
+      snprintf(g_traceroute_path, sizeof(g_traceroute_path), "%s", cand);
+      g_has_traceroute = 1;
+      return;
     }
-    pclose(fp);
   }
 }
 
+/* exec_argv() for callers that only use the output of a completed run. */
+static int run_argv(const char *const argv[], int flags, int timeout_ms, char **out, size_t *outlen) {
+  if (exec_argv(argv, flags, timeout_ms, out, outlen, NULL) == 0) return 0;
+  free(*out); *out = NULL; *outlen = 0;
+  return -1;
+}
+
+static int ip_route_default(char **out, size_t *outlen) {
+  static const char *const argv[] = { "ip", "route", "show", "default", NULL };
+  return run_argv(argv, 0, 2000, out, outlen);
+}
+
+/* Gateway of the default route, "" when there is none. */
+static void default_route_via(char *out, size_t outlen) {
+  out[0] = '\0';
+  char *rout = NULL; size_t rn = 0;
+  if (ip_route_default(&rout, &rn) != 0 || !rout) return;
+  char *p = strstr(rout, "via ");
+  if (p) { p += 4; size_t L = strcspn(p, " \n"); if (L && L < outlen) { memcpy(out, p, L); out[L] = '\0'; } }
+  free(rout);
+}
+
 /* Forward declarations for HTTP handlers */
 static int h_root(http_request_t *r);
 static int h_ipv4(http_request_t *r); static int h_ipv6(http_request_t *r);
@@ -1029,8 +1238,9 @@ static int h_olsrd_json(http_request_t *r); static int h_capabilities_local(http
 static int h_txtinfo(http_request_t *r); static int h_jsoninfo(http_request_t *r); static int h_olsrd(http_request_t *r);
 static int h_discover(http_request_t *r); static int h_discover_ubnt(http_request_t *r); static int h_embedded_appjs(http_request_t *r); static int h_emb_jquery(http_request_t *r); static int h_emb_bootstrap(http_request_t *r);
 static int h_connections(http_request_t *r); static int h_connections_json(http_request_t *r);
-static int h_airos(http_request_t *r); static int h_traffic(http_request_t *r); static int h_versions_json(http_request_t *r); static int h_nodedb(http_request_t *r);
+static int h_airos(http_request_t *r); static int h_traffic(http_request_t *r); static int h_traffic_json(http_request_t *r); static int h_versions_json(http_request_t *r); static int h_nodedb(http_request_t *r);
 static int h_platform_json(http_request_t *r);
+static int h_history(http_request_t *r); static int lq_history_collect(lqh_sample_t **out);
 static int h_fetch_metrics(http_request_t *r);
 static int h_prometheus_metrics(http_request_t *r);
 static int h_fetch_debug(http_request_t *r);
@@ -1173,35 +1383,113 @@ static int json_buf_append(char **bufptr, size_t *lenptr, size_t *capptr, const
 }
 
 static int json_append_escaped(char **bufptr, size_t *lenptr, size_t *capptr, const char *s) {
-  if (!s) { return json_buf_append(bufptr, lenptr, capptr, "\"\""); }
-  if (json_buf_append(bufptr, lenptr, capptr, "\"") < 0) return -1;
-  const unsigned char *p = (const unsigned char*)s;
-  for (; *p; ++p) {
-    unsigned char c = *p;
-    switch (c) {
-      case '"': if (json_buf_append(bufptr, lenptr, capptr, "\\\"") < 0) return -1; break;
-      case '\\': if (json_buf_append(bufptr, lenptr, capptr, "\\\\") < 0) return -1; break;
-      case '\b': if (json_buf_append(bufptr, lenptr, capptr, "\\b") < 0) return -1; break;
-      case '\f': if (json_buf_append(bufptr, lenptr, capptr, "\\f") < 0) return -1; break;
-      case '\n': if (json_buf_append(bufptr, lenptr, capptr, "\\n") < 0) return -1; break;
-      case '\r': if (json_buf_append(bufptr, lenptr, capptr, "\\r") < 0) return -1; break;
-      case '\t': if (json_buf_append(bufptr, lenptr, capptr, "\\t") < 0) return -1; break;
-      default:
-        if (c < 0x20) {
-          if (json_buf_append(bufptr, lenptr, capptr, "\\u%04x", c) < 0) return -1;
-        } else {
-          char t[2] = { (char)c, 0 };
-          if (json_buf_append(bufptr, lenptr, capptr, "%s", t) < 0) return -1;
-        }
-    }
+  /* clean runs are copied in bulk; see json_writer.c */
+  return jw_escape_append(bufptr, lenptr, capptr, s ? s : "", s ? strlen(s) : 0);
+}
+
+/* Traceroute hops as [{"hop":1,"ip":"..","host":"..","ping":"0.412","rtt_ms":0.412},...];
+ * silent hops get ip "*" and rtt_ms null. ping_unit is appended to "ping".
+ */
+static int trace_hops_json(char **buf, size_t *len, size_t *cap, const trace_result_t *tr, const char *ping_unit) {
+  if (json_buf_append(buf, len, cap, "[") < 0) return -1;
+  for (int i = 0; i < tr->nhops; i++) {
+    const trace_hop_t *h = &tr->hop[i];
+    char host[256] = "", ping[32] = "";
+    if (h->ip[0]) resolve_ip_cached(h->ip, host, sizeof(host));
+    if (h->rtt_ms >= 0) snprintf(ping, sizeof(ping), "%.3f%s", h->rtt_ms, ping_unit);
+    if (json_buf_append(buf, len, cap, "%s{\"hop\":%d,\"ip\":", i ? "," : "", h->ttl) < 0) return -1;
+    if (json_append_escaped(buf, len, cap, h->ip[0] ? h->ip : "*") < 0) return -1;
+    if (json_buf_append(buf, len, cap, ",\"host\":") < 0 || json_append_escaped(buf, len, cap, host) < 0) return -1;
+    if (json_buf_append(buf, len, cap, ",\"ping\":") < 0 || json_append_escaped(buf, len, cap, ping) < 0) return -1;
+    if (h->rtt_ms >= 0) { if (json_buf_append(buf, len, cap, ",\"rtt_ms\":%.3f", h->rtt_ms) < 0) return -1; }
+    else if (json_buf_append(buf, len, cap, ",\"rtt_ms\":null") < 0) return -1;
+    if (h->flag && json_buf_append(buf, len, cap, ",\"unreachable\":\"!%c\"", h->flag) < 0) return -1;
+    if (json_buf_append(buf, len, cap, "}") < 0) return -1;
+  }
+  return json_buf_append(buf, len, cap, "]") < 0 ? -1 : 0;
+}
+
+/* IPv4 path to the uplink, as `traceroute -4` used to report it. */
+static int trace_uplink(const char *target, trace_result_t *tr) {
+  trace_opts_t o = { .max_ttl = 30, .timeout_ms = NATIVE_TRACE_TIMEOUT_MS, .proto = TRACE_UDP, .family = AF_INET };
+  return trace_run(target, &o, tr);
+}
+
+/* trace_target, trace_to_uplink and the age of the monitor's latest sample
+ * (s == NULL while the first run is still pending). Without with_age the
+ * age is left out, for fragments that outlive the request.
+ */
+static int uplink_sample_json(char **buf, size_t *len, size_t *cap, const trace_sample_t *s, int with_age) {
+  if (!s) return json_buf_append(buf, len, cap, "\"trace_target\":\"\",\"trace_to_uplink\":[],\"trace_pending\":true") < 0 ? -1 : 0;
+  long age = (long)(time(NULL) - s->ts);
+  if (json_buf_append(buf, len, cap, "\"trace_target\":") < 0 || json_append_escaped(buf, len, cap, s->target) < 0) return -1;
+  if (json_buf_append(buf, len, cap, ",\"trace_to_uplink\":") < 0 || trace_hops_json(buf, len, cap, &s->tr, "") != 0) return -1;
+  if (json_buf_append(buf, len, cap, ",\"trace_updated\":%ld", (long)s->ts) < 0) return -1;
+  if (with_age && json_buf_append(buf, len, cap, ",\"trace_age_s\":%ld", age < 0 ? 0 : age) < 0) return -1;
+  return json_buf_append(buf, len, cap, ",\"trace_reached\":%s,\"trace_path_changed\":%s",
+                         s->tr.reached ? "true" : "false", s->changed ? "true" : "false") < 0 ? -1 : 0;
+}
+
+/* Monitor target: traceroute_to from settings.inc, else the default gateway,
+ * else the reference uplink the python status page used.
+ */
+static void uplink_trace_target(char *out, size_t outlen) {
+  out[0] = '\0';
+  char *s = NULL; size_t sn = 0;
+  if (util_read_file("/config/custom/www/settings.inc", &s, &sn) == 0 && s) {
+    for (char *save = NULL, *line = strtok_r(s, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+      while (*line == ' ' || *line == '\t' || *line == '$') line++;
+      if (strncmp(line, "traceroute_to", 13) != 0) continue;
+      char *v = strchr(line, '=');
+      if (!v) continue;
+      v++;
+      while (*v == ' ' || *v == '\'' || *v == '"') v++;
+      size_t vl = strcspn(v, "'\";\r \t");
+      if (vl && vl < outlen) { memcpy(out, v, vl); out[vl] = '\0'; }
+      break;
+    }
+    free(s);
+  }
+  if (out[0]) return;
+  char *rout = NULL; size_t rn = 0;
+  if (ip_route_default(&rout, &rn) == 0 && rout) {
+    char *p = strstr(rout, "via ");
+    if (p) { p += 4; size_t L = strcspn(p, " \n"); if (L && L < outlen) { memcpy(out, p, L); out[L] = '\0'; } }
+    free(rout);
   }
-  if (json_buf_append(bufptr, lenptr, capptr, "\"") < 0) return -1;
-  return 0;
+  if (!out[0]) snprintf(out, outlen, "%s", "78.41.115.36");
+}
+
+/* Ring contents, newest first: one compact path per run. */
+static int uplink_history_json(char **buf, size_t *len, size_t *cap) {
+  int max = g_uplink_trace_history > 0 ? g_uplink_trace_history : 1;
+  trace_sample_t *h = malloc(sizeof(*h) * (size_t)max);
+  if (!h) return -1;
+  int n = trace_monitor_history(h, max), rc = 0;
+  trace_monitor_stats_t st; trace_monitor_get_stats(&st);
+  rc = json_buf_append(buf, len, cap, ",\"trace_changes\":%lu,\"trace_last_change\":%ld,\"trace_history\":[", st.changes, (long)st.last_change) < 0 ? -1 : 0;
+  for (int i = 0; rc == 0 && i < n; i++) {
+    const trace_result_t *t = &h[i].tr;
+    rc = json_buf_append(buf, len, cap, "%s{\"ts\":%ld,\"reached\":%s,\"changed\":%s,\"hops\":%d,\"rtt_ms\":", i ? "," : "", (long)h[i].ts,
+                         t->reached ? "true" : "false", h[i].changed ? "true" : "false", t->nhops) < 0 ? -1 : 0;
+    if (rc == 0) {
+      double last = t->nhops > 0 ? t->hop[t->nhops - 1].rtt_ms : -1;
+      rc = (last >= 0 ? json_buf_append(buf, len, cap, "%.3f", last) : json_buf_append(buf, len, cap, "null")) < 0 ? -1 : 0;
+    }
+    if (rc == 0) rc = json_buf_append(buf, len, cap, ",\"path\":[") < 0 ? -1 : 0;
+    for (int k = 0; rc == 0 && k < t->nhops; k++)
+      rc = json_buf_append(buf, len, cap, "%s\"%s\"", k ? "," : "", t->hop[k].ip[0] ? t->hop[k].ip : "*") < 0 ? -1 : 0;
+    if (rc == 0) rc = json_buf_append(buf, len, cap, "]}") < 0 ? -1 : 0;
+  }
+  if (rc == 0) rc = json_buf_append(buf, len, cap, "]") < 0 ? -1 : 0;
+  free(h);
+  return rc;
 }
 
 /* --- Helper counters for OLSR link enrichment --- */
 static int find_json_string_value(const char *start, const char *key, char **val, size_t *val_len); /* forward */
 static int find_best_nodename_in_nodedb(const char *buf, size_t len, const char *dest_ip, char *out_name, size_t out_len); /* forward */
+static int nodedb_lookup_name_locked(const char *ip, char *out, size_t outlen); /* forward */
 static int count_routes_for_ip(const char *section, const char *ip) {
   if (!section || !ip || !ip[0]) return 0;
   const char *arr = strchr(section,'[');
@@ -1394,19 +1682,17 @@ static int count_unique_nodes_for_ip(const char *section, const char *ip) {
       if (destTrim[0]==0) continue;
       /* Try to resolve the destination to a node name from node_db; fall back to dest IP if unavailable. */
       char nodename[128] = "";
-      if (g_nodedb_cached && g_nodedb_cached_len > 0) {
-        pthread_mutex_lock(&g_nodedb_lock);
-        /* Use CIDR-aware best-match lookup */
-        find_best_nodename_in_nodedb(g_nodedb_cached, g_nodedb_cached_len, destTrim, nodename, sizeof(nodename));
-        pthread_mutex_unlock(&g_nodedb_lock);
-      }
+      pthread_mutex_lock(&g_nodedb_lock);
+      /* Use CIDR-aware best-match lookup */
+      nodedb_lookup_name_locked(destTrim, nodename, sizeof(nodename));
+      pthread_mutex_unlock(&g_nodedb_lock);
       if (!nodename[0]) snprintf(nodename, sizeof(nodename), "%s", destTrim);
       /* linear de-dupe by node name */
       int dup = 0; for (int i=0;i<ucnt;i++) { if (strcmp(uniq[i], nodename) == 0) { dup = 1; break; } }
       if (!dup) {
-        if (!uniq) uniq = (char**)calloc(MAX_UNIQUE, sizeof(char*));
+        if (!uniq) uniq = (char**)req_calloc(MAX_UNIQUE, sizeof(char*));
         if (uniq && ucnt < MAX_UNIQUE) {
-          uniq[ucnt] = strdup(nodename);
+          uniq[ucnt] = req_strdup(nodename);
           if (uniq[ucnt]) ucnt++;
         }
       }
@@ -1415,7 +1701,7 @@ static int count_unique_nodes_for_ip(const char *section, const char *ip) {
     p++;
   }
   rc = ucnt;
-  if (uniq) { for (int i=0;i<ucnt;i++) free(uniq[i]); free(uniq); }
+  if (uniq) { for (int i=0;i<ucnt;i++) req_free(uniq[i]); req_free(uniq); }
   return rc;
 }
 
@@ -1510,27 +1796,8 @@ static void __attribute__((unused)) arp_enrich_ip(const char *ip, char *mac_out,
   if (mac_out && mac_len) mac_out[0] = '\0';
   if (host_out && host_len) host_out[0] = '\0';
   if (!ip || !*ip) return;
-  FILE *f = fopen("/proc/net/arp", "r");
-  if (f) {
-    char line[512];
-    /* skip header */
-    if (!fgets(line, sizeof(line), f)) { fclose(f); f = NULL; }
-    while (f && fgets(line, sizeof(line), f)) {
-      char ipf[128] = "", hw[128] = "", dev[64] = "";
-      if (sscanf(line, "%127s %*s %*s %127s %*s %63s", ipf, hw, dev) >= 2) {
-        if (strcmp(ipf, ip) == 0) {
-          if (mac_out && mac_len) {
-            size_t hwlen = strlen(hw);
-            if (hwlen >= mac_len) hwlen = mac_len - 1;
-            memcpy(mac_out, hw, hwlen);
-            mac_out[hwlen] = '\0';
-          }
-          break;
-        }
-      }
-    }
-    if (f) fclose(f);
-  }
+  neigh_entry_t ne;
+  if (mac_out && mac_len && neigh_cache_lookup(ip, &ne)) snprintf(mac_out, mac_len, "%s", ne.mac);
   if (host_out && host_len) {
     struct in_addr ina;
     if (inet_aton(ip, &ina)) {
@@ -1546,60 +1813,60 @@ static void __attribute__((unused)) arp_enrich_ip(const char *ip, char *mac_out,
 }
 
 /* Basic ARP table to JSON device list */
-/* Build fresh ARP JSON list (uncached). Caller owns returned buffer. */
+/* Build fresh ARP JSON list (uncached) from the neighbour table, or from
+ * /proc/net/arp when netlink is unavailable. Caller owns returned buffer.
+ */
 static int build_arp_json(char **out, size_t *outlen) {
   if (!out || !outlen) return -1;
   *out = NULL; *outlen = 0;
-  FILE *f = fopen("/proc/net/arp", "r");
-  if (!f) return -1;
-  char *buf = NULL; size_t cap = 2048, len = 0; buf = malloc(cap); if(!buf){ fclose(f); return -1; }
+  neigh_entry_t *ne = NULL;
+  int n = neigh_cache_snapshot(AF_INET, &ne);
+  if (n < 0) n = neigh_proc_arp(&ne);
+  if (n < 0) return -1;
+  char *buf = NULL; size_t cap = 2048, len = 0; buf = malloc(cap); if(!buf){ free(ne); return -1; }
   buf[0] = '\0';
   json_buf_append(&buf, &len, &cap, "[");
-  int first = 1; char line[512];
-  if (!fgets(line, sizeof(line), f)) { fclose(f); free(buf); return -1; }
-  while (fgets(line, sizeof(line), f)) {
-    char ip[128], hw[128], dev[64];
-    if (sscanf(line, "%127s %*s %*s %127s %*s %63s", ip, hw, dev) >= 2) {
-      if (!first) json_buf_append(&buf, &len, &cap, ",");
-      first = 0;
-      json_buf_append(&buf, &len, &cap, "{\"ipv4\":"); json_append_escaped(&buf,&len,&cap,ip);
-      json_buf_append(&buf, &len, &cap, ",\"hwaddr\":"); json_append_escaped(&buf,&len,&cap,hw);
-      /* ARP-derived entries minimal fields */
-      json_buf_append(&buf,&len,&cap,",\"hostname\":\"\",\"product\":\"\",\"uptime\":\"\",\"mode\":\"\",\"essid\":\"\",\"firmware\":\"\",\"signal\":\"\",\"tx_rate\":\"\",\"rx_rate\":\"\",\"source\":\"arp\"}");
-    }
+  int first = 1;
+  for (int i = 0; i < n; i++) {
+    if (!ne[i].mac[0] || ne[i].state == NUD_NOARP) continue;   /* INCOMPLETE/FAILED, broadcast */
+    if (!first) json_buf_append(&buf, &len, &cap, ",");
+    first = 0;
+    json_buf_append(&buf, &len, &cap, "{\"ipv4\":"); json_append_escaped(&buf,&len,&cap,ne[i].ip);
+    json_buf_append(&buf, &len, &cap, ",\"hwaddr\":"); json_append_escaped(&buf,&len,&cap,ne[i].mac);
+    /* ARP-derived entries minimal fields */
+    json_buf_append(&buf,&len,&cap,",\"hostname\":\"\",\"product\":\"\",\"uptime\":\"\",\"mode\":\"\",\"essid\":\"\",\"firmware\":\"\",\"signal\":\"\",\"tx_rate\":\"\",\"rx_rate\":\"\",\"source\":\"arp\"}");
   }
-  fclose(f);
+  free(ne);
   json_buf_append(&buf, &len, &cap, "]");
   *out = buf; *outlen = len; return 0;
 }
 
-/* Cached accessor for ARP JSON; returns dup the caller must free */
-static int get_arp_json_cached(char **out, size_t *outlen) {
-  if (!out || !outlen) return -1;
+/* Cached accessor for ARP JSON; returns a reference the caller releases with
+ * payload_unref(), or NULL. The JSON is rebuilt only when the neighbour table
+ * version moved (or the TTL expired); without the table (version 0) only the
+ * TTL applies.
+ */
+static payload_t *get_arp_json_cached(void) {
   time_t now = time(NULL);
+  unsigned long ver = neigh_cache_version();
   pthread_mutex_lock(&g_arp_cache_lock);
-  int fresh = (g_arp_cache && g_arp_cache_len > 0 && (g_arp_cache_ttl_s <= 0 || (now - g_arp_cache_ts) <= g_arp_cache_ttl_s));
+  int fresh = (g_arp_cache && g_arp_cache->len > 0 && ver == g_arp_cache_ver && (g_arp_cache_ttl_s <= 0 || (now - g_arp_cache_ts) <= g_arp_cache_ttl_s));
   if (fresh) {
-    char *dup = malloc(g_arp_cache_len + 1);
-    if (!dup) { pthread_mutex_unlock(&g_arp_cache_lock); return -1; }
-    memcpy(dup, g_arp_cache, g_arp_cache_len + 1);
-    *out = dup; *outlen = g_arp_cache_len;
+    payload_t *p = payload_get(&g_arp_cache);
     pthread_mutex_unlock(&g_arp_cache_lock);
-    return 0;
+    return p;
   }
   pthread_mutex_unlock(&g_arp_cache_lock);
   /* build fresh outside lock */
   char *fresh_json = NULL; size_t fresh_len = 0;
-  if (build_arp_json(&fresh_json, &fresh_len) != 0) return -1;
+  if (build_arp_json(&fresh_json, &fresh_len) != 0) return NULL;
+  payload_t *p = payload_adopt(fresh_json, fresh_len);
+  if (!p) return NULL;
   pthread_mutex_lock(&g_arp_cache_lock);
-  if (g_arp_cache) free(g_arp_cache);
-  g_arp_cache = fresh_json; g_arp_cache_len = fresh_len; g_arp_cache_ts = now;
-  /* duplicate for caller */
-  char *dup = malloc(g_arp_cache_len + 1);
-  if (!dup) { pthread_mutex_unlock(&g_arp_cache_lock); return -1; }
-  memcpy(dup, g_arp_cache, g_arp_cache_len + 1);
+  payload_swap(&g_arp_cache, payload_ref(p));
+  g_arp_cache_ts = now; g_arp_cache_ver = ver;
   pthread_mutex_unlock(&g_arp_cache_lock);
-  *out = dup; *outlen = fresh_len; return 0;
+  return p;
 }
 
 /* Obtain primary non-loopback IPv4 (best effort). */
@@ -1608,6 +1875,210 @@ static void get_primary_ipv4(char *out, size_t outlen){ if(out&&outlen) out[0]=0
 /* Very lightweight validation that node_db json has object form & expected keys */
 static int validate_nodedb_json(const char *buf, size_t len){ if(!buf||len==0) return 0; /* skip leading ws */ size_t i=0; while(i<len && (buf[i]==' '||buf[i]=='\n'||buf[i]=='\r'||buf[i]=='\t')) i++; if(i>=len) return 0; if(buf[i] != '{') return 0; /* look for some indicative keys */ if(strstr(buf,"\"v6-to-v4\"")||strstr(buf,"\"v6-to-id\"")||strstr(buf,"\"v6-hna-at\"")) return 1; if(strstr(buf,"\"n\"")) return 1; return 1; }
 
+/* Skip one JSON value starting at p (whitespace allowed); returns pointer just past it or NULL. */
+static const char *json_skip_value(const char *p, const char *end) {
+  while (p < end && isspace((unsigned char)*p)) p++;
+  if (p >= end) return NULL;
+  if (*p == '"') {
+    p++;
+    while (p < end && *p != '"') { if (*p == '\\' && p + 1 < end) p += 2; else p++; }
+    return (p < end) ? p + 1 : NULL;
+  }
+  if (*p == '{' || *p == '[') {
+    int depth = 0;
+    while (p < end) {
+      char c = *p;
+      if (c == '"') { p++; while (p < end && *p != '"') { if (*p == '\\' && p + 1 < end) p += 2; else p++; } if (p >= end) return NULL; }
+      else if (c == '{' || c == '[') depth++;
+      else if (c == '}' || c == ']') { depth--; if (depth == 0) return p + 1; }
+      p++;
+    }
+    return NULL;
+  }
+  while (p < end && *p != ',' && *p != '}' && *p != ']' && !isspace((unsigned char)*p)) p++;
+  return p;
+}
+
+/* Top-level nodedb entry: key and raw value spans inside the cached blob */
+struct nodedb_entry_ref { const char *key; size_t klen; const char *val; size_t vlen; uint64_t h; };
+
+static int nodedb_entry_cmp(const void *a, const void *b) {
+  const struct nodedb_entry_ref *x = a, *y = b;
+  size_t m = x->klen < y->klen ? x->klen : y->klen;
+  int c = memcmp(x->key, y->key, m);
+  if (c) return c;
+  return (x->klen > y->klen) - (x->klen < y->klen);
+}
+
+/* Index the top-level "key": value pairs of a nodedb object, sorted by key.
+ * Returns the entry count (0 when the blob is not an object); *out is malloc'd.
+ */
+static size_t nodedb_index_entries(const char *buf, size_t len, struct nodedb_entry_ref **out) {
+  *out = NULL;
+  if (!buf || len == 0) return 0;
+  const char *p = buf, *end = buf + len;
+  while (p < end && isspace((unsigned char)*p)) p++;
+  if (p >= end || *p != '{') return 0;
+  p++;
+  size_t cap = 256, n = 0;
+  struct nodedb_entry_ref *v = malloc(cap * sizeof(*v));
+  if (!v) return 0;
+  for (;;) {
+    while (p < end && (isspace((unsigned char)*p) || *p == ',')) p++;
+    if (p >= end || *p != '"') break;
+    const char *k = p + 1;
+    const char *ke = json_skip_value(p, end); if (!ke) break;
+    const char *c = ke; while (c < end && isspace((unsigned char)*c)) c++;
+    if (c >= end || *c != ':') break;
+    c++; while (c < end && isspace((unsigned char)*c)) c++;
+    const char *ve = json_skip_value(c, end); if (!ve) break;
+    if (n == cap) { cap *= 2; struct nodedb_entry_ref *nv = realloc(v, cap * sizeof(*v)); if (!nv) break; v = nv; }
+    v[n].key = k; v[n].klen = (size_t)(ke - 1 - k); v[n].val = c; v[n].vlen = (size_t)(ve - c);
+    uint64_t h = UINT64_C(1469598103934665603);
+    for (const char *q = c; q < ve; ++q) h = (h ^ (unsigned char)*q) * UINT64_C(1099511628211);
+    v[n].h = h; n++;
+    p = ve;
+  }
+  if (n) qsort(v, n, sizeof(*v), nodedb_entry_cmp);
+  else { free(v); v = NULL; }
+  *out = v;
+  return n;
+}
+
+/* Sorted entries of the blob in g_nodedb, kept by the fetch thread between
+ * fetches (fetches never overlap) so a diff only indexes the new body. The
+ * refs point into g_nodedb_prev_p, which holds its own reference.
+ */
+static struct nodedb_entry_ref *g_nodedb_prev_refs = NULL;
+static size_t g_nodedb_prev_n = 0;
+static payload_t *g_nodedb_prev_p = NULL;
+
+/* Count added/removed/changed top-level entries between two sorted entry sets. */
+static void nodedb_diff(const struct nodedb_entry_ref *a, size_t na, const struct nodedb_entry_ref *b, size_t nb,
+                        unsigned long *added, unsigned long *removed, unsigned long *changed,
+                        unsigned long *changed_bytes, unsigned long *entries) {
+  unsigned long ad = 0, rm = 0, ch = 0, cb = 0;
+  size_t i = 0, j = 0;
+  while (i < na || j < nb) {
+    int c = (i >= na) ? 1 : (j >= nb) ? -1 : nodedb_entry_cmp(&a[i], &b[j]);
+    if (c < 0) { rm++; i++; }
+    else if (c > 0) { ad++; cb += (unsigned long)b[j].vlen; j++; }
+    else {
+      if (a[i].h != b[j].h || a[i].vlen != b[j].vlen || memcmp(a[i].val, b[j].val, a[i].vlen) != 0) { ch++; cb += (unsigned long)b[j].vlen; }
+      i++; j++;
+    }
+  }
+  *added = ad; *removed = rm; *changed = ch; *changed_bytes = cb; *entries = (unsigned long)nb;
+}
+
+/* Find a top-level string field inside one JSON object span. Returns 1 if found. */
+static int json_object_string_field(const char *obj, size_t len, const char *key, const char **val, size_t *vlen) {
+  const char *p = obj, *end = obj + len;
+  size_t klen = strlen(key);
+  while (p < end && isspace((unsigned char)*p)) p++;
+  if (p >= end || *p != '{') return 0;
+  p++;
+  for (;;) {
+    while (p < end && (isspace((unsigned char)*p) || *p == ',')) p++;
+    if (p >= end || *p != '"') return 0;
+    const char *k = p + 1;
+    const char *ke = json_skip_value(p, end); if (!ke) return 0;
+    const char *c = ke; while (c < end && isspace((unsigned char)*c)) c++;
+    if (c >= end || *c != ':') return 0;
+    c++; while (c < end && isspace((unsigned char)*c)) c++;
+    const char *ve = json_skip_value(c, end); if (!ve) return 0;
+    if ((size_t)(ke - 1 - k) == klen && memcmp(k, key, klen) == 0 && *c == '"' && ve - c >= 2) {
+      *val = c + 1; *vlen = (size_t)(ve - c - 2); return 1;
+    }
+    p = ve;
+  }
+}
+
+/* Build the prefix index with the same key rules as find_best_nodename_in_nodedb:
+ * ip[/mask] keys map the prefix to n/name/hostname, other keys contribute a /32
+ * for each IP-like field (h, host, ip, ...) of their object.
+ */
+static nodedb_index_t *nodedb_build_index(const struct nodedb_entry_ref *e, size_t n) {
+  struct nodedb_prefix *pv = malloc((n ? n : 1) * 8 * sizeof(*pv));
+  if (!pv) return NULL;
+  size_t np = 0;
+  static const char *name_keys[] = { "n", "name", "hostname", NULL };
+  static const char *ip_keys[] = { "h", "host", "hostname", "m", "ip", "ipv4", "addr", "address", NULL };
+  for (size_t i = 0; i < n; i++) {
+    const char *nm = NULL; size_t nl = 0;
+    for (int k = 0; name_keys[k] && !nm; k++) json_object_string_field(e[i].val, e[i].vlen, name_keys[k], &nm, &nl);
+    if (!nm) continue;
+    char tmp[64];
+    if (e[i].klen > 0 && e[i].key[0] >= '0' && e[i].key[0] <= '9') {
+      if (e[i].klen >= sizeof(tmp)) continue;
+      memcpy(tmp, e[i].key, e[i].klen); tmp[e[i].klen] = '\0';
+      int plen = 32; char *slash = strchr(tmp, '/');
+      if (slash) { *slash = '\0'; plen = atoi(slash + 1); }
+      struct in_addr a; if (!inet_aton(tmp, &a)) continue;
+      pv[np].net = ntohl(a.s_addr); pv[np].plen = plen; pv[np].name = nm; pv[np].name_len = nl; np++;
+    } else {
+      for (int k = 0; ip_keys[k]; k++) {
+        const char *iv = NULL; size_t il = 0;
+        if (!json_object_string_field(e[i].val, e[i].vlen, ip_keys[k], &iv, &il) || il == 0 || il >= sizeof(tmp)) continue;
+        memcpy(tmp, iv, il); tmp[il] = '\0';
+        char *slash = strchr(tmp, '/'); if (slash) *slash = '\0';
+        struct in_addr a; if (!inet_aton(tmp, &a)) continue;
+        pv[np].net = ntohl(a.s_addr); pv[np].plen = 32; pv[np].name = nm; pv[np].name_len = nl; np++;
+      }
+    }
+  }
+  nodedb_index_t *ix = nodedb_index_build(pv, np);
+  free(pv);
+  return ix;
+}
+
+/* Resolve a destination IPv4 to a node name. Caller holds g_nodedb_lock.
+ * Uses the prefix index when present and falls back to scanning the JSON.
+ */
+static int nodedb_lookup_name_locked(const char *ip, char *out, size_t outlen) {
+  if (g_nodedb_index) {
+    struct in_addr a; if (!inet_aton(ip, &a)) return 0;
+    return nodedb_index_lookup(g_nodedb_index, ntohl(a.s_addr), out, outlen);
+  }
+  if (g_nodedb && g_nodedb->len > 0) return find_best_nodename_in_nodedb(g_nodedb->data, g_nodedb->len, ip, out, outlen);
+  return 0;
+}
+
+/* Host name for one address, as lookup_hostname_cached always answered it: an
+ * object keyed by exactly this IP gives its "hostname", then its "n"; anything
+ * else goes through the prefix lookup. Caller holds g_nodedb_lock.
+ */
+static int nodedb_hostname_locked(const char *ip, char *out, size_t outlen) {
+  char needle[64];
+  if (g_nodedb && g_nodedb->len > 0 && snprintf(needle, sizeof(needle), "\"%s\":", ip) < (int)sizeof(needle)) {
+    const char *end = g_nodedb->data + g_nodedb->len;
+    const char *k = memmem(g_nodedb->data, g_nodedb->len, needle, strlen(needle));
+    if (k) {
+      const char *v = k + strlen(needle);
+      while (v < end && isspace((unsigned char)*v)) v++;
+      const char *ve = json_skip_value(v, end);
+      const char *nm = NULL; size_t nl = 0;
+      if (ve && (json_object_string_field(v, (size_t)(ve - v), "hostname", &nm, &nl) || json_object_string_field(v, (size_t)(ve - v), "n", &nm, &nl)) && nl > 0) {
+        if (nl >= outlen) nl = outlen - 1;
+        memcpy(out, nm, nl); out[nl] = '\0';
+        return 1;
+      }
+    }
+  }
+  return nodedb_lookup_name_locked(ip, out, outlen);
+}
+
+/* Validators end up inside a shell command for the external curl path; only
+ * accept plain printable ASCII without quoting/escape characters.
+ */
+static int nodedb_validator_shell_safe(const char *v) {
+  if (!v || !v[0]) return 0;
+  for (const unsigned char *p = (const unsigned char*)v; *p; ++p) {
+    if (*p < 0x20 || *p > 0x7e || *p == '\'' || *p == '\\' || *p == '`' || *p == '$') return 0;
+  }
+  return 1;
+}
+
 /* Fetch remote node_db and update cache */
 /* TTL-aware wrapper: only fetch if cache is stale or empty */
 /* forward-declare actual fetch implementation so wrapper can call it */
@@ -1618,8 +2089,20 @@ static void fetch_remote_nodedb(void);
 struct curl_fetch {
   char *buf;
   size_t len;
+  char etag[128];
+  char last_modified[64];
 };
 
+/* Header callback: capture validators from the (final) response headers */
+static size_t curl_header_cb(char *ptr, size_t size, size_t nmemb, void *userdata) {
+  struct curl_fetch *cf = (struct curl_fetch*)userdata;
+  size_t n = size * nmemb;
+  char v[128];
+  if (util_http_header_value(ptr, n, "ETag", v, sizeof(v))) snprintf(cf->etag, sizeof(cf->etag), "%s", v);
+  if (util_http_header_value(ptr, n, "Last-Modified", v, sizeof(v))) snprintf(cf->last_modified, sizeof(cf->last_modified), "%s", v);
+  return n;
+}
+
 static size_t curl_write_cb(void *ptr, size_t size, size_t nmemb, void *userdata) {
   struct curl_fetch *cf = (struct curl_fetch*)userdata;
   size_t add = size * nmemb;
@@ -1646,7 +2129,7 @@ static void fetch_remote_nodedb_if_needed(void) {
   time_t now = time(NULL);
   pthread_mutex_lock(&g_nodedb_lock);
   int need = 0;
-  if (!g_nodedb_cached || g_nodedb_cached_len == 0) need = 1;
+  if (!g_nodedb || g_nodedb->len == 0) need = 1;
   else if (g_nodedb_last_fetch == 0) need = 1;
   else if ((now - g_nodedb_last_fetch) >= g_nodedb_ttl) need = 1;
   pthread_mutex_unlock(&g_nodedb_lock);
@@ -1696,14 +2179,35 @@ static void fetch_remote_nodedb(void) {
     }
   }
 
+  /* Snapshot validators from the last full response; only send them while we
+   * still hold the data they describe, otherwise a 304 would leave us empty.
+   */
+  char cond_etag[128] = "", cond_lm[64] = "";
+  pthread_mutex_lock(&g_nodedb_lock);
+  if (g_nodedb && g_nodedb->len > 0) {
+    snprintf(cond_etag, sizeof(cond_etag), "%s", g_nodedb_etag);
+    snprintf(cond_lm, sizeof(cond_lm), "%s", g_nodedb_last_modified);
+  }
+  pthread_mutex_unlock(&g_nodedb_lock);
+  char new_etag[128] = "", new_lm[64] = "";
+  int not_modified = 0; size_t wire = 0;
+
   /* Prefer internal HTTP fetch for plain http:// URLs to avoid spawning curl. */
   int success = 0;
   if (strncmp(g_nodedb_url, "http://", 7) == 0) {
     fprintf(stderr, "[status-plugin] nodedb fetch: attempting internal HTTP fetch %s\n", g_nodedb_url);
-    int rc = util_http_get_url(g_nodedb_url, &fresh, &fn, 5);
-    fprintf(stderr, "[status-plugin] nodedb fetch: internal_http rc=%d bytes=%zu\n", rc, fn);
-    if (rc == 0 && fresh && buffer_has_content(fresh,fn) && validate_nodedb_json(fresh,fn)) {
+    util_http_cond_t cond; memset(&cond, 0, sizeof(cond));
+    cond.if_none_match = cond_etag; cond.if_modified_since = cond_lm;
+    int rc = util_http_get_url_cond(g_nodedb_url, &cond, &fresh, &fn, 5);
+    fprintf(stderr, "[status-plugin] nodedb fetch: internal_http rc=%d status=%d bytes=%zu\n", rc, cond.status, fn);
+    wire += cond.wire_bytes;
+    if (rc == 0 && cond.status == 304 && (cond_etag[0] || cond_lm[0])) {
+      fprintf(stderr, "[status-plugin] nodedb fetch: method=internal_http not modified\n");
+      not_modified = 1; success = 1;
+    } else if (rc == 0 && fresh && buffer_has_content(fresh,fn) && validate_nodedb_json(fresh,fn)) {
       fprintf(stderr, "[status-plugin] nodedb fetch: method=internal_http success, got %zu bytes\n", fn);
+      snprintf(new_etag, sizeof(new_etag), "%s", cond.etag);
+      snprintf(new_lm, sizeof(new_lm), "%s", cond.last_modified);
       success = 1;
     } else {
       if (fresh) { free(fresh); fresh = NULL; fn = 0; }
@@ -1717,24 +2221,38 @@ static void fetch_remote_nodedb(void) {
   fprintf(stderr, "[status-plugin] nodedb fetch: attempting libcurl fetch %s\n", g_nodedb_url);
     CURL *c = curl_easy_init();
     if (c) {
-      struct curl_fetch cf = { NULL, 0 };
+      struct curl_fetch cf; memset(&cf, 0, sizeof(cf));
       curl_easy_setopt(c, CURLOPT_URL, g_nodedb_url);
       curl_easy_setopt(c, CURLOPT_TIMEOUT, 5L);
       curl_easy_setopt(c, CURLOPT_FOLLOWLOCATION, 1L);
       curl_easy_setopt(c, CURLOPT_USERAGENT, "status-plugin");
-      struct curl_slist *hdr = NULL; hdr = curl_slist_append(hdr, "Accept: application/json"); curl_easy_setopt(c, CURLOPT_HTTPHEADER, hdr);
+      struct curl_slist *hdr = NULL; hdr = curl_slist_append(hdr, "Accept: application/json");
+      char vh[160];
+      if (cond_etag[0]) { snprintf(vh, sizeof(vh), "If-None-Match: %s", cond_etag); hdr = curl_slist_append(hdr, vh); }
+      if (cond_lm[0]) { snprintf(vh, sizeof(vh), "If-Modified-Since: %s", cond_lm); hdr = curl_slist_append(hdr, vh); }
+      curl_easy_setopt(c, CURLOPT_HTTPHEADER, hdr);
       curl_easy_setopt(c, CURLOPT_SSL_VERIFYPEER, 0L);
       curl_easy_setopt(c, CURLOPT_SSL_VERIFYHOST, 0L);
       curl_easy_setopt(c, CURLOPT_WRITEFUNCTION, curl_write_cb);
       curl_easy_setopt(c, CURLOPT_WRITEDATA, &cf);
+      curl_easy_setopt(c, CURLOPT_HEADERFUNCTION, curl_header_cb);
+      curl_easy_setopt(c, CURLOPT_HEADERDATA, &cf);
       CURLcode cres = curl_easy_perform(c);
+      long code = 0; curl_easy_getinfo(c, CURLINFO_RESPONSE_CODE, &code);
+      long hsize = 0; curl_easy_getinfo(c, CURLINFO_HEADER_SIZE, &hsize);
       curl_slist_free_all(hdr);
       curl_easy_cleanup(c);
-      if (cres == CURLE_OK && cf.buf && cf.len > 0 && validate_nodedb_json(cf.buf, cf.len)) {
+      if (cres == CURLE_OK) wire += (size_t)hsize + cf.len;
+      if (cres == CURLE_OK && code == 304 && (cond_etag[0] || cond_lm[0])) {
+        if (cf.buf) free(cf.buf);
+        not_modified = 1; success = 1; fprintf(stderr, "[status-plugin] nodedb fetch: method=libcurl not modified\n");
+      } else if (cres == CURLE_OK && code == 200 && cf.buf && cf.len > 0 && validate_nodedb_json(cf.buf, cf.len)) {
         fresh = cf.buf; fn = cf.len; success = 1; fprintf(stderr, "[status-plugin] nodedb fetch: method=libcurl success, got %zu bytes\n", fn);
+        snprintf(new_etag, sizeof(new_etag), "%s", cf.etag);
+        snprintf(new_lm, sizeof(new_lm), "%s", cf.last_modified);
       } else {
         if (cf.buf) free(cf.buf);
-        fprintf(stderr, "[status-plugin] nodedb fetch: method=libcurl failed (curl code=%d)\n", (int)cres);
+        fprintf(stderr, "[status-plugin] nodedb fetch: method=libcurl failed (curl code=%d http=%ld)\n", (int)cres, code);
       }
     } else {
       fprintf(stderr, "[status-plugin] nodedb fetch: libcurl init failed\n");
@@ -1743,15 +2261,49 @@ static void fetch_remote_nodedb(void) {
 
 #ifndef NO_CURL_FALLBACK
     if (!success) {
+      /* -D - prepends the response headers to stdout so status and validators
+       * can be read back; validators are only forwarded when shell-safe.
+       */
+      char vh[256] = "";
+      size_t vo = 0;
+      if (nodedb_validator_shell_safe(cond_etag)) vo += (size_t)snprintf(vh + vo, sizeof(vh) - vo, " -H 'If-None-Match: %s'", cond_etag);
+      if (vo < sizeof(vh) && nodedb_validator_shell_safe(cond_lm)) snprintf(vh + vo, sizeof(vh) - vo, " -H 'If-Modified-Since: %s'", cond_lm);
       const char *curl_paths[] = {"/usr/bin/curl", "/bin/curl", "/usr/local/bin/curl", "curl", NULL};
       for (const char **curl_path = curl_paths; *curl_path && !success; curl_path++) {
         fprintf(stderr, "[status-plugin] nodedb fetch: attempting external curl at %s\n", *curl_path);
-        char cmd[1024];
-        snprintf(cmd,sizeof(cmd),"%s -s --max-time 5 -H \"User-Agent: status-plugin OriginIP/%s\" -H \"Accept: application/json\" %s", *curl_path, ipbuf, g_nodedb_url);
-        if (util_exec(cmd,&fresh,&fn)==0 && fresh && buffer_has_content(fresh,fn) && validate_nodedb_json(fresh,fn)) {
+        char cmd[1536];
+        snprintf(cmd,sizeof(cmd),"%s -s --max-time 5 -D - -H \"User-Agent: status-plugin OriginIP/%s\" -H \"Accept: application/json\"%s %s", *curl_path, ipbuf, vh, g_nodedb_url);
+        char *raw = NULL; size_t rn = 0;
+        if (util_exec(cmd,&raw,&rn)==0 && raw && rn > 0) {
+          /* skip interim header blocks (1xx, proxy CONNECT) and keep the final one */
+          const char *hdr = raw; const char *hend = NULL; size_t left = rn;
+          for (;;) {
+            hend = memmem(hdr, left, "\r\n\r\n", 4);
+            if (!hend) break;
+            const char *next = hend + 4; size_t nleft = left - (size_t)(next - hdr);
+            if (nleft >= 5 && strncmp(next, "HTTP/", 5) == 0) { hdr = next; left = nleft; continue; }
+            break;
+          }
+          int status = hend ? util_http_status_code(hdr, (size_t)(hend - hdr)) : 0;
+          wire += rn;
+          if (status == 304 && (cond_etag[0] || cond_lm[0])) {
+            fprintf(stderr, "[status-plugin] nodedb fetch: method=external_curl not modified (%s)\n", *curl_path);
+            not_modified = 1; success = 1; free(raw); break;
+          }
+          if (status == 200) {
+            size_t hl = (size_t)(hend - hdr);
+            util_http_header_value(hdr, hl, "ETag", new_etag, sizeof(new_etag));
+            util_http_header_value(hdr, hl, "Last-Modified", new_lm, sizeof(new_lm));
+            fn = rn - (size_t)(hend + 4 - raw);
+            fresh = malloc(fn + 1);
+            if (fresh) { memcpy(fresh, hend + 4, fn); fresh[fn] = '\0'; }
+          }
+          free(raw);
+        } else if (raw) free(raw);
+        if (fresh && buffer_has_content(fresh,fn) && validate_nodedb_json(fresh,fn)) {
           fprintf(stderr, "[status-plugin] nodedb fetch: method=external_curl success with %s, got %zu bytes\n", *curl_path, fn);
           success = 1; break;
-        } else { if (fresh) { free(fresh); fresh = NULL; fn = 0; } }
+        } else { if (fresh) { free(fresh); fresh = NULL; fn = 0; } new_etag[0] = new_lm[0] = '\0'; }
       }
     }
 #else
@@ -1761,7 +2313,14 @@ static void fetch_remote_nodedb(void) {
 #endif
   }
 
-  if (success) {
+  if (success && not_modified) {
+    /* 304: the cached copy is still current; refresh its age only */
+    pthread_mutex_lock(&g_nodedb_lock);
+    g_nodedb_last_fetch = time(NULL);
+    g_nodedb_fetch_requests++; g_nodedb_fetch_not_modified++; g_nodedb_fetch_bytes += wire;
+    g_nodedb_diff_added = g_nodedb_diff_removed = g_nodedb_diff_changed = g_nodedb_diff_bytes = 0;
+    pthread_mutex_unlock(&g_nodedb_lock);
+  } else if (success) {
     /* augment: if remote JSON is an object mapping IP -> { n:.. } ensure each has hostname/name keys */
     int is_object_mapping = 0; /* heuristic: starts with '{' and contains '"n"' and an IPv4 pattern */
     if (fresh[0]=='{' && strstr(fresh,"\"n\"") && strstr(fresh,".\"")) is_object_mapping=1;
@@ -1787,17 +2346,80 @@ static void fetch_remote_nodedb(void) {
         else free(aug);
       }
     }
+    payload_t *fresh_p = payload_adopt(fresh, fn);
+    fresh = NULL;
+    if (!fresh_p) goto fetch_done;
+    /* parsing, sorting, diffing and the index (names are copied into its own
+     * pool) all happen outside the lock; an unchanged body skips them
+     */
     pthread_mutex_lock(&g_nodedb_lock);
-    if (g_nodedb_cached) free(g_nodedb_cached);
-    g_nodedb_cached=fresh; g_nodedb_cached_len=fn; g_nodedb_last_fetch=time(NULL);
+    payload_t *cur_p = payload_get(&g_nodedb);
+    int have_ix = g_nodedb_index != NULL;
     pthread_mutex_unlock(&g_nodedb_lock);
-    /* write a copy for external inspection if explicitly enabled (avoid frequent flash writes) */
-    if (g_nodedb_write_disk) {
-      FILE *wf=fopen("/tmp/node_db.json","w"); if(wf){ fwrite(g_nodedb_cached,1,g_nodedb_cached_len,wf); fclose(wf);}
+    int unchanged = (cur_p && cur_p->len == fn && memcmp(cur_p->data, fresh_p->data, fn) == 0);
+    struct nodedb_entry_ref *fresh_refs = NULL;
+    size_t fresh_n = 0;
+    nodedb_index_t *fresh_ix = NULL;
+    unsigned long da = 0, dr = 0, dc = 0, db = 0, ne = 0;
+    if (!unchanged || !have_ix) {
+      fresh_n = nodedb_index_entries(fresh_p->data, fn, &fresh_refs);
+      fresh_ix = nodedb_build_index(fresh_refs, fresh_n);
+    }
+    if (!unchanged) {
+      /* the previous entry set is reused unless g_nodedb moved under us */
+      if (g_nodedb_prev_p != cur_p) {
+        free(g_nodedb_prev_refs); payload_unref(g_nodedb_prev_p);
+        g_nodedb_prev_p = cur_p ? payload_ref(cur_p) : NULL;
+        g_nodedb_prev_n = cur_p ? nodedb_index_entries(cur_p->data, cur_p->len, &g_nodedb_prev_refs) : 0;
+        if (!cur_p) g_nodedb_prev_refs = NULL;
+      }
+      nodedb_diff(g_nodedb_prev_refs, g_nodedb_prev_n, fresh_refs, fresh_n, &da, &dr, &dc, &db, &ne);
+      free(g_nodedb_prev_refs); payload_unref(g_nodedb_prev_p);
+      g_nodedb_prev_refs = fresh_refs; g_nodedb_prev_n = fresh_n; g_nodedb_prev_p = payload_ref(fresh_p);
+      fresh_refs = NULL;
+      if (g_fetch_log_queue || g_fetch_log_force)
+        fprintf(stderr, "[status-plugin] nodedb fetch: diff entries=%lu added=%lu removed=%lu changed=%lu bytes=%lu\n", ne, da, dr, dc, db);
+    }
+    free(fresh_refs);
+    payload_unref(cur_p);
+    pthread_mutex_lock(&g_nodedb_lock);
+    g_nodedb_fetch_requests++; g_nodedb_fetch_full++; g_nodedb_fetch_bytes += wire;
+    snprintf(g_nodedb_etag, sizeof(g_nodedb_etag), "%s", new_etag);
+    snprintf(g_nodedb_last_modified, sizeof(g_nodedb_last_modified), "%s", new_lm);
+    if (unchanged) {
+      /* server ignored our validators but the body is identical: keep the current blob */
+      g_nodedb_fetch_unchanged++;
+      g_nodedb_diff_added = g_nodedb_diff_removed = g_nodedb_diff_changed = g_nodedb_diff_bytes = 0;
+      g_nodedb_last_fetch = time(NULL);
+      if (!g_nodedb_index && fresh_ix) { g_nodedb_index = fresh_ix; fresh_ix = NULL; }
+      pthread_mutex_unlock(&g_nodedb_lock);
+      payload_unref(fresh_p);
+      nodedb_index_free(fresh_ix);
+    } else {
+      g_nodedb_diff_added = da; g_nodedb_diff_removed = dr; g_nodedb_diff_changed = dc; g_nodedb_diff_bytes = db; g_nodedb_entries = ne;
+      payload_swap(&g_nodedb, payload_ref(fresh_p));
+      g_nodedb_last_fetch=time(NULL);
+      nodedb_index_t *old_ix = g_nodedb_index;
+      g_nodedb_index = fresh_ix;
+      pthread_mutex_unlock(&g_nodedb_lock);
+      nodedb_index_free(old_ix);
+      /* persist for the next start; skipped when the content hash is unchanged */
+      if (fresh_ix && g_nodedb_snapshot_path[0]) {
+        int rc = nodedb_index_save(fresh_ix, g_nodedb_snapshot_path);
+        if (rc < 0) fprintf(stderr, "[status-plugin] nodedb snapshot: write to %s failed: %s\n", g_nodedb_snapshot_path, strerror(errno));
+        else if (rc > 0 && (g_fetch_log_queue || g_fetch_log_force))
+          fprintf(stderr, "[status-plugin] nodedb snapshot: wrote %zu prefixes to %s\n", nodedb_index_count(fresh_ix), g_nodedb_snapshot_path);
+      }
+      /* write a copy for external inspection if explicitly enabled (avoid frequent flash writes) */
+      if (g_nodedb_write_disk) {
+        FILE *wf=fopen("/tmp/node_db.json","w"); if(wf){ fwrite(fresh_p->data,1,fresh_p->len,wf); fclose(wf);}
+      }
+      payload_unref(fresh_p);
     }
     fresh=NULL;
   } else if (fresh) { free(fresh); }
     else { fprintf(stderr,"[status-plugin] nodedb fetch failed or invalid (%s)\n", g_nodedb_url); }
+fetch_done:
   /* Clear fetch-in-progress and notify any waiters so they can re-check cache. */
   pthread_mutex_lock(&g_nodedb_fetch_lock);
   g_nodedb_fetch_in_progress = 0;
@@ -1805,10 +2427,29 @@ static void fetch_remote_nodedb(void) {
   pthread_mutex_unlock(&g_nodedb_fetch_lock);
 }
 
-/* Improved unique-destination counting: counts distinct destination nodes reachable via given last hop. */
-static int normalize_olsrd_links(const char *raw, char **outbuf, size_t *outlen) {
+/* Per-gateway route/node tally for normalize_olsrd_links. Scratch for one
+ * call: the table, name lists and names come from the request arena.
+ */
+struct gw_stat { char gw[64]; int routes; int nodes; int name_count, name_cap; char **names; };
+#define MAX_GW_STATS 512
+#define MAX_GW_NAMES 256
+
+static void gw_stats_free(struct gw_stat *gw, int n) {
+  if (!gw) return;
+  for (int i = 0; i < n; i++) {
+    for (int k = 0; k < gw[i].name_count; k++) req_free(gw[i].names[k]);
+    req_free(gw[i].names);
+  }
+  req_free(gw);
+}
+
+/* Improved unique-destination counting: counts distinct destination nodes reachable via given last hop.
+ * def_ip is the default gateway (to flag that link); NULL looks it up once per call.
+ */
+static int normalize_olsrd_links(const char *raw, const char *def_ip, char **outbuf, size_t *outlen) {
   if (!raw || !outbuf || !outlen) return -1;
   *outbuf = NULL; *outlen = 0;
+  char def_buf[64];
   /* Fetch remote node_db only if cache is stale or empty */
   fetch_remote_nodedb_if_needed();
   /* --- Route & node name fan-out (Python legacy parity) ------------------
@@ -1822,29 +2463,13 @@ static int normalize_olsrd_links(const char *raw, char **outbuf, size_t *outlen)
    * prefer these authoritative counts. Only if unavailable / zero do we
    * fall back to topology / neighbors heuristic logic.
    */
-  struct gw_stat { char gw[64]; int routes; int nodes; int name_count; char names[256][64]; };
-  #define MAX_GW_STATS 512
   struct gw_stat *gw_stats = NULL; int gw_stats_count = 0; /* local per-call allocation to avoid cross-thread races */
   do {
     char *rt_raw=NULL; size_t rlen=0;
-    const char *rt_cmds[] = {
-      "/sbin/ip -4 r 2>/dev/null",
-      "/usr/sbin/ip -4 r 2>/dev/null",
-      "ip -4 r 2>/dev/null",
-      NULL
-    };
-      for (int ci=0; rt_cmds[ci] && !rt_raw; ++ci) {
-        /* use local HTTP helper when endpoint is loopback */
-        if (strstr(rt_cmds[ci], "127.0.0.1") || strstr(rt_cmds[ci], "localhost")) {
-          if (util_http_get_url_local(rt_cmds[ci], &rt_raw, &rlen, 1) == 0 && rt_raw && rlen>0) break;
-          if (rt_raw) { free(rt_raw); rt_raw=NULL; rlen=0; }
-        } else {
-          if (util_exec(rt_cmds[ci], &rt_raw, &rlen) == 0 && rt_raw && rlen>0) break;
-          if (rt_raw) { free(rt_raw); rt_raw=NULL; rlen=0; }
-        }
-      }
+    static const char *const rt_argv[] = { "ip", "-4", "r", NULL };
+    if (run_argv(rt_argv, 0, 2000, &rt_raw, &rlen) != 0 || rlen == 0) { free(rt_raw); rt_raw = NULL; }
     if (!rt_raw) break; /* no routing table */
-    gw_stats = calloc(MAX_GW_STATS, sizeof(struct gw_stat));
+    gw_stats = req_calloc(MAX_GW_STATS, sizeof(struct gw_stat));
     if (!gw_stats) { free(rt_raw); break; }
     char *saveptr=NULL; char *line = strtok_r(rt_raw, "\n", &saveptr);
     while(line) {
@@ -1863,22 +2488,29 @@ static int normalize_olsrd_links(const char *raw, char **outbuf, size_t *outlen)
             /* node name lookup: use CIDR-aware best-match from node_db */
             char nodename[128] = "";
             int have_name = 0;
-            if (g_nodedb_cached && g_nodedb_cached_len > 0) {
-              pthread_mutex_lock(&g_nodedb_lock);
-              if (find_best_nodename_in_nodedb(g_nodedb_cached, g_nodedb_cached_len, dest, nodename, sizeof(nodename))) have_name = 1;
-              pthread_mutex_unlock(&g_nodedb_lock);
-            }
+            pthread_mutex_lock(&g_nodedb_lock);
+            if (nodedb_lookup_name_locked(dest, nodename, sizeof(nodename))) have_name = 1;
+            pthread_mutex_unlock(&g_nodedb_lock);
             if (have_name) {
               /* ensure unique per gateway */
               int dup=0; for (int ni=0; ni<gw_stats[gi].name_count; ++ni) if(strcmp(gw_stats[gi].names[ni],nodename)==0){ dup=1; break; }
-              if(!dup && gw_stats[gi].name_count < 256) {
+              struct gw_stat *gs = &gw_stats[gi];
+              if (!dup && gs->name_count == gs->name_cap && gs->name_cap < MAX_GW_NAMES) {
+                int nc = gs->name_cap ? gs->name_cap * 2 : 8;
+                char **nn = req_alloc((size_t)nc * sizeof(*nn));
+                if (nn) {
+                  if (gs->name_count) memcpy(nn, gs->names, (size_t)gs->name_count * sizeof(*nn));
+                  req_free(gs->names); gs->names = nn; gs->name_cap = nc;
+                }
+              }
+              if(!dup && gs->name_count < gs->name_cap) {
                 /* Cap and copy safely */
                 nodename[63]='\0';
-                size_t nlen = strnlen(nodename, 63);
-                memcpy(gw_stats[gi].names[gw_stats[gi].name_count], nodename, nlen);
-                gw_stats[gi].names[gw_stats[gi].name_count][nlen] = '\0';
-                gw_stats[gi].name_count++;
-                gw_stats[gi].nodes = gw_stats[gi].name_count;
+                char *nm = req_strdup(nodename);
+                if (nm) {
+                  gs->names[gs->name_count++] = nm;
+                  gs->nodes = gs->name_count;
+                }
               }
             }
           }
@@ -1897,6 +2529,7 @@ static int normalize_olsrd_links(const char *raw, char **outbuf, size_t *outlen)
     arr = strchr(raw, '[');
     if (!arr) {
       METRIC_SET_UNIQUE(0, 0);
+      gw_stats_free(gw_stats, gw_stats_count);
       return -1;
     }
   }
@@ -1904,8 +2537,9 @@ static int normalize_olsrd_links(const char *raw, char **outbuf, size_t *outlen)
   /* accumulate totals for metrics */
   int total_unique_routes = 0;
   int total_unique_nodes = 0;
-  size_t cap = 4096; size_t len = 0; char *buf = malloc(cap); if (!buf) { METRIC_SET_UNIQUE(0,0); return -1; } buf[0]=0;
-  json_buf_append(&buf, &len, &cap, "["); int first = 1; int parsed = 0;
+  jw_t w;
+  if (jw_init(&w, 4096) != 0) { METRIC_SET_UNIQUE(0,0); gw_stats_free(gw_stats, gw_stats_count); return -1; }
+  jw_begin_arr(&w); int parsed = 0;
   /* Detect legacy (olsrd) or v2 (olsr2 json embedded) route/topology sections. We first look for plain
    * "routes" / "topology" keys; if not found, fall back to the wrapper keys we emit in /status (olsr_routes_raw / olsr_topology_raw).
    */
@@ -2001,25 +2635,22 @@ static int normalize_olsrd_links(const char *raw, char **outbuf, size_t *outlen)
         if (twohop > 0) nodes_cnt = twohop;
         if (routes_cnt == 0 && twohop > 0) routes_cnt = twohop; /* approximate */
       }
-      char routes_s[16]; snprintf(routes_s,sizeof(routes_s),"%d",routes_cnt);
-      char nodes_s[16]; snprintf(nodes_s,sizeof(nodes_s),"%d",nodes_cnt);
-      static char def_ip_cached[64];
-      if (!def_ip_cached[0]) { char *rout_link=NULL; size_t rnl=0; if(util_exec("/sbin/ip route show default 2>/dev/null || /usr/sbin/ip route show default 2>/dev/null || ip route show default 2>/dev/null", &rout_link,&rnl)==0 && rout_link){ char *pdef=strstr(rout_link,"via "); if(pdef){ pdef+=4; char *q2=strchr(pdef,' '); if(q2){ size_t L=q2-pdef; if(L<sizeof(def_ip_cached)){ strncpy(def_ip_cached,pdef,L); def_ip_cached[L]=0; } } } free(rout_link);} }
-      int is_default = (def_ip_cached[0] && strcmp(def_ip_cached, remote)==0)?1:0;
-  if (!first) json_buf_append(&buf,&len,&cap,",");
-  first=0;
-      json_buf_append(&buf,&len,&cap,"{\"intf\":"); json_append_escaped(&buf,&len,&cap,intf);
-      json_buf_append(&buf,&len,&cap,",\"local\":"); json_append_escaped(&buf,&len,&cap,local);
-      json_buf_append(&buf,&len,&cap,",\"remote\":"); json_append_escaped(&buf,&len,&cap,remote);
-      json_buf_append(&buf,&len,&cap,",\"remote_host\":"); json_append_escaped(&buf,&len,&cap,remote_host);
-      json_buf_append(&buf,&len,&cap,",\"lq\":"); json_append_escaped(&buf,&len,&cap,lq);
-      json_buf_append(&buf,&len,&cap,",\"nlq\":"); json_append_escaped(&buf,&len,&cap,nlq);
-      json_buf_append(&buf,&len,&cap,",\"cost\":"); json_append_escaped(&buf,&len,&cap,cost);
-      json_buf_append(&buf,&len,&cap,",\"routes\":"); json_append_escaped(&buf,&len,&cap,routes_s);
-      json_buf_append(&buf,&len,&cap,",\"nodes\":"); json_append_escaped(&buf,&len,&cap,nodes_s);
-  if (node_names_concat[0]) { json_buf_append(&buf,&len,&cap,",\"node_names\":"); json_append_escaped(&buf,&len,&cap,node_names_concat); }
-      json_buf_append(&buf,&len,&cap,",\"is_default\":%s", is_default?"true":"false");
-      json_buf_append(&buf,&len,&cap,"}");
+      if (!def_ip) { default_route_via(def_buf, sizeof(def_buf)); def_ip = def_buf; }
+      int is_default = (def_ip[0] && strcmp(def_ip, remote)==0)?1:0;
+      jw_begin_obj(&w);
+      JW_KEY(&w, "intf"); jw_str(&w, intf);
+      JW_KEY(&w, "local"); jw_str(&w, local);
+      JW_KEY(&w, "remote"); jw_str(&w, remote);
+      JW_KEY(&w, "remote_host"); jw_str(&w, remote_host);
+      JW_KEY(&w, "lq"); jw_str(&w, lq);
+      JW_KEY(&w, "nlq"); jw_str(&w, nlq);
+      JW_KEY(&w, "cost"); jw_str(&w, cost);
+      /* counts are strings in this schema */
+      JW_KEY(&w, "routes"); if (routes_cnt < 0) jw_str(&w, "-1"); else jw_u64_str(&w, (uint64_t)routes_cnt);
+      JW_KEY(&w, "nodes"); if (nodes_cnt < 0) jw_str(&w, "-1"); else jw_u64_str(&w, (uint64_t)nodes_cnt);
+      if (node_names_concat[0]) { JW_KEY(&w, "node_names"); jw_str(&w, node_names_concat); }
+      JW_KEY(&w, "is_default"); jw_bool(&w, is_default);
+      jw_end_obj(&w);
       parsed++;
   /* update totals for metrics */
   if (routes_cnt > 0) total_unique_routes += routes_cnt;
@@ -2030,7 +2661,9 @@ static int normalize_olsrd_links(const char *raw, char **outbuf, size_t *outlen)
   }
   if (parsed == 0) {
     /* broad fallback: scan objects manually */
-    free(buf); buf=NULL; cap=4096; len=0; buf=malloc(cap); if(!buf) return -1; buf[0]=0; json_buf_append(&buf,&len,&cap,"["); first=1;
+    free(w.buf);
+    if (jw_init(&w, 4096) != 0) { gw_stats_free(gw_stats, gw_stats_count); return -1; }
+    jw_begin_arr(&w);
     const char *scan = raw; int safety=0;
     while((scan=strchr(scan,'{')) && safety<500) {
       safety++; const char *obj=scan; int od=0; const char *r=obj; while(*r){ if(*r=='{') od++; else if(*r=='}'){ od--; if(od==0){ r++; break; } } r++; }
@@ -2042,20 +2675,28 @@ static int normalize_olsrd_links(const char *raw, char **outbuf, size_t *outlen)
       if(find_json_string_value(obj,"remoteIP",&v,&vlen) || find_json_string_value(obj,"remote",&v,&vlen) || find_json_string_value(obj,"neighborIP",&v,&vlen)) snprintf(remote,sizeof(remote),"%.*s",(int)vlen,v);
       if(!remote[0]) { scan=r; continue; }
   if(remote[0]){ char rv[256]; if (resolve_ip_to_hostname(remote, rv, sizeof(rv)) == 0) snprintf(remote_host, sizeof(remote_host), "%s", rv); }
-  if(!first) json_buf_append(&buf,&len,&cap,",");
-  first=0;
-      json_buf_append(&buf,&len,&cap,"{\"intf\":\"\",\"local\":"); json_append_escaped(&buf,&len,&cap,local);
-      json_buf_append(&buf,&len,&cap,",\"remote\":"); json_append_escaped(&buf,&len,&cap,remote);
-      json_buf_append(&buf,&len,&cap,",\"remote_host\":"); json_append_escaped(&buf,&len,&cap,remote_host);
-      json_buf_append(&buf,&len,&cap,",\"lq\":\"\",\"nlq\":\"\",\"cost\":\"\",\"routes\":\"0\",\"nodes\":\"0\",\"is_default\":false}");
+      jw_begin_obj(&w);
+      JW_KEY(&w, "intf"); jw_str(&w, "");
+      JW_KEY(&w, "local"); jw_str(&w, local);
+      JW_KEY(&w, "remote"); jw_str(&w, remote);
+      JW_KEY(&w, "remote_host"); jw_str(&w, remote_host);
+      JW_KEY(&w, "lq"); jw_str(&w, "");
+      JW_KEY(&w, "nlq"); jw_str(&w, "");
+      JW_KEY(&w, "cost"); jw_str(&w, "");
+      JW_KEY(&w, "routes"); jw_str(&w, "0");
+      JW_KEY(&w, "nodes"); jw_str(&w, "0");
+      JW_KEY(&w, "is_default"); jw_bool(&w, 0);
+      jw_end_obj(&w);
       scan=r;
     }
-  json_buf_append(&buf,&len,&cap,"]"); *outbuf=buf; *outlen=len;
-  if (gw_stats) { free(gw_stats); gw_stats = NULL; gw_stats_count = 0; }
-  return 0;
+  jw_end_arr(&w);
+  gw_stats_free(gw_stats, gw_stats_count);
+  return jw_finish(&w, outbuf, outlen, NULL);
   }
-    json_buf_append(&buf,&len,&cap,"]"); *outbuf=buf; *outlen=len; if (gw_stats) { free(gw_stats); gw_stats = NULL; gw_stats_count = 0; } METRIC_SET_UNIQUE(total_unique_routes, total_unique_nodes); return 0;
-  if (gw_stats) { free(gw_stats); gw_stats = NULL; gw_stats_count = 0; }
+  jw_end_arr(&w);
+  gw_stats_free(gw_stats, gw_stats_count);
+  METRIC_SET_UNIQUE(total_unique_routes, total_unique_nodes);
+  return jw_finish(&w, outbuf, outlen, NULL);
 }
 
 /* UBNT discover output acquisition using internal discovery only */
@@ -2393,7 +3034,10 @@ static int find_json_string_value(const char *start, const char *key, char **val
     if (q >= search_end) return 0;
     if (*q == '"') {
       q++; const char *vstart = q; const char *r = q;
-      while (r < search_end && *r) {
+      while (r < search_end) {
+        /* stops at the closing quote, an escape, or NUL (a control byte) */
+        r += js_find_special(r, (size_t)(search_end - r));
+        if (r >= search_end || !*r) break;
         if (*r == '\\' && (r + 1) < search_end) { r += 2; continue; }
         if (*r == '"') {
           size_t vlen = (size_t)(r - vstart);
@@ -2517,8 +3161,6 @@ static int find_best_nodename_in_nodedb(const char *buf, size_t len, const char
 /* forward declaration for cached hostname lookup (defined later) */
 static void lookup_hostname_cached(const char *ipv4, char *out, size_t outlen);
 /* forward declarations for OLSRd proxy cache helpers */
-static int olsr_cache_get(const char *key, char *out, size_t outlen);
-static void olsr_cache_set(const char *key, const char *val);
 
 /* Normalize devices array from ubnt-discover JSON string `ud` into a new allocated JSON array in *outbuf (caller must free). */
 static int normalize_ubnt_devices(const char *ud, char **outbuf, size_t *outlen) {
@@ -2543,6 +3185,9 @@ static int normalize_ubnt_devices(const char *ud, char **outbuf, size_t *outlen)
   }
   const char *arr = strchr(p, '[');
   if (!arr) { json_buf_append(&buf,&len,&cap,"[]"); *outbuf=buf; *outlen=len; return 0; }
+  jw_t w;
+  jw_resume(&w, buf, len, cap);
+  jw_begin_arr(&w);
   /* iterate objects inside array by scanning braces */
   const char *q = arr; int depth = 0;
   while (*q) {
@@ -2586,32 +3231,35 @@ static int normalize_ubnt_devices(const char *ud, char **outbuf, size_t *outlen)
   if (find_json_string_value(obj_start, "tx_rate", &v, &vlen) || find_json_string_value(obj_start, "txrate", &v, &vlen) || find_json_string_value(obj_start, "txSpeed", &v, &vlen)) { snprintf(tx_rate, sizeof(tx_rate), "%.*s", (int)vlen, v); }
   if (find_json_string_value(obj_start, "rx_rate", &v, &vlen) || find_json_string_value(obj_start, "rxrate", &v, &vlen) || find_json_string_value(obj_start, "rxSpeed", &v, &vlen)) { snprintf(rx_rate, sizeof(rx_rate), "%.*s", (int)vlen, v); }
 
-      /* append comma if not first */
-      if (len > 2) json_buf_append(&buf, &len, &cap, ",");
-      /* append normalized object */
-      json_buf_append(&buf, &len, &cap, "{\"ipv4\":"); json_append_escaped(&buf, &len, &cap, ipv4); json_buf_append(&buf,&len,&cap, ",\"hwaddr\":"); json_append_escaped(&buf,&len,&cap, hwaddr);
-      json_buf_append(&buf,&len,&cap, ",\"hostname\":"); json_append_escaped(&buf,&len,&cap, hostname);
-      json_buf_append(&buf,&len,&cap, ",\"product\":"); json_append_escaped(&buf,&len,&cap, product);
-      json_buf_append(&buf,&len,&cap, ",\"uptime\":"); json_append_escaped(&buf,&len,&cap, uptime);
-      json_buf_append(&buf,&len,&cap, ",\"mode\":"); json_append_escaped(&buf,&len,&cap, mode);
-      json_buf_append(&buf,&len,&cap, ",\"essid\":"); json_append_escaped(&buf,&len,&cap, essid);
-  json_buf_append(&buf,&len,&cap, ",\"firmware\":"); json_append_escaped(&buf,&len,&cap, firmware);
-  json_buf_append(&buf,&len,&cap, ",\"signal\":"); json_append_escaped(&buf,&len,&cap, signal);
-  json_buf_append(&buf,&len,&cap, ",\"tx_rate\":"); json_append_escaped(&buf,&len,&cap, tx_rate);
-  json_buf_append(&buf,&len,&cap, ",\"rx_rate\":"); json_append_escaped(&buf,&len,&cap, rx_rate);
+      jw_begin_obj(&w);
+      JW_KEY(&w, "ipv4"); jw_str(&w, ipv4);
+      JW_KEY(&w, "hwaddr"); jw_str(&w, hwaddr);
+      JW_KEY(&w, "hostname"); jw_str(&w, hostname);
+      JW_KEY(&w, "product"); jw_str(&w, product);
+      JW_KEY(&w, "uptime"); jw_str(&w, uptime);
+      JW_KEY(&w, "mode"); jw_str(&w, mode);
+      JW_KEY(&w, "essid"); jw_str(&w, essid);
+      JW_KEY(&w, "firmware"); jw_str(&w, firmware);
+      JW_KEY(&w, "signal"); jw_str(&w, signal);
+      JW_KEY(&w, "tx_rate"); jw_str(&w, tx_rate);
+      JW_KEY(&w, "rx_rate"); jw_str(&w, rx_rate);
       /* mark provenance explicitly for normalized ubnt-discover entries */
-      json_buf_append(&buf,&len,&cap, ",\"source\":\"ubnt-discover\"}");
+      JW_KEY(&w, "source"); jw_str(&w, "ubnt-discover");
+      jw_end_obj(&w);
 
       q = r; continue;
     }
     q++;
   }
-  /* wrap with brackets */
-  char *full = malloc(len + 4);
-  if (!full) { free(buf); return -1; }
-  full[0] = '['; if (len>0) memcpy(full+1, buf, len); full[1+len] = ']'; full[2+len] = '\n'; full[3+len]=0;
-  free(buf);
-  *outbuf = full; *outlen = 3 + len; return 0;
+  jw_end_arr(&w);
+  if (jw_finish(&w, &buf, &len, &cap) != 0) return -1;
+  if (len + 2 > cap) {
+    char *nb = realloc(buf, len + 2);
+    if (!nb) { free(buf); return -1; }
+    buf = nb;
+  }
+  buf[len++] = '\n'; buf[len] = 0;
+  *outbuf = buf; *outlen = len; return 0;
 }
 
 /* Normalize olsrd API JSON links into simple array expected by UI
@@ -2628,8 +3276,10 @@ static int normalize_olsrd_neighbors(const char *raw, char **outbuf, size_t *out
   if (!p) p = strstr(raw, "\"link\""); /* some variants */
   const char *arr = p ? strchr(p,'[') : NULL;
   if (!arr) { arr = strchr(raw,'['); if(!arr) return -1; }
-  const char *q = arr; int depth=0; size_t cap=4096,len=0; char *buf=malloc(cap); if(!buf) return -1; buf[0]=0;
-  json_buf_append(&buf,&len,&cap,"["); int first=1;
+  const char *q = arr; int depth=0;
+  jw_t w;
+  if (jw_init(&w, 4096) != 0) return -1;
+  jw_begin_arr(&w);
   while(*q){
     if(*q=='['){ depth++; q++; continue; }
     if(*q==']'){ depth--; if(depth==0) break; q++; continue; }
@@ -2644,26 +3294,30 @@ static int normalize_olsrd_neighbors(const char *raw, char **outbuf, size_t *out
       if(find_json_string_value(obj,"linkCost",&v,&vlen) || find_json_string_value(obj,"cost",&v,&vlen)) snprintf(cost,sizeof(cost),"%.*s",(int)vlen,v);
       if(find_json_string_value(obj,"metric",&v,&vlen)) snprintf(metric,sizeof(metric),"%.*s",(int)vlen,v);
       if(originator[0]) lookup_hostname_cached(originator, hostname, sizeof(hostname));
-  if(!first) json_buf_append(&buf,&len,&cap,",");
-  first=0;
-      json_buf_append(&buf,&len,&cap,"{\"originator\":"); json_append_escaped(&buf,&len,&cap,originator);
-      json_buf_append(&buf,&len,&cap,",\"bindto\":"); json_append_escaped(&buf,&len,&cap,bindto);
-      json_buf_append(&buf,&len,&cap,",\"lq\":"); json_append_escaped(&buf,&len,&cap,lq);
-      json_buf_append(&buf,&len,&cap,",\"nlq\":"); json_append_escaped(&buf,&len,&cap,nlq);
-      json_buf_append(&buf,&len,&cap,",\"cost\":"); json_append_escaped(&buf,&len,&cap,cost);
-      json_buf_append(&buf,&len,&cap,",\"metric\":"); json_append_escaped(&buf,&len,&cap,metric);
-      json_buf_append(&buf,&len,&cap,",\"hostname\":"); json_append_escaped(&buf,&len,&cap,hostname);
-      json_buf_append(&buf,&len,&cap,"}");
+      jw_begin_obj(&w);
+      JW_KEY(&w, "originator"); jw_str(&w, originator);
+      JW_KEY(&w, "bindto"); jw_str(&w, bindto);
+      JW_KEY(&w, "lq"); jw_str(&w, lq);
+      JW_KEY(&w, "nlq"); jw_str(&w, nlq);
+      JW_KEY(&w, "cost"); jw_str(&w, cost);
+      JW_KEY(&w, "metric"); jw_str(&w, metric);
+      JW_KEY(&w, "hostname"); jw_str(&w, hostname);
+      jw_end_obj(&w);
   q=r; continue;
     }
     q++;
   }
-  json_buf_append(&buf,&len,&cap,"]"); *outbuf=buf; *outlen=len; return 0;
+  jw_end_arr(&w);
+  return jw_finish(&w, outbuf, outlen, NULL);
 }
 
 /* forward decls for local helpers used before their definitions */
 static void send_text(http_request_t *r, const char *text);
 static void send_json(http_request_t *r, const char *json);
+static int accept_binary_format(const http_request_t *r);
+static uint64_t fnv1a64(const char *s, size_t n);
+static void send_payload_as(http_request_t *r, int fmt, int slot, const payload_t *p, const char *extra);
+static void send_payload_negotiated(http_request_t *r, int slot, const payload_t *p);
 static int get_query_param(http_request_t *r, const char *key, char *out, size_t outlen);
 static void detect_olsr_processes(int *out_olsrd, int *out_olsr2);
 /* forward decls for stderr capture and log handler implemented later */
@@ -2672,6 +3326,160 @@ static void stop_stderr_capture(void);
 static int h_log(http_request_t *r);
 static void detect_olsr_processes(int *out_olsrd, int *out_olsr2);
 
+/* Facts for /versions.json that cannot change while olsrd runs. Filled on
+ * first use; the boot image digest is computed in-process once.
+ */
+static struct {
+  pthread_mutex_t lock;
+  int done;
+  const char *system_type;
+  int olsrd_exists, olsr2_exists;
+  char bootimage_md5[40];
+  char linkserial[64];
+} g_versions_static = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static void versions_static_init_locked(void) {
+  if (g_versions_static.done) return;
+  g_versions_static.system_type = path_exists("/config/wizard") ? "edge-router" : "linux-container";
+  g_versions_static.olsrd_exists = (path_exists("/usr/sbin/olsrd") || path_exists("/usr/bin/olsrd") || path_exists("/sbin/olsrd"));
+  g_versions_static.olsr2_exists = (path_exists("/usr/sbin/olsrd2") || path_exists("/usr/bin/olsrd2") || path_exists("/sbin/olsrd2"));
+  if (util_md5_file("/dev/mtdblock2", g_versions_static.bootimage_md5, sizeof(g_versions_static.bootimage_md5)) != 0)
+    snprintf(g_versions_static.bootimage_md5, sizeof(g_versions_static.bootimage_md5), "n/a");
+  /* eth0 MAC without colons, upper case (was: ip -6 link show eth0 | awk) */
+  snprintf(g_versions_static.linkserial, sizeof(g_versions_static.linkserial), "n/a");
+  char mac[64];
+  FILE *f = fopen("/sys/class/net/eth0/address", "r");
+  if (f) {
+    if (fgets(mac, sizeof(mac), f)) {
+      size_t o = 0;
+      for (const char *p = mac; *p && *p != '\n' && o + 1 < sizeof(g_versions_static.linkserial); p++)
+        if (*p != ':') g_versions_static.linkserial[o++] = (char)toupper((unsigned char)*p);
+      if (o) g_versions_static.linkserial[o] = '\0';
+    }
+    fclose(f);
+  }
+  detect_traceroute_binary();
+  g_versions_static.done = 1;
+}
+
+/* olsrd build banner: raw bytes from "olsr.org - " up to the next newline (at
+ * most OLSRD_BANNER_MAX), found with memmem over an mmap of the binary. The
+ * result is cached and only recomputed when the file's inode/mtime/size change.
+ */
+#define OLSRD_BANNER_MAX 211
+static struct {
+  pthread_mutex_t lock;
+  int valid;
+  dev_t dev; ino_t ino; time_t mtime; off_t size;
+  char banner[OLSRD_BANNER_MAX];
+  size_t n;
+} g_olsrd_banner = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static size_t olsrd_binary_banner(char *out, size_t outlen) {
+  const char *path = "/usr/sbin/olsrd";
+  struct stat st;
+  if (!out || outlen == 0 || stat(path, &st) != 0) return 0;
+  pthread_mutex_lock(&g_olsrd_banner.lock);
+  if (!g_olsrd_banner.valid || g_olsrd_banner.dev != st.st_dev || g_olsrd_banner.ino != st.st_ino ||
+      g_olsrd_banner.mtime != st.st_mtime || g_olsrd_banner.size != st.st_size) {
+    g_olsrd_banner.n = 0;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd >= 0 && st.st_size > 0) {
+      void *m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (m != MAP_FAILED) {
+        const char *hit = memmem(m, (size_t)st.st_size, "olsr.org - ", 11);
+        if (hit) {
+          const char *end = (const char *)m + st.st_size;
+          size_t n = 0;
+          while (hit + n < end && n < sizeof(g_olsrd_banner.banner) && hit[n] != '\n') n++;
+          memcpy(g_olsrd_banner.banner, hit, n);
+          g_olsrd_banner.n = n;
+        }
+        munmap(m, (size_t)st.st_size);
+      }
+    }
+    if (fd >= 0) close(fd);
+    g_olsrd_banner.valid = 1;
+    g_olsrd_banner.dev = st.st_dev; g_olsrd_banner.ino = st.st_ino;
+    g_olsrd_banner.mtime = st.st_mtime; g_olsrd_banner.size = st.st_size;
+  }
+  size_t n = g_olsrd_banner.n < outlen ? g_olsrd_banner.n : outlen;
+  memcpy(out, g_olsrd_banner.banner, n);
+  pthread_mutex_unlock(&g_olsrd_banner.lock);
+  return n;
+}
+
+/* First global-scope address of a family (was: ip -4/-6 -o addr show scope global). */
+static void first_global_addr(int family, char *out, size_t outlen) {
+  struct ifaddrs *ifa = NULL;
+  if (getifaddrs(&ifa) != 0) return;
+  for (struct ifaddrs *i = ifa; i; i = i->ifa_next) {
+    if (!i->ifa_addr || i->ifa_addr->sa_family != family) continue;
+    if (family == AF_INET) {
+      const struct in_addr *a = &((const struct sockaddr_in *)(const void *)i->ifa_addr)->sin_addr;
+      if ((ntohl(a->s_addr) >> 24) == 127) continue;
+      if (inet_ntop(AF_INET, a, out, (socklen_t)outlen)) break;
+    } else {
+      const struct in6_addr *a = &((const struct sockaddr_in6 *)(const void *)i->ifa_addr)->sin6_addr;
+      if (IN6_IS_ADDR_LOOPBACK(a) || IN6_IS_ADDR_LINKLOCAL(a)) continue;
+      if (inet_ntop(AF_INET6, a, out, (socklen_t)outlen)) break;
+    }
+  }
+  freeifaddrs(ifa);
+}
+
+static int versions_str_cmp(const void *a, const void *b) { return strcmp(*(char * const *)a, *(char * const *)b); }
+
+/* JSON array of /home entries, sorted like `ls -1`. */
+static void list_homes_json(char *out, size_t outlen) {
+  char *names[64]; int n = 0;
+  DIR *d = opendir("/home");
+  if (d) {
+    struct dirent *de;
+    while ((de = readdir(d)) && n < 64) {
+      if (de->d_name[0] == '.' || strpbrk(de->d_name, "\"\\")) continue;
+      names[n] = strdup(de->d_name);
+      if (names[n]) n++;
+    }
+    closedir(d);
+  }
+  qsort(names, (size_t)n, sizeof(names[0]), versions_str_cmp);
+  size_t o = (size_t)snprintf(out, outlen, "[");
+  for (int i = 0; i < n; i++) {
+    if (o < outlen) o += (size_t)snprintf(out + o, outlen - o, "%s\"%s\"", i ? "," : "", names[i]);
+    free(names[i]);
+  }
+  if (o < outlen) snprintf(out + o, outlen - o, "]");
+  else snprintf(out, outlen, "[]");
+}
+
+/* Version string of the bmk-webstatus CGI (was: head -n 12 | grep -m1 version= | cut -d'"' -f2). */
+static void bmk_webstatus_version(char *out, size_t outlen) {
+  DIR *d = opendir("/config/custom/www");
+  if (!d) return;
+  char best[256] = ""; char found[128] = "";
+  struct dirent *de;
+  while ((de = readdir(d))) {
+    /* glob cgi-bin-status*.php expands in sorted order; keep the first match */
+    size_t L = strlen(de->d_name);
+    if (strncmp(de->d_name, "cgi-bin-status", 14) != 0 || L < 18 || strcmp(de->d_name + L - 4, ".php") != 0) continue;
+    if (best[0] && strcmp(de->d_name, best) >= 0) continue;
+    char path[512]; snprintf(path, sizeof(path), "/config/custom/www/%s", de->d_name);
+    FILE *f = fopen(path, "r");
+    if (!f) continue;
+    char line[512];
+    for (int ln = 0; ln < 12 && fgets(line, sizeof(line), f); ln++) {
+      if (!strstr(line, "version=")) continue;
+      char *q1 = strchr(line, '"'), *q2 = q1 ? strchr(q1 + 1, '"') : NULL;
+      if (q1 && q2) { *q2 = '\0'; snprintf(found, sizeof(found), "%s", q1 + 1); snprintf(best, sizeof(best), "%s", de->d_name); }
+      break;
+    }
+    fclose(f);
+  }
+  closedir(d);
+  if (found[0]) snprintf(out, outlen, "%s", found);
+}
+
 /* Generate versions JSON into an allocated buffer (caller frees) */
 static int generate_versions_json(char **outbuf, size_t *outlen) {
   if (!outbuf || !outlen) return -1;
@@ -2690,11 +3498,14 @@ static int generate_versions_json(char **outbuf, size_t *outlen) {
     return 0;
   }
   pthread_mutex_unlock(&versions_cache_lock);
+  /* immutable facts (computed once), then the cheap dynamic ones; no process spawns */
+  pthread_mutex_lock(&g_versions_static.lock);
+  versions_static_init_locked();
+  pthread_mutex_unlock(&g_versions_static.lock);
+  const char *system_type = g_versions_static.system_type;
+  int olsrd_exists = g_versions_static.olsrd_exists, olsr2_exists = g_versions_static.olsr2_exists;
   char host[256] = ""; gethostname(host, sizeof(host)); host[sizeof(host)-1]=0;
   int olsrd_on=0, olsr2_on=0; detect_olsr_processes(&olsrd_on,&olsr2_on);
-  /* detect whether olsrd / olsrd2 binaries exist on filesystem (best-effort) */
-  int olsrd_exists = (path_exists("/usr/sbin/olsrd") || path_exists("/usr/bin/olsrd") || path_exists("/sbin/olsrd"));
-  int olsr2_exists = (path_exists("/usr/sbin/olsrd2") || path_exists("/usr/bin/olsrd2") || path_exists("/sbin/olsrd2"));
 
   /* autoupdate wizard info */
   const char *au_path = "/etc/cron.daily/autoupdatewizards";
@@ -2711,24 +3522,8 @@ static int generate_versions_json(char **outbuf, size_t *outlen) {
     if (memmem(adu_dat, adu_n, "wizard-blockPrivate=yes", 24)) aabp_on = 1;
   }
 
-  /* homes */
-  char *homes_out = NULL; size_t homes_n = 0;
-  if (util_exec("/bin/ls -1 /home 2>/dev/null | awk '{printf \"\\\"%s\\\",\", $0}' | sed 's/,$/\\n/'", &homes_out, &homes_n) != 0) {
-    if (homes_out) { free(homes_out); homes_out = NULL; homes_n = 0; }
-  }
-  if (!homes_out) { homes_out = strdup("\n"); homes_n = homes_out ? strlen(homes_out) : 0; }
-
-  /* md5 */
-  char *md5_out = NULL; size_t md5_n = 0;
-  if (util_exec("/usr/bin/md5sum /dev/mtdblock2 2>/dev/null | cut -f1 -d' '", &md5_out, &md5_n) != 0) { if (md5_out) { free(md5_out); md5_out = NULL; md5_n = 0; } }
-
-  const char *system_type = path_exists("/config/wizard") ? "edge-router" : "linux-container";
-
-  /* bmk-webstatus */
-  char *bmk_out = NULL; size_t bmk_n = 0; char bmkwebstatus[128] = "n/a";
-  if (util_exec("head -n 12 /config/custom/www/cgi-bin-status*.php 2>/dev/null | grep -m1 version= | cut -d'\"' -f2", &bmk_out, &bmk_n) == 0 && bmk_out && bmk_n>0) {
-    char *t = strndup(bmk_out, (size_t)bmk_n); if (t) { char *nl = strchr(t,'\n'); if (nl) *nl = 0; strncpy(bmkwebstatus, t, sizeof(bmkwebstatus)-1); free(t); }
-  }
+  char homes_json[512] = "[]"; list_homes_json(homes_json, sizeof(homes_json));
+  char bmkwebstatus[128] = "n/a"; bmk_webstatus_version(bmkwebstatus, sizeof(bmkwebstatus));
 
   /* olsrd4watchdog */
   int olsrd4watchdog = 0; char *olsrd4conf = NULL; size_t olsrd4_n = 0;
@@ -2739,17 +3534,8 @@ static int generate_versions_json(char **outbuf, size_t *outlen) {
 
   /* ips */
   char ipv4_addr[64] = "n/a", ipv6_addr[128] = "n/a";
-  char *tmp_out = NULL; size_t tmp_n = 0;
-  if (util_exec("ip -4 -o addr show scope global | awk '{print $4; exit}' | cut -d/ -f1", &tmp_out, &tmp_n) == 0 && tmp_out && tmp_n>0) { char *t = strndup(tmp_out, tmp_n); if (t) { char *nl = strchr(t,'\n'); if (nl) *nl = 0; strncpy(ipv4_addr, t, sizeof(ipv4_addr)-1); free(t); } free(tmp_out); tmp_out=NULL; tmp_n=0; }
-  if (util_exec("ip -6 -o addr show scope global | awk '{print $4; exit}' | cut -d/ -f1", &tmp_out, &tmp_n) == 0 && tmp_out && tmp_n>0) { char *t = strndup(tmp_out, tmp_n); if (t) { char *nl = strchr(t,'\n'); if (nl) *nl = 0; strncpy(ipv6_addr, t, sizeof(ipv6_addr)-1); free(t); } free(tmp_out); tmp_out=NULL; tmp_n=0; }
-
-  /* linkserial */
-  char linkserial[128] = "n/a"; char *ll_out = NULL; size_t ll_n = 0;
-  if (util_exec("ip -6 link show eth0 2>/dev/null | grep link/ether | awk '{gsub(\":\",\"\", $2); print toupper($2)}'", &ll_out, &ll_n) == 0 && ll_out && ll_n>0) {
-    char *t = strndup(ll_out, ll_n);
-    if (t) { char *nl = strchr(t,'\n'); if (nl) *nl=0; strncpy(linkserial, t, sizeof(linkserial)-1); free(t); }
-    if (ll_out) free(ll_out);
-  }
+  first_global_addr(AF_INET, ipv4_addr, sizeof(ipv4_addr));
+  first_global_addr(AF_INET6, ipv6_addr, sizeof(ipv6_addr));
 
   /* Attempt to extract olsrd binary/version information (best-effort). Keep fields small and safe. */
   char olsrd_ver[256] = "";
@@ -2758,8 +3544,8 @@ static int generate_versions_json(char **outbuf, size_t *outlen) {
   char olsrd_date[64] = "";
   char olsrd_rel[64] = "";
   char olsrd_src[256] = "";
-  char *ols_out = NULL; size_t ols_n = 0;
-  if (util_exec("grep -oaEm1 'olsr.org - .{1,200}' /usr/sbin/olsrd 2>/dev/null", &ols_out, &ols_n) == 0 && ols_out && ols_n>0) {
+  char ols_out[OLSRD_BANNER_MAX]; size_t ols_n = olsrd_binary_banner(ols_out, sizeof(ols_out));
+  if (ols_n > 0) {
     char *s = strndup(ols_out, ols_n);
     if (s) {
       for (char *p = s; *p; ++p) { if ((unsigned char)*p < 0x20) *p = ' '; }
@@ -2775,17 +3561,14 @@ static int generate_versions_json(char **outbuf, size_t *outlen) {
       }
       free(s);
     }
-    free(ols_out); ols_out = NULL; ols_n = 0;
   }
 
-  detect_traceroute_binary();
   /* Build JSON */
-  size_t buf_sz = 4096 + (homes_n>0?homes_n:0) + (md5_n>0?md5_n:0);
+  size_t buf_sz = 4096 + sizeof(homes_json);
   char *obuf = malloc(buf_sz);
-  if (!obuf) { if (adu_dat) free(adu_dat); if (homes_out) free(homes_out); if (md5_out) free(md5_out); return -1; }
-  char homes_json[512] = "[]";
-  if (homes_out && homes_n>0) { size_t hn = homes_n; char *tmp = strndup(homes_out, homes_n); if (tmp) { while (hn>0 && (tmp[hn-1]=='\n' || tmp[hn-1]==',')) { tmp[--hn]=0; } snprintf(homes_json,sizeof(homes_json),"[%s]", tmp[0]?tmp:"" ); free(tmp); } }
-  char bootimage_md5[128] = "n/a"; if (md5_out && md5_n>0) { char *m = strndup(md5_out, md5_n); if (m) { char *nl = strchr(m,'\n'); if (nl) *nl=0; strncpy(bootimage_md5, m, sizeof(bootimage_md5)-1); free(m); } }
+  if (!obuf) { if (adu_dat) free(adu_dat); return -1; }
+  const char *bootimage_md5 = g_versions_static.bootimage_md5;
+  const char *linkserial = g_versions_static.linkserial;
   snprintf(obuf, buf_sz,
     "{\"host\":\"%s\",\"system\":\"%s\",\"olsrd_running\":%s,\"olsr2_running\":%s,\"olsrd_exists\":%s,\"olsr2_exists\":%s,\"olsrd4watchdog\":%s,\"autoupdate_wizards_installed\":\"%s\",\"autoupdate_settings\":{\"auto_update_enabled\":%s,\"olsrd_v1\":%s,\"olsrd_v2\":%s,\"wsle\":%s,\"ebtables\":%s,\"blockpriv\":%s},\"homes\":%s,\"bootimage\":{\"md5\":\"%s\"},\"bmk_webstatus\":\"%s\",\"ipv4\":\"%s\",\"ipv6\":\"%s\",\"linkserial\":\"%s\",\"olsrd\":\"%s\",\"olsrd_details\":{\"version\":\"%s\",\"description\":\"%s\",\"device\":\"%s\",\"date\":\"%s\",\"release\":\"%s\",\"source\":\"%s\"}}\n",
     host,
@@ -2818,8 +3601,6 @@ static int generate_versions_json(char **outbuf, size_t *outlen) {
   );
 
   if (adu_dat) free(adu_dat);
-  if (homes_out) free(homes_out);
-  if (md5_out) free(md5_out);
   *outbuf = obuf; *outlen = strlen(obuf);
   /* update cache (store a copy) */
   pthread_mutex_lock(&versions_cache_lock);
@@ -2831,57 +3612,304 @@ static int generate_versions_json(char **outbuf, size_t *outlen) {
   return 0;
 }
 
-/* Robust detection of olsrd / olsrd2 processes for diverse environments (EdgeRouter, containers, musl) */
-static void detect_olsr_processes(int *out_olsrd, int *out_olsr2) {
-  if(out_olsrd) {
-    *out_olsrd = 0;
-  }
-  if(out_olsr2) {
-    *out_olsr2 = 0;
-  }
-  char *out=NULL; size_t on=0;
-  if(out_olsr2 && util_exec("pidof olsrd2 2>/dev/null", &out,&on)==0 && out && on>0){ *out_olsr2=1; }
-  if(out){ free(out); out=NULL; on=0; }
-  if(out_olsrd && util_exec("pidof olsrd 2>/dev/null", &out,&on)==0 && out && on>0){ *out_olsrd=1; }
-  if(out){ free(out); out=NULL; on=0; }
-  if( (out_olsrd && *out_olsrd) || (out_olsr2 && *out_olsr2) ) return;
-  /* Fallback: parse ps output (works even when pidof missing or wrapper used) */
-  if(util_exec("ps -o pid= -o comm= -o args= 2>/dev/null", &out,&on)!=0 || !out){
-    if(out){ free(out); out=NULL; on=0; }
-    util_exec("ps 2>/dev/null", &out,&on); /* busybox minimal */
-  }
-  if(out){
-    const char *needle2="olsrd2"; const char *needle1="olsrd"; /* order: check olsrd2 first to avoid substring confusion */
-    const char *p=out;
-    while(p && *p){
-      const char *line_end=strchr(p,'\n'); if(!line_end) line_end=p+strlen(p);
-      if(line_end>p){
-        if(out_olsr2 && !*out_olsr2){ if(strstr(p,needle2)) *out_olsr2=1; }
-        if(out_olsrd && !*out_olsrd){ if(strstr(p,needle1) && !strstr(p,needle2)) *out_olsrd=1; }
-        if( (out_olsrd && *out_olsrd) && (out_olsr2 && *out_olsr2) ) break;
-      }
-      if(*line_end==0) break; else p=line_end+1;
-    }
-    free(out);
+/* Cached olsrd / olsrd2 process state. A full /proc walk only happens when a
+ * known pid disappears or, for daemons not running, every OLSR_PROC_RESCAN_S.
+ * Known pids are revalidated through a pidfd (readable once the process exits)
+ * or, without pidfd support, by re-reading their stat and comparing starttime.
+ */
+#define OLSR_PROC_RESCAN_S 10
+static struct {
+  pthread_mutex_t lock;
+  int init;
+  int self;                 /* the plugin is loaded into olsrd itself */
+  int found[2];             /* [0] olsrd, [1] olsrd2 */
+  procscan_info_t info[2];
+  int pidfd[2];
+  time_t scanned;
+} g_olsr_procs = { .lock = PTHREAD_MUTEX_INITIALIZER, .pidfd = { -1, -1 } };
+
+static int olsr_proc_open_pidfd(int pid) {
+#ifdef SYS_pidfd_open
+  return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+  (void)pid; return -1;
+#endif
+}
+
+static int olsr_proc_alive(int i) {
+  if (g_olsr_procs.pidfd[i] >= 0) {
+    struct pollfd pfd = { g_olsr_procs.pidfd[i], POLLIN, 0 };
+    return poll(&pfd, 1, 0) == 0;
   }
+  procscan_info_t cur;
+  return procscan_read(g_olsr_procs.info[i].pid, &cur) == 0 && cur.start_ticks == g_olsr_procs.info[i].start_ticks;
 }
 
-static int h_airos(http_request_t *r);
+/* Caller holds g_olsr_procs.lock. */
+static void olsr_proc_refresh_locked(void) {
+  time_t now = time(NULL);
+  if (!g_olsr_procs.init) {
+    char comm[32];
+    g_olsr_procs.init = 1;
+    /* running inside olsrd: the olsrd case needs no scanning at all */
+    if (procscan_comm(0, comm, sizeof(comm)) == 0 && strcmp(comm, "olsrd") == 0 && procscan_read(getpid(), &g_olsr_procs.info[0]) == 0) {
+      g_olsr_procs.self = 1; g_olsr_procs.found[0] = 1;
+    }
+  }
+  int need_scan = 0;
+  for (int i = 0; i < 2; i++) {
+    if (i == 0 && g_olsr_procs.self) continue;
+    if (g_olsr_procs.found[i] && !olsr_proc_alive(i)) need_scan = 1;
+    else if (!g_olsr_procs.found[i] && now - g_olsr_procs.scanned >= OLSR_PROC_RESCAN_S) need_scan = 1;
+  }
+  if (!need_scan) return;
+  static const char *const names[2] = { "olsrd", "olsrd2" };
+  procscan_info_t info[2]; memset(info, 0, sizeof(info));
+  unsigned got = procscan_find(names + g_olsr_procs.self, 2 - g_olsr_procs.self, info + g_olsr_procs.self);
+  if (g_olsr_procs.self) got <<= 1;
+  for (int i = g_olsr_procs.self; i < 2; i++) {
+    int hit = (got >> i) & 1;
+    if (hit && g_olsr_procs.found[i] && g_olsr_procs.info[i].pid == info[i].pid && g_olsr_procs.info[i].start_ticks == info[i].start_ticks) continue;
+    if (g_olsr_procs.pidfd[i] >= 0) { close(g_olsr_procs.pidfd[i]); g_olsr_procs.pidfd[i] = -1; }
+    g_olsr_procs.found[i] = hit;
+    if (hit) { g_olsr_procs.info[i] = info[i]; g_olsr_procs.pidfd[i] = olsr_proc_open_pidfd(info[i].pid); }
+  }
+  g_olsr_procs.scanned = now;
+}
 
-/* Full /status endpoint */
-static int h_status(http_request_t *r) {
-  char *buf = NULL; size_t cap = 16384, len = 0; buf = malloc(cap); if(!buf){ send_json(r, "{}\n"); return 0; } buf[0]=0;
-  #define APPEND(fmt,...) do { if (json_appendf(&buf, &len, &cap, fmt, ##__VA_ARGS__) != 0) { free(buf); send_json(r,"{}\n"); return 0; } } while(0)
+/* Snapshot of the olsrd (which=0) / olsrd2 (which=1) process with fresh uptime/RSS. */
+static int olsr_proc_info(int which, procscan_info_t *out) {
+  pthread_mutex_lock(&g_olsr_procs.lock);
+  olsr_proc_refresh_locked();
+  int ok = g_olsr_procs.found[which];
+  int pid = g_olsr_procs.info[which].pid;
+  pthread_mutex_unlock(&g_olsr_procs.lock);
+  return ok && procscan_read(pid, out) == 0 ? 0 : -1;
+}
 
-  /* Build JSON */
-  APPEND("{");
+/* Detection of olsrd / olsrd2 processes (cached, no fork/exec). */
+static void detect_olsr_processes(int *out_olsrd, int *out_olsr2) {
+  pthread_mutex_lock(&g_olsr_procs.lock);
+  olsr_proc_refresh_locked();
+  if (out_olsrd) *out_olsrd = g_olsr_procs.found[0];
+  if (out_olsr2) *out_olsr2 = g_olsr_procs.found[1];
+  pthread_mutex_unlock(&g_olsr_procs.lock);
+}
 
-  /* hostname */
-  char hostname[256] = ""; if (gethostname(hostname, sizeof(hostname))==0) hostname[sizeof(hostname)-1]=0;
+static int h_airos(http_request_t *r);
 
-  /* primary IPv4: pick first non-loopback IPv4 */
-  char ipaddr[128] = "";
-  struct ifaddrs *ifap = NULL, *ifa = NULL;
+/* Full /status endpoint */
+/* --- /status sections ---
+ * /status is assembled from a fixed list of sections. Each producer appends
+ * one or more top-level members ("key":value, comma separated) to the body;
+ * inputs several sections share (OLSR fetches, default route, process
+ * detection) are loaded on first use through the request context, so a
+ * section that is not requested never pays for them. ?fields=a,b.c selects
+ * sections by name or key and projects nested objects by dotted path.
+ *
+ * Sections are cached as serialized fragments for their TTL. Each also
+ * declares the inputs it is derived from; an input's generation moves when a
+ * fetch returns different content (or, for state kept elsewhere, when its
+ * owner's version changes), which makes every dependent fragment stale early.
+ * Fetched inputs of fragments that are still within their TTL are loaded
+ * before freshness is judged, so a change shows up in the next request; the
+ * producers that then run reuse those loads through the context.
+ *
+ * Caches this layer sits on rather than replaces: the whole-response
+ * coalescers (/status itself, 1 s), local_http_get (1 s, so a burst of
+ * requests shares one olsrd fetch), generate_versions_json (2 s, shared with
+ * /status/lite and /versions.json) and the ARP JSON snapshot
+ * (arp_cache_ttl_s, shared with /status/lite).
+ */
+enum { SIN_OLSR_PROC, SIN_LINKS, SIN_NEIGHBORS, SIN_ROUTES, SIN_DEFROUTE, SIN_NODEDB, SIN_DEVICES, SIN_TRACE, SIN_COUNT };
+#define SIN(x) (1u << (x))
+
+static pthread_mutex_t g_status_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t g_sin_hash[SIN_COUNT];
+static unsigned long g_sin_gen[SIN_COUNT];
+
+/* Record the content an input was just loaded with. */
+static void status_input_seen(int in, const void *data, size_t n) {
+  uint64_t h = fnv1a64(data ? (const char *)data : "", data ? n : 0);
+  pthread_mutex_lock(&g_status_cache_lock);
+  if (h != g_sin_hash[in]) { g_sin_hash[in] = h; g_sin_gen[in]++; }
+  pthread_mutex_unlock(&g_status_cache_lock);
+}
+
+/* Current generation of an input; called with g_status_cache_lock held. */
+static unsigned long status_input_gen(int in) {
+  switch (in) {
+    case SIN_NODEDB: { pthread_mutex_lock(&g_nodedb_lock); unsigned long v = (unsigned long)g_nodedb_last_fetch; pthread_mutex_unlock(&g_nodedb_lock); return v; }
+    case SIN_DEVICES: { pthread_mutex_lock(&g_devices_cache_lock); unsigned long v = (unsigned long)g_devices_cache_ts; pthread_mutex_unlock(&g_devices_cache_lock); return v; }
+    case SIN_TRACE: { trace_monitor_stats_t ts; trace_monitor_get_stats(&ts); return ts.runs; }
+    default: return g_sin_gen[in];
+  }
+}
+
+/* Sections may run on several workers at once: each input is loaded by the
+ * first producer asking for it (state 0 -> 1 -> 2) while the others wait.
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  int olsr_done, olsrd_on, olsr2_on;
+  int links_done; payload_t *links;
+  int neighbors_done; payload_t *neighbors;
+  int routes_done; payload_t *routes;
+  int route_done; char def_ip[64], def_dev[64];
+  int host_done; char hostname[256];
+  int uptime_done; long uptime;
+} status_ctx_t;
+
+static void status_ctx_init(status_ctx_t *c) {
+  memset(c, 0, sizeof(*c));
+  pthread_mutex_init(&c->lock, NULL);
+  pthread_cond_init(&c->cond, NULL);
+}
+
+static void status_ctx_free(status_ctx_t *c) {
+  payload_unref(c->links); payload_unref(c->neighbors); payload_unref(c->routes);
+  pthread_cond_destroy(&c->cond);
+  pthread_mutex_destroy(&c->lock);
+}
+
+/* 1 when the caller has to load the input, which it then marks loaded. */
+static int status_ctx_claim(status_ctx_t *c, int *state) {
+  pthread_mutex_lock(&c->lock);
+  while (*state == 1) pthread_cond_wait(&c->cond, &c->lock);
+  int mine = *state == 0;
+  if (mine) *state = 1;
+  pthread_mutex_unlock(&c->lock);
+  return mine;
+}
+
+static void status_ctx_loaded(status_ctx_t *c, int *state) {
+  pthread_mutex_lock(&c->lock);
+  *state = 2;
+  pthread_cond_broadcast(&c->cond);
+  pthread_mutex_unlock(&c->lock);
+}
+
+static void status_ctx_olsr(status_ctx_t *c) {
+  if (!status_ctx_claim(c, &c->olsr_done)) return;
+  detect_olsr_processes(&c->olsrd_on, &c->olsr2_on);
+  int flags[2] = { c->olsrd_on, c->olsr2_on };
+  status_input_seen(SIN_OLSR_PROC, flags, sizeof(flags));
+  if (c->olsr2_on) fprintf(stderr,"[status-plugin] detected olsrd2 (robust)\n");
+  if (c->olsrd_on) fprintf(stderr,"[status-plugin] detected olsrd (robust)\n");
+  if (!c->olsrd_on && !c->olsr2_on) fprintf(stderr,"[status-plugin] no OLSR process detected (robust path)\n");
+  status_ctx_loaded(c, &c->olsr_done);
+}
+
+/* fetch links (for either implementation); do not toggle olsr2_on based on HTTP success */
+static const char *status_ctx_links(status_ctx_t *c) {
+  if (!status_ctx_claim(c, &c->links_done)) return c->links ? c->links->data : NULL;
+  const char *endpoints[]={"http://127.0.0.1:9090/links","http://127.0.0.1:2006/links","http://127.0.0.1:8123/links",NULL};
+  for (const char **ep=endpoints; *ep; ++ep) {
+    fprintf(stderr,"[status-plugin] trying OLSR endpoint: %s\n", *ep);
+    c->links = local_http_get(*ep, 1);
+    if (c->links && c->links->len > 0) {
+      fprintf(stderr,"[status-plugin] fetched OLSR links from %s (%zu bytes)\n", *ep, c->links->len);
+      break;
+    }
+    payload_unref(c->links); c->links = NULL;
+  }
+  status_input_seen(SIN_LINKS, c->links ? c->links->data : NULL, c->links ? c->links->len : 0);
+  status_ctx_loaded(c, &c->links_done);
+  return c->links ? c->links->data : NULL;
+}
+
+static const char *status_ctx_fetch(status_ctx_t *c, int in, const char *url, int *done, payload_t **raw) {
+  if (!status_ctx_claim(c, done)) return *raw ? (*raw)->data : NULL;
+  *raw = local_http_get(url, 1);
+  if (*raw && (*raw)->len == 0) { payload_unref(*raw); *raw = NULL; }
+  status_input_seen(in, *raw ? (*raw)->data : NULL, *raw ? (*raw)->len : 0);
+  status_ctx_loaded(c, done);
+  return *raw ? (*raw)->data : NULL;
+}
+#define status_ctx_neighbors(c) status_ctx_fetch((c), SIN_NEIGHBORS, "http://127.0.0.1:9090/neighbors", &(c)->neighbors_done, &(c)->neighbors)
+#define status_ctx_routes(c) status_ctx_fetch((c), SIN_ROUTES, "http://127.0.0.1:9090/routes", &(c)->routes_done, &(c)->routes)
+
+static void status_ctx_route(status_ctx_t *c) {
+  if (!status_ctx_claim(c, &c->route_done)) return;
+  char *rout=NULL; size_t rn=0;
+  if (ip_route_default(&rout,&rn)==0 && rout) {
+    char *p=strstr(rout,"via "); if(p){ p+=4; char *q=strchr(p,' '); if(q){ size_t L=q-p; if(L<sizeof(c->def_ip)){ memcpy(c->def_ip,p,L); c->def_ip[L]=0; } } }
+    p=strstr(rout," dev "); if(p){ p+=5; char *q=strchr(p,' '); if(!q) q=strchr(p,'\n'); if(q){ size_t L=q-p; if(L<sizeof(c->def_dev)){ memcpy(c->def_dev,p,L); c->def_dev[L]=0; } } }
+    free(rout);
+  }
+  char seen[sizeof(c->def_ip) + sizeof(c->def_dev)];
+  int sn = snprintf(seen, sizeof(seen), "%s %s", c->def_ip, c->def_dev);
+  status_input_seen(SIN_DEFROUTE, seen, (size_t)sn);
+  status_ctx_loaded(c, &c->route_done);
+}
+
+/* Load a fetched input into the context; owner-versioned inputs are read in
+ * status_input_gen instead.
+ */
+static void status_ctx_load(status_ctx_t *c, int in) {
+  switch (in) {
+    case SIN_OLSR_PROC: status_ctx_olsr(c); break;
+    case SIN_LINKS: status_ctx_links(c); break;
+    case SIN_NEIGHBORS: status_ctx_neighbors(c); break;
+    case SIN_ROUTES: status_ctx_routes(c); break;
+    case SIN_DEFROUTE: status_ctx_route(c); break;
+    default: break;
+  }
+}
+
+static const char *status_ctx_hostname(status_ctx_t *c) {
+  if (status_ctx_claim(c, &c->host_done)) {
+    if (gethostname(c->hostname, sizeof(c->hostname)) == 0) c->hostname[sizeof(c->hostname)-1] = 0;
+    else c->hostname[0] = 0;
+    status_ctx_loaded(c, &c->host_done);
+  }
+  return c->hostname;
+}
+
+static long status_ctx_uptime(status_ctx_t *c) {
+  if (status_ctx_claim(c, &c->uptime_done)) { c->uptime = get_uptime_seconds(); status_ctx_loaded(c, &c->uptime_done); }
+  return c->uptime;
+}
+
+/* Producers return 0 after appending, 1 when they have nothing to add and -1
+ * when the buffer could not grow.
+ */
+typedef int (*status_producer_fn)(status_ctx_t *c, char **buf, size_t *len, size_t *cap);
+#define SAPPEND(fmt,...) do { if (json_appendf(buf, len, cap, fmt, ##__VA_ARGS__) != 0) return -1; } while(0)
+#define SESC(s) do { if (json_append_escaped(buf, len, cap, (s)) != 0) return -1; } while(0)
+
+static int st_fetch_stats(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  (void)c;
+  int qlen = 0; struct fetch_req *fit = NULL; unsigned long m_d=0, m_r=0, m_s=0;
+  pthread_mutex_lock(&g_fetch_q_lock);
+  fit = g_fetch_q_head; while (fit) { qlen++; fit = fit->next; }
+  pthread_mutex_unlock(&g_fetch_q_lock);
+  METRIC_LOAD_ALL(m_d, m_r, m_s);
+  unsigned long _de=0,_den=0,_ded=0,_dp=0,_dpn=0,_dpd=0;
+  DEBUG_LOAD_ALL(_de,_den,_ded,_dp,_dpn,_dpd);
+  unsigned long _ur = 0, _un = 0; METRIC_LOAD_UNIQUE(_ur, _un);
+  SAPPEND("\"fetch_stats\":{\"queue_length\":%d,\"dropped\":%lu,\"retries\":%lu,\"successes\":%lu,\"enqueued\":%lu,\"enqueued_nodedb\":%lu,\"enqueued_discover\":%lu,\"processed\":%lu,\"processed_nodedb\":%lu,\"processed_discover\":%lu,\"unique_routes\":%lu,\"unique_nodes\":%lu,\"thresholds\":{\"queue_warn\":%d,\"queue_crit\":%d,\"dropped_warn\":%d}}", qlen, m_d, m_r, m_s, _de, _den, _ded, _dp, _dpn, _dpd, _ur, _un, g_fetch_queue_warn, g_fetch_queue_crit, g_fetch_dropped_warn);
+  return 0;
+}
+
+/* include suggested UI autos-refresh ms */
+static int st_fetch_auto_refresh(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  (void)c;
+  SAPPEND("\"fetch_auto_refresh_ms\":%d", g_fetch_auto_refresh_ms);
+  return 0;
+}
+
+static int st_hostname(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  SAPPEND("\"hostname\":"); SESC(status_ctx_hostname(c));
+  return 0;
+}
+
+/* primary IPv4: pick first non-loopback IPv4 */
+static int st_ip(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  (void)c;
+  char ipaddr[128] = "";
+  struct ifaddrs *ifap = NULL, *ifa = NULL;
   if (getifaddrs(&ifap) == 0) {
     for (ifa = ifap; ifa; ifa = ifa->ifa_next) {
       if (!ifa->ifa_addr) continue;
@@ -2896,438 +3924,632 @@ static int h_status(http_request_t *r) {
     }
     freeifaddrs(ifap);
   }
+  SAPPEND("\"ip\":"); SESC(ipaddr);
+  return 0;
+}
 
-  /* uptime in seconds */
-  long uptime_seconds = get_uptime_seconds();
+static int st_uptime(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  SAPPEND("\"uptime\":\"%ld\"", status_ctx_uptime(c));
+  return 0;
+}
 
-  /* airosdata */
-  char *airos_raw = NULL; size_t airos_n = 0;
-  (void)airos_n; /* kept for symmetry with util_read_file signature */
-  util_read_file("/tmp/10-all.json", &airos_raw, &airos_n); /* ignore result; airos_raw may be NULL */
+/* versions: use internal generator rather than external script */
+static int st_versions(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  (void)c;
+  char *v = NULL; size_t vn = 0;
+  int rc = 0;
+  if (generate_versions_json(&v, &vn) == 0 && v && vn > 0) rc = json_appendf(buf, len, cap, "\"versions\":%s", v);
+  else rc = json_appendf(buf, len, cap, "\"versions\":{\"olsrd\":\"unknown\",\"system\":\"linux-container\"}"); /* basic fallback for Linux container */
+  free(v);
+  return rc != 0 ? -1 : 0;
+}
 
-  /* Generate versions JSON early (reusable helper) */
-  char *vgen = NULL; size_t vgen_n = 0;
-  (void)vgen_n;
-  if (generate_versions_json(&vgen, &vgen_n) != 0) { if (vgen) { free(vgen); vgen = NULL; vgen_n = 0; } }
+/* human readable uptime string, prefer python-like format */
+static int st_uptime_str(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  char uptime_str[64] = ""; format_duration(status_ctx_uptime(c), uptime_str, sizeof(uptime_str));
+  SAPPEND("\"uptime_str\":"); SESC(uptime_str);
+  return 0;
+}
 
-  /* fetch queue and metrics */
-  int qlen = 0; struct fetch_req *fit = NULL; unsigned long m_d=0, m_r=0, m_s=0;
-  pthread_mutex_lock(&g_fetch_q_lock);
-  fit = g_fetch_q_head; while (fit) { qlen++; fit = fit->next; }
-  pthread_mutex_unlock(&g_fetch_q_lock);
-  METRIC_LOAD_ALL(m_d, m_r, m_s);
+static int st_uptime_linux(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  char uptime_linux[160] = ""; format_uptime_linux(status_ctx_uptime(c), uptime_linux, sizeof(uptime_linux));
+  SAPPEND("\"uptime_linux\":"); SESC(uptime_linux);
+  return 0;
+}
 
-  /* default route */
-  char def_ip[64] = ""; char def_dev[64] = ""; char *rout=NULL; size_t rn=0;
-  if (util_exec("/sbin/ip route show default 2>/dev/null || /usr/sbin/ip route show default 2>/dev/null || ip route show default 2>/dev/null", &rout,&rn)==0 && rout) {
-    char *p=strstr(rout,"via "); if(p){ p+=4; char *q=strchr(p,' '); if(q){ size_t L=q-p; if(L<sizeof(def_ip)){ strncpy(def_ip,p,L); def_ip[L]=0; } } }
-    p=strstr(rout," dev "); if(p){ p+=5; char *q=strchr(p,' '); if(!q) q=strchr(p,'\n'); if(q){ size_t L=q-p; if(L<sizeof(def_dev)){ strncpy(def_dev,p,L); def_dev[L]=0; } } }
-    free(rout);
+/* Devices: prefer cached devices populated by background worker to avoid blocking */
+static int st_devices(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  (void)c;
+  payload_t *dp = NULL;
+  pthread_mutex_lock(&g_devices_cache_lock);
+  if (g_devices_cache && g_devices_cache->len > 0) {
+    /* consider cache stale if older than g_ubnt_cache_ttl_s */
+    time_t nowt = time(NULL);
+    if (g_ubnt_cache_ttl_s <= 0 || (nowt - g_devices_cache_ts) <= g_ubnt_cache_ttl_s) {
+      dp = payload_get(&g_devices_cache);
+    } else {
+      /* stale: treat as absent */
+      if (g_fetch_log_queue || g_fetch_log_force) fprintf(stderr, "[status-plugin] devices cache stale (age=%lds > %ds)\n", (long)(nowt - g_devices_cache_ts), g_ubnt_cache_ttl_s);
+    }
   }
-
-  {
-    unsigned long _de=0,_den=0,_ded=0,_dp=0,_dpn=0,_dpd=0;
-    DEBUG_LOAD_ALL(_de,_den,_ded,_dp,_dpn,_dpd);
-  unsigned long _ur = 0, _un = 0; METRIC_LOAD_UNIQUE(_ur, _un);
-  APPEND("\"fetch_stats\":{\"queue_length\":%d,\"dropped\":%lu,\"retries\":%lu,\"successes\":%lu,\"enqueued\":%lu,\"enqueued_nodedb\":%lu,\"enqueued_discover\":%lu,\"processed\":%lu,\"processed_nodedb\":%lu,\"processed_discover\":%lu,\"unique_routes\":%lu,\"unique_nodes\":%lu,\"thresholds\":{\"queue_warn\":%d,\"queue_crit\":%d,\"dropped_warn\":%d}},", qlen, m_d, m_r, m_s, _de, _den, _ded, _dp, _dpn, _dpd, _ur, _un, g_fetch_queue_warn, g_fetch_queue_crit, g_fetch_dropped_warn);
+  pthread_mutex_unlock(&g_devices_cache_lock);
+  if (dp) {
+    int rc = json_appendf(buf, len, cap, "\"devices\":%s", dp->data);
+    payload_unref(dp);
+    return rc != 0 ? -1 : 0;
   }
-  /* include suggested UI autos-refresh ms */
-  APPEND("\"fetch_auto_refresh_ms\":%d,", g_fetch_auto_refresh_ms);
+  /* fallback to inline discovery if cache not ready */
+  int rc;
+  char *ud = NULL; size_t udn = 0;
+  if (ubnt_discover_output(&ud, &udn) == 0 && ud && udn > 0) {
+    fprintf(stderr, "[status-plugin] got device data from ubnt-discover (inline %zu bytes)\n", udn);
+    /* Mirror message into ubnt debug channel for parity with background worker */
+    if (ubnt_debug_enabled()) plugin_log_trace("ubnt: got device data from ubnt-discover (inline %zu bytes)", udn);
+    char *normalized = NULL; size_t nlen = 0;
+    if (normalize_ubnt_devices(ud, &normalized, &nlen) == 0 && normalized) {
+      rc = json_appendf(buf, len, cap, "\"devices\":%s", normalized);
+      free(normalized);
+    } else rc = json_appendf(buf, len, cap, "\"devices\":[]");
+    free(ud);
+  } else rc = json_appendf(buf, len, cap, "\"devices\":[]");
+  return rc != 0 ? -1 : 0;
+}
+
+/* links: normalized from the olsrd API (with the routes section appended so
+ * the normalizer can count routes), the raw payload if that fails, else [].
+ */
+static int st_links(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  const char *links = status_ctx_links(c);
+  if (!links) { SAPPEND("\"links\":[]"); return 0; }
+  const char *routes = status_ctx_routes(c);
+  size_t l1 = strlen(links), l2 = routes ? strlen(routes) : 0;
+  char *combined = req_alloc(l1 + l2 + 2);
+  if (combined) {
+    memcpy(combined, links, l1); combined[l1] = '\n';
+    if (l2) memcpy(combined + l1 + 1, routes, l2);
+    combined[l1 + 1 + l2] = 0;
+  }
+  status_ctx_route(c);
+  char *norm = NULL; size_t nn = 0; int rc;
+  if (normalize_olsrd_links(combined ? combined : links, c->def_ip, &norm, &nn) == 0 && norm && nn > 0) rc = json_appendf(buf, len, cap, "\"links\":%s", norm);
+  else rc = json_appendf(buf, len, cap, "\"links\":%s", links);
+  free(norm); req_free(combined);
+  return rc != 0 ? -1 : 0;
+}
 
+/* neighbors: from the neighbors payload, else derived from links */
+static int st_neighbors(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  const char *nraw = status_ctx_neighbors(c);
+  char *nne = NULL; size_t nne_n = 0;
+  if (!(nraw && normalize_olsrd_neighbors(nraw, &nne, &nne_n) == 0 && nne && nne_n > 0)) {
+    free(nne); nne = NULL; nne_n = 0;
+    const char *links = status_ctx_links(c);
+    if (links && normalize_olsrd_neighbors(links, &nne, &nne_n) != 0) { free(nne); nne = NULL; nne_n = 0; }
+  }
+  int rc = (nne && nne_n > 0) ? json_appendf(buf, len, cap, "\"neighbors\":%s", nne) : json_appendf(buf, len, cap, "\"neighbors\":[]");
+  free(nne);
+  return rc != 0 ? -1 : 0;
+}
 
-  int olsr2_on=0, olsrd_on=0; detect_olsr_processes(&olsrd_on,&olsr2_on);
-  if(olsr2_on) fprintf(stderr,"[status-plugin] detected olsrd2 (robust)\n");
-  if(olsrd_on) fprintf(stderr,"[status-plugin] detected olsrd (robust)\n");
-  if(!olsrd_on && !olsr2_on) fprintf(stderr,"[status-plugin] no OLSR process detected (robust path)\n");
-
-  /* fetch links (for either implementation); do not toggle olsr2_on based on HTTP success */
-  char *olsr_links_raw=NULL; size_t oln=0; {
-    const char *endpoints[]={"http://127.0.0.1:9090/links","http://127.0.0.1:2006/links","http://127.0.0.1:8123/links",NULL};
-    for(const char **ep=endpoints; *ep && !olsr_links_raw; ++ep){
-      fprintf(stderr,"[status-plugin] trying OLSR endpoint: %s\n", *ep);
-      if (strstr(*ep, "127.0.0.1") || strstr(*ep, "localhost")) {
-        if (util_http_get_url_local(*ep, &olsr_links_raw, &oln, 1) == 0 && olsr_links_raw && oln > 0) {
-          fprintf(stderr,"[status-plugin] fetched OLSR links from %s (%zu bytes)\n", *ep, oln);
-          break;
-        }
+/* legacy compatibility: olsrd4watchdog object with state on/off to match bmk-webstatus style */
+static int st_olsr(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  status_ctx_olsr(c);
+  SAPPEND("\"olsr2_on\":%s,\"olsrd_on\":%s,\"olsrd4watchdog\":{\"state\":\"%s\"}", c->olsr2_on?"true":"false", c->olsrd_on?"true":"false", c->olsrd_on?"on":"off");
+  return 0;
+}
+
+/* include raw olsr routes JSON when available; raw neighbors/topology are left out to slim the payload */
+static int st_olsr_routes_raw(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  const char *routes = status_ctx_routes(c);
+  if (!routes) return 1;
+  SAPPEND("\"olsr_routes_raw\":%s", routes);
+  return 0;
+}
+
+/* diagnostics: report which local olsrd endpoints answer and traceroute info */
+static int st_diagnostics(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  (void)c;
+  const char *eps[] = { "http://127.0.0.1:9090/links", "http://127.0.0.1:2006/links", "http://127.0.0.1:8123/links", NULL };
+  SAPPEND("\"diagnostics\":{\"olsrd_endpoints\":[");
+  for (const char **ep = eps; *ep; ++ep) {
+    payload_t *tp = local_http_get(*ep, 1);
+    size_t tlen = tp ? tp->len : 0;
+    int ok = tlen > 0;
+    char sample[256] = "";
+    if (ok) { size_t copy = tlen < sizeof(sample)-1 ? tlen : sizeof(sample)-1; memcpy(sample, tp->data, copy); sample[copy]=0; }
+    payload_unref(tp);
+    SAPPEND("%s{\"url\":", ep == eps ? "" : ","); SESC(*ep);
+    /* include a short sample */
+    SAPPEND(",\"ok\":%s,\"len\":%zu,\"sample\":", ok?"true":"false", ok ? tlen : 0); SESC(sample);
+    SAPPEND("}");
+  }
+  SAPPEND("],\"traceroute\":{\"available\":%s,\"path\":", g_has_traceroute?"true":"false"); SESC(g_traceroute_path);
+  SAPPEND("}}");
+  return 0;
+}
+
+/* Parse `traceroute` binary output into the trace_to_uplink hop objects. */
+static int traceroute_text_json(char *tout, char **buf, size_t *len, size_t *cap) {
+  SAPPEND("[");
+  char *p = tout; char *line; int first = 1;
+  while ((line = strsep(&p, "\n")) != NULL) {
+    if (!line || !*line) continue;
+    if (strstr(line, "traceroute to") == line) continue;
+    /* Normalize multiple spaces -> single to simplify splitting */
+    char *norm = req_strdup(line); if(!norm) continue;
+    for(char *q=norm; *q; ++q){ if(*q=='\t') *q=' '; }
+    /* collapse spaces */
+    char *w=norm, *rdr=norm; int sp=0; while(*rdr){ if(*rdr==' '){ if(!sp){ *w++=' '; sp=1; } } else { *w++=*rdr; sp=0; } rdr++; } *w=0;
+    /* ping buffer enlarged to 64 to avoid truncation when copying parsed token */
+    char hop[16]=""; char ip[64]=""; char host[256]=""; char ping[64]="";
+    /* Tokenize manually */
+    char *save=NULL; char *tok=strtok_r(norm," ",&save); int idx=0; char seen_paren_ip=0; char raw_ip_paren[64]=""; char raw_host[256]="";
+    char prev_tok[64]="";
+    while(tok){
+      if(idx==0){ snprintf(hop,sizeof(hop),"%s",tok); }
+      else if(idx==1){
+        if(tok[0]=='('){ /* rare ordering, will handle later */ }
+        else if(strcmp(tok,"*")==0){ snprintf(ip,sizeof(ip),"*"); }
+        else { snprintf(raw_host,sizeof(raw_host),"%s",tok); }
       } else {
-        char cmd[256]; snprintf(cmd,sizeof(cmd),"/usr/bin/curl -s --max-time 1 %s", *ep);
-        if(util_exec(cmd,&olsr_links_raw,&oln)==0 && olsr_links_raw && oln>0){
-          fprintf(stderr,"[status-plugin] fetched OLSR links from %s (%zu bytes)\n", *ep, oln);
-          break;
+        if(tok[0]=='('){
+          char *endp=strchr(tok,')'); if(endp){ *endp=0; snprintf(raw_ip_paren,sizeof(raw_ip_paren),"%s",tok+1); seen_paren_ip=1; }
+        }
+        /* latency extraction: accept forms '12.3ms' OR '12.3' followed by token 'ms' */
+        if(!ping[0]) {
+          size_t L = strlen(tok);
+          if(L>2 && tok[L-2]=='m' && tok[L-1]=='s') {
+            char num[32]; size_t cpy = (L-2) < sizeof(num)-1 ? (L-2) : sizeof(num)-1; memcpy(num,tok,cpy); num[cpy]=0;
+            int ok=1; for(size_t xi=0; xi<cpy; ++xi){ if(!(isdigit((unsigned char)num[xi]) || num[xi]=='.')) { ok=0; break; } }
+            if(ok && cpy>0) snprintf(ping,sizeof(ping),"%s",num);
+          } else if(strcmp(tok,"ms")==0 && prev_tok[0]) {
+            int ok=1; for(size_t xi=0; prev_tok[xi]; ++xi){ if(!(isdigit((unsigned char)prev_tok[xi]) || prev_tok[xi]=='.')) { ok=0; break; } }
+            if(ok) snprintf(ping,sizeof(ping),"%s",prev_tok);
+          }
         }
       }
-      if(olsr_links_raw){ free(olsr_links_raw); olsr_links_raw=NULL; oln=0; }
-    }
+      /* remember token for next iteration */
+      snprintf(prev_tok,sizeof(prev_tok),"%s",tok);
+      tok=strtok_r(NULL," ",&save); idx++;
+    }
+    /* If ping captured originally with trailing ms (legacy), ensure we didn't store literal 'ms' */
+    if(strcmp(ping,"ms")==0) ping[0]=0;
+    if(seen_paren_ip){
+      snprintf(ip,sizeof(ip),"%s",raw_ip_paren);
+      snprintf(host,sizeof(host),"%s",raw_host);
+    } else if(raw_host[0]) {
+      int is_ip=1; for(char *ch=raw_host; *ch; ++ch){ if(!isdigit((unsigned char)*ch) && *ch!='.') { is_ip=0; break; } }
+      /* limit copy explicitly to avoid warning (raw_host len already bounded) */
+      if(is_ip) snprintf(ip,sizeof(ip),"%.*s", (int)sizeof(ip)-1, raw_host);
+      else snprintf(host,sizeof(host),"%.*s", (int)sizeof(host)-1, raw_host);
+    }
+    req_free(norm);
+    SAPPEND("%s{\"hop\":%s,\"ip\":", first ? "" : ",", hop); SESC(ip);
+    first = 0;
+    SAPPEND(",\"host\":"); SESC(host);
+    SAPPEND(",\"ping\":"); SESC(ping);
+    SAPPEND("}");
   }
+  SAPPEND("]");
+  return 0;
+}
 
-  /* (legacy duplicate fetch block removed after refactor) */
+/* traceroute to the uplink (mimics the python page): the background
+ * monitor's latest run when it is enabled, else a probe now, else the
+ * traceroute binary.
+ */
+static int st_trace(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  (void)c;
+  trace_sample_t uplink_s;
+  int uplink_mon = trace_monitor_latest(&uplink_s);
+  if (uplink_mon >= 0) return uplink_sample_json(buf, len, cap, uplink_mon ? &uplink_s : NULL, 0) != 0 ? -1 : 0;
+  char target[256] = "";
+  uplink_trace_target(target, sizeof(target));
+  trace_result_t uplink_tr;
+  if (target[0] && trace_uplink(target, &uplink_tr) == 0) {
+    SAPPEND("\"trace_target\":"); SESC(target);
+    SAPPEND(",\"trace_to_uplink\":");
+    return trace_hops_json(buf, len, cap, &uplink_tr, "") != 0 ? -1 : 0;
+  }
+  if (!target[0] || !g_has_traceroute) return 1;
+  /* no usable probe socket: fall back to the traceroute binary */
+  const char *trpath = (g_traceroute_path[0]) ? g_traceroute_path : "traceroute";
+  const char *targv[] = { trpath, "-4", "-w", "1", "-q", "1", target, NULL };
+  char *tout = NULL; size_t t_n = 0; int rc = 1;
+  /* a path still unfinished at the deadline is reported as far as it got */
+  int trc = exec_argv(targv, 0, TRACEROUTE_DEADLINE_MS, &tout, &t_n, NULL);
+  if ((trc == 0 || trc == EXEC_TIMEOUT) && tout && t_n>0) {
+    rc = (json_appendf(buf, len, cap, "\"trace_target\":") == 0 && json_append_escaped(buf, len, cap, target) == 0 &&
+          json_appendf(buf, len, cap, ",\"trace_to_uplink\":") == 0 && traceroute_text_json(tout, buf, len, cap) == 0) ? 0 : -1;
+  }
+  free(tout);
+  return rc;
+}
 
-  char *olsr_neighbors_raw=NULL; size_t olnn=0; if(util_http_get_url_local("http://127.0.0.1:9090/neighbors", &olsr_neighbors_raw, &olnn, 1) != 0) { if(olsr_neighbors_raw){ free(olsr_neighbors_raw); olsr_neighbors_raw=NULL; } olnn=0; }
-  char *olsr_routes_raw=NULL; size_t olr=0; if(util_http_get_url_local("http://127.0.0.1:9090/routes", &olsr_routes_raw, &olr, 1) != 0) { if(olsr_routes_raw){ free(olsr_routes_raw); olsr_routes_raw=NULL; } olr=0; }
-  char *olsr_topology_raw=NULL; size_t olt=0; if(util_http_get_url_local("http://127.0.0.1:9090/topology", &olsr_topology_raw, &olt, 1) != 0) { if(olsr_topology_raw){ free(olsr_topology_raw); olsr_topology_raw=NULL; } olt=0; }
+/* trace_age_s of the monitor's latest sample, computed per request: the
+ * trace fragment itself is cached and only carries trace_updated.
+ */
+static int st_trace_age(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  (void)c;
+  trace_sample_t s;
+  if (trace_monitor_latest(&s) != 1) return 1;
+  long age = (long)(time(NULL) - s.ts);
+  SAPPEND("\"trace_age_s\":%ld", age < 0 ? 0 : age);
+  return 0;
+}
 
-  /* Build JSON */
-  APPEND("\"hostname\":"); json_append_escaped(&buf,&len,&cap,hostname); APPEND(",");
-  APPEND("\"ip\":"); json_append_escaped(&buf,&len,&cap,ipaddr); APPEND(",");
-  APPEND("\"uptime\":\"%ld\",", uptime_seconds);
-
-  /* default_route */
-  /* attempt reverse DNS for default route IP to provide a hostname for the gateway */
-  /* Try EdgeRouter path first */
-  /* versions: use internal generator rather than external script (we generated vgen earlier) */
-  if (vgen && vgen_n > 0) {
-    APPEND("\"versions\":%s,", vgen);
-  } else {
-    /* fallback: try a quick generation (rare) */
-    char *vtmp = NULL; size_t vtmp_n = 0;
-    if (generate_versions_json(&vtmp, &vtmp_n) == 0 && vtmp && vtmp_n>0) {
-      APPEND("\"versions\":%s,", vtmp);
-      free(vtmp); vtmp = NULL;
-    } else {
-      /* Provide basic fallback versions for Linux container */
-      APPEND("\"versions\":{\"olsrd\":\"unknown\",\"system\":\"linux-container\"},");
-    }
-  }
-  /* attempt to read traceroute_to from settings.inc (same path as python reference) */
-    /* attempt to read traceroute_to from settings.inc (same path as python reference)
-     * Default to the Python script's traceroute target if not configured.
-     */
-  char traceroute_to[256] = "";
-  int traceroute_to_set = 0;
-  /* human readable uptime string, prefer python-like format */
-  char uptime_str[64] = ""; format_duration(uptime_seconds, uptime_str, sizeof(uptime_str));
-  char uptime_linux[160] = ""; format_uptime_linux(uptime_seconds, uptime_linux, sizeof(uptime_linux));
-  APPEND("\"uptime_str\":"); json_append_escaped(&buf, &len, &cap, uptime_str); APPEND(",");
-  APPEND("\"uptime_linux\":"); json_append_escaped(&buf, &len, &cap, uptime_linux); APPEND(",");
-  {
-    char *s=NULL; size_t sn=0;
-    if (util_read_file("/config/custom/www/settings.inc", &s, &sn) == 0 && s && sn>0) {
-      /* simple parse: look for traceroute_to= value */
-      char *line = s; char *end = s + sn;
-      while (line && line < end) {
-        char *nl = memchr(line, '\n', (size_t)(end - line));
-        size_t linelen = nl ? (size_t)(nl - line) : (size_t)(end - line);
-  if (linelen > 0 && memmem(line, linelen, "traceroute_to", 12)) {
-          /* find '=' */
-          char *eq = memchr(line, '=', linelen);
-          if (eq) {
-            char *v = eq + 1; size_t vlen = (size_t)(end - v);
-            /* trim semicolons, quotes and whitespace */
-            while (vlen && (v[vlen-1]=='\n' || v[vlen-1]=='\r' || v[vlen-1]==' ' || v[vlen-1]=='\'' || v[vlen-1]=='\"' || v[vlen-1]==';')) vlen--;
-            while (vlen && (*v==' ' || *v=='\'' || *v=='\"')) { v++; vlen--; }
-            if (vlen > 0) {
-              size_t copy = vlen < sizeof(traceroute_to)-1 ? vlen : sizeof(traceroute_to)-1;
-              memcpy(traceroute_to, v, copy); traceroute_to[copy]=0;
-              traceroute_to_set = 1;
-            }
-          }
-        }
-        if (!nl) {
-          break;
-        }
-        line = nl + 1;
+/* admin_url when running on EdgeRouter: default route ip (else hostname) and the GUI https port */
+static int st_admin_url(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  if (!g_is_edgerouter) return 1;
+  int admin_port = 443;
+  char *cfg = NULL; size_t cn = 0;
+  if (util_read_file("/config/config.boot", &cfg, &cn) == 0 && cfg && cn > 0) {
+    const char *tok = strstr(cfg, "https-port");
+    if (tok) {
+      /* move past token and find first integer sequence */
+      tok += strlen("https-port");
+      while (*tok && !isdigit((unsigned char)*tok)) tok++;
+      if (isdigit((unsigned char)*tok)) {
+        char *endptr = NULL; long v = strtol(tok, &endptr, 10);
+        if (v > 0 && v < 65536) admin_port = (int)v;
       }
-      free(s);
     }
   }
-  /* fallback: if traceroute_to not set, use default route IP (filled later) - placeholder handled below */
-  if (!traceroute_to_set || !traceroute_to[0]) {
-    if (def_ip[0]) {
-      snprintf(traceroute_to, sizeof(traceroute_to), "%s", def_ip);
-      traceroute_to_set = 1;
-    } else {
-      snprintf(traceroute_to, sizeof(traceroute_to), "%s", "78.41.115.36");
-      traceroute_to_set = 1;
-    }
-  }
-  /* Devices: prefer cached devices populated by background worker to avoid blocking */
-  {
-    int used_cache = 0;
-    pthread_mutex_lock(&g_devices_cache_lock);
-    if (g_devices_cache && g_devices_cache_len > 0) {
-      /* consider cache stale if older than g_ubnt_cache_ttl_s */
-      time_t nowt = time(NULL);
-      if (g_ubnt_cache_ttl_s <= 0 || (nowt - g_devices_cache_ts) <= g_ubnt_cache_ttl_s) {
-        APPEND("\"devices\":%s,", g_devices_cache);
-        used_cache = 1;
-      } else {
-        /* stale: treat as absent */
-        if (g_fetch_log_queue || g_fetch_log_force) fprintf(stderr, "[status-plugin] devices cache stale (age=%lds > %ds)\n", (long)(nowt - g_devices_cache_ts), g_ubnt_cache_ttl_s);
-      }
-    }
-    pthread_mutex_unlock(&g_devices_cache_lock);
-    if (!used_cache) {
-      /* fallback to inline discovery if cache not ready */
-      char *ud = NULL; size_t udn = 0;
-      if (ubnt_discover_output(&ud, &udn) == 0 && ud && udn > 0) {
-        fprintf(stderr, "[status-plugin] got device data from ubnt-discover (inline %zu bytes)\n", udn);
-        /* Mirror message into ubnt debug channel for parity with background worker */
-    if (ubnt_debug_enabled()) plugin_log_trace("ubnt: got device data from ubnt-discover (inline %zu bytes)", udn);
-        char *normalized = NULL; size_t nlen = 0;
-        if (normalize_ubnt_devices(ud, &normalized, &nlen) == 0 && normalized) {
-          APPEND("\"devices\":%s,", normalized);
-          free(normalized);
-        } else {
-          APPEND("\"devices\":[],");
-        }
-        free(ud);
-      } else {
-        APPEND("\"devices\":[],");
-      }
-    }
+  free(cfg);
+  status_ctx_route(c);
+  const char *host_for_admin = c->def_ip[0] ? c->def_ip : status_ctx_hostname(c);
+  if (!host_for_admin[0]) return 1;
+  char admin_url[384];
+  if (admin_port == 443) snprintf(admin_url, sizeof(admin_url), "https://%s/", host_for_admin);
+  else snprintf(admin_url, sizeof(admin_url), "https://%s:%d/", host_for_admin, admin_port);
+  SAPPEND("\"admin_url\":"); SESC(admin_url);
+  return 0;
+}
+
+/* legacy bmk-webstatus.py key: airos data file, else an empty object */
+static int st_airosdata(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  (void)c;
+  char *airos_raw = NULL; size_t airos_n = 0;
+  int rc = (util_read_file("/tmp/10-all.json", &airos_raw, &airos_n) == 0 && airos_raw && airos_n > 0)
+           ? json_appendf(buf, len, cap, "\"airosdata\":%s", airos_raw) : json_appendf(buf, len, cap, "\"airosdata\":{}");
+  free(airos_raw);
+  return rc != 0 ? -1 : 0;
+}
+
+/* bootimage: minimal placeholder (detailed info is in versions JSON) */
+static int st_bootimage(status_ctx_t *c, char **buf, size_t *len, size_t *cap) {
+  (void)c;
+  SAPPEND("\"bootimage\":{\"md5\":\"n/a\"}");
+  return 0;
+}
+#undef SAPPEND
+#undef SESC
+
+typedef struct {
+  const char *name;          /* for ?fields=, the request log and metrics */
+  const char *keys;          /* other top-level keys it emits, comma separated */
+  status_producer_fn fn;
+  int ttl;                   /* seconds a fragment is reused; 0 = always computed */
+  unsigned inputs;           /* SIN() mask of what it is derived from */
+  int cheap;                 /* computed on the request thread rather than a worker */
+} status_section_t;
+
+/* Output order of /status. */
+static const status_section_t g_status_sections[] = {
+  { "fetch_stats", "", st_fetch_stats, 0, 0, 1 },
+  { "fetch_auto_refresh_ms", "", st_fetch_auto_refresh, 3600, 0, 1 },
+  { "hostname", "", st_hostname, 60, 0, 1 },
+  { "ip", "", st_ip, 10, 0, 0 },
+  { "uptime", "", st_uptime, 0, 0, 1 },
+  { "versions", "", st_versions, 30, 0, 0 },
+  { "uptime_str", "", st_uptime_str, 0, 0, 1 },
+  { "uptime_linux", "", st_uptime_linux, 0, 0, 1 },
+  { "devices", "", st_devices, 10, SIN(SIN_DEVICES), 0 },
+  { "links", "", st_links, 5, SIN(SIN_LINKS) | SIN(SIN_ROUTES) | SIN(SIN_NODEDB) | SIN(SIN_DEFROUTE), 0 },
+  { "neighbors", "", st_neighbors, 5, SIN(SIN_NEIGHBORS) | SIN(SIN_LINKS) | SIN(SIN_NODEDB), 0 },
+  { "olsr", "olsr2_on,olsrd_on,olsrd4watchdog", st_olsr, 5, SIN(SIN_OLSR_PROC), 0 },
+  { "olsr_routes_raw", "", st_olsr_routes_raw, 5, SIN(SIN_ROUTES), 0 },
+  { "diagnostics", "", st_diagnostics, 10, 0, 0 },
+  { "trace", "trace_target,trace_to_uplink,trace_pending,trace_updated,trace_reached,trace_path_changed", st_trace, 10, SIN(SIN_TRACE) | SIN(SIN_DEFROUTE), 0 },
+  { "trace_age", "trace_age_s", st_trace_age, 0, 0, 1 },
+  { "admin_url", "", st_admin_url, 60, SIN(SIN_DEFROUTE), 0 },
+  { "airosdata", "", st_airosdata, 10, 0, 0 },
+  { "bootimage", "", st_bootimage, 3600, 0, 1 },
+};
+#define STATUS_NSECTIONS ((int)(sizeof(g_status_sections) / sizeof(g_status_sections[0])))
+
+typedef struct {
+  char *frag; size_t len;    /* members as emitted; len 0 = section had nothing */
+  int valid;
+  time_t ts;
+  unsigned long gens[SIN_COUNT];
+  int inflight;              /* a worker is recomputing it */
+  unsigned long hits, misses, late;
+  uint64_t compute_us;       /* total time spent in the producer */
+  size_t arena_peak;         /* most scratch arena bytes one computation used */
+} status_cache_t;
+static status_cache_t g_status_cache[STATUS_NSECTIONS];
+
+/* Called with g_status_cache_lock held. */
+static int status_cache_fresh(int i, time_t now) {
+  const status_section_t *s = &g_status_sections[i];
+  const status_cache_t *e = &g_status_cache[i];
+  if (!g_status_section_cache || !e->valid || s->ttl <= 0 || now - e->ts >= s->ttl) return 0;
+  for (int in = 0; in < SIN_COUNT; in++)
+    if ((s->inputs & SIN(in)) && status_input_gen(in) != e->gens[in]) return 0;
+  return 1;
+}
+
+/* frag NULL: the producer failed, the previous fragment stays. */
+static void status_cache_store(int i, const char *frag, size_t len, time_t now, uint64_t us) {
+  const status_section_t *s = &g_status_sections[i];
+  status_cache_t *e = &g_status_cache[i];
+  if (!frag) { pthread_mutex_lock(&g_status_cache_lock); e->inflight = 0; pthread_mutex_unlock(&g_status_cache_lock); return; }
+  char *copy = (s->ttl > 0 && g_status_section_cache) ? malloc(len + 1) : NULL;
+  if (copy) { memcpy(copy, frag, len); copy[len] = 0; }
+  pthread_mutex_lock(&g_status_cache_lock);
+  e->misses++; e->compute_us += us; e->inflight = 0;
+  free(e->frag); e->frag = copy; e->len = len; e->valid = copy != NULL; e->ts = now;
+  for (int in = 0; in < SIN_COUNT; in++) if (s->inputs & SIN(in)) e->gens[in] = status_input_gen(in);
+  pthread_mutex_unlock(&g_status_cache_lock);
+}
+
+/* 1 when name (length n) is the section's name or one of its keys */
+static int status_section_matches(const status_section_t *s, const char *name, size_t n) {
+  if (strlen(s->name) == n && memcmp(s->name, name, n) == 0) return 1;
+  for (const char *k = s->keys; *k; ) {
+    size_t kl = strcspn(k, ",");
+    if (kl == n && memcmp(k, name, n) == 0) return 1;
+    k += kl; if (*k == ',') k++;
   }
+  return 0;
+}
 
-  /* links: either from olsrd API or empty array */
-  if (olsr_links_raw && oln>0) {
-    /* try to normalize olsrd raw links into UI-friendly format */
-    char *norm = NULL; size_t nn = 0;
-    /* combine links + routes raw so route counting inside normalizer can see routes section */
-    char *combined_raw=NULL; size_t combined_len=0;
-    if (olsr_links_raw) {
-      size_t l1=strlen(olsr_links_raw); size_t l2= (olsr_routes_raw? strlen(olsr_routes_raw):0);
-      combined_len = l1 + l2 + 8;
-      combined_raw = malloc(combined_len+1);
-      if (combined_raw) {
-        combined_raw[0]=0;
-        memcpy(combined_raw, olsr_links_raw, l1); combined_raw[l1]='\n';
-        if (l2) memcpy(combined_raw+l1+1, olsr_routes_raw, l2);
-        combined_raw[l1+1+l2]=0;
-      }
-    }
-    if (normalize_olsrd_links(combined_raw?combined_raw:olsr_links_raw, &norm, &nn) == 0 && norm && nn>0) {
-      APPEND("\"links\":"); json_buf_append(&buf, &len, &cap, "%s", norm); APPEND(",");
-      /* also attempt to normalize neighbors from neighbors payload */
-      char *nne = NULL; size_t nne_n = 0;
-      if (olsr_neighbors_raw && olnn > 0 && normalize_olsrd_neighbors(olsr_neighbors_raw, &nne, &nne_n) == 0 && nne && nne_n>0) {
-        APPEND("\"neighbors\":"); json_buf_append(&buf, &len, &cap, "%s", nne); APPEND(",");
-        free(nne);
-      } else {
-        APPEND("\"neighbors\":[],");
-      }
-      free(norm);
-      if (combined_raw) { free(combined_raw); combined_raw=NULL; }
-    } else {
-      APPEND("\"links\":"); json_buf_append(&buf, &len, &cap, "%s", olsr_links_raw); APPEND(",");
-      /* neighbors fallback: try neighbors data first, then links */
-      char *nne2 = NULL; size_t nne2_n = 0;
-      if ((olsr_neighbors_raw && olnn > 0 && normalize_olsrd_neighbors(olsr_neighbors_raw, &nne2, &nne2_n) == 0 && nne2 && nne2_n>0) ||
-          (normalize_olsrd_neighbors(olsr_links_raw, &nne2, &nne2_n) == 0 && nne2 && nne2_n>0)) {
-        APPEND("\"neighbors\":"); json_buf_append(&buf, &len, &cap, "%s", nne2); APPEND(","); free(nne2);
-      } else {
-        APPEND("\"neighbors\":[],");
-      }
-      if (combined_raw) { free(combined_raw); combined_raw=NULL; }
-    }
-  } else {
-    APPEND("\"links\":[],");
-    /* try to get neighbors even if no links */
-    char *nne3 = NULL; size_t nne3_n = 0;
-    if (olsr_neighbors_raw && olnn > 0 && normalize_olsrd_neighbors(olsr_neighbors_raw, &nne3, &nne3_n) == 0 && nne3 && nne3_n>0) {
-      APPEND("\"neighbors\":"); json_buf_append(&buf, &len, &cap, "%s", nne3); APPEND(",");
-      free(nne3);
-    } else {
-      APPEND("\"neighbors\":[],");
+/* End of the JSON value starting at p (NULL when it is cut off). */
+static const char *json_value_end(const char *p, const char *end) {
+  int depth = 0;
+  while (p < end) {
+    char ch = *p;
+    if (ch == '"') {
+      for (p++; p < end && *p != '"'; p++) if (*p == '\\') p++;
+      if (p >= end) return NULL;
+      p++;
+      if (depth == 0) return p;
+      continue;
     }
+    if (ch == '{' || ch == '[') depth++;
+    else if (ch == '}' || ch == ']') { if (--depth < 0) return p; if (depth == 0) return p + 1; }
+    else if (depth == 0 && (ch == ',' || ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t')) return p;
+    p++;
   }
-  APPEND("\"olsr2_on\":%s,", olsr2_on?"true":"false");
-  APPEND("\"olsrd_on\":%s", olsrd_on?"true":"false");
-  /* legacy compatibility: expose olsrd4watchdog object with state on/off to match bmk-webstatus style */
-  APPEND(",\"olsrd4watchdog\":{\"state\":\"%s\"}", olsrd_on?"on":"off");
+  return depth == 0 ? p : NULL;
+}
 
-  /* include raw olsr routes JSON when available; avoid including raw neighbors/topology to slim payload */
-  if (olsr_routes_raw && olr>0) { APPEND(",\"olsr_routes_raw\":%s", olsr_routes_raw); }
+/* Append the members of the object body [p,end) selected by paths, each the
+ * remaining dotted path below this object. A path naming a member keeps it
+ * whole; a longer one descends into it when it is an object.
+ */
+static int json_project_members(const char *p, const char *end, const char *const *paths, int npaths, jw_t *w) {
+  while (p < end) {
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t' || *p == ',' || *p == '{')) p++;
+    if (p >= end || *p != '"') break;
+    const char *k = p + 1, *ke = json_value_end(p, end);
+    if (!ke) return 0;
+    size_t kl = (size_t)(ke - 1 - k);
+    p = ke;
+    while (p < end && (*p == ' ' || *p == ':')) p++;
+    const char *v = p, *ve = json_value_end(p, end);
+    if (!ve) return 0;
+    p = ve;
+    int whole = 0, deeper = 0;
+    const char *sub[32]; int nsub = 0;
+    for (int i = 0; i < npaths; i++) {
+      if (strncmp(paths[i], k, kl) != 0) continue;
+      if (paths[i][kl] == 0) whole = 1;
+      else if (paths[i][kl] == '.' && nsub < 32) { sub[nsub++] = paths[i] + kl + 1; deeper = 1; }
+    }
+    if (!whole && !(deeper && *v == '{')) continue;
+    jw_keyn(w, k, kl);
+    if (whole) { jw_raw(w, v, (size_t)(ve - v)); continue; }
+    jw_begin_obj(w);
+    if (json_project_members(v + 1, ve - 1, sub, nsub, w) != 0) return -1;
+    jw_end_obj(w);
+  }
+  return w->err ? -1 : 0;
+}
 
-  if (olsr_links_raw) { free(olsr_links_raw); olsr_links_raw = NULL; }
+/* Stale sections of one /status request. The fork-join group owns it: it is
+ * freed once the request and every worker still computing for it are done.
+ */
+typedef struct status_batch status_batch_t;
+typedef struct {
+  status_batch_t *b;
+  int section;
+  int task;                  /* fork-join index; -1 = ran on the request thread */
+  char *frag; size_t flen, fcap;
+  int prc;
+} status_job_t;
+struct status_batch {
+  status_ctx_t ctx;
+  int njobs;
+  status_job_t jobs[STATUS_NSECTIONS];
+};
 
-  /* diagnostics: report which local olsrd endpoints were probed and traceroute info */
-  {
-    APPEND(",\"diagnostics\":{");
-    /* endpoints probed earlier (try same list) */
-    const char *eps[] = { "http://127.0.0.1:9090/links", "http://127.0.0.1:2006/links", "http://127.0.0.1:8123/links", NULL };
-    APPEND("\"olsrd_endpoints\":[");
-    int first_ep = 1;
-    for (const char **ep = eps; *ep; ++ep) {
-      char *tout = NULL; size_t tlen = 0; int ok = 0;
-      if (strstr(*ep, "127.0.0.1") || strstr(*ep, "localhost")) {
-        if (util_http_get_url_local(*ep, &tout, &tlen, 1) == 0 && tout && tlen>0) ok = 1;
-      } else {
-        char cmd[256]; snprintf(cmd, sizeof(cmd), "/usr/bin/curl -s --max-time 1 %s", *ep);
-        if (util_exec(cmd, &tout, &tlen) == 0 && tout && tlen>0) ok = 1;
-      }
-      if (!first_ep) APPEND(","); first_ep = 0;
-      APPEND("{\"url\":"); json_append_escaped(&buf,&len,&cap,*ep);
-      APPEND(",\"ok\":%s,\"len\":%zu,\"sample\":", ok?"true":"false", tlen);
-      if (tout && tlen>0) {
-        /* include a short sample */
-        char sample[256]; size_t copy = tlen < sizeof(sample)-1 ? tlen : sizeof(sample)-1; memcpy(sample, tout, copy); sample[copy]=0; json_append_escaped(&buf,&len,&cap,sample);
-      } else json_append_escaped(&buf,&len,&cap,"");
-      APPEND("}"); if (tout) free(tout);
-    }
-    APPEND("]");
-    APPEND(",\"traceroute\":{\"available\":%s,\"path\":", g_has_traceroute?"true":"false"); json_append_escaped(&buf,&len,&cap, g_traceroute_path);
-    APPEND("}");
-    APPEND("}");
-  }
-
-  /* include fixed traceroute-to-uplink output (mimic python behavior) */
-  if (!traceroute_to[0]) {
-    /* if not explicitly configured, use default route IP as traceroute target */
-    if (def_ip[0]) snprintf(traceroute_to, sizeof(traceroute_to), "%s", def_ip);
-  }
-  if (traceroute_to[0] && g_has_traceroute) {
-    const char *trpath = (g_traceroute_path[0]) ? g_traceroute_path : "traceroute";
-    size_t cmdlen = strlen(trpath) + strlen(traceroute_to) + 64;
-    char *cmd = (char*)malloc(cmdlen);
-    if (cmd) {
-      snprintf(cmd, cmdlen, "%s -4 -w 1 -q 1 %s", trpath, traceroute_to);
-      char *tout = NULL; size_t t_n = 0;
-      if (util_exec(cmd, &tout, &t_n) == 0 && tout && t_n>0) {
-        /* parse lines into simple objects */
-        APPEND(",\"trace_target\":"); json_append_escaped(&buf,&len,&cap,traceroute_to);
-        APPEND(",\"trace_to_uplink\":[");
-        char *p = tout; char *line; int first = 1;
-        while ((line = strsep(&p, "\n")) != NULL) {
-          if (!line || !*line) continue;
-          if (strstr(line, "traceroute to") == line) continue;
-          /* Normalize multiple spaces -> single to simplify splitting */
-          char *norm = strdup(line); if(!norm) continue;
-          for(char *q=norm; *q; ++q){ if(*q=='\t') *q=' '; }
-          /* collapse spaces */
-          char *w=norm, *rdr=norm; int sp=0; while(*rdr){ if(*rdr==' '){ if(!sp){ *w++=' '; sp=1; } } else { *w++=*rdr; sp=0; } rdr++; } *w=0;
-          /* ping buffer enlarged to 64 to avoid truncation when copying parsed token */
-          char hop[16]=""; char ip[64]=""; char host[256]=""; char ping[64]="";
-          /* '*' hop */
-          if (strchr(norm,'*') && strstr(norm," * ")==norm+ (strchr(norm,' ')? (strchr(norm,' ')-norm)+1:0)) {
-            /* leave as '*' no latency */
-          }
-          /* Tokenize manually */
-          char *save=NULL; char *tok=strtok_r(norm," ",&save); int idx=0; char seen_paren_ip=0; char raw_ip_paren[64]=""; char raw_host[256]="";
-          char prev_tok[64]="";
-          while(tok){
-            if(idx==0){ snprintf(hop,sizeof(hop),"%s",tok); }
-            else if(idx==1){
-              if(tok[0]=='('){ /* rare ordering, will handle later */ }
-              else if(strcmp(tok,"*")==0){ snprintf(ip,sizeof(ip),"*"); }
-              else { snprintf(raw_host,sizeof(raw_host),"%s",tok); }
-            } else {
-              if(tok[0]=='('){
-                char *endp=strchr(tok,')'); if(endp){ *endp=0; snprintf(raw_ip_paren,sizeof(raw_ip_paren),"%s",tok+1); seen_paren_ip=1; }
-              }
-              /* latency extraction: accept forms '12.3ms' OR '12.3' followed by token 'ms' */
-              if(!ping[0]) {
-                size_t L = strlen(tok);
-                if(L>2 && tok[L-2]=='m' && tok[L-1]=='s') {
-                  char num[32]; size_t cpy = (L-2) < sizeof(num)-1 ? (L-2) : sizeof(num)-1; memcpy(num,tok,cpy); num[cpy]=0;
-                  int ok=1; for(size_t xi=0; xi<cpy; ++xi){ if(!(isdigit((unsigned char)num[xi]) || num[xi]=='.')) { ok=0; break; } }
-                  if(ok && cpy>0) snprintf(ping,sizeof(ping),"%s",num);
-                } else if(strcmp(tok,"ms")==0 && prev_tok[0]) {
-                  int ok=1; for(size_t xi=0; prev_tok[xi]; ++xi){ if(!(isdigit((unsigned char)prev_tok[xi]) || prev_tok[xi]=='.')) { ok=0; break; } }
-                  if(ok) snprintf(ping,sizeof(ping),"%s",prev_tok);
-                }
-              }
-            }
-            /* remember token for next iteration */
-            snprintf(prev_tok,sizeof(prev_tok),"%s",tok);
-            tok=strtok_r(NULL," ",&save); idx++;
-          }
-          /* If ping captured originally with trailing ms (legacy), ensure we didn't store literal 'ms' */
-          if(strcmp(ping,"ms")==0) ping[0]=0;
-          if(seen_paren_ip){
-            snprintf(ip,sizeof(ip),"%s",raw_ip_paren);
-            snprintf(host,sizeof(host),"%s",raw_host);
-          } else {
-            if(raw_host[0]) {
-              int is_ip=1; for(char *c=raw_host; *c; ++c){ if(!isdigit((unsigned char)*c) && *c!='.') { is_ip=0; break; } }
-              if(is_ip) {
-                /* limit copy explicitly to avoid warning (raw_host len already bounded) */
-                snprintf(ip,sizeof(ip),"%.*s", (int)sizeof(ip)-1, raw_host);
-              } else {
-                snprintf(host,sizeof(host),"%.*s", (int)sizeof(host)-1, raw_host);
-              }
-            }
-          }
-          free(norm);
-          if(!first) APPEND(","); first=0;
-          APPEND("{\"hop\":%s,\"ip\":", hop); json_append_escaped(&buf,&len,&cap, ip);
-          APPEND(",\"host\":"); json_append_escaped(&buf,&len,&cap, host);
-          APPEND(",\"ping\":"); json_append_escaped(&buf,&len,&cap, ping);
-          APPEND("}");
-        }
-        APPEND("]");
-        free(tout);
-      }
-      free(cmd);
-    }
-  }
-
-  /* optionally include admin_url when running on EdgeRouter */
-  if (g_is_edgerouter) {
-    int admin_port = 443;
-    char *cfg = NULL; size_t cn = 0;
-    if (util_read_file("/config/config.boot", &cfg, &cn) == 0 && cfg && cn > 0) {
-      const char *tok = strstr(cfg, "https-port");
-      if (tok) {
-        /* move past token and find first integer sequence */
-        tok += strlen("https-port");
-        while (*tok && !isdigit((unsigned char)*tok)) tok++;
-        if (isdigit((unsigned char)*tok)) {
-          char *endptr = NULL; long v = strtol(tok, &endptr, 10);
-          if (v > 0 && v < 65536) admin_port = (int)v;
-        }
-      }
-      free(cfg);
-    }
-    /* prefer default route ip if available, else hostname */
-    if (def_ip[0] || hostname[0]) {
-      const char *host_for_admin = def_ip[0] ? def_ip : hostname;
-      size_t needed = strlen("https://") + strlen(host_for_admin) + 16;
-      char *admin_url_buf = (char*)malloc(needed);
-      if (admin_url_buf) {
-        if (admin_port == 443) snprintf(admin_url_buf, needed, "https://%s/", host_for_admin);
-        else snprintf(admin_url_buf, needed, "https://%s:%d/", host_for_admin, admin_port);
-        APPEND(",\"admin_url\":"); json_append_escaped(&buf, &len, &cap, admin_url_buf);
-        free(admin_url_buf);
-      }
-    }
-  }
+static void status_batch_free(void *ud) {
+  status_batch_t *b = ud;
+  for (int i = 0; i < b->njobs; i++) free(b->jobs[i].frag);
+  status_ctx_free(&b->ctx);
+  free(b);
+}
 
-  /* Compatibility: add some legacy top-level keys expected by bmk-webstatus.py output
-   * We try to copy relevant sub-objects from the previously generated versions JSON or other local buffers.
+static void status_job_run(void *arg) {
+  status_job_t *j = arg;
+  time_t now = time(NULL);
+  struct timespec s0, s1; clock_gettime(CLOCK_MONOTONIC, &s0);
+  /* on a pool worker the section's scratch goes to that worker's arena;
+   * run inline it shares the request's
    */
-  {
-    /* airosdata: use airos_raw if present, otherwise empty object */
-    if (airos_raw && airos_n>0) {
-      APPEND(",\"airosdata\":%s", airos_raw);
-    } else {
-      APPEND(",\"airosdata\":{}" );
-    }
+  arena_t *own = arena_current() ? NULL : arena_thread();
+  if (own) arena_bind(own);
+  size_t a0 = arena_used(arena_current());
+  j->fcap = 4096; j->flen = 0; j->frag = malloc(j->fcap);
+  if (j->frag) { j->frag[0] = 0; j->prc = g_status_sections[j->section].fn(&j->b->ctx, &j->frag, &j->flen, &j->fcap); }
+  else j->prc = -1;
+  size_t scratch = arena_used(arena_current()) - a0;
+  if (own) { arena_bind(NULL); arena_reset(own); }
+  pthread_mutex_lock(&g_status_cache_lock);
+  if (scratch > g_status_cache[j->section].arena_peak) g_status_cache[j->section].arena_peak = scratch;
+  pthread_mutex_unlock(&g_status_cache_lock);
+  clock_gettime(CLOCK_MONOTONIC, &s1);
+  if (j->prc > 0) j->flen = 0;
+  status_cache_store(j->section, j->prc < 0 ? NULL : j->frag, j->flen, now,
+                     (uint64_t)((s1.tv_sec - s0.tv_sec) * 1000000LL + (s1.tv_nsec - s0.tv_nsec) / 1000));
+}
 
-    /* autoupdate: attempt to extract autoupdate_settings from versions JSON above (we already appended versions)
-     * For simplicity, re-generate versions JSON into vtmp and extract keys. generate_versions_json already freed its buffer
-     * earlier, so we re-run it here to fetch the structured object. This is slightly redundant but safe.
-     */
-    char *vtmp = NULL; size_t vtmp_n = 0; int vtmp_owned = 0;
-    if (vgen && vgen_n > 0) {
-      vtmp = vgen; vtmp_n = vgen_n; vtmp_owned = 0;
-    } else if (generate_versions_json(&vtmp, &vtmp_n) == 0 && vtmp && vtmp_n>0) {
-      vtmp_owned = 1;
-    }
-    /* keep versions-derived data generation but avoid emitting autoupdate/wizards here to reduce payload */
-    if (vtmp && vtmp_n > 0) {
-      if (vtmp_owned) { free(vtmp); vtmp = NULL; }
-    }
-  /* bootimage: emit minimal placeholder (detailed info is in versions JSON elsewhere) */
-  APPEND(",\"bootimage\":{\"md5\":\"n/a\"}");
-  }
-  APPEND("\n}\n");
+static int status_emit(const char *frag, size_t flen, char **paths, int npaths, jw_t *w) {
+  if (!frag || flen == 0) return 0;
+  if (npaths > 0) return json_project_members(frag, frag + flen, (const char *const *)paths, npaths, w);
+  jw_members(w, frag, flen);
+  return w->err ? -1 : 0;
+}
 
-  /* send and cleanup */
-  http_send_status(r, 200, "OK");
-  http_printf(r, "Content-Type: application/json; charset=utf-8\r\n\r\n");
-  http_write(r, buf, len);
-  free(buf);
-  if (airos_raw) free(airos_raw);
+/* Assemble /status (all sections, or those behind paths) into a malloc'ed
+ * body. Returns 0, or -1 when a buffer could not grow.
+ */
+static int status_render(char **paths, int npaths, char **out, size_t *outlen) {
+  struct timespec t0; clock_gettime(CLOCK_MONOTONIC, &t0);
+  jw_t w;
+  if (jw_init(&w, 16384) != 0) return -1;
+  status_batch_t *b = calloc(1, sizeof(*b));
+  fj_group_t *g = b ? fj_group_new(status_batch_free, b) : NULL;
+  if (!g) { free(b); free(w.buf); return -1; }
+  status_ctx_init(&b->ctx);
+
+  /* which sections are wanted, and of those which are still fresh */
+  enum { SEC_SKIP, SEC_CACHED, SEC_JOB, SEC_STALE };
+  int mode[STATUS_NSECTIONS], job_of[STATUS_NSECTIONS], wanted[STATUS_NSECTIONS];
+  time_t now = time(NULL);
+  unsigned reload = 0;
+  pthread_mutex_lock(&g_status_cache_lock);
+  for (int i = 0; i < STATUS_NSECTIONS; i++) {
+    const status_section_t *s = &g_status_sections[i];
+    const status_cache_t *e = &g_status_cache[i];
+    wanted[i] = npaths == 0;
+    for (int k = 0; !wanted[i] && k < npaths; k++) wanted[i] = status_section_matches(s, paths[k], strcspn(paths[k], "."));
+    /* only fragments that the TTL alone would keep need their inputs checked */
+    if (wanted[i] && g_status_section_cache && e->valid && s->ttl > 0 && now - e->ts < s->ttl) reload |= s->inputs;
+  }
+  pthread_mutex_unlock(&g_status_cache_lock);
+  for (int in = 0; in < SIN_COUNT; in++) if (reload & SIN(in)) status_ctx_load(&b->ctx, in);
+
+  pthread_mutex_lock(&g_status_cache_lock);
+  for (int i = 0; i < STATUS_NSECTIONS; i++) {
+    const status_section_t *s = &g_status_sections[i];
+    status_cache_t *e = &g_status_cache[i];
+    mode[i] = SEC_SKIP;
+    if (!wanted[i]) continue;
+    if (status_cache_fresh(i, now)) { mode[i] = SEC_CACHED; e->hits++; continue; }
+    /* another request's worker is already on it: serve what we have */
+    if (e->inflight && e->valid) { mode[i] = SEC_STALE; e->late++; continue; }
+    mode[i] = SEC_JOB; job_of[i] = b->njobs;
+    status_job_t *j = &b->jobs[b->njobs++];
+    j->b = b; j->section = i; j->task = -1;
+    if (s->ttl > 0) e->inflight = 1;
+  }
+  pthread_mutex_unlock(&g_status_cache_lock);
+
+  /* fork the slow sections, compute the cheap ones here meanwhile, join */
+  for (int k = 0; k < b->njobs; k++) {
+    status_job_t *j = &b->jobs[k];
+    if (g_status_sections[j->section].cheap) continue;
+    j->task = fj_spawn(g, status_job_run, j);
+    if (j->task < 0) status_job_run(j);
+  }
+  for (int k = 0; k < b->njobs; k++)
+    if (g_status_sections[b->jobs[k].section].cheap) status_job_run(&b->jobs[k]);
+  fj_wait(g, g_status_deadline_ms);
+
+  /* merge in table order */
+  char computed[512] = "", stale[512] = ""; size_t cl = 0, sl = 0;
+  int ncomputed = 0, ncached = 0, nstale = 0, rc = 0;
+  jw_begin_obj(&w);
+  for (int i = 0; rc == 0 && i < STATUS_NSECTIONS; i++) {
+    const char *name = g_status_sections[i].name;
+    if (mode[i] == SEC_SKIP) continue;
+    if (mode[i] == SEC_JOB) {
+      status_job_t *j = &b->jobs[job_of[i]];
+      if (j->task < 0 || fj_done(g, j->task)) {
+        ncomputed++;
+        if (cl < sizeof(computed)) cl += (size_t)snprintf(computed + cl, sizeof(computed) - cl, "%s%s", cl ? "," : "", name);
+        if (j->prc < 0) { rc = -1; break; }
+        rc = status_emit(j->frag, j->flen, paths, npaths, &w);
+        continue;
+      }
+      /* late: its worker keeps going and refreshes the cache when it is done */
+      mode[i] = SEC_STALE;
+      pthread_mutex_lock(&g_status_cache_lock); g_status_cache[i].late++; pthread_mutex_unlock(&g_status_cache_lock);
+    }
+    if (mode[i] == SEC_STALE) {
+      nstale++;
+      if (sl < sizeof(stale)) sl += (size_t)snprintf(stale + sl, sizeof(stale) - sl, "%s\"%s\"", sl ? "," : "", name);
+    } else ncached++;
+    /* copied out under the lock: fragments are replaced, never edited in place */
+    pthread_mutex_lock(&g_status_cache_lock);
+    status_cache_t *e = &g_status_cache[i];
+    int have = e->valid;
+    if (have) rc = status_emit(e->frag, e->len, paths, npaths, &w);
+    pthread_mutex_unlock(&g_status_cache_lock);
+    /* nothing computed yet (cold cache or caching off): keep its keys, as null */
+    if (!have && rc == 0) {
+      char ph[512]; size_t pl = 0;
+      const char *k = g_status_sections[i].keys[0] ? g_status_sections[i].keys : name;
+      while (*k && pl < sizeof(ph)) {
+        size_t kl = strcspn(k, ",");
+        pl += (size_t)snprintf(ph + pl, sizeof(ph) - pl, "%s\"%.*s\":null", pl ? "," : "", (int)kl, k);
+        k += kl; if (*k == ',') k++;
+      }
+      if (pl < sizeof(ph)) rc = status_emit(ph, pl, paths, npaths, &w);
+    }
+  }
+  fj_group_put(g);
+  if (rc == 0 && nstale > 0) { JW_KEY(&w, "stale_sections"); jw_begin_arr(&w); jw_members(&w, stale, strlen(stale)); jw_end_arr(&w); }
+  jw_text(&w, "\n", 1); jw_end_obj(&w); jw_text(&w, "\n", 1);
+  char *buf; size_t len;
+  if (jw_finish(&w, &buf, &len, NULL) != 0 || rc != 0) { free(buf); return -1; }
+  struct timespec t1; clock_gettime(CLOCK_MONOTONIC, &t1);
+  long ms = (long)((t1.tv_sec - t0.tv_sec) * 1000 + (t1.tv_nsec - t0.tv_nsec) / 1000000);
+  fprintf(stderr, "[status-plugin] /status: computed %d (%s), cached %d, stale %d%s%s%s of %d sections in %ldms\n",
+          ncomputed, computed, ncached, nstale, nstale ? " (" : "", stale, nstale ? ")" : "", STATUS_NSECTIONS, ms);
+  *out = buf; *outlen = len;
+  return 0;
+}
+
+static int h_status(http_request_t *r) {
+  /* ?fields=: up to 32 comma-separated (dotted) paths; the raw list keys the coalescer */
+  char fields[512] = "", key[192] = ""; char *paths[32]; int npaths = 0;
+  if (get_query_param(r, "fields", fields, sizeof(fields)) && fields[0]) {
+    snprintf(key, sizeof(key), "%s", fields);
+    for (char *save = NULL, *t = strtok_r(fields, ",", &save); t && npaths < 32; t = strtok_r(NULL, ",", &save)) {
+      while (*t == ' ') t++;
+      if (*t) paths[npaths++] = t;
+    }
+  }
+  payload_t *p = NULL;
+  int co = endpoint_coalesce_begin(&g_status_co, key, &p);
+  if (p) {
+    send_payload_negotiated(r, ENC_STATUS, p); payload_unref(p);
+    if (co == CO_HIT) return 0;
+    http_end_response(r);
+  }
+  char *buf = NULL; size_t len = 0;
+  if (status_render(paths, npaths, &buf, &len) != 0) {
+    endpoint_coalesce_finish(&g_status_co, co, key, NULL);
+    if (co != CO_REVALIDATE) send_json(r, "{}\n");
+    return 0;
+  }
+  payload_t *np = payload_adopt(buf, len);
+  if (co != CO_REVALIDATE) { if (np) send_payload_negotiated(r, ENC_STATUS, np); else send_json(r, "{}\n"); }
+  endpoint_coalesce_finish(&g_status_co, co, key, np);
   return 0;
 }
 
@@ -3384,9 +4606,9 @@ static int h_status_compat(http_request_t *r) {
 
 
 /* --- Lightweight /status/lite (omit OLSR link/neighbor discovery for faster initial load) --- */
-static int h_status_lite(http_request_t *r) {
-  char *buf = NULL; size_t cap = 4096, len = 0; buf = malloc(cap); if(!buf){ send_json(r,"{}\n"); return 0; } buf[0]=0;
-  #define APP_L(fmt,...) do { if (json_appendf(&buf, &len, &cap, fmt, ##__VA_ARGS__) != 0) { free(buf); send_json(r,"{}\n"); return 0; } } while(0)
+static int status_lite_build(char **out, size_t *outlen) {
+  char *buf = NULL; size_t cap = 4096, len = 0; buf = malloc(cap); if(!buf) return -1; buf[0]=0;
+  #define APP_L(fmt,...) do { if (json_appendf(&buf, &len, &cap, fmt, ##__VA_ARGS__) != 0) { free(buf); return -1; } } while(0)
   APP_L("{");
   char hostname[256]=""; if(gethostname(hostname,sizeof(hostname))==0) hostname[sizeof(hostname)-1]=0; APP_L("\"hostname\":"); json_append_escaped(&buf,&len,&cap,hostname); APP_L(",");
   /* primary IPv4 */
@@ -3421,7 +4643,7 @@ static int h_status_lite(http_request_t *r) {
   }
   /* default route */
   char def_ip[64]="", def_dev[64]="", def_hostname[256]=""; char *rout=NULL; size_t rn=0;
-  if (util_exec("/sbin/ip route show default 2>/dev/null || /usr/sbin/ip route show default 2>/dev/null || ip route show default 2>/dev/null", &rout, &rn) == 0 && rout) {
+  if (ip_route_default(&rout, &rn) == 0 && rout) {
     char *p = strstr(rout, "via ");
     if (p) { p += 4; char *q = strchr(p, ' '); if (q) { size_t L = q - p; if (L < sizeof(def_ip)) { strncpy(def_ip, p, L); def_ip[L] = 0; } } }
     p = strstr(rout, " dev "); if (p) { p += 5; char *q = strchr(p, ' '); if (!q) q = strchr(p, '\n'); if (q) { size_t L = q - p; if (L < sizeof(def_dev)) { strncpy(def_dev, p, L); def_dev[L] = 0; } } }
@@ -3448,7 +4670,7 @@ static int h_status_lite(http_request_t *r) {
   if (g_status_devices_mode == 1) {
     /* full merged array as before */
     char *ud = NULL; size_t udn = 0;
-    char *arp = NULL; size_t arpn = 0;
+    payload_t *arp_p = NULL; const char *arp = NULL; size_t arpn = 0;
     char *normalized = NULL; size_t nlen = 0;
     int have_ud = 0, have_arp = 0;
     if (ubnt_discover_output(&ud, &udn) == 0 && ud) {
@@ -3460,7 +4682,9 @@ static int h_status_lite(http_request_t *r) {
       free(ud); ud = NULL; udn = 0;
     }
     if (g_allow_arp_fallback) {
-      if (get_arp_json_cached(&arp, &arpn) == 0 && arp && arpn > 0) {
+      arp_p = get_arp_json_cached();
+      if (arp_p && arp_p->len > 0) {
+        arp = arp_p->data; arpn = arp_p->len;
         have_arp = 1;
       }
     }
@@ -3495,7 +4719,7 @@ static int h_status_lite(http_request_t *r) {
             if (!first) APP_L(",");
             /* append raw substring */
             size_t chunk = (size_t)(q - p);
-            if (json_buf_append(&buf, &len, &cap, "%.*s", (int)chunk, p) < 0) { free(buf); send_json(r,"{}\n"); return 0; }
+            if (json_buf_append(&buf, &len, &cap, "%.*s", (int)chunk, p) < 0) { free(buf); return -1; }
             first = 0;
             p = q;
             continue;
@@ -3523,7 +4747,7 @@ static int h_status_lite(http_request_t *r) {
             if (q <= p) break;
             if (!first) APP_L(",");
             size_t chunk = (size_t)(q - p);
-            if (json_buf_append(&buf, &len, &cap, "%.*s", (int)chunk, p) < 0) { free(buf); send_json(r,"{}\n"); return 0; }
+            if (json_buf_append(&buf, &len, &cap, "%.*s", (int)chunk, p) < 0) { free(buf); return -1; }
             first = 0;
             p = q;
             continue;
@@ -3534,8 +4758,8 @@ static int h_status_lite(http_request_t *r) {
       /* close array */
       APP_L("],");
       if (normalized) free(normalized);
-      if (arp) free(arp);
     }
+    payload_unref(arp_p);
   } else if (g_status_devices_mode == 2) {
     /* summary only: counts of UBNT vs ARP vs total */
     int count_ubnt = 0, count_arp = 0;
@@ -3551,10 +4775,10 @@ static int h_status_lite(http_request_t *r) {
     if (ud) free(ud);
     if (normalized) free(normalized);
     if (g_allow_arp_fallback) {
-      char *arp = NULL; size_t arpn = 0;
-      if (get_arp_json_cached(&arp, &arpn) == 0 && arp) {
-        const char *p = arp; int depth=0; int in_obj=0; while (*p) { if (*p=='{'){ depth++; if(depth==1){ in_obj=1; count_arp++; } } else if (*p=='}'){ if(depth==1 && in_obj) in_obj=0; depth--; } p++; }
-        free(arp);
+      payload_t *arp = get_arp_json_cached();
+      if (arp) {
+        const char *p = arp->data; int depth=0; int in_obj=0; while (*p) { if (*p=='{'){ depth++; if(depth==1){ in_obj=1; count_arp++; } } else if (*p=='}'){ if(depth==1 && in_obj) in_obj=0; depth--; } p++; }
+        payload_unref(arp);
       }
     }
     APP_L("\"devices_summary\":{\"ubnt\":%d,\"arp\":%d,\"total\":%d},", count_ubnt, count_arp, count_ubnt+count_arp);
@@ -3579,7 +4803,27 @@ static int h_status_lite(http_request_t *r) {
   int lite_olsr2_exists = (path_exists("/usr/sbin/olsrd2") || path_exists("/usr/bin/olsrd2") || path_exists("/sbin/olsrd2"));
   APP_L("\"olsr2_on\":%s,\"olsrd_on\":%s,\"olsrd_exists\":%s,\"olsr2_exists\":%s", lite_olsr2_on?"true":"false", lite_olsrd_on?"true":"false", lite_olsrd_exists?"true":"false", lite_olsr2_exists?"true":"false");
   APP_L("}\n");
-  http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r,buf,len); free(buf); return 0;
+  *out = buf; *outlen = len; return 0;
+}
+
+static int h_status_lite(http_request_t *r) {
+  payload_t *p = NULL;
+  int co = endpoint_coalesce_begin(&g_status_lite_co, "", &p);
+  if (p) {
+    send_payload_negotiated(r, ENC_STATUS_LITE, p); payload_unref(p);
+    if (co == CO_HIT) return 0;
+    http_end_response(r);
+  }
+  char *buf = NULL; size_t len = 0;
+  if (status_lite_build(&buf, &len) != 0) {
+    endpoint_coalesce_finish(&g_status_lite_co, co, "", NULL);
+    if (co != CO_REVALIDATE) send_json(r, "{}\n");
+    return 0;
+  }
+  payload_t *np = payload_adopt(buf, len);
+  if (co != CO_REVALIDATE) { if (np) send_payload_negotiated(r, ENC_STATUS_LITE, np); else send_json(r, "{}\n"); }
+  endpoint_coalesce_finish(&g_status_lite_co, co, "", np);
+  return 0;
 }
 
 /* Devices JSON endpoint: return merged ubnt-discover (cached) + ARP entries
@@ -3587,7 +4831,7 @@ static int h_status_lite(http_request_t *r) {
  */
 static int h_devices_json(http_request_t *r) {
   char *arp = NULL; size_t arpn = 0;
-  char *udcopy = NULL; size_t udlen = 0;
+  payload_t *udp = NULL; const char *udcopy = NULL; size_t udlen = 0;
   int have_ud = 0, have_arp = 0;
   int want_lite = 0;
   if (r && r->query[0] && strstr(r->query, "lite=1")) want_lite = 1;
@@ -3601,13 +4845,17 @@ static int h_devices_json(http_request_t *r) {
     if (qpval[0] == '\0' || strcmp(qpval, "1") == 0 || strcmp(qpval, "true") == 0) want_refresh = 1;
   }
 
-  /* try to serve cached merged devices JSON via coalescer */
-  char *cached = NULL; size_t cached_len = 0;
-  if (endpoint_coalesce_try_start(&g_devices_co, &cached, &cached_len)) {
-    if (cached) {
-      http_send_status(r, 200, "OK"); http_printf(r, "Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r, cached, cached_len); free(cached); return 0;
+  /* serve the merged devices JSON via the coalescer; ?refresh=1 always rebuilds */
+  const char *co_key = want_lite ? "lite" : "";
+  int co = CO_BUILD_ALONE;
+  if (!want_refresh) {
+    payload_t *p = NULL;
+    co = endpoint_coalesce_begin(&g_devices_co, co_key, &p);
+    if (p) {
+      send_payload_negotiated(r, ENC_DEVICES, p); payload_unref(p);
+      if (co == CO_HIT) return 0;
+      http_end_response(r);
     }
-    /* otherwise fall through to build fresh output */
   }
 
   /* If the client requested a refresh, perform a synchronous discovery pass so
@@ -3621,16 +4869,12 @@ static int h_devices_json(http_request_t *r) {
 
   /* grab snapshot of cached normalized ubnt devices if present */
   pthread_mutex_lock(&g_devices_cache_lock);
-  if (g_devices_cache && g_devices_cache_len > 0) {
+  if (g_devices_cache && g_devices_cache->len > 0) {
     time_t nowt = time(NULL);
     if (g_ubnt_cache_ttl_s <= 0 || (nowt - g_devices_cache_ts) <= g_ubnt_cache_ttl_s) {
-      udlen = g_devices_cache_len;
-      udcopy = malloc(udlen + 1);
-      if (udcopy) {
-        memcpy(udcopy, g_devices_cache, udlen);
-        udcopy[udlen] = '\0';
-        have_ud = 1;
-      }
+      udp = payload_get(&g_devices_cache);
+      udcopy = udp->data; udlen = udp->len;
+      have_ud = 1;
     } else {
       if (g_fetch_log_queue || g_fetch_log_force) fprintf(stderr, "[status-plugin] devices cache stale (age=%lds > %ds)\n", (long)(nowt - g_devices_cache_ts), g_ubnt_cache_ttl_s);
     }
@@ -3643,14 +4887,14 @@ static int h_devices_json(http_request_t *r) {
   /* Build merged JSON */
   char *out = NULL; size_t cap = 4096, len = 0;
   out = malloc(cap);
-  if (!out) {
-    if (udcopy) free(udcopy);
+  if (!out || json_buf_append(&out, &len, &cap, "{") < 0) {
+    free(out);
+    payload_unref(udp);
     if (arp) free(arp);
-    send_json(r, "{}\n");
+    endpoint_coalesce_finish(&g_devices_co, co, co_key, NULL);
+    if (co != CO_REVALIDATE) send_json(r, "{}\n");
     return 0;
   }
-  out[0] = '\0';
-  if (json_buf_append(&out, &len, &cap, "{") < 0) { free(out); if (udcopy) free(udcopy); if (arp) free(arp); send_json(r, "{}\n"); return 0; }
   /* devices array */
   if (!have_ud) {
     json_buf_append(&out, &len, &cap, "\"devices\":[]");
@@ -3733,19 +4977,12 @@ static int h_devices_json(http_request_t *r) {
 
   json_buf_append(&out, &len, &cap, "}");
 
-  http_send_status(r, 200, "OK"); http_printf(r, "Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r, out, len);
-
-  /* Prepare a malloc'd copy for caching (ownership will be given to coalescer) */
-  char *cache_copy = NULL; size_t cache_len = 0;
-  if (out) {
-    cache_len = len;
-    cache_copy = malloc(cache_len + 1);
-    if (cache_copy) { memcpy(cache_copy, out, cache_len); cache_copy[cache_len] = '\0'; }
-  }
-  if (out) free(out);
-  if (udcopy) free(udcopy);
+  payload_unref(udp);
   if (arp) free(arp);
-  endpoint_coalesce_finish(&g_devices_co, cache_copy, cache_len);
+  /* the body itself becomes the cached payload */
+  payload_t *np = payload_adopt(out, len);
+  if (co != CO_REVALIDATE) { if (np) send_payload_negotiated(r, ENC_DEVICES, np); else send_json(r, "{}\n"); }
+  endpoint_coalesce_finish(&g_devices_co, co, co_key, np);
   return 0;
 }
 
@@ -3797,7 +5034,7 @@ static int h_status_stats(http_request_t *r) {
         if (routes_raw) { strncat(combined, routes_raw, clen); strncat(combined, "\n", clen); }
         if (topology_raw) { strncat(combined, topology_raw, clen); strncat(combined, "\n", clen); }
         char *norm = NULL; size_t nn = 0;
-        if (normalize_olsrd_links(combined, &norm, &nn) == 0 && norm && nn>0) {
+        if (normalize_olsrd_links(combined, NULL, &norm, &nn) == 0 && norm && nn>0) {
           /* crude parse: sum all occurrences of "\"routes\":\"NUM\"" and "\"nodes\":\"NUM\"" */
           unsigned long sum_routes = 0, sum_nodes = 0;
           const char *p = norm;
@@ -3907,15 +5144,15 @@ static int h_olsr_links(http_request_t *r) {
     size_t total = l1 + l2 + l3;
     /* Safety guard: avoid attempting to allocate absurdly large combined buffer */
     if (total && total < (512 * 1024)) {
-      char *combined_raw = malloc(total + 16);
+      char *combined_raw = req_alloc(total + 16);
       if (combined_raw) {
         size_t off=0;
         if (l1){ memcpy(combined_raw+off,links_raw,l1); off+=l1; combined_raw[off++]='\n'; }
         if (l2){ memcpy(combined_raw+off,routes_raw,l2); off+=l2; combined_raw[off++]='\n'; }
         if (l3){ memcpy(combined_raw+off,topology_raw,l3); off+=l3; }
         combined_raw[off]=0;
-        if(normalize_olsrd_links(combined_raw,&norm_links,&nlinks)!=0){ norm_links=NULL; }
-        free(combined_raw);
+        if(normalize_olsrd_links(combined_raw,NULL,&norm_links,&nlinks)!=0){ norm_links=NULL; }
+        req_free(combined_raw);
       }
     } else if (total) {
       fprintf(stderr, "[status-plugin] combined OLSR input too large (%zu bytes), skipping normalization\n", total);
@@ -3994,7 +5231,7 @@ static int h_status_olsr(http_request_t *r) {
   char hostname[256]=""; if(gethostname(hostname,sizeof(hostname))==0) hostname[sizeof(hostname)-1]=0; APP2("\"hostname\":"); json_append_escaped(&buf,&len,&cap,hostname); APP2(",");
   char ipaddr[128]=""; struct ifaddrs *ifap=NULL,*ifa=NULL; if(getifaddrs(&ifap)==0){ for(ifa=ifap;ifa;ifa=ifa->ifa_next){ if(ifa->ifa_addr && ifa->ifa_addr->sa_family==AF_INET){ struct sockaddr_in sa; memcpy(&sa,ifa->ifa_addr,sizeof(sa)); char b[INET_ADDRSTRLEN]; if(inet_ntop(AF_INET,&sa.sin_addr,b,sizeof(b)) && strcmp(b,"127.0.0.1")!=0){ snprintf(ipaddr,sizeof(ipaddr),"%s",b); break;} } } if(ifap) freeifaddrs(ifap);} APP2("\"ip\":"); json_append_escaped(&buf,&len,&cap,ipaddr); APP2(",");
   /* default route */
-  char def_ip[64]="", def_dev[64]=""; char *rout=NULL; size_t rn=0; if(util_exec("/sbin/ip route show default 2>/dev/null || /usr/sbin/ip route show default 2>/dev/null || ip route show default 2>/dev/null", &rout,&rn)==0 && rout){ char *p=strstr(rout,"via "); if(p){ p+=4; char *q=strchr(p,' '); if(q){ size_t L=q-p; if(L<sizeof(def_ip)){ strncpy(def_ip,p,L); def_ip[L]=0; } } } p=strstr(rout," dev "); if(p){ p+=5; char *q=strchr(p,' '); if(!q) q=strchr(p,'\n'); if(q){ size_t L=q-p; if(L<sizeof(def_dev)){ strncpy(def_dev,p,L); def_dev[L]=0; } } }
+  char def_ip[64]="", def_dev[64]=""; char *rout=NULL; size_t rn=0; if(ip_route_default(&rout,&rn)==0 && rout){ char *p=strstr(rout,"via "); if(p){ p+=4; char *q=strchr(p,' '); if(q){ size_t L=q-p; if(L<sizeof(def_ip)){ strncpy(def_ip,p,L); def_ip[L]=0; } } } p=strstr(rout," dev "); if(p){ p+=5; char *q=strchr(p,' '); if(!q) q=strchr(p,'\n'); if(q){ size_t L=q-p; if(L<sizeof(def_dev)){ strncpy(def_dev,p,L); def_dev[L]=0; } } }
     free(rout); }
   APP2("\"default_route\":{"); APP2("\"ip\":"); json_append_escaped(&buf,&len,&cap,def_ip); APP2(",\"dev\":"); json_append_escaped(&buf,&len,&cap,def_dev); APP2("},");
   /* attempt OLSR links minimal (separate flags) */
@@ -4008,7 +5245,7 @@ static int h_status_olsr(http_request_t *r) {
   APP2("\"olsrd_on\":%s,", olsrd_on?"true":"false");
   if(olsr_links_raw && oln>0){
     size_t l1=strlen(olsr_links_raw); size_t l2=routes_raw?strlen(routes_raw):0; size_t l3=topology_raw?strlen(topology_raw):0;
-    char *combined_raw=malloc(l1+l2+l3+8); if(combined_raw){ size_t off=0; memcpy(combined_raw+off,olsr_links_raw,l1); off+=l1; combined_raw[off++]='\n'; if(l2){ memcpy(combined_raw+off,routes_raw,l2); off+=l2; combined_raw[off++]='\n'; } if(l3){ memcpy(combined_raw+off,topology_raw,l3); off+=l3; } combined_raw[off]=0; char *norm=NULL; size_t nn=0; if(normalize_olsrd_links(combined_raw,&norm,&nn)==0 && norm){ APP2("\"links\":%s", norm); free(norm);} else { APP2("\"links\":[]"); } free(combined_raw);} else { APP2("\"links\":[]"); }
+    char *combined_raw=req_alloc(l1+l2+l3+8); if(combined_raw){ size_t off=0; memcpy(combined_raw+off,olsr_links_raw,l1); off+=l1; combined_raw[off++]='\n'; if(l2){ memcpy(combined_raw+off,routes_raw,l2); off+=l2; combined_raw[off++]='\n'; } if(l3){ memcpy(combined_raw+off,topology_raw,l3); off+=l3; } combined_raw[off]=0; char *norm=NULL; size_t nn=0; if(normalize_olsrd_links(combined_raw,def_ip,&norm,&nn)==0 && norm){ APP2("\"links\":%s", norm); free(norm);} else { APP2("\"links\":[]"); } req_free(combined_raw);} else { APP2("\"links\":[]"); }
   } else { APP2("\"links\":[]"); }
   APP2("}\n");
   http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r,buf,len); free(buf); if(olsr_links_raw) free(olsr_links_raw); if(routes_raw) free(routes_raw); if(topology_raw) free(topology_raw); return 0; }
@@ -4016,27 +5253,33 @@ static int h_status_olsr(http_request_t *r) {
 static int h_nodedb(http_request_t *r) {
   /* Only fetch if needed (respect TTL) */
   fetch_remote_nodedb_if_needed();
+  /* take a reference and let go of the lock: the fetch worker can swap in a
+   * new blob while a slow client is still reading this one
+   */
   pthread_mutex_lock(&g_nodedb_lock);
-  if (g_nodedb_cached && g_nodedb_cached_len>0) {
+  payload_t *nd = g_nodedb && g_nodedb->len > 0 ? payload_get(&g_nodedb) : NULL;
+  time_t last_fetch = g_nodedb_last_fetch;
+  pthread_mutex_unlock(&g_nodedb_lock);
+  if (nd) {
   /* Add basic caching headers to reduce client revalidation frequency */
-  http_send_status(r,200,"OK");
-  http_printf(r,"Content-Type: application/json; charset=utf-8\r\n");
+  int fmt = accept_binary_format(r);
+  char hdrs[256]; size_t hl = 0;
   /* Cache-Control: client-side TTL aligns with server-side TTL */
-  http_printf(r,"Cache-Control: public, max-age=%d\r\n", g_nodedb_ttl);
+  hl += (size_t)snprintf(hdrs + hl, sizeof(hdrs) - hl, "Cache-Control: public, max-age=%d\r\n", g_nodedb_ttl);
   /* Last-Modified: use last fetch time */
-    if (g_nodedb_last_fetch) {
-      char tbuf[64]; format_rfc1123_time(g_nodedb_last_fetch, tbuf, sizeof(tbuf)); http_printf(r, "Last-Modified: %s\r\n", tbuf);
+    if (last_fetch) {
+      char tbuf[64]; format_rfc1123_time(last_fetch, tbuf, sizeof(tbuf)); hl += (size_t)snprintf(hdrs + hl, sizeof(hdrs) - hl, "Last-Modified: %s\r\n", tbuf);
     }
-    /* ETag: weak tag based on length + last_fetch to allow conditional GET */
-    http_printf(r,"ETag: \"%zx-%ld\"\r\n\r\n", g_nodedb_cached_len, g_nodedb_last_fetch);
-  http_write(r,g_nodedb_cached,g_nodedb_cached_len); pthread_mutex_unlock(&g_nodedb_lock); return 0; }
-  pthread_mutex_unlock(&g_nodedb_lock);
+    /* ETag: the blob's own tag (+ encoding) to allow conditional GET */
+    snprintf(hdrs + hl, sizeof(hdrs) - hl, "ETag: %.*s%s\"\r\n", (int)strlen(nd->etag) - 1, nd->etag,
+             fmt == BINJSON_CBOR ? "-cbor" : fmt == BINJSON_MSGPACK ? "-msgpack" : "");
+  send_payload_as(r, fmt, ENC_NODEDB, nd, hdrs); payload_unref(nd); return 0; }
   /* Debug: return error info instead of empty JSON */
   char debug_json[1024];
   char url_copy[256];
   strncpy(url_copy, g_nodedb_url, sizeof(url_copy) - 1);
   url_copy[sizeof(url_copy) - 1] = '\0';
-  snprintf(debug_json, sizeof(debug_json), "{\"error\":\"No remote node_db data available\",\"url\":\"%s\",\"last_fetch\":%lld,\"cached_len\":%zu}", url_copy, (long long)g_nodedb_last_fetch, g_nodedb_cached_len);
+  snprintf(debug_json, sizeof(debug_json), "{\"error\":\"No remote node_db data available\",\"url\":\"%s\",\"last_fetch\":%lld,\"cached_len\":0}", url_copy, (long long)last_fetch);
   send_json(r, debug_json); return 0;
 }
 
@@ -4057,12 +5300,13 @@ static int h_nodedb_refresh(http_request_t *r) {
     /* perform forced fetch: enqueue and wait for completion (legacy behaviour) */
     enqueue_fetch_request(1, 1, FETCH_TYPE_NODEDB);
     pthread_mutex_lock(&g_nodedb_lock);
-    if (g_nodedb_cached && g_nodedb_cached_len>0) {
+    long long last = (long long)g_nodedb_last_fetch; size_t len = g_nodedb ? g_nodedb->len : 0;
+    pthread_mutex_unlock(&g_nodedb_lock);
+    if (len > 0) {
       /* return a small success JSON including last_fetch */
-      char resp[256]; snprintf(resp, sizeof(resp), "{\"status\":\"ok\",\"last_fetch\":%lld,\"len\":%zu}", (long long)g_nodedb_last_fetch, g_nodedb_cached_len);
-      http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r,resp,strlen(resp)); pthread_mutex_unlock(&g_nodedb_lock); return 0;
+      char resp[256]; snprintf(resp, sizeof(resp), "{\"status\":\"ok\",\"last_fetch\":%lld,\"len\":%zu}", last, len);
+      http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r,resp,strlen(resp)); return 0;
     }
-    pthread_mutex_unlock(&g_nodedb_lock);
     send_json(r, "{\"status\":\"error\",\"message\":\"fetch failed\"}");
     return 0;
   }
@@ -4074,7 +5318,7 @@ static int h_nodedb_refresh(http_request_t *r) {
   int qlen = 0; struct fetch_req *it = g_fetch_q_head; while (it) { qlen++; it = it->next; }
   pthread_mutex_unlock(&g_fetch_q_lock);
   pthread_mutex_lock(&g_nodedb_lock);
-  long last = g_nodedb_last_fetch; size_t len = g_nodedb_cached_len;
+  long last = g_nodedb_last_fetch; size_t len = g_nodedb ? g_nodedb->len : 0;
   pthread_mutex_unlock(&g_nodedb_lock);
   char resp2[256]; snprintf(resp2, sizeof(resp2), "{\"status\":\"queued\",\"last_fetch\":%ld,\"len\":%zu,\"queue_len\":%d}", last, len, qlen);
   http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r,resp2,strlen(resp2));
@@ -4083,11 +5327,19 @@ static int h_nodedb_refresh(http_request_t *r) {
 
   /* Simple metrics endpoint for fetch-related counters */
   static int h_fetch_metrics(http_request_t *r) {
-    char buf[256];
+    char buf[768];
     pthread_mutex_lock(&g_metrics_lock);
     unsigned long dropped = 0, retries = 0, successes = 0;
     METRIC_LOAD_ALL(dropped, retries, successes);
-    snprintf(buf, sizeof(buf), "{\"fetch_dropped\":%lu,\"fetch_retries\":%lu,\"fetch_successes\":%lu}", dropped, retries, successes);
+    pthread_mutex_lock(&g_nodedb_lock);
+    unsigned long nreq = g_nodedb_fetch_requests, nfull = g_nodedb_fetch_full, n304 = g_nodedb_fetch_not_modified, nsame = g_nodedb_fetch_unchanged;
+    unsigned long long nbytes = g_nodedb_fetch_bytes;
+    unsigned long da = g_nodedb_diff_added, dr = g_nodedb_diff_removed, dc = g_nodedb_diff_changed, db = g_nodedb_diff_bytes, ne = g_nodedb_entries;
+    pthread_mutex_unlock(&g_nodedb_lock);
+    snprintf(buf, sizeof(buf), "{\"fetch_dropped\":%lu,\"fetch_retries\":%lu,\"fetch_successes\":%lu,"
+      "\"nodedb\":{\"requests\":%lu,\"full\":%lu,\"not_modified\":%lu,\"unchanged\":%lu,\"not_modified_ratio\":%.3f,\"bytes\":%llu,\"entries\":%lu,"
+      "\"last_diff\":{\"added\":%lu,\"removed\":%lu,\"changed\":%lu,\"bytes\":%lu}}}",
+      dropped, retries, successes, nreq, nfull, n304, nsame, nreq ? (double)n304 / (double)nreq : 0.0, nbytes, ne, da, dr, dc, db);
     http_send_status(r,200,"OK"); http_printf(r, "Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r, buf, strlen(buf));
     return 0;
   }
@@ -4143,8 +5395,17 @@ static int h_status_py(http_request_t *r) {
 }
 
 /* Prometheus-compatible metrics endpoint (simple, non-exhaustive) */
+/* routes that served at least one request, for the arena usage metrics */
+typedef struct { int n; char route[64][64]; http_route_arena_stats_t st[64]; } route_arena_list_t;
+static void route_arena_collect(const char *route, const http_route_arena_stats_t *st, void *ud) {
+  route_arena_list_t *l = ud;
+  if (st->requests == 0 || l->n >= 64) return;
+  snprintf(l->route[l->n], sizeof(l->route[0]), "%s", route);
+  l->st[l->n++] = *st;
+}
+
 static int h_prometheus_metrics(http_request_t *r) {
-  char buf[1024]; size_t off = 0;
+  char buf[32768]; size_t off = 0;
   /* Safe append helper: calculate remaining space and update offset safely. */
 #define SAFE_APPEND(fmt, ...) do { \
     size_t _rem = (sizeof(buf) > off) ? (sizeof(buf) - off) : 0; \
@@ -4188,6 +5449,214 @@ static int h_prometheus_metrics(http_request_t *r) {
   SAFE_APPEND("# HELP olsrd_status_fetch_processed_discover_total Processed discover ops\n");
   SAFE_APPEND("# TYPE olsrd_status_fetch_processed_discover_total counter\n");
   SAFE_APPEND("olsrd_status_fetch_processed_discover_total %lu\n", dpd);
+  pthread_mutex_lock(&g_nodedb_lock);
+  unsigned long nreq = g_nodedb_fetch_requests, nfull = g_nodedb_fetch_full, n304 = g_nodedb_fetch_not_modified, nsame = g_nodedb_fetch_unchanged;
+  unsigned long long nbytes = g_nodedb_fetch_bytes;
+  unsigned long da = g_nodedb_diff_added, dr = g_nodedb_diff_removed, dc = g_nodedb_diff_changed, db = g_nodedb_diff_bytes;
+  pthread_mutex_unlock(&g_nodedb_lock);
+  SAFE_APPEND("# HELP olsrd_status_nodedb_fetch_responses_total NodeDB HTTP responses by outcome\n");
+  SAFE_APPEND("# TYPE olsrd_status_nodedb_fetch_responses_total counter\n");
+  SAFE_APPEND("olsrd_status_nodedb_fetch_responses_total{outcome=\"full\"} %lu\n", nfull - nsame);
+  SAFE_APPEND("olsrd_status_nodedb_fetch_responses_total{outcome=\"unchanged\"} %lu\n", nsame);
+  SAFE_APPEND("olsrd_status_nodedb_fetch_responses_total{outcome=\"not_modified\"} %lu\n", n304);
+  SAFE_APPEND("# HELP olsrd_status_nodedb_fetch_bytes_total Bytes transferred for NodeDB fetches\n");
+  SAFE_APPEND("# TYPE olsrd_status_nodedb_fetch_bytes_total counter\n");
+  SAFE_APPEND("olsrd_status_nodedb_fetch_bytes_total %llu\n", nbytes);
+  SAFE_APPEND("# HELP olsrd_status_nodedb_not_modified_ratio Share of NodeDB fetches answered with 304\n");
+  SAFE_APPEND("# TYPE olsrd_status_nodedb_not_modified_ratio gauge\n");
+  SAFE_APPEND("olsrd_status_nodedb_not_modified_ratio %.3f\n", nreq ? (double)n304 / (double)nreq : 0.0);
+  SAFE_APPEND("# HELP olsrd_status_nodedb_last_diff_entries Entries touched by the last NodeDB update\n");
+  SAFE_APPEND("# TYPE olsrd_status_nodedb_last_diff_entries gauge\n");
+  SAFE_APPEND("olsrd_status_nodedb_last_diff_entries{kind=\"added\"} %lu\n", da);
+  SAFE_APPEND("olsrd_status_nodedb_last_diff_entries{kind=\"removed\"} %lu\n", dr);
+  SAFE_APPEND("olsrd_status_nodedb_last_diff_entries{kind=\"changed\"} %lu\n", dc);
+  SAFE_APPEND("# HELP olsrd_status_nodedb_last_diff_bytes Serialized size of added and changed NodeDB entries\n");
+  SAFE_APPEND("# TYPE olsrd_status_nodedb_last_diff_bytes gauge\n");
+  SAFE_APPEND("olsrd_status_nodedb_last_diff_bytes %lu\n", db);
+  {
+    lru_cache_stats_t hs; lru_cache_get_stats(g_host_cache, &hs);
+    SAFE_APPEND("# HELP olsrd_status_host_cache_lookups_total Hostname cache lookups by result\n");
+    SAFE_APPEND("# TYPE olsrd_status_host_cache_lookups_total counter\n");
+    SAFE_APPEND("olsrd_status_host_cache_lookups_total{result=\"hit\"} %lu\n", hs.hits);
+    SAFE_APPEND("olsrd_status_host_cache_lookups_total{result=\"stale\"} %lu\n", hs.stale_hits);
+    SAFE_APPEND("olsrd_status_host_cache_lookups_total{result=\"negative\"} %lu\n", hs.negative_hits);
+    SAFE_APPEND("olsrd_status_host_cache_lookups_total{result=\"miss\"} %lu\n", hs.misses);
+    SAFE_APPEND("# HELP olsrd_status_host_cache_evictions_total Hostname cache LRU evictions\n");
+    SAFE_APPEND("# TYPE olsrd_status_host_cache_evictions_total counter\n");
+    SAFE_APPEND("olsrd_status_host_cache_evictions_total %lu\n", hs.evictions);
+    SAFE_APPEND("# HELP olsrd_status_host_cache_entries Hostname cache entries (and capacity)\n");
+    SAFE_APPEND("# TYPE olsrd_status_host_cache_entries gauge\n");
+    SAFE_APPEND("olsrd_status_host_cache_entries %zu\n", hs.entries);
+    SAFE_APPEND("olsrd_status_host_cache_capacity %zu\n", hs.capacity);
+  }
+  if (dns_async_running()) {
+    dns_async_stats_t ds; dns_async_get_stats(&ds);
+    SAFE_APPEND("# HELP olsrd_status_dns_queries_total Reverse DNS datagrams sent (retries included)\n");
+    SAFE_APPEND("# TYPE olsrd_status_dns_queries_total counter\n");
+    SAFE_APPEND("olsrd_status_dns_queries_total %lu\n", ds.sent);
+    SAFE_APPEND("# HELP olsrd_status_dns_lookups_total Reverse DNS lookups by outcome\n");
+    SAFE_APPEND("# TYPE olsrd_status_dns_lookups_total counter\n");
+    SAFE_APPEND("olsrd_status_dns_lookups_total{outcome=\"answered\"} %lu\n", ds.answered);
+    SAFE_APPEND("olsrd_status_dns_lookups_total{outcome=\"failed\"} %lu\n", ds.failed);
+    SAFE_APPEND("olsrd_status_dns_lookups_total{outcome=\"dropped\"} %lu\n", ds.dropped);
+    SAFE_APPEND("# HELP olsrd_status_dns_timeouts_total Reverse DNS attempts that hit their deadline\n");
+    SAFE_APPEND("# TYPE olsrd_status_dns_timeouts_total counter\n");
+    SAFE_APPEND("olsrd_status_dns_timeouts_total %lu\n", ds.timeouts);
+    SAFE_APPEND("# HELP olsrd_status_dns_pending Reverse DNS lookups queued or on the wire\n");
+    SAFE_APPEND("# TYPE olsrd_status_dns_pending gauge\n");
+    SAFE_APPEND("olsrd_status_dns_pending{state=\"queued\"} %u\n", ds.queued);
+    SAFE_APPEND("olsrd_status_dns_pending{state=\"inflight\"} %u\n", ds.inflight);
+  }
+  {
+    trace_monitor_stats_t ts; trace_monitor_get_stats(&ts);
+    if (ts.interval > 0) {
+      SAFE_APPEND("# HELP olsrd_status_uplink_trace_runs_total Background uplink traceroute runs (and failures)\n");
+      SAFE_APPEND("# TYPE olsrd_status_uplink_trace_runs_total counter\n");
+      SAFE_APPEND("olsrd_status_uplink_trace_runs_total %lu\n", ts.runs);
+      SAFE_APPEND("olsrd_status_uplink_trace_failures_total %lu\n", ts.failures);
+      SAFE_APPEND("# HELP olsrd_status_uplink_path_changes_total Uplink path changes seen between consecutive runs\n");
+      SAFE_APPEND("# TYPE olsrd_status_uplink_path_changes_total counter\n");
+      SAFE_APPEND("olsrd_status_uplink_path_changes_total %lu\n", ts.changes);
+    }
+  }
+  {
+    traffic_stats_t fs; traffic_get_stats(&fs);
+    if (fs.interval > 0) {
+      SAFE_APPEND("# HELP olsrd_status_traffic_memory_bytes Memory held by the interface traffic rings\n");
+      SAFE_APPEND("# TYPE olsrd_status_traffic_memory_bytes gauge\n");
+      SAFE_APPEND("olsrd_status_traffic_memory_bytes %zu\n", fs.memory_bytes);
+      SAFE_APPEND("olsrd_status_traffic_interfaces %d\n", fs.ifaces);
+      SAFE_APPEND("# HELP olsrd_status_traffic_samples_total Interface counter samples taken (and failed)\n");
+      SAFE_APPEND("# TYPE olsrd_status_traffic_samples_total counter\n");
+      SAFE_APPEND("olsrd_status_traffic_samples_total %lu\n", fs.samples);
+      SAFE_APPEND("olsrd_status_traffic_sample_errors_total %lu\n", fs.errors);
+    }
+  }
+  {
+    lqh_stats_t ls; lqh_get_stats(&ls);
+    if (ls.interval > 0) {
+      SAFE_APPEND("# HELP olsrd_status_lq_history_memory_bytes Memory held by the link quality history rings\n");
+      SAFE_APPEND("# TYPE olsrd_status_lq_history_memory_bytes gauge\n");
+      SAFE_APPEND("olsrd_status_lq_history_memory_bytes %zu\n", ls.memory_bytes);
+      SAFE_APPEND("olsrd_status_lq_history_neighbors %d\n", ls.neighbors);
+      SAFE_APPEND("# HELP olsrd_status_lq_history_samples_total Link quality collection passes\n");
+      SAFE_APPEND("# TYPE olsrd_status_lq_history_samples_total counter\n");
+      SAFE_APPEND("olsrd_status_lq_history_samples_total %lu\n", ls.samples);
+      SAFE_APPEND("olsrd_status_lq_history_flushes_total %lu\n", ls.flushes);
+      SAFE_APPEND("olsrd_status_lq_history_flush_errors_total %lu\n", ls.flush_errors);
+    }
+  }
+  {
+    pthread_mutex_lock(&g_enc_lock);
+    unsigned long eh = g_enc_hits, em = g_enc_misses, ee = g_enc_errors;
+    pthread_mutex_unlock(&g_enc_lock);
+    SAFE_APPEND("# HELP olsrd_status_binary_encodings_total CBOR/MessagePack bodies served from the encoding cache (hit) or transcoded (miss)\n");
+    SAFE_APPEND("# TYPE olsrd_status_binary_encodings_total counter\n");
+    SAFE_APPEND("olsrd_status_binary_encodings_total{result=\"hit\"} %lu\n", eh);
+    SAFE_APPEND("olsrd_status_binary_encodings_total{result=\"miss\"} %lu\n", em);
+    SAFE_APPEND("olsrd_status_binary_encodings_total{result=\"error\"} %lu\n", ee);
+  }
+  {
+    unsigned long sh[STATUS_NSECTIONS], sm[STATUS_NSECTIONS], sl[STATUS_NSECTIONS]; uint64_t su[STATUS_NSECTIONS]; size_t sa[STATUS_NSECTIONS];
+    pthread_mutex_lock(&g_status_cache_lock);
+    for (int i = 0; i < STATUS_NSECTIONS; i++) { sh[i] = g_status_cache[i].hits; sm[i] = g_status_cache[i].misses; sl[i] = g_status_cache[i].late; su[i] = g_status_cache[i].compute_us; sa[i] = g_status_cache[i].arena_peak; }
+    pthread_mutex_unlock(&g_status_cache_lock);
+    SAFE_APPEND("# HELP olsrd_status_section_requests_total /status sections served from the fragment cache (hit) or computed (miss)\n");
+    SAFE_APPEND("# TYPE olsrd_status_section_requests_total counter\n");
+    for (int i = 0; i < STATUS_NSECTIONS; i++) {
+      SAFE_APPEND("olsrd_status_section_requests_total{section=\"%s\",result=\"hit\"} %lu\n", g_status_sections[i].name, sh[i]);
+      SAFE_APPEND("olsrd_status_section_requests_total{section=\"%s\",result=\"miss\"} %lu\n", g_status_sections[i].name, sm[i]);
+      if (sl[i]) SAFE_APPEND("olsrd_status_section_requests_total{section=\"%s\",result=\"stale\"} %lu\n", g_status_sections[i].name, sl[i]);
+    }
+    SAFE_APPEND("# HELP olsrd_status_section_compute_seconds_total Time spent computing each /status section\n");
+    SAFE_APPEND("# TYPE olsrd_status_section_compute_seconds_total counter\n");
+    for (int i = 0; i < STATUS_NSECTIONS; i++)
+      SAFE_APPEND("olsrd_status_section_compute_seconds_total{section=\"%s\"} %.6f\n", g_status_sections[i].name, (double)su[i] / 1e6);
+    SAFE_APPEND("# HELP olsrd_status_section_arena_bytes_peak Most scratch arena bytes one computation of a /status section used\n");
+    SAFE_APPEND("# TYPE olsrd_status_section_arena_bytes_peak gauge\n");
+    for (int i = 0; i < STATUS_NSECTIONS; i++)
+      if (sa[i]) SAFE_APPEND("olsrd_status_section_arena_bytes_peak{section=\"%s\"} %zu\n", g_status_sections[i].name, sa[i]);
+  }
+  {
+    static const struct { const char *name; endpoint_coalesce_t *e; } cos[] = {
+      { "status", &g_status_co }, { "status_lite", &g_status_lite_co }, { "devices", &g_devices_co },
+      { "discover", &g_discover_raw_co }, { "discover_ubnt", &g_discover_co },
+      { "traceroute", &g_trace_target_co }, { "status_traceroute", &g_traceroute_co },
+    };
+    SAFE_APPEND("# HELP olsrd_status_coalesce_total Coalesced endpoint requests: fresh hit, stale served while revalidating, waited for a first fill, wait timed out, built\n");
+    SAFE_APPEND("# TYPE olsrd_status_coalesce_total counter\n");
+    for (size_t i = 0; i < sizeof(cos) / sizeof(cos[0]); i++) {
+      endpoint_coalesce_t *e = cos[i].e;
+      pthread_mutex_lock(&e->m);
+      unsigned long v[5] = { e->hits, e->stale, e->waits, e->timeouts, e->builds };
+      pthread_mutex_unlock(&e->m);
+      static const char *res[5] = { "hit", "stale", "wait", "timeout", "build" };
+      for (int k = 0; k < 5; k++) SAFE_APPEND("olsrd_status_coalesce_total{endpoint=\"%s\",result=\"%s\"} %lu\n", cos[i].name, res[k], v[k]);
+    }
+  }
+  {
+    route_arena_list_t ra = { .n = 0 };
+    http_route_arena_stats(route_arena_collect, &ra);
+    if (ra.n > 0) {
+      SAFE_APPEND("# HELP olsrd_status_request_arena_bytes Request scratch arena bytes per route: largest request and average\n");
+      SAFE_APPEND("# TYPE olsrd_status_request_arena_bytes gauge\n");
+      for (int i = 0; i < ra.n; i++) {
+        const http_route_arena_stats_t *st = &ra.st[i];
+        SAFE_APPEND("olsrd_status_request_arena_bytes{route=\"%s\",stat=\"peak\"} %zu\n", ra.route[i], st->bytes_peak);
+        SAFE_APPEND("olsrd_status_request_arena_bytes{route=\"%s\",stat=\"avg\"} %llu\n", ra.route[i], st->bytes_total / st->requests);
+        SAFE_APPEND("olsrd_status_request_arena_allocs_avg{route=\"%s\"} %llu\n", ra.route[i], st->allocs_total / st->requests);
+      }
+    }
+  }
+  {
+    fj_stats_t fs; fj_get_stats(&fs);
+    if (fs.workers > 0) {
+      SAFE_APPEND("# HELP olsrd_status_workers_busy /status section workers computing right now, of olsrd_status_workers\n");
+      SAFE_APPEND("# TYPE olsrd_status_workers_busy gauge\n");
+      SAFE_APPEND("olsrd_status_workers %d\n", fs.workers);
+      SAFE_APPEND("olsrd_status_workers_busy %u\n", fs.busy);
+      SAFE_APPEND("olsrd_status_workers_queued %u\n", fs.queued);
+      SAFE_APPEND("# HELP olsrd_status_worker_tasks_total Section tasks run on workers, inline on the request thread, or still running at the deadline\n");
+      SAFE_APPEND("# TYPE olsrd_status_worker_tasks_total counter\n");
+      SAFE_APPEND("olsrd_status_worker_tasks_total{result=\"spawned\"} %lu\n", fs.spawned);
+      SAFE_APPEND("olsrd_status_worker_tasks_total{result=\"inline\"} %lu\n", fs.inlined);
+      SAFE_APPEND("olsrd_status_worker_tasks_total{result=\"late\"} %lu\n", fs.late);
+    }
+  }
+  {
+    neigh_cache_stats_t ns; neigh_cache_get_stats(&ns);
+    if (ns.running) {
+      SAFE_APPEND("# HELP olsrd_status_neigh_entries Entries in the netlink neighbour table (ARP/NDP)\n");
+      SAFE_APPEND("# TYPE olsrd_status_neigh_entries gauge\n");
+      SAFE_APPEND("olsrd_status_neigh_entries %d\n", ns.entries);
+      SAFE_APPEND("# HELP olsrd_status_neigh_events_total Neighbour table netlink events, dumps and socket overruns\n");
+      SAFE_APPEND("# TYPE olsrd_status_neigh_events_total counter\n");
+      SAFE_APPEND("olsrd_status_neigh_events_total %lu\n", ns.events);
+      SAFE_APPEND("olsrd_status_neigh_dumps_total %lu\n", ns.dumps);
+      SAFE_APPEND("olsrd_status_neigh_overruns_total %lu\n", ns.overruns);
+    }
+  }
+  {
+    exec_cmd_stats_t es[32]; int ne = exec_get_stats(es, 32);
+    if (ne > 0) {
+      SAFE_APPEND("# HELP olsrd_status_exec_runs_total External command runs by outcome\n");
+      SAFE_APPEND("# TYPE olsrd_status_exec_runs_total counter\n");
+      for (int i = 0; i < ne; i++) {
+        SAFE_APPEND("olsrd_status_exec_runs_total{cmd=\"%s\",outcome=\"ok\"} %lu\n", es[i].name, es[i].runs - es[i].failures - es[i].timeouts);
+        SAFE_APPEND("olsrd_status_exec_runs_total{cmd=\"%s\",outcome=\"failed\"} %lu\n", es[i].name, es[i].failures);
+        SAFE_APPEND("olsrd_status_exec_runs_total{cmd=\"%s\",outcome=\"timeout\"} %lu\n", es[i].name, es[i].timeouts);
+      }
+      SAFE_APPEND("# HELP olsrd_status_exec_seconds_total Wall time spent in external commands (spawn to reap)\n");
+      SAFE_APPEND("# TYPE olsrd_status_exec_seconds_total counter\n");
+      for (int i = 0; i < ne; i++) SAFE_APPEND("olsrd_status_exec_seconds_total{cmd=\"%s\"} %.6f\n", es[i].name, (double)es[i].total_us / 1e6);
+      SAFE_APPEND("# HELP olsrd_status_exec_max_seconds Slowest single run per command\n");
+      SAFE_APPEND("# TYPE olsrd_status_exec_max_seconds gauge\n");
+      for (int i = 0; i < ne; i++) SAFE_APPEND("olsrd_status_exec_max_seconds{cmd=\"%s\"} %.6f\n", es[i].name, (double)es[i].max_us / 1e6);
+    }
+    SAFE_APPEND("# HELP olsrd_status_exec_helper Pre-forked spawn helper in use\n");
+    SAFE_APPEND("# TYPE olsrd_status_exec_helper gauge\n");
+    SAFE_APPEND("olsrd_status_exec_helper %d\n", exec_helper_running() ? 1 : 0);
+  }
 
   http_send_status(r,200,"OK"); http_printf(r, "Content-Type: text/plain; charset=utf-8\r\n\r\n"); http_write(r, buf, off);
   /* cleanup macro */
@@ -4199,6 +5668,23 @@ static int h_prometheus_metrics(http_request_t *r) {
  * This avoids client-side parsing issues when /status may be wrapped or concatenated for some collectors.
  */
 static int h_status_traceroute(http_request_t *r) {
+  {
+    trace_sample_t s;
+    int mon = trace_monitor_latest(&s);
+    if (mon >= 0) {
+      char want_hist[8] = ""; (void)get_query_param(r, "history", want_hist, sizeof(want_hist));
+      size_t cap = 4096, len = 0; char *out = malloc(cap);
+      int rc = out ? 0 : -1;
+      if (rc == 0) rc = json_buf_append(&out, &len, &cap, "{") < 0 ? -1 : 0;
+      if (rc == 0) rc = uplink_sample_json(&out, &len, &cap, mon ? &s : NULL, 1);
+      if (rc == 0 && want_hist[0] == '1') rc = uplink_history_json(&out, &len, &cap);
+      if (rc == 0) rc = json_buf_append(&out, &len, &cap, " }") < 0 ? -1 : 0;
+      if (rc == 0) { http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r, out, len); }
+      else send_json(r, "{}\n");
+      free(out);
+      return 0;
+    }
+  }
   char traceroute_to[256] = "";
   int traceroute_to_set = 0;
   /* attempt to read /config/custom/www/settings.inc for traceroute_to */
@@ -4244,49 +5730,54 @@ static int h_status_traceroute(http_request_t *r) {
     esc[p]=0; TAPP("\"%s\",", esc);
   }
 
-  /* If traceroute binary not available, return empty array */
-  if (!g_has_traceroute) {
-    TAPP("\"trace_to_uplink\":[] }");
-    http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r, outbuf, outlen);
-    return 0;
-  }
-
   /* Run traceroute and parse lines into simple objects (reuse same parsing as h_status) */
   {
     /* coalesce concurrent traceroute work */
-    char *cached = NULL; size_t cached_len = 0;
-    if (endpoint_coalesce_try_start(&g_traceroute_co, &cached, &cached_len)) {
-      if (cached) {
-        http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r, cached, cached_len);
-        free(cached);
+    payload_t *cp = NULL;
+    int co = endpoint_coalesce_begin(&g_traceroute_co, traceroute_to, &cp);
+    if (cp) {
+      http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r, cp->data, cp->len);
+      payload_unref(cp);
+      if (co == CO_HIT) return 0;
+      http_end_response(r);
+    }
+    /* the response goes out unless a stale copy was already sent */
+    int send_now = co != CO_REVALIDATE;
+    trace_result_t tr;
+    if (trace_uplink(traceroute_to, &tr) == 0) {
+      size_t resp_cap = 4096, resp_len = 0; char *resp = malloc(resp_cap);
+      if (resp && json_buf_append(&resp, &resp_len, &resp_cap, "%s\"trace_to_uplink\":", outbuf) == 0 &&
+          trace_hops_json(&resp, &resp_len, &resp_cap, &tr, "") == 0 && json_buf_append(&resp, &resp_len, &resp_cap, " }") == 0) {
+        if (send_now) { http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r, resp, resp_len); }
+        endpoint_coalesce_finish(&g_traceroute_co, co, traceroute_to, payload_adopt(resp, resp_len));
         return 0;
       }
-      /* fell through to perform work */
+      free(resp);
+    }
+    /* If the traceroute binary is not available either, return an empty array */
+    if (!g_has_traceroute) {
+      TAPP("\"trace_to_uplink\":[] }");
+      if (send_now) { http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r, outbuf, outlen); }
+      endpoint_coalesce_finish(&g_traceroute_co, co, traceroute_to, NULL);
+      return 0;
     }
     const char *trpath = (g_traceroute_path[0]) ? g_traceroute_path : "traceroute";
-    size_t cmdlen = strlen(trpath) + strlen(traceroute_to) + 64;
-    char *cmd = (char*)malloc(cmdlen);
-    if (!cmd) { TAPP("\"trace_to_uplink\":[] }"); http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r, outbuf, outlen); endpoint_coalesce_finish(&g_traceroute_co, NULL, 0); return 0; }
-    snprintf(cmd, cmdlen, "%s -4 -w 1 -q 1 %s", trpath, traceroute_to);
+    const char *targv[] = { trpath, "-4", "-w", "1", "-q", "1", traceroute_to, NULL };
     char *tout = NULL; size_t t_n = 0;
-    if (util_exec(cmd, &tout, &t_n) != 0 || !tout || t_n==0) {
-      free(cmd);
+    int trc = exec_argv(targv, 0, TRACEROUTE_DEADLINE_MS, &tout, &t_n, NULL);
+    if ((trc != 0 && trc != EXEC_TIMEOUT) || !tout || t_n==0) {
       TAPP("\"trace_to_uplink\":[] }");
-      /* prepare a malloc'd copy for cache */
-      char *resp_copy = strdup(outbuf);
-      size_t resp_len = resp_copy ? strlen(resp_copy) : 0;
-      http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r, outbuf, outlen);
-      endpoint_coalesce_finish(&g_traceroute_co, resp_copy, resp_len);
+      if (send_now) { http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r, outbuf, outlen); }
+      endpoint_coalesce_finish(&g_traceroute_co, co, traceroute_to, payload_new(outbuf, outlen));
       if (tout) free(tout);
       return 0;
     }
-    free(cmd);
     /* We'll build the full JSON into a malloc'd buffer so it can be cached. */
     size_t resp_cap = 8192; size_t resp_len = 0; char *resp = malloc(resp_cap);
     if (!resp) {
       if (tout) free(tout);
-      endpoint_coalesce_finish(&g_traceroute_co, NULL, 0);
-      TAPP("\"trace_to_uplink\":[] }"); http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r, outbuf, outlen); return 0;
+      endpoint_coalesce_finish(&g_traceroute_co, co, traceroute_to, NULL);
+      TAPP("\"trace_to_uplink\":[] }"); if (send_now) { http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r, outbuf, outlen); } return 0;
     }
     resp[0] = '\0';
     /* copy existing header content from outbuf into resp */
@@ -4303,7 +5794,7 @@ static int h_status_traceroute(http_request_t *r) {
       if (!line || !*line) continue;
       if (strstr(line, "traceroute to") == line) continue;
       /* normalize spaces */
-      char *norm = strdup(line); if(!norm) continue;
+      char *norm = req_strdup(line); if(!norm) continue;
       for(char *q=norm; *q; ++q) if(*q=='\t') *q=' ';
       /* collapse spaces */
       char *w=norm, *rdr=norm; int sp=0; while(*rdr){ if(*rdr==' '){ if(!sp){ *w++=' '; sp=1; } } else { *w++=*rdr; sp=0; } rdr++; } *w=0;
@@ -4312,7 +5803,7 @@ static int h_status_traceroute(http_request_t *r) {
       while(tok){ if(idx==0) snprintf(hop,sizeof(hop),"%s",tok); else if(idx==1){ if(strcmp(tok,"*")==0) snprintf(ip,sizeof(ip),"*"); else snprintf(raw_host,sizeof(raw_host),"%s",tok); } else { if(tok[0]=='('){ char *endp=strchr(tok,')'); if(endp){ *endp=0; snprintf(raw_ip_paren,sizeof(raw_ip_paren),"%s",tok+1); seen_paren_ip=1; } } if(!ping[0]){ size_t L=strlen(tok); if(L>2 && tok[L-2]=='m' && tok[L-1]=='s'){ char num[32]; size_t cpy=(L-2)<sizeof(num)-1?(L-2):sizeof(num)-1; memcpy(num,tok,cpy); num[cpy]=0; int ok=1; for(size_t xi=0; xi<cpy; ++xi){ if(!(isdigit((unsigned char)num[xi])||num[xi]=='.')){ok=0;break;} } if(ok) snprintf(ping,sizeof(ping),"%s",num); } else if(strcmp(tok,"ms")==0 && prev_tok[0]){ int ok=1; for(size_t xi=0; prev_tok[xi]; ++xi){ if(!(isdigit((unsigned char)prev_tok[xi])||prev_tok[xi]=='.')){ok=0;break;} } if(ok) snprintf(ping,sizeof(ping),"%s",prev_tok); } } }
         snprintf(prev_tok,sizeof(prev_tok),"%s",tok); tok=strtok_r(NULL," ",&save); idx++; }
       if(seen_paren_ip){ snprintf(ip,sizeof(ip),"%s",raw_ip_paren); snprintf(host,sizeof(host),"%s",raw_host); } else { if(raw_host[0]){ int is_ip=1; for(char *c=raw_host; *c; ++c){ if(!isdigit((unsigned char)*c) && *c!='.') { is_ip=0; break; } } if(is_ip) snprintf(ip,sizeof(ip),"%.*s", (int)sizeof(ip)-1, raw_host); else snprintf(host,sizeof(host),"%.*s", (int)sizeof(host)-1, raw_host); } }
-      free(norm);
+      req_free(norm);
       /* append comma if needed */
       if (!first) {
         if (resp_len + 2 > resp_cap) { size_t nc = resp_cap * 2 + 1024; char *tmp = realloc(resp, nc); if (tmp) { resp = tmp; resp_cap = nc; } }
@@ -4334,10 +5825,10 @@ static int h_status_traceroute(http_request_t *r) {
     /* close array/object */
     if (resp_len + 4 > resp_cap) { size_t nc = resp_cap + 64; char *tmp = realloc(resp, nc); if (tmp) { resp = tmp; resp_cap = nc; } }
     memcpy(resp + resp_len, "] }", 3); resp_len += 3; resp[resp_len] = '\0';
-    http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r, resp, resp_len);
+    if (send_now) { http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r, resp, resp_len); }
     if (tout) free(tout);
-    /* cache and finish coalescing (endpoint_coalesce_finish takes ownership of resp) */
-    endpoint_coalesce_finish(&g_traceroute_co, resp, resp_len);
+    /* cache and finish coalescing (the payload takes ownership of resp) */
+    endpoint_coalesce_finish(&g_traceroute_co, co, traceroute_to, payload_adopt(resp, resp_len));
     return 0;
   }
 }
@@ -4547,16 +6038,30 @@ static int h_diagnostics_json(http_request_t *r) {
   /* expose some top-level booleans and additional config flags */
   if (json_appendf(&out, &outlen, &outcap, "\"status_flags\":{\"is_edgerouter\":%d,\"is_linux_container\":%d,\"allow_arp_fallback\":%d,\"status_devices_mode\":%d},", g_is_edgerouter, g_is_linux_container, g_allow_arp_fallback, g_status_devices_mode) != 0) { free(out); if(versions) free(versions); if(fetchbuf) free(fetchbuf); if(summary) free(summary); send_json(r, "{}\n"); return 0; }
 
-  if (json_appendf(&out, &outlen, &outcap, "\"nodedb\":{\"cfg_port_set\":%d,\"cfg_nodedb_ttl_set\":%d,\"cfg_nodedb_write_disk_set\":%d,\"cfg_nodedb_url_set\":%d,\"cfg_net_count\":%d,\"nodedb_ttl\":%d,\"nodedb_last_fetch\":%d,\"nodedb_cached_len\":%d,\"nodedb_fetch_in_progress\":%d,\"nodedb_write_disk\":%d,\"nodedb_startup_wait\":%d,\"nodedb_url\":\"%s\"},",
+  pthread_mutex_lock(&g_nodedb_lock);
+  size_t snap_prefixes = nodedb_index_count(g_nodedb_index);
+  size_t nodedb_len = g_nodedb ? g_nodedb->len : 0;
+  unsigned long long snap_hash = (unsigned long long)nodedb_index_hash(g_nodedb_index);
+  int has_etag = g_nodedb_etag[0] != 0, has_lm = g_nodedb_last_modified[0] != 0;
+  unsigned long n304 = g_nodedb_fetch_not_modified, nreq = g_nodedb_fetch_requests;
+  unsigned long long nbytes = g_nodedb_fetch_bytes;
+  time_t last_fetch = g_nodedb_last_fetch;
+  pthread_mutex_unlock(&g_nodedb_lock);
+  if (json_appendf(&out, &outlen, &outcap, "\"nodedb\":{\"cfg_port_set\":%d,\"cfg_nodedb_ttl_set\":%d,\"cfg_nodedb_write_disk_set\":%d,\"cfg_nodedb_url_set\":%d,\"cfg_net_count\":%d,\"nodedb_ttl\":%d,\"nodedb_last_fetch\":%d,\"nodedb_cached_len\":%d,\"nodedb_fetch_in_progress\":%d,\"nodedb_write_disk\":%d,\"nodedb_startup_wait\":%d,\"nodedb_url\":\"%s\",\"snapshot\":{\"path\":\"%s\",\"prefixes\":%zu,\"hash\":\"%016llx\"},\"conditional\":{\"has_etag\":%d,\"has_last_modified\":%d,\"not_modified\":%lu,\"requests\":%lu,\"bytes\":%llu}},",
               g_cfg_port_set, g_cfg_nodedb_ttl_set, g_cfg_nodedb_write_disk_set, g_cfg_nodedb_url_set, g_cfg_net_count,
-              g_nodedb_ttl, (int)g_nodedb_last_fetch, (int)g_nodedb_cached_len, g_nodedb_fetch_in_progress, g_nodedb_write_disk, g_nodedb_startup_wait, g_nodedb_url) != 0) { free(out); if(versions) free(versions); if(fetchbuf) free(fetchbuf); if(summary) free(summary); send_json(r, "{}\n"); return 0; }
+              g_nodedb_ttl, (int)last_fetch, (int)nodedb_len, g_nodedb_fetch_in_progress, g_nodedb_write_disk, g_nodedb_startup_wait, g_nodedb_url,
+              g_nodedb_snapshot_path, snap_prefixes, snap_hash,
+              has_etag, has_lm, n304, nreq, nbytes) != 0) { free(out); if(versions) free(versions); if(fetchbuf) free(fetchbuf); if(summary) free(summary); send_json(r, "{}\n"); return 0; }
 
     if (json_appendf(&out, &outlen, &outcap, "\"fetch_opts\":{\"fetch_log_queue\":%d,\"cfg_fetch_log_queue_set\":%d,\"fetch_log_force\":%d,\"cfg_fetch_log_force_set\":%d,\"fetch_report_interval\":%d,\"cfg_fetch_report_set\":%d,\"fetch_auto_refresh_ms\":%d,\"cfg_fetch_auto_refresh_set\":%d},",
                           g_fetch_log_queue, g_cfg_fetch_log_queue_set, g_fetch_log_force, g_cfg_fetch_log_force_set, g_fetch_report_interval, g_cfg_fetch_report_set, g_fetch_auto_refresh_ms, g_cfg_fetch_auto_refresh_set) != 0) { free(out); if(versions) free(versions); if(fetchbuf) free(fetchbuf); if(summary) free(summary); send_json(r, "{}\n"); return 0; }
 
     if (json_appendf(&out, &outlen, &outcap, "\"ubnt\":{\"devices_discover_interval\":%d,\"ubnt_probe_window_ms\":%d,\"ubnt_cache_ttl_s\":%d},", g_devices_discover_interval, g_ubnt_probe_window_ms, g_ubnt_cache_ttl_s) != 0) { free(out); if(versions) free(versions); if(fetchbuf) free(fetchbuf); if(summary) free(summary); send_json(r, "{}\n"); return 0; }
 
-    if (json_appendf(&out, &outlen, &outcap, "\"arp\":{\"arp_cache_len\":%d,\"arp_cache_ts\":%d,\"arp_cache_ttl_s\":%d},", g_arp_cache_len, (int)g_arp_cache_ts, g_arp_cache_ttl_s) != 0) { free(out); if(versions) free(versions); if(fetchbuf) free(fetchbuf); if(summary) free(summary); send_json(r, "{}\n"); return 0; }
+    pthread_mutex_lock(&g_arp_cache_lock);
+    int arp_len = g_arp_cache ? (int)g_arp_cache->len : 0; time_t arp_ts = g_arp_cache_ts;
+    pthread_mutex_unlock(&g_arp_cache_lock);
+    if (json_appendf(&out, &outlen, &outcap, "\"arp\":{\"arp_cache_len\":%d,\"arp_cache_ts\":%d,\"arp_cache_ttl_s\":%d},", arp_len, (int)arp_ts, g_arp_cache_ttl_s) != 0) { free(out); if(versions) free(versions); if(fetchbuf) free(fetchbuf); if(summary) free(summary); send_json(r, "{}\n"); return 0; }
 
     if (json_appendf(&out, &outlen, &outcap, "\"coalesce\":{\"devices_ttl\":%d,\"discover_ttl\":%d,\"traceroute_ttl\":%d},", g_coalesce_devices_ttl, g_coalesce_discover_ttl, g_coalesce_traceroute_ttl) != 0) { free(out); if(versions) free(versions); if(fetchbuf) free(fetchbuf); if(summary) free(summary); send_json(r, "{}\n"); return 0; }
 
@@ -4580,30 +6085,76 @@ static int h_traceroute(http_request_t *r) {
   char target[256] = "";
   (void)get_query_param(r, "target", target, sizeof(target));
   char want_json[8] = ""; (void)get_query_param(r, "format", want_json, sizeof(want_json));
+  char proto[8] = ""; (void)get_query_param(r, "proto", proto, sizeof(proto));
   if (!target[0]) { send_text(r, "No target provided\n"); return 0; }
+  int is_json = want_json[0] == 'j' || want_json[0] == 'J';
+  const char *ctype = is_json ? "application/json" : "text/plain";
+  char co_key[192]; snprintf(co_key, sizeof(co_key), "%s|%d|%s", target, is_json, proto);
+  payload_t *cp = NULL;
+  int co = endpoint_coalesce_begin(&g_trace_target_co, co_key, &cp);
+  if (cp) {
+    http_send_status(r, 200, "OK"); http_printf(r, "Content-Type: %s; charset=utf-8\r\n\r\n", ctype); http_write(r, cp->data, cp->len);
+    payload_unref(cp);
+    if (co == CO_HIT) return 0;
+    http_end_response(r);
+  }
+  {
+    /* in-process: same limits as the command below (max 8 hops), all hops probed at once */
+    trace_opts_t o = { .max_ttl = 8, .timeout_ms = NATIVE_TRACE_TIMEOUT_MS, .proto = strcmp(proto, "icmp") == 0 ? TRACE_ICMP : TRACE_UDP, .family = 0 };
+    trace_result_t tr;
+    if (trace_run(target, &o, &tr) == 0) {
+      size_t cap = 2048, len2 = 0; char *out = malloc(cap);
+      int rc = out ? 0 : -1;
+      if (is_json) {
+        if (rc == 0) rc = json_buf_append(&out, &len2, &cap, "{\"target\":");
+        if (rc == 0) rc = json_append_escaped(&out, &len2, &cap, target);
+        if (rc == 0) rc = json_buf_append(&out, &len2, &cap, ",\"address\":\"%s\",\"reached\":%s,\"elapsed_ms\":%ld,\"hops\":",
+                                          tr.target_ip, tr.reached ? "true" : "false", tr.elapsed_ms);
+        if (rc == 0) rc = trace_hops_json(&out, &len2, &cap, &tr, "ms");
+        if (rc == 0) rc = json_buf_append(&out, &len2, &cap, "}\n");
+      } else {
+        if (rc == 0) rc = json_buf_append(&out, &len2, &cap, "traceroute to %s (%s), %d hops max\n", target, tr.target_ip, o.max_ttl);
+        for (int i = 0; rc == 0 && i < tr.nhops; i++) {
+          const trace_hop_t *h = &tr.hop[i];
+          if (h->rtt_ms < 0) rc = json_buf_append(&out, &len2, &cap, "%2d  *\n", h->ttl);
+          else if (h->flag) rc = json_buf_append(&out, &len2, &cap, "%2d  %s  %.3f ms !%c\n", h->ttl, h->ip, h->rtt_ms, h->flag);
+          else rc = json_buf_append(&out, &len2, &cap, "%2d  %s  %.3f ms\n", h->ttl, h->ip, h->rtt_ms);
+        }
+      }
+      if (co != CO_REVALIDATE) {
+        if (rc == 0) { http_send_status(r, 200, "OK"); http_printf(r, "Content-Type: %s; charset=utf-8\r\n\r\n", ctype); http_write(r, out, len2); }
+        else if (is_json) send_json(r, "{\"error\":\"oom\"}\n");
+        else send_text(r, "error allocating memory\n");
+      }
+      if (rc == 0) endpoint_coalesce_finish(&g_trace_target_co, co, co_key, payload_adopt(out, len2));
+      else { free(out); endpoint_coalesce_finish(&g_trace_target_co, co, co_key, NULL); }
+      return 0;
+    }
+  }
+  /* the traceroute binary below is not coalesced: give up the refresh */
+  endpoint_coalesce_finish(&g_trace_target_co, co, co_key, NULL);
+  if (co == CO_REVALIDATE) return 0;
   if (!g_has_traceroute || !g_traceroute_path[0]) { send_text(r, "traceroute not available\n"); return 0; }
-  /* build command dynamically to avoid compile-time truncation warnings */
-  size_t cmdlen = strlen(g_traceroute_path) + 4 + strlen(target) + 32;
-  char *cmd = (char*)malloc(cmdlen);
-  if (!cmd) { send_text(r, "error allocating memory\n"); return 0; }
-  /* conservative flags: IPv4, numeric, wait 2s, 1 probe per hop, max 8 hops */
-  snprintf(cmd, cmdlen, "%s -4 -n -w 2 -q 1 -m 8 %s 2>&1", g_traceroute_path, target);
+  /* conservative flags: IPv4, numeric, wait 2s, 1 probe per hop, max 8 hops;
+   * target goes in as one argv word, so it cannot inject shell syntax */
+  const char *targv[] = { g_traceroute_path, "-4", "-n", "-w", "2", "-q", "1", "-m", "8", target, NULL };
   char *out = NULL; size_t n = 0;
-  if (util_exec(cmd, &out, &n) == 0 && out) {
+  int trc = exec_argv(targv, EXEC_STDERR, TRACEROUTE_DEADLINE_MS, &out, &n, NULL);
+  if ((trc == 0 || trc == EXEC_TIMEOUT) && out) {
     if (want_json[0] && (want_json[0]=='j' || want_json[0]=='J')) {
       /* parse traceroute plain text into JSON hops */
       char *dup = strndup(out, n);
-      if (!dup) { free(out); free(cmd); send_json(r, "{\"error\":\"oom\"}\n"); return 0; }
+      if (!dup) { free(out); send_json(r, "{\"error\":\"oom\"}\n"); return 0; }
       char *saveptr=NULL; char *line=strtok_r(dup, "\n", &saveptr);
-      size_t cap=2048,len2=0; char *json=malloc(cap); if(!json){ free(dup); free(out); free(cmd); send_json(r,"{\"error\":\"oom\"}\n"); return 0; } json[0]=0;
-  #define APP_TR(fmt,...) do { if (json_appendf(&json, &len2, &cap, fmt, ##__VA_ARGS__) != 0) { free(json); free(dup); free(out); free(cmd); send_json(r,"{\"error\":\"oom\"}\n"); return 0; } } while(0)
+      size_t cap=2048,len2=0; char *json=malloc(cap); if(!json){ free(dup); free(out); send_json(r,"{\"error\":\"oom\"}\n"); return 0; } json[0]=0;
+  #define APP_TR(fmt,...) do { if (json_appendf(&json, &len2, &cap, fmt, ##__VA_ARGS__) != 0) { free(json); free(dup); free(out); send_json(r,"{\"error\":\"oom\"}\n"); return 0; } } while(0)
       /* Collect hops into a temporary array so we can resolve missing hostnames
        * via the system resolver (resolve_ip_to_hostname) before emitting JSON.
        */
       typedef struct { char hop[16]; char ip[64]; char host[128]; char ping[128]; } tr_hop_t;
       size_t hop_cap = 32; size_t hop_count = 0;
       tr_hop_t *hops = (tr_hop_t*)malloc(sizeof(tr_hop_t) * hop_cap);
-      if (!hops) { free(dup); free(out); free(cmd); free(json); send_json(r, "{\"error\":\"oom\"}\n"); return 0; }
+      if (!hops) { free(dup); free(out); free(json); send_json(r, "{\"error\":\"oom\"}\n"); return 0; }
       while(line){
         /* skip header */
         if (strstr(line, "traceroute to") == line) { line=strtok_r(NULL,"\n",&saveptr); continue; }
@@ -4671,34 +6222,29 @@ static int h_traceroute(http_request_t *r) {
       APP_TR("]}\n");
       free(hops);
       http_send_status(r,200,"OK"); http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n"); http_write(r,json,len2);
-      free(json); free(dup); free(out); free(cmd); return 0;
+      free(json); free(dup); free(out); return 0;
     } else {
       http_send_status(r, 200, "OK");
       http_printf(r, "Content-Type: text/plain; charset=utf-8\r\n\r\n");
       http_write(r, out, n);
       free(out);
-      free(cmd);
       return 0;
     }
   }
-  free(cmd);
+  free(out);
   /* try ICMP-based traceroute as a fallback */
   {
-    size_t cmdlen2 = strlen(g_traceroute_path) + 8 + strlen(target) + 32;
-    char *cmd2 = malloc(cmdlen2);
-    if (cmd2) {
-  snprintf(cmd2, cmdlen2, "%s -I -n -w 2 -q 1 -m 8 %s 2>&1", g_traceroute_path, target);
-      char *out2 = NULL; size_t n2 = 0;
-      if (util_exec(cmd2, &out2, &n2) == 0 && out2) {
-        http_send_status(r, 200, "OK");
-        http_printf(r, "Content-Type: text/plain; charset=utf-8\r\n\r\n");
-        http_write(r, out2, n2);
-        free(out2);
-        free(cmd2);
-        return 0;
-      }
-      free(cmd2);
+    const char *iargv[] = { g_traceroute_path, "-I", "-n", "-w", "2", "-q", "1", "-m", "8", target, NULL };
+    char *out2 = NULL; size_t n2 = 0;
+    trc = exec_argv(iargv, EXEC_STDERR, TRACEROUTE_DEADLINE_MS, &out2, &n2, NULL);
+    if ((trc == 0 || trc == EXEC_TIMEOUT) && out2) {
+      http_send_status(r, 200, "OK");
+      http_printf(r, "Content-Type: text/plain; charset=utf-8\r\n\r\n");
+      http_write(r, out2, n2);
+      free(out2);
+      return 0;
     }
+    free(out2);
   }
   send_text(r, "error running traceroute\n");
   return 0;
@@ -4733,13 +6279,13 @@ static int h_olsrd_json(http_request_t *r) {
   for (const char **p = allowed; *p; ++p) if (strcmp(*p, q) == 0) { ok = 1; break; }
   if (!ok) { send_json(r, "{}\n"); return 0; }
   /* consult in-memory cache first */
-  char cached[256] = "";
-  if (olsr_cache_get(q, cached, sizeof(cached))) { send_json(r, cached); return 0; }
+  char *cached = NULL; size_t cn = 0;
+  if (lru_cache_get_dup(g_olsr_cache, q, &cached, &cn, NULL) == LRU_HIT && cached) { send_json(r, cached); free(cached); return 0; }
+  free(cached);
   char url[512]; snprintf(url, sizeof(url), "http://127.0.0.1:9090/%s", q);
   char *out = NULL; size_t n = 0;
   if (util_http_get_url_local(url, &out, &n, 1) == 0 && out && n>0) {
-    /* cache truncated to OLSR_CACHE_VAL-1 */
-    olsr_cache_set(q, out);
+    lru_cache_put(g_olsr_cache, q, out, n, OLSR_CACHE_TTL);
     send_json(r, out); free(out); return 0;
   }
   send_json(r, "{}\n"); return 0;
@@ -4792,109 +6338,121 @@ static void send_json(http_request_t *r, const char *json) {
   http_write(r, json, strlen(json));
 }
 
-int olsrd_plugin_interface_version(void) {
-  return 5;
+/* Binary format asked for by the Accept header (BINJSON_*), 0 for JSON. The
+ * highest q wins, earlier entries on ties; wildcards count as JSON.
+ */
+static int accept_binary_format(const http_request_t *r) {
+  int best = 0; double best_q = -1;
+  const char *p = r ? r->accept : "";
+  while (*p) {
+    size_t n = strcspn(p, ",");
+    char item[96]; snprintf(item, sizeof(item), "%.*s", (int)(n < sizeof(item) - 1 ? n : sizeof(item) - 1), p);
+    p += n; if (*p == ',') p++;
+    char *type = item; while (*type == ' ' || *type == '\t') type++;
+    double q = 1;
+    char *semi = strchr(type, ';');
+    if (semi) {
+      char *qs = strstr(semi, "q=");
+      if (qs) q = atof(qs + 2);
+      *semi = 0;
+    }
+    char *e = type + strlen(type); while (e > type && (e[-1] == ' ' || e[-1] == '\t')) *--e = 0;
+    int fmt;
+    if (strcasecmp(type, "application/cbor") == 0) fmt = BINJSON_CBOR;
+    else if (strcasecmp(type, "application/msgpack") == 0 || strcasecmp(type, "application/x-msgpack") == 0 ||
+             strcasecmp(type, "application/vnd.msgpack") == 0) fmt = BINJSON_MSGPACK;
+    else if (strcasecmp(type, "application/json") == 0 || strcmp(type, "*/*") == 0 || strcasecmp(type, "application/*") == 0) fmt = 0;
+    else continue;
+    if (q > 0 && q > best_q) { best = fmt; best_q = q; }
+  }
+  return best;
 }
 
-/* Simple TTL cache for hostname lookups & nodedb lookups to avoid repeated blocking I/O
- * Very small fixed-size cache with linear probing; entries expire after CACHE_TTL seconds.
+static uint64_t fnv1a64(const char *s, size_t n) {
+  uint64_t h = 1469598103934665603ULL;
+  for (size_t i = 0; i < n; i++) { h ^= (unsigned char)s[i]; h *= 1099511628211ULL; }
+  return h;
+}
+
+/* Encoding of p in fmt, from the endpoint's cache while p is the payload it
+ * was made from. Returns a malloc'ed copy, NULL when it cannot be encoded.
  */
-#define CACHE_SIZE 128
-#define CACHE_TTL 60
-struct kv_cache_entry { char key[128]; char val[256]; time_t ts; };
-static struct kv_cache_entry g_host_cache[CACHE_SIZE];
-/* separate cache for OLSRd proxy responses; uses same slot size as kv_cache_entry */
-static struct kv_cache_entry g_olsr_cache[CACHE_SIZE];
-/* mutex protecting both small in-process caches */
-static pthread_mutex_t g_kv_cache_lock = PTHREAD_MUTEX_INITIALIZER;
-
-static int olsr_cache_get(const char *key, char *out, size_t outlen) {
-  if (!key || !out) return 0;
-  uint64_t h = UINT64_C(1469598103934665603);
-  for (const unsigned char *p = (const unsigned char*)key; *p; ++p) h = (h ^ *p) * UINT64_C(1099511628211);
-  int idx = (int)(h % CACHE_SIZE);
-  pthread_mutex_lock(&g_kv_cache_lock);
-  if (g_olsr_cache[idx].key[0] == 0) { pthread_mutex_unlock(&g_kv_cache_lock); return 0; }
-  if (strcmp(g_olsr_cache[idx].key, key) != 0) { pthread_mutex_unlock(&g_kv_cache_lock); return 0; }
-  if (difftime(time(NULL), g_olsr_cache[idx].ts) > CACHE_TTL) { pthread_mutex_unlock(&g_kv_cache_lock); return 0; }
-  /* copy up to outlen-1 chars */
-  snprintf(out, outlen, "%s", g_olsr_cache[idx].val);
-  pthread_mutex_unlock(&g_kv_cache_lock);
-  return 1;
+static char *encoded_body(int slot, int fmt, const payload_t *p, size_t *outlen) {
+  enc_cache_t *c = &g_enc_cache[slot][fmt - 1];
+  char *out = NULL;
+  pthread_mutex_lock(&g_enc_lock);
+  if (c->body && c->gen == p->gen && (out = malloc(c->len ? c->len : 1)) != NULL) {
+    memcpy(out, c->body, c->len); *outlen = c->len; g_enc_hits++;
+  }
+  pthread_mutex_unlock(&g_enc_lock);
+  if (out) return out;
+  size_t n = 0;
+  if (binjson_encode(p->data, p->len, fmt, &out, &n) != 0) {
+    pthread_mutex_lock(&g_enc_lock); g_enc_errors++; pthread_mutex_unlock(&g_enc_lock);
+    return NULL;
+  }
+  char *keep = malloc(n ? n : 1);
+  if (keep) memcpy(keep, out, n);
+  pthread_mutex_lock(&g_enc_lock);
+  g_enc_misses++;
+  if (keep) { free(c->body); c->body = keep; c->len = n; c->gen = p->gen; }
+  pthread_mutex_unlock(&g_enc_lock);
+  *outlen = n;
+  return out;
 }
 
-static void olsr_cache_set(const char *key, const char *val) {
-  if (!key || !val) return;
-  uint64_t h = UINT64_C(1469598103934665603);
-  for (const unsigned char *p = (const unsigned char*)key; *p; ++p) h = (h ^ *p) * UINT64_C(1099511628211);
-  int idx = (int)(h % CACHE_SIZE);
-  pthread_mutex_lock(&g_kv_cache_lock);
-  snprintf(g_olsr_cache[idx].key, sizeof(g_olsr_cache[idx].key), "%s", key);
-  /* store truncated value (safe) */
-  snprintf(g_olsr_cache[idx].val, sizeof(g_olsr_cache[idx].val), "%s", val);
-  g_olsr_cache[idx].ts = time(NULL);
-  pthread_mutex_unlock(&g_kv_cache_lock);
-}
-
-static void cache_set(struct kv_cache_entry *cache, const char *key, const char *val) {
-  if (!key || !val) return;
-  uint64_t h = UINT64_C(1469598103934665603);
-  for (const unsigned char *p = (const unsigned char*)key; *p; ++p) h = (h ^ *p) * UINT64_C(1099511628211);
-  int idx = (int)(h % CACHE_SIZE);
-  pthread_mutex_lock(&g_kv_cache_lock);
-  snprintf(cache[idx].key, sizeof(cache[idx].key), "%s", key);
-  snprintf(cache[idx].val, sizeof(cache[idx].val), "%s", val);
-  cache[idx].ts = time(NULL);
-  pthread_mutex_unlock(&g_kv_cache_lock);
-}
-
-static int cache_get(struct kv_cache_entry *cache, const char *key, char *out, size_t outlen) {
-  if (!key || !out) return 0;
-  uint64_t h = UINT64_C(1469598103934665603);
-  for (const unsigned char *p = (const unsigned char*)key; *p; ++p) h = (h ^ *p) * UINT64_C(1099511628211);
-  int idx = (int)(h % CACHE_SIZE);
-  pthread_mutex_lock(&g_kv_cache_lock);
-  if (cache[idx].key[0] == 0) { pthread_mutex_unlock(&g_kv_cache_lock); return 0; }
-  if (strcmp(cache[idx].key, key) != 0) { pthread_mutex_unlock(&g_kv_cache_lock); return 0; }
-  if (difftime(time(NULL), cache[idx].ts) > CACHE_TTL) { pthread_mutex_unlock(&g_kv_cache_lock); return 0; }
-  snprintf(out, outlen, "%s", cache[idx].val);
-  pthread_mutex_unlock(&g_kv_cache_lock);
-  return 1;
+/* Send a JSON payload, or its fmt encoding (falling back to JSON when the
+ * body does not parse). extra holds additional header lines, "" for none.
+ */
+static void send_payload_as(http_request_t *r, int fmt, int slot, const payload_t *p, const char *extra) {
+  if (fmt) {
+    size_t n = 0;
+    char *enc = encoded_body(slot, fmt, p, &n);
+    if (enc) {
+      http_send_status(r, 200, "OK");
+      http_printf(r, "Content-Type: %s\r\nVary: Accept\r\n%s\r\n", binjson_mime(fmt), extra);
+      http_write(r, enc, n);
+      free(enc);
+      return;
+    }
+  }
+  http_send_status(r, 200, "OK");
+  http_printf(r, "Content-Type: application/json; charset=utf-8\r\nVary: Accept\r\n%s\r\n", extra);
+  http_write(r, p->data, p->len);
+}
+
+static void send_payload_negotiated(http_request_t *r, int slot, const payload_t *p) {
+  send_payload_as(r, accept_binary_format(r), slot, p, "");
+}
+
+int olsrd_plugin_interface_version(void) {
+  return 5;
+}
+
+/* Resolver thread callback: names and failures both land in the host cache. */
+static void host_cache_dns_result(const char *ip, const char *name, uint32_t ttl, void *user) {
+  (void)ttl; (void)user;
+  if (name && name[0]) lru_cache_put(g_host_cache, ip, name, strlen(name), 0);
+  else lru_cache_put_negative(g_host_cache, ip);
 }
 
 /* lookup hostname for an ipv4 string using cache, gethostbyaddr and nodedb files/remote as fallback */
 static void lookup_hostname_cached(const char *ipv4, char *out, size_t outlen) {
   if (!ipv4 || !out) return;
   out[0]=0;
-  if (cache_get(g_host_cache, ipv4, out, outlen)) return;
-  /* try reverse DNS using thread-safe resolver */
-  if (resolve_ip_to_hostname(ipv4, out, outlen) == 0) {
-    cache_set(g_host_cache, ipv4, out);
-    return;
-  }
-  /* try cached remote node_db first */
+  /* host cache, then reverse DNS (never blocks when the async resolver runs) */
+  if (resolve_ip_to_hostname(ipv4, out, outlen) == 0) return;
+  /* then the node_db, through its own cache */
+  int st = lru_cache_get(g_nodedb_name_cache, ipv4, out, outlen, NULL);
+  if (st == LRU_HIT) return;
+  out[0]=0;
+  if (st == LRU_NEGATIVE) return;
   fetch_remote_nodedb_if_needed();
-  if (g_nodedb_cached && g_nodedb_cached_len > 0) {
-    char needle[256];
-    if (snprintf(needle, sizeof(needle), "\"%s\":", ipv4) >= (int)sizeof(needle)) {
-      /* IP address too long, skip */
-      goto nothing_found;
-    }
-    char *pos = strstr(g_nodedb_cached, needle);
-    if (pos) {
-      char *hpos = strstr(pos, "\"hostname\":");
-      if (hpos && find_json_string_value(hpos, "hostname", &pos, &g_nodedb_cached_len)) {
-        size_t copy = g_nodedb_cached_len < outlen-1 ? g_nodedb_cached_len : outlen-1; memcpy(out, pos, copy); out[copy]=0; cache_set(g_host_cache, ipv4, out); return;
-      }
-      /* fallback to "n" */
-      char *npos = strstr(pos, "\"n\":");
-      if (npos && find_json_string_value(npos, "n", &pos, &g_nodedb_cached_len)) {
-        size_t copy = g_nodedb_cached_len < outlen-1 ? g_nodedb_cached_len : outlen-1; memcpy(out, pos, copy); out[copy]=0; cache_set(g_host_cache, ipv4, out); return;
-      }
-    }
-  }
-  /* nothing found */
-nothing_found:
+  pthread_mutex_lock(&g_nodedb_lock);
+  int found = nodedb_hostname_locked(ipv4, out, outlen);
+  pthread_mutex_unlock(&g_nodedb_lock);
+  if (found && out[0]) { lru_cache_put(g_nodedb_name_cache, ipv4, out, strlen(out), 0); return; }
+  lru_cache_put_negative(g_nodedb_name_cache, ipv4);
   out[0]=0;
 }
 
@@ -4921,6 +6479,9 @@ static int set_str_param(const char *value, void *data, set_plugin_parameter_add
   snprintf((char*)data, 511, "%s", value);
   /* If the caller provided nodedb_url via PlParam, mark it as set */
   if (data == g_nodedb_url) g_cfg_nodedb_url_set = 1;
+  if (data == g_nodedb_snapshot_path) g_cfg_nodedb_snapshot_set = 1;
+  if (data == g_dns_servers) g_cfg_dns_servers_set = 1;
+  if (data == g_lq_history_path) g_cfg_lq_history_path_set = 1;
   return 0;
 }
 static int set_int_param(const char *value, void *data, set_plugin_parameter_addon addon __attribute__((unused))) {
@@ -4930,6 +6491,20 @@ static int set_int_param(const char *value, void *data, set_plugin_parameter_add
   if (data == &g_port) g_cfg_port_set = 1;
   if (data == &g_nodedb_ttl) g_cfg_nodedb_ttl_set = 1;
   if (data == &g_nodedb_write_disk) g_cfg_nodedb_write_disk_set = 1;
+  if (data == &g_dns_async) g_cfg_dns_async_set = 1;
+  if (data == &g_exec_helper) g_cfg_exec_helper_set = 1;
+  if (data == &g_uplink_trace_interval) g_cfg_uplink_trace_interval_set = 1;
+  if (data == &g_uplink_trace_history) g_cfg_uplink_trace_history_set = 1;
+  if (data == &g_traffic_interval) g_cfg_traffic_interval_set = 1;
+  if (data == &g_lq_history_interval) g_cfg_lq_history_interval_set = 1;
+  if (data == &g_lq_history_flush) g_cfg_lq_history_flush_set = 1;
+  if (data == &g_status_section_cache) g_cfg_status_section_cache_set = 1;
+  if (data == &g_status_workers) g_cfg_status_workers_set = 1;
+  if (data == &g_status_deadline_ms) g_cfg_status_deadline_ms_set = 1;
+  if (data == &g_host_cache_size) g_cfg_host_cache_size_set = 1;
+  if (data == &g_host_cache_ttl) g_cfg_host_cache_ttl_set = 1;
+  if (data == &g_host_cache_negative_ttl) g_cfg_host_cache_negative_ttl_set = 1;
+  if (data == &g_host_cache_stale_ttl) g_cfg_host_cache_stale_ttl_set = 1;
   /* new fetch tuning params via PlParam */
   if (data == &g_fetch_queue_max) g_cfg_fetch_queue_set = 1;
   if (data == &g_fetch_retries) g_cfg_fetch_retries_set = 1;
@@ -4968,6 +6543,23 @@ static const struct olsrd_plugin_parameters g_params[] = {
   { .name = "nodedb_url", .set_plugin_parameter = &set_str_param, .data = g_nodedb_url,  .addon = {0} },
   { .name = "nodedb_ttl", .set_plugin_parameter = &set_int_param, .data = &g_nodedb_ttl, .addon = {0} },
   { .name = "nodedb_write_disk", .set_plugin_parameter = &set_int_param, .data = &g_nodedb_write_disk, .addon = {0} },
+  { .name = "nodedb_snapshot", .set_plugin_parameter = &set_str_param, .data = g_nodedb_snapshot_path, .addon = {0} },
+  { .name = "dns_async", .set_plugin_parameter = &set_int_param, .data = &g_dns_async, .addon = {0} },
+  { .name = "dns_servers", .set_plugin_parameter = &set_str_param, .data = g_dns_servers, .addon = {0} },
+  { .name = "uplink_trace_interval", .set_plugin_parameter = &set_int_param, .data = &g_uplink_trace_interval, .addon = {0} },
+  { .name = "uplink_trace_history", .set_plugin_parameter = &set_int_param, .data = &g_uplink_trace_history, .addon = {0} },
+  { .name = "traffic_interval", .set_plugin_parameter = &set_int_param, .data = &g_traffic_interval, .addon = {0} },
+  { .name = "lq_history_interval", .set_plugin_parameter = &set_int_param, .data = &g_lq_history_interval, .addon = {0} },
+  { .name = "lq_history_path", .set_plugin_parameter = &set_str_param, .data = g_lq_history_path, .addon = {0} },
+  { .name = "lq_history_flush", .set_plugin_parameter = &set_int_param, .data = &g_lq_history_flush, .addon = {0} },
+  { .name = "status_section_cache", .set_plugin_parameter = &set_int_param, .data = &g_status_section_cache, .addon = {0} },
+  { .name = "status_workers", .set_plugin_parameter = &set_int_param, .data = &g_status_workers, .addon = {0} },
+  { .name = "status_deadline_ms", .set_plugin_parameter = &set_int_param, .data = &g_status_deadline_ms, .addon = {0} },
+  { .name = "exec_helper", .set_plugin_parameter = &set_int_param, .data = &g_exec_helper, .addon = {0} },
+  { .name = "host_cache_size", .set_plugin_parameter = &set_int_param, .data = &g_host_cache_size, .addon = {0} },
+  { .name = "host_cache_ttl", .set_plugin_parameter = &set_int_param, .data = &g_host_cache_ttl, .addon = {0} },
+  { .name = "host_cache_negative_ttl", .set_plugin_parameter = &set_int_param, .data = &g_host_cache_negative_ttl, .addon = {0} },
+  { .name = "host_cache_stale_ttl", .set_plugin_parameter = &set_int_param, .data = &g_host_cache_stale_ttl, .addon = {0} },
   /* fetch tuning PlParams: override defaults (PlParam wins over env) */
   { .name = "fetch_queue_max", .set_plugin_parameter = &set_int_param, .data = &g_fetch_queue_max, .addon = {0} },
   { .name = "fetch_retries", .set_plugin_parameter = &set_int_param, .data = &g_fetch_retries, .addon = {0} },
@@ -4981,6 +6573,9 @@ static const struct olsrd_plugin_parameters g_params[] = {
   { .name = "coalesce_devices_ttl", .set_plugin_parameter = &set_int_param, .data = &g_coalesce_devices_ttl, .addon = {0} },
   { .name = "coalesce_discover_ttl", .set_plugin_parameter = &set_int_param, .data = &g_coalesce_discover_ttl, .addon = {0} },
   { .name = "coalesce_traceroute_ttl", .set_plugin_parameter = &set_int_param, .data = &g_coalesce_traceroute_ttl, .addon = {0} },
+  { .name = "coalesce_status_ttl", .set_plugin_parameter = &set_int_param, .data = &g_coalesce_status_ttl, .addon = {0} },
+  { .name = "coalesce_wait_ms", .set_plugin_parameter = &set_int_param, .data = &g_coalesce_wait_ms, .addon = {0} },
+  { .name = "coalesce_max_stale", .set_plugin_parameter = &set_int_param, .data = &g_coalesce_max_stale, .addon = {0} },
   /* UI thresholds exported for front-end convenience */
   { .name = "fetch_queue_warn", .set_plugin_parameter = &set_int_param, .data = &g_fetch_queue_warn, .addon = {0} },
   { .name = "fetch_queue_crit", .set_plugin_parameter = &set_int_param, .data = &g_fetch_queue_crit, .addon = {0} },
@@ -4999,6 +6594,16 @@ void olsrd_get_plugin_parameters(const struct olsrd_plugin_parameters **params,
 }
 
 int olsrd_plugin_init(void) {
+  /* fork the spawn helper before any plugin thread exists, while the process is small */
+  {
+    const char *env_eh = getenv("OLSRD_STATUS_EXEC_HELPER");
+    if (env_eh && env_eh[0] && !g_cfg_exec_helper_set) g_exec_helper = atoi(env_eh);
+    if (g_exec_helper) {
+      if (exec_helper_start() == 0) fprintf(stderr, "[status-plugin] exec helper started\n");
+      else fprintf(stderr, "[status-plugin] exec helper unavailable, spawning directly\n");
+    }
+  }
+  if (neigh_cache_start() != 0) fprintf(stderr, "[status-plugin] netlink neighbour table unavailable\n");
   log_asset_permissions();
   /* detect availability of optional external tools without failing startup */
   const char *tracer_candidates[] = { "/usr/sbin/traceroute", "/bin/traceroute", "/usr/bin/traceroute", "/usr/local/bin/traceroute", NULL };
@@ -5377,6 +6982,8 @@ int olsrd_plugin_init(void) {
   http_server_register_handler("/connections.json", &h_connections_json);
   http_server_register_handler("/airos",    &h_airos);
   http_server_register_handler("/traffic",  &h_traffic);
+  http_server_register_handler("/traffic.json", &h_traffic_json);
+  http_server_register_handler("/history",  &h_history);
   http_server_register_handler("/versions.json", &h_versions_json);
   http_server_register_handler("/nodedb.json", &h_nodedb);
   http_server_register_handler("/fetch_metrics", &h_fetch_metrics);
@@ -5391,7 +6998,120 @@ int olsrd_plugin_init(void) {
   endpoint_coalesce_init(&g_traceroute_co, g_coalesce_traceroute_ttl);
   endpoint_coalesce_init(&g_discover_co, g_coalesce_discover_ttl);
   endpoint_coalesce_init(&g_devices_co, g_coalesce_devices_ttl);
+  if (g_coalesce_wait_ms < 0) g_coalesce_wait_ms = 0;
+  if (g_coalesce_max_stale < 0) g_coalesce_max_stale = 0;
+  endpoint_coalesce_init(&g_status_co, g_coalesce_status_ttl);
+  endpoint_coalesce_init(&g_status_lite_co, g_coalesce_status_ttl);
+  endpoint_coalesce_init(&g_trace_target_co, g_coalesce_traceroute_ttl);
+  endpoint_coalesce_init(&g_discover_raw_co, g_coalesce_discover_ttl);
   start_devices_worker();
+  /* hostname / OLSRd proxy caches (created before any handler or resolver can use them) */
+  {
+    static const struct { const char *env; int *val; int *set; int min, max; } hc_env[] = {
+      { "OLSRD_STATUS_HOST_CACHE_SIZE", &g_host_cache_size, &g_cfg_host_cache_size_set, 16, 1000000 },
+      { "OLSRD_STATUS_HOST_CACHE_TTL", &g_host_cache_ttl, &g_cfg_host_cache_ttl_set, 1, 86400 },
+      { "OLSRD_STATUS_HOST_CACHE_NEGATIVE_TTL", &g_host_cache_negative_ttl, &g_cfg_host_cache_negative_ttl_set, 0, 86400 },
+      { "OLSRD_STATUS_HOST_CACHE_STALE_TTL", &g_host_cache_stale_ttl, &g_cfg_host_cache_stale_ttl_set, 0, 86400 },
+    };
+    for (size_t i = 0; i < sizeof(hc_env) / sizeof(hc_env[0]); i++) {
+      const char *ev = getenv(hc_env[i].env);
+      if (!ev || !ev[0] || *hc_env[i].set) continue;
+      char *endptr = NULL; long v = strtol(ev, &endptr, 10);
+      if (endptr && *endptr == '\0' && v >= hc_env[i].min && v <= hc_env[i].max) *hc_env[i].val = (int)v;
+      else fprintf(stderr, "[status-plugin] invalid %s value: %s (ignored)\n", hc_env[i].env, ev);
+    }
+    if (g_host_cache_size < 16) g_host_cache_size = 16;
+    g_host_cache = lru_cache_create((size_t)g_host_cache_size, 16, g_host_cache_ttl, g_host_cache_negative_ttl, g_host_cache_stale_ttl);
+    g_nodedb_name_cache = lru_cache_create((size_t)g_host_cache_size, 16, g_host_cache_ttl, g_host_cache_negative_ttl, 0);
+    g_olsr_cache = lru_cache_create(32, 1, OLSR_CACHE_TTL, 0, 0);
+  }
+  /* async reverse DNS so request handlers never wait on a resolver */
+  {
+    const char *env_da = getenv("OLSRD_STATUS_DNS_ASYNC");
+    if (env_da && env_da[0] && !g_cfg_dns_async_set) g_dns_async = atoi(env_da);
+    const char *env_ds = getenv("OLSRD_STATUS_DNS_SERVERS");
+    if (env_ds && env_ds[0] && !g_cfg_dns_servers_set) snprintf(g_dns_servers, sizeof(g_dns_servers), "%s", env_ds);
+    if (g_dns_async) {
+      dns_async_config_t dc; memset(&dc, 0, sizeof(dc));
+      dc.servers = g_dns_servers;
+      dc.cb = host_cache_dns_result;
+      if (dns_async_start(&dc) == 0) {
+        dns_async_stats_t ds; dns_async_get_stats(&ds);
+        fprintf(stderr, "[status-plugin] async reverse DNS enabled (%u nameserver%s)\n", ds.servers, ds.servers == 1 ? "" : "s");
+      } else {
+        fprintf(stderr, "[status-plugin] async reverse DNS unavailable, using blocking getnameinfo\n");
+      }
+    }
+  }
+  /* warm start: map the last node_db snapshot so names resolve before the first fetch */
+  {
+    const char *env_snap = getenv("OLSRD_STATUS_PLUGIN_NODEDB_SNAPSHOT");
+    if (env_snap && !g_cfg_nodedb_snapshot_set) snprintf(g_nodedb_snapshot_path, sizeof(g_nodedb_snapshot_path), "%s", env_snap);
+    if (g_nodedb_snapshot_path[0]) {
+      struct timespec t0, t1; clock_gettime(CLOCK_MONOTONIC, &t0);
+      nodedb_index_t *ix = nodedb_index_load(g_nodedb_snapshot_path);
+      clock_gettime(CLOCK_MONOTONIC, &t1);
+      if (ix) {
+        pthread_mutex_lock(&g_nodedb_lock);
+        if (!g_nodedb_index) { g_nodedb_index = ix; ix = NULL; }
+        pthread_mutex_unlock(&g_nodedb_lock);
+        fprintf(stderr, "[status-plugin] nodedb snapshot: loaded %zu prefixes from %s in %ld us\n",
+                nodedb_index_count(g_nodedb_index), g_nodedb_snapshot_path,
+                (long)((t1.tv_sec - t0.tv_sec) * 1000000L + (t1.tv_nsec - t0.tv_nsec) / 1000L));
+        nodedb_index_free(ix);
+      }
+    }
+  }
+  /* keep the uplink path fresh in the background so handlers never trace inline */
+  {
+    const char *env_ti = getenv("OLSRD_STATUS_UPLINK_TRACE_INTERVAL");
+    if (env_ti && env_ti[0] && !g_cfg_uplink_trace_interval_set) g_uplink_trace_interval = atoi(env_ti);
+    const char *env_th = getenv("OLSRD_STATUS_UPLINK_TRACE_HISTORY");
+    if (env_th && env_th[0] && !g_cfg_uplink_trace_history_set) g_uplink_trace_history = atoi(env_th);
+    if (g_uplink_trace_history < 1) g_uplink_trace_history = 1;
+    if (g_uplink_trace_history > 1024) g_uplink_trace_history = 1024;
+    if (g_uplink_trace_interval > 0) {
+      trace_opts_t o = { .max_ttl = 30, .timeout_ms = NATIVE_TRACE_TIMEOUT_MS, .proto = TRACE_UDP, .family = AF_INET };
+      if (g_uplink_trace_interval < 5) g_uplink_trace_interval = 5;
+      if (trace_monitor_start(g_uplink_trace_interval, g_uplink_trace_history, &o, uplink_trace_target) == 0)
+        fprintf(stderr, "[status-plugin] uplink traceroute every %ds (%d samples kept)\n", g_uplink_trace_interval, g_uplink_trace_history);
+    }
+  }
+  {
+    const char *env_tr = getenv("OLSRD_STATUS_TRAFFIC_INTERVAL");
+    if (env_tr && env_tr[0] && !g_cfg_traffic_interval_set) g_traffic_interval = atoi(env_tr);
+    if (g_traffic_interval > 3600) g_traffic_interval = 3600;
+    if (g_traffic_interval > 0 && traffic_start(g_traffic_interval) == 0)
+      fprintf(stderr, "[status-plugin] sampling interface traffic every %ds\n", g_traffic_interval);
+  }
+  {
+    const char *env_li = getenv("OLSRD_STATUS_LQ_HISTORY_INTERVAL");
+    const char *env_lp = getenv("OLSRD_STATUS_LQ_HISTORY_PATH");
+    const char *env_lf = getenv("OLSRD_STATUS_LQ_HISTORY_FLUSH");
+    if (env_li && env_li[0] && !g_cfg_lq_history_interval_set) g_lq_history_interval = atoi(env_li);
+    if (env_lp && !g_cfg_lq_history_path_set) snprintf(g_lq_history_path, sizeof(g_lq_history_path), "%s", env_lp);
+    if (env_lf && env_lf[0] && !g_cfg_lq_history_flush_set) g_lq_history_flush = atoi(env_lf);
+    if (g_lq_history_interval > 0 && g_lq_history_interval < 5) g_lq_history_interval = 5;
+    if (g_lq_history_interval > 300) g_lq_history_interval = 300;
+    if (g_lq_history_flush < 60) g_lq_history_flush = 60;
+    if (g_lq_history_interval > 0 && lqh_start(g_lq_history_interval, g_lq_history_path, g_lq_history_flush, lq_history_collect) == 0)
+      fprintf(stderr, "[status-plugin] link quality history every %ds%s%s\n", g_lq_history_interval,
+              g_lq_history_path[0] ? ", saved to " : "", g_lq_history_path);
+  }
+  {
+    const char *env_sc = getenv("OLSRD_STATUS_SECTION_CACHE");
+    if (env_sc && env_sc[0] && !g_cfg_status_section_cache_set) g_status_section_cache = atoi(env_sc) != 0;
+    const char *env_sw = getenv("OLSRD_STATUS_WORKERS");
+    const char *env_sd = getenv("OLSRD_STATUS_DEADLINE_MS");
+    if (env_sw && env_sw[0] && !g_cfg_status_workers_set) g_status_workers = atoi(env_sw);
+    if (env_sd && env_sd[0] && !g_cfg_status_deadline_ms_set) g_status_deadline_ms = atoi(env_sd);
+    if (g_status_workers < 0) g_status_workers = 0;
+    if (g_status_workers > 16) g_status_workers = 16;
+    if (g_status_deadline_ms < 100) g_status_deadline_ms = 100;
+    if (g_status_deadline_ms > 30000) g_status_deadline_ms = 30000;
+    if (g_status_workers > 0 && fj_start(g_status_workers) == 0)
+      fprintf(stderr, "[status-plugin] /status sections on %d workers, deadline %dms\n", g_status_workers, g_status_deadline_ms);
+  }
   /* start node DB background worker */
   start_nodedb_worker();
   /* install SIGSEGV handler for diagnostic backtraces */
@@ -5401,16 +7121,35 @@ int olsrd_plugin_init(void) {
 
 void olsrd_plugin_exit(void) {
   http_server_stop();
+  fj_stop();
   /* stop devices worker and free cache */
   g_devices_worker_running = 0;
   pthread_mutex_lock(&g_devices_cache_lock);
-  if (g_devices_cache) { free(g_devices_cache); g_devices_cache = NULL; g_devices_cache_len = 0; }
+  payload_swap(&g_devices_cache, NULL);
   pthread_mutex_unlock(&g_devices_cache_lock);
   /* stop nodedb worker and free cache */
   g_nodedb_worker_running = 0;
   pthread_mutex_lock(&g_nodedb_lock);
-  if (g_nodedb_cached) { free(g_nodedb_cached); g_nodedb_cached = NULL; g_nodedb_cached_len = 0; }
+  payload_swap(&g_nodedb, NULL);
+  nodedb_index_free(g_nodedb_index); g_nodedb_index = NULL;
   pthread_mutex_unlock(&g_nodedb_lock);
+  free(g_nodedb_prev_refs); g_nodedb_prev_refs = NULL; g_nodedb_prev_n = 0;
+  payload_unref(g_nodedb_prev_p); g_nodedb_prev_p = NULL;
+  pthread_mutex_lock(&g_arp_cache_lock);
+  payload_swap(&g_arp_cache, NULL);
+  pthread_mutex_unlock(&g_arp_cache_lock);
+  pthread_mutex_lock(&g_local_cache_lock);
+  for (int i = 0; i < LOCAL_CACHE_ENTRIES; ++i) { free(g_local_cache[i].url); g_local_cache[i].url = NULL; payload_swap(&g_local_cache[i].body, NULL); }
+  pthread_mutex_unlock(&g_local_cache_lock);
+  trace_monitor_stop();
+  traffic_stop();
+  lqh_stop();
+  neigh_cache_stop();
+  dns_async_stop();
+  exec_helper_stop();
+  lru_cache_destroy(g_host_cache); g_host_cache = NULL;
+  lru_cache_destroy(g_nodedb_name_cache); g_nodedb_name_cache = NULL;
+  lru_cache_destroy(g_olsr_cache); g_olsr_cache = NULL;
   /* stop stderr capture */
   stop_stderr_capture();
 }
@@ -5592,29 +7331,51 @@ static int h_root(http_request_t *r) {
   return h_embedded_index(r);
 }
 
-static int h_ipv4(http_request_t *r) {
-  char *out=NULL; size_t n=0;
-  const char *cmd = "/sbin/ip -4 a 2>/dev/null || /usr/sbin/ip -4 a 2>/dev/null || ip -4 a 2>/dev/null && echo && /sbin/ip -4 neigh 2>/dev/null || /usr/sbin/ip -4 neigh 2>/dev/null || ip -4 neigh 2>/dev/null && echo && /usr/sbin/brctl show 2>/dev/null || /sbin/brctl show 2>/dev/null || brctl show 2>/dev/null";
-  if (util_exec(cmd, &out, &n)==0 && out) {
-    http_send_status(r, 200, "OK");
-    http_printf(r, "Content-Type: text/plain; charset=utf-8\r\n\r\n");
-    http_write(r, out, n);
-    free(out);
-  } else send_text(r, "error\n");
+/* `ip neigh` text rendered from the neighbour table (NOARP rows hidden as ip
+ * does); falls back to running ip when the table is unavailable.
+ */
+static int neigh_text(int family, char **out, size_t *outlen) {
+  neigh_entry_t *ne = NULL;
+  int n = neigh_cache_snapshot(family, &ne);
+  if (n < 0) {
+    const char *argv[] = { "ip", family == AF_INET6 ? "-6" : "-4", "neigh", NULL };
+    return run_argv(argv, 0, 2000, out, outlen);
+  }
+  size_t cap = 256 + (size_t)n * 96, len = 0;
+  char *buf = malloc(cap);
+  if (!buf) { free(ne); return -1; }
+  buf[0] = 0;
+  for (int i = 0; i < n; i++) {
+    if (ne[i].state == NUD_NOARP) continue;
+    if (json_appendf(&buf, &len, &cap, "%s dev %s%s%s %s\n", ne[i].ip, ne[i].dev, ne[i].mac[0] ? " lladdr " : "", ne[i].mac, neigh_state_name(ne[i].state)) != 0) { free(buf); free(ne); return -1; }
+  }
+  free(ne);
+  *out = buf; *outlen = len;
   return 0;
 }
-static int h_ipv6(http_request_t *r) {
-  char *out=NULL; size_t n=0;
-  const char *cmd = "/sbin/ip -6 a 2>/dev/null || /usr/sbin/ip -6 a 2>/dev/null || ip -6 a 2>/dev/null && echo && /sbin/ip -6 neigh 2>/dev/null || /usr/sbin/ip -6 neigh 2>/dev/null || ip -6 neigh 2>/dev/null && echo && /usr/sbin/brctl show 2>/dev/null || /sbin/brctl show 2>/dev/null || brctl show 2>/dev/null";
-  if (util_exec(cmd, &out, &n)==0 && out) {
-    http_send_status(r, 200, "OK");
-    http_printf(r, "Content-Type: text/plain; charset=utf-8\r\n\r\n");
-    http_write(r, out, n);
-    free(out);
-  } else send_text(r, "error\n");
+
+static int send_ip_overview(http_request_t *r, int family) {
+  const char *a[] = { "ip", family == AF_INET6 ? "-6" : "-4", "a", NULL };
+  static const char *const br[] = { "brctl", "show", NULL };
+  char *out = NULL, *part = NULL; size_t n = 0, pn = 0, cap = 0;
+  if (run_argv(a, 0, 2000, &out, &n) != 0) { out = NULL; n = 0; }
+  cap = n + 1;
+  if (!out && !(out = calloc(1, cap))) { send_text(r, "error\n"); return 0; }
+  int rc = json_appendf(&out, &n, &cap, "\n");
+  if (rc == 0 && neigh_text(family, &part, &pn) == 0) { rc = json_appendf(&out, &n, &cap, "%s", part); free(part); }
+  if (rc == 0) rc = json_appendf(&out, &n, &cap, "\n");
+  if (rc == 0 && run_argv(br, 0, 2000, &part, &pn) == 0) { rc = json_appendf(&out, &n, &cap, "%s", part); free(part); }
+  if (rc != 0) { free(out); send_text(r, "error\n"); return 0; }
+  http_send_status(r, 200, "OK");
+  http_printf(r, "Content-Type: text/plain; charset=utf-8\r\n\r\n");
+  http_write(r, out, n);
+  free(out);
   return 0;
 }
 
+static int h_ipv4(http_request_t *r) { return send_ip_overview(r, AF_INET); }
+static int h_ipv6(http_request_t *r) { return send_ip_overview(r, AF_INET6); }
+
 static int h_txtinfo(http_request_t *r) {
   char q[64]="ver";
   (void)get_query_param(r, "q", q, sizeof(q));
@@ -5645,23 +7406,11 @@ static int h_olsrd(http_request_t *r) {
   char hn[256] = "unknown"; if (gethostname(hn, sizeof(hn))==0) hn[sizeof(hn)-1]=0;
   off += snprintf(outbuf+off, sizeof(outbuf)-off, "%s\n", hn);
 
-  /* olsrd pid file change time: stat /proc/<pid>/stat ctime if pid exists */
-  char *pout = NULL; size_t pn = 0;
-  if (util_exec("pidof olsrd", &pout, &pn)==0 && pout && pn>0) {
-    /* take first token as pid */
-    char pid[32] = {0}; size_t i=0; while (i<pn && i<sizeof(pid)-1 && pout[i] && pout[i]!=' ' && pout[i]!='\n') { pid[i]=pout[i]; i++; }
-    if (pid[0]) {
-      char statpath[64]; snprintf(statpath, sizeof(statpath), "/proc/%s/stat", pid);
-      struct stat st; if (stat(statpath, &st)==0) {
-        time_t s = st.st_mtime; time_t d = time(NULL);
-        off += snprintf(outbuf+off, sizeof(outbuf)-off, "%ld\n%ld\n%ld\n", (long)s, (long)(d - s), (long)d);
-      } else {
-        off += snprintf(outbuf+off, sizeof(outbuf)-off, "\n\n\n");
-      }
-    } else {
-      off += snprintf(outbuf+off, sizeof(outbuf)-off, "\n\n\n");
-    }
-    free(pout); pout = NULL; pn = 0;
+  /* olsrd start time, uptime and now (from /proc/<pid>/stat starttime) */
+  procscan_info_t pi;
+  if (olsr_proc_info(0, &pi) == 0) {
+    time_t d = time(NULL);
+    off += snprintf(outbuf+off, sizeof(outbuf)-off, "%ld\n%ld\n%ld\n", (long)pi.started, pi.uptime_s, (long)d);
   } else {
     off += snprintf(outbuf+off, sizeof(outbuf)-off, "\n\n\n");
   }
@@ -5677,8 +7426,9 @@ static int h_olsrd(http_request_t *r) {
   }
 
   /* binary/version parsing: run grep to extract a chunk, replace control chars with '~' and split by '~' to mimic original awk parsing */
-  char *sout = NULL; size_t sn=0;
-  if (util_exec("grep -oaEm1 'olsr.org - .{185}' /usr/sbin/olsrd 2>/dev/null", &sout, &sn)==0 && sout && sn>0) {
+  char sout[OLSRD_BANNER_MAX + 1]; size_t sn = olsrd_binary_banner(sout, 196); /* 'olsr.org - .{185}' */
+  sout[sn] = '\0';
+  if (sn > 0) {
     /* replace selected control chars with '~' to create separators similar to the original sed call */
     for (size_t i=0;i<sn;i++) {
       unsigned char c = (unsigned char)sout[i];
@@ -5714,7 +7464,6 @@ static int h_olsrd(http_request_t *r) {
     for(char *s=trel;*s;s++) if(*s=='\n' || *s=='\r') *s=' ';
     for(char *s=tsrc;*s;s++) if(*s=='\n' || *s=='\r') *s=' ';
     off += snprintf(outbuf+off, sizeof(outbuf)-off, "ver:%s\ndsc:%s\ndev:%s\ndat:%s\nrel:%s\nsrc:%s\n", tver, tdsc, tdev, tdat, trel, tsrc);
-    free(sout); sout = NULL;
   } else {
     off += snprintf(outbuf+off, sizeof(outbuf)-off, "ver:\ndsc:\ndev:\ndat:\nrel:\nsrc:\n");
   }
@@ -5737,12 +7486,21 @@ static int h_olsrd(http_request_t *r) {
 }
 
 static int h_discover(http_request_t *r) {
+  payload_t *p = NULL;
+  int co = endpoint_coalesce_begin(&g_discover_raw_co, "", &p);
+  if (p) {
+    send_json(r, p->data); payload_unref(p);
+    if (co == CO_HIT) return 0;
+    http_end_response(r);
+  }
   char *out=NULL; size_t n=0;
   if (ubnt_discover_output(&out, &n) == 0 && out && n > 0) {
-    send_json(r, out);
-    free(out);
+    if (co != CO_REVALIDATE) send_json(r, out);
+    endpoint_coalesce_finish(&g_discover_raw_co, co, "", payload_adopt(out, n));
   } else {
-    send_json(r, "{}");
+    free(out);
+    endpoint_coalesce_finish(&g_discover_raw_co, co, "", NULL);
+    if (co != CO_REVALIDATE) send_json(r, "{}");
   }
   return 0;
 }
@@ -5753,21 +7511,28 @@ static int h_discover(http_request_t *r) {
  */
 static int h_discover_ubnt(http_request_t *r) {
   char *devices_json = NULL; size_t devices_n = 0;
+  /* Optional slimming: unless query contains full=1, we strip each device object to a minimal set of keys */
+  int want_full = 0;
+  if (r && r->query[0] && strstr(r->query, "full=1")) want_full = 1;
+  const char *co_key = want_full ? "full" : "";
   /* Try to serve from coalescing cache first or wait for ongoing work */
-  if (endpoint_coalesce_try_start(&g_discover_co, &devices_json, &devices_n)) {
-    if (devices_json) { send_json(r, devices_json); free(devices_json); return 0; }
-    /* otherwise fall through to attempt discovery */
+  payload_t *cp = NULL;
+  int co = endpoint_coalesce_begin(&g_discover_co, co_key, &cp);
+  if (cp) {
+    send_json(r, cp->data); payload_unref(cp);
+    if (co == CO_HIT) return 0;
+    http_end_response(r);
   }
   /* Try immediate internal aggregated discovery first (fast path) */
   if (ubnt_discover_output(&devices_json, &devices_n) != 0 || !devices_json || devices_n == 0) {
     /* enqueue and wait briefly as fallback */
     enqueue_fetch_request(1, 1, FETCH_TYPE_DISCOVER);
     pthread_mutex_lock(&g_devices_cache_lock);
-    if (g_devices_cache && g_devices_cache_len > 0) {
+    if (g_devices_cache && g_devices_cache->len > 0) {
       time_t nowt = time(NULL);
       if (g_ubnt_cache_ttl_s <= 0 || (nowt - g_devices_cache_ts) <= g_ubnt_cache_ttl_s) {
-        devices_json = strdup(g_devices_cache);
-        devices_n = g_devices_cache_len;
+        devices_json = strdup(g_devices_cache->data);
+        devices_n = g_devices_cache->len;
       } else {
         if (g_fetch_log_queue || g_fetch_log_force) fprintf(stderr, "[status-plugin] discover_ubnt fallback: devices cache stale (age=%lds > %ds)\n", (long)(nowt - g_devices_cache_ts), g_ubnt_cache_ttl_s);
       }
@@ -5775,10 +7540,6 @@ static int h_discover_ubnt(http_request_t *r) {
     pthread_mutex_unlock(&g_devices_cache_lock);
   }
 
-  /* Optional slimming: unless query contains full=1, we strip each device object to a minimal set of keys */
-  int want_full = 0;
-  if (r && r->query[0] && strstr(r->query, "full=1")) want_full = 1;
-
   char *slimmed = NULL; size_t slim_len = 0;
   if (!want_full && devices_json && devices_n > 0) {
     /* very lightweight device array filtering: we expect devices_json to be a JSON array. We'll scan objects and copy only whitelisted keys */
@@ -5863,7 +7624,13 @@ static int h_discover_ubnt(http_request_t *r) {
   }
 
   /* Always produce a JSON object with 'devices' and 'debug' fields */
-  size_t cap = 4096; size_t len = 0; char *b = malloc(cap); if (!b) { if (devices_json) free(devices_json); send_json(r, "{}"); return 0; }
+  size_t cap = 4096; size_t len = 0; char *b = malloc(cap);
+  if (!b) {
+    if (devices_json) free(devices_json);
+    endpoint_coalesce_finish(&g_discover_co, co, co_key, NULL);
+    if (co != CO_REVALIDATE) send_json(r, "{}");
+    return 0;
+  }
   b[0] = 0; json_buf_append(&b, &len, &cap, "{");
   /* devices: either discovered JSON array or empty array */
   json_buf_append(&b, &len, &cap, "\"devices\":");
@@ -5953,21 +7720,14 @@ static int h_discover_ubnt(http_request_t *r) {
 
   json_buf_append(&b,&len,&cap, "]}}\n");
 
-  /* Return assembled JSON */
-  /* prepare string to cache: ensure malloc'd buffer owned by coalescer */
-  char *cache_copy = NULL; size_t cache_len = 0;
-  if (b) {
-    cache_len = len;
-    cache_copy = malloc(cache_len + 1);
-    if (cache_copy) { memcpy(cache_copy, b, cache_len); cache_copy[cache_len] = '\0'; }
+  /* Return assembled JSON; the body itself becomes the cached payload */
+  if (co != CO_REVALIDATE) {
+    http_send_status(r, 200, "OK");
+    http_printf(r, "Content-Type: application/json; charset=utf-8\r\n\r\n");
+    http_write(r, b, len);
   }
-  http_send_status(r, 200, "OK");
-  http_printf(r, "Content-Type: application/json; charset=utf-8\r\n\r\n");
-  http_write(r, b, len);
-  free(b);
   if (devices_json) free(devices_json);
-  /* finish coalescing and store cache (cache_copy ownership transferred) */
-  endpoint_coalesce_finish(&g_discover_co, cache_copy, cache_len);
+  endpoint_coalesce_finish(&g_discover_co, co, co_key, payload_adopt(b, len));
   return 0;
 }
 
@@ -6010,182 +7770,10 @@ static int h_versions_json(http_request_t *r) {
     http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n");
     http_write(r,out,n); free(out); return 0;
   }
-  /* fallback: synthesize a useful versions JSON inline (no external script)
-   * Provide info useful for both EdgeRouter and container setups.
-   */
+  /* generator only fails when out of memory: minimal fallback */
   char host[256]=""; gethostname(host,sizeof(host)); host[sizeof(host)-1]=0;
-  int olsrd_on=0, olsr2_on=0; detect_olsr_processes(&olsrd_on,&olsr2_on);
-
-  /* autoupdate wizard info */
-  const char *au_path = "/etc/cron.daily/autoupdatewizards";
-  int auon = path_exists(au_path);
-  char *adu_dat = NULL; size_t adu_n = 0;
-  util_read_file("/config/user-data/autoupdate.dat", &adu_dat, &adu_n);
-  int aa_on = 0, aa1_on = 0, aa2_on = 0, aale_on = 0, aaebt_on = 0, aabp_on = 0;
-  if (adu_dat && adu_n>0) {
-    if (memmem(adu_dat, adu_n, "wizard-autoupdate=yes", 20)) aa_on = 1;
-    if (memmem(adu_dat, adu_n, "wizard-olsrd_v1=yes", 19)) aa1_on = 1;
-    if (memmem(adu_dat, adu_n, "wizard-olsrd_v2=yes", 19)) aa2_on = 1;
-    if (memmem(adu_dat, adu_n, "wizard-0xffwsle=yes", 18)) aale_on = 1;
-    if (memmem(adu_dat, adu_n, "wizard-ebtables=yes", 18)) aaebt_on = 1;
-    if (memmem(adu_dat, adu_n, "wizard-blockPrivate=yes", 24)) aabp_on = 1;
-  }
-
-  // Gather wizard versions (if present under /config/wizard/feature/*/wizard-run)
-  // We'll execute a small shell loop and parse lines like key=version to extract values.
-  char *wiz_out = NULL; size_t wiz_n = 0;
-  char olsrv1_ver[64] = "n/a", olsrv2_ver[64] = "n/a", wsle_ver[64] = "n/a", ebtables_ver[64] = "n/a", blockpriv_ver[64] = "n/a", autoupdate_ver[64] = "n/a";
-  if (path_exists("/config/wizard")) {
-  const char *wiz_cmd = "for i in /config/wizard/feature/*/wizard-run 2>/dev/null; do vers=$(head -n 10 \"$i\" | grep -ioE -m 1 'version.*' | awk -F' ' '{print $2;}' | tr -d '[]() '); if head -n 10 \"$i\" | grep -q 'OLSRd_V1'; then echo olsrv1=$vers; fi; if head -n 10 \"$i\" | grep -q 'OLSRd_V2'; then echo olsrv2=$vers; fi; if head -n 10 \"$i\" | grep -q '0xFF-BMK-Webstatus-LetsEncrypt'; then echo wsle=$vers; fi; if head -n 10 \"$i\" | grep -q 'ER-wizard-ebtables'; then echo ebtables=$vers; fi; if head -n 10 \"$i\" | grep -q 'ER-wizard-blockPrivate'; then echo blockpriv=$vers; fi; if head -n 10 \"$i\" | grep -q 'ER-wizard-AutoUpdate'; then echo autoupdate=$vers; fi; done";
-    if (util_exec(wiz_cmd, &wiz_out, &wiz_n) == 0 && wiz_out && wiz_n>0) {
-      /* parse lines */
-      char *p = wiz_out; char *line = NULL;
-      while (p && *p) {
-        line = p; char *nl = strchr(line,'\n'); if (nl) *nl = '\0';
-        if (strncmp(line, "olsrv1=", 7) == 0) strncpy(olsrv1_ver, line+7, sizeof(olsrv1_ver)-1);
-        else if (strncmp(line, "olsrv2=", 7) == 0) strncpy(olsrv2_ver, line+7, sizeof(olsrv2_ver)-1);
-        else if (strncmp(line, "wsle=", 5) == 0) strncpy(wsle_ver, line+5, sizeof(wsle_ver)-1);
-        else if (strncmp(line, "ebtables=", 9) == 0) strncpy(ebtables_ver, line+9, sizeof(ebtables_ver)-1);
-        else if (strncmp(line, "blockpriv=", 10) == 0) strncpy(blockpriv_ver, line+10, sizeof(blockpriv_ver)-1);
-        else if (strncmp(line, "autoupdate=", 11) == 0) strncpy(autoupdate_ver, line+11, sizeof(autoupdate_ver)-1);
-        if (!nl) {
-          break;
-        }
-        p = nl + 1;
-      }
-    }
-  }
-
-  /* homes (users) - simple listing */
-  char *homes_out = NULL; size_t homes_n = 0;
-  if (util_exec("/bin/ls -1 /home 2>/dev/null | awk '{printf \"\\\"%s\\\",\", $0}' | sed 's/,$/\\n/'", &homes_out, &homes_n) != 0) {
-    if (homes_out) { free(homes_out); homes_out = NULL; homes_n = 0; }
-  }
-  if (!homes_out) {
-    /* fallback to empty array */
-    homes_out = strdup("\n"); homes_n = homes_out ? strlen(homes_out) : 0;
-  }
-
-  /* boot image md5 */
-  char *md5_out = NULL; size_t md5_n = 0;
-  if (util_exec("/usr/bin/md5sum /dev/mtdblock2 2>/dev/null | cut -f1 -d' '", &md5_out, &md5_n) != 0) {
-    if (md5_out) { free(md5_out); md5_out = NULL; md5_n = 0; }
-  }
-
-  /* Determine system type heuristically */
-  const char *system_type = path_exists("/config/wizard") ? "edge-router" : "linux-container";
-
-  /* bmk-webstatus version (if present) */
-  char *bmk_out = NULL; size_t bmk_n = 0; char bmkwebstatus[128] = "n/a";
-  if (util_exec("head -n 12 /config/custom/www/cgi-bin-status*.php 2>/dev/null | grep -m1 version= | cut -d'\"' -f2", &bmk_out, &bmk_n) == 0 && bmk_out && bmk_n>0) {
-    char *t = strndup(bmk_out, (size_t)bmk_n);
-    if (t) { char *nl = strchr(t,'\n'); if (nl) *nl = 0; strncpy(bmkwebstatus, t, sizeof(bmkwebstatus)-1); free(t); }
-  }
-
-  /* olsrd4 watchdog flag: check EdgeRouter path first, then container path */
-  int olsrd4watchdog = 0;
-  char *olsrd4conf = NULL; size_t olsrd4_n = 0;
-  if (util_read_file("/config/user-data/olsrd4.conf", &olsrd4conf, &olsrd4_n) != 0) {
-    /* fallback to common linux container path */
-    if (util_read_file("/etc/olsrd/olsrd.conf", &olsrd4conf, &olsrd4_n) != 0) {
-      olsrd4conf = NULL; olsrd4_n = 0;
-    }
-  }
-  if (olsrd4conf && olsrd4_n>0) {
-    if (memmem(olsrd4conf, olsrd4_n, "olsrd_watchdog", 13) || memmem(olsrd4conf, olsrd4_n, "LoadPlugin.*olsrd_watchdog", 22)) olsrd4watchdog = 1;
-    free(olsrd4conf); olsrd4conf = NULL; olsrd4_n = 0;
-  }
-
-  /* local IPs: try to get a reasonable IPv4 and IPv6; prefer non-loopback addresses */
-  char ipv4_addr[64] = "n/a"; char ipv6_addr[128] = "n/a"; char originator[128] = "n/a";
-  char *tmp_out = NULL; size_t tmp_n = 0;
-  if (util_exec("ip -4 -o addr show scope global | awk '{print $4; exit}' | cut -d/ -f1", &tmp_out, &tmp_n) == 0 && tmp_out && tmp_n>0) {
-    char *t = strndup(tmp_out, tmp_n); if (t) { char *nl = strchr(t,'\n'); if (nl) *nl = 0; strncpy(ipv4_addr, t, sizeof(ipv4_addr)-1); free(t); }
-    free(tmp_out); tmp_out = NULL; tmp_n = 0;
-  }
-  if (util_exec("ip -6 -o addr show scope global | awk '{print $4; exit}' | cut -d/ -f1", &tmp_out, &tmp_n) == 0 && tmp_out && tmp_n>0) {
-    char *t = strndup(tmp_out, tmp_n); if (t) { char *nl = strchr(t,'\n'); if (nl) *nl = 0; strncpy(ipv6_addr, t, sizeof(ipv6_addr)-1); free(t); }
-    free(tmp_out); tmp_out = NULL; tmp_n = 0;
-  }
-  /* originator: if olsr2 running, try local telnet endpoint */
-  if (olsr2_on) {
-    char *orig_raw = NULL; size_t orig_n = 0;
-    if (util_http_get_url_local("http://127.0.0.1:8000/telnet/olsrv2info%20originator", &orig_raw, &orig_n, 1) == 0 && orig_raw && orig_n>0) {
-      /* take first line that contains ':' */
-      char *nl = strchr(orig_raw,'\n'); if (nl) *nl = 0; if (strchr(orig_raw,':')) strncpy(originator, orig_raw, sizeof(originator)-1);
-      free(orig_raw);
-    }
-  }
-
-  /* linklocals: capture eth0 MAC as serial-like identifier (best-effort) */
-  char linkserial[128] = "n/a";
-  char *ll_out = NULL; size_t ll_n = 0;
-  if (util_exec("ip -6 link show eth0 2>/dev/null | grep link/ether | awk '{gsub(\":\",\"\", $2); print toupper($2)}'", &ll_out, &ll_n) == 0 && ll_out && ll_n>0) {
-    char *t = strndup(ll_out, ll_n); if (t) { char *nl = strchr(t,'\n'); if (nl) *nl = 0; strncpy(linkserial, t, sizeof(linkserial)-1); free(t); }
-  }
-
-
-  /* Build JSON into dynamic buffer */
-  size_t buf_sz = 4096 + (homes_n>0?homes_n:0) + (md5_n>0?md5_n:0);
-  char *obuf = malloc(buf_sz);
-  if (!obuf) {
-    /* out of memory: fallback minimal */
-    char buf2[512]; snprintf(buf2,sizeof(buf2),"{\"olsrd_status_plugin\":\"%s\",\"host\":\"%s\"}\n","1.0",host);
-    send_json(r, buf2);
-    if (adu_dat) free(adu_dat);
-    return 0;
-  }
-  /* sanitize homes_out (it should contain quoted comma separated list or newline) */
-  char homes_json[512] = "[]";
-  if (homes_out && homes_n>0) {
-    /* homes_out already formatted by the ls command above ("user","user2",) */
-    size_t hn = homes_n;
-    /* remove trailing comma/newline and ensure brackets */
-    char *tmp = strndup(homes_out, homes_n);
-    if (tmp) {
-      /* strip trailing comma or newline */
-      while (hn>0 && (tmp[hn-1]=='\n' || tmp[hn-1]==',')) { tmp[--hn]=0; }
-      snprintf(homes_json, sizeof(homes_json), "[%s]", tmp[0] ? tmp : "");
-      free(tmp);
-    }
-  }
-
-  /* md5 cleanup */
-  char bootimage_md5[128] = "n/a";
-  if (md5_out && md5_n>0) {
-    /* trim newline */
-    char *m = strndup(md5_out, md5_n);
-    if (m) {
-      char *nl = strchr(m,'\n'); if (nl) *nl = 0; strncpy(bootimage_md5, m, sizeof(bootimage_md5)-1); bootimage_md5[sizeof(bootimage_md5)-1]=0; free(m);
-    }
-  }
-
-  snprintf(obuf, buf_sz,
-    "{\"host\":\"%s\",\"system\":\"%s\",\"olsrd_running\":%s,\"olsr2_running\":%s,\"olsrd4watchdog\":%s,\"autoupdate_wizards_installed\":\"%s\",\"autoupdate_settings\":{\"auto_update_enabled\":%s,\"olsrd_v1\":%s,\"olsrd_v2\":%s,\"wsle\":%s,\"ebtables\":%s,\"blockpriv\":%s},\"homes\":%s,\"bootimage\":{\"md5\":\"%s\"}}\n",
-    host,
-    system_type,
-    olsrd_on?"true":"false",
-    olsr2_on?"true":"false",
-    olsrd4watchdog?"true":"false",
-    auon?"yes":"no",
-    aa_on?"true":"false",
-    aa1_on?"true":"false",
-    aa2_on?"true":"false",
-    aale_on?"true":"false",
-    aaebt_on?"true":"false",
-    aabp_on?"true":"false",
-    homes_json,
-    bootimage_md5
-  );
-
-  http_send_status(r,200,"OK");
-  http_printf(r,"Content-Type: application/json; charset=utf-8\r\n\r\n");
-  http_write(r, obuf, strlen(obuf));
-  free(obuf);
-  if (adu_dat) free(adu_dat);
-  if (homes_out) free(homes_out);
-  if (md5_out) free(md5_out);
-  return 0;
+  char buf2[512]; snprintf(buf2,sizeof(buf2),"{\"olsrd_status_plugin\":\"%s\",\"host\":\"%s\"}\n","1.0",host);
+  send_json(r, buf2);
   return 0;
 }
 
@@ -6212,9 +7800,120 @@ static int h_airos(http_request_t *r) {
   return 0;
 }
 
+/* Concatenate /tmp/traffic-*.dat, each preceded by a "### <path>" line. */
+static int read_traffic_files(char **out, size_t *outlen) {
+  glob_t g;
+  if (glob("/tmp/traffic-*.dat", 0, NULL, &g) != 0) return -1;
+  size_t cap = 4096, len = 0;
+  char *buf = malloc(cap);
+  if (!buf) { globfree(&g); return -1; }
+  buf[0] = 0;
+  for (size_t i = 0; i < g.gl_pathc; i++) {
+    char *data = NULL; size_t dn = 0;
+    if (util_read_file(g.gl_pathv[i], &data, &dn) != 0) continue;
+    int rc = json_appendf(&buf, &len, &cap, "### %s\n%.*s", g.gl_pathv[i], (int)dn, data);
+    free(data);
+    if (rc != 0) { free(buf); globfree(&g); return -1; }
+  }
+  globfree(&g);
+  *out = buf; *outlen = len;
+  return 0;
+}
+
+static const char *const traffic_res_name[TRAFFIC_NRES] = { "sample", "1m", "1h" };
+
+/* bits per second over a bucket, or null */
+static int traffic_rate_json(char **buf, size_t *len, size_t *cap, const char *key, const traffic_bucket_t *b, int tx, int packets) {
+  if (!b || !b->secs) return json_buf_append(buf, len, cap, ",\"%s\":null", key) < 0 ? -1 : 0;
+  uint64_t v = packets ? (tx ? b->tx_packets : b->rx_packets) : (tx ? b->tx_bytes : b->rx_bytes) * 8;
+  return json_buf_append(buf, len, cap, ",\"%s\":%.1f", key, (double)v / b->secs) < 0 ? -1 : 0;
+}
+
+static int traffic_bucket_json(char **buf, size_t *len, size_t *cap, const traffic_bucket_t *b, int comma) {
+  return json_buf_append(buf, len, cap, "%s[%ld,%u,%llu,%llu,%llu,%llu]", comma ? "," : "", (long)b->t, (unsigned)b->secs,
+                         (unsigned long long)b->rx_bytes, (unsigned long long)b->tx_bytes,
+                         (unsigned long long)b->rx_packets, (unsigned long long)b->tx_packets) < 0 ? -1 : 0;
+}
+
+/* Sampler state as JSON: counters and current rates per interface, plus the
+ * ring of one resolution when res= is given (buckets are
+ * [start, seconds, rx_bytes, tx_bytes, rx_packets, tx_packets], newest first).
+ */
+static int traffic_json(http_request_t *r, char **out, size_t *outlen) {
+  char want_if[32] = "", want_res[16] = "", nbuf[16] = "";
+  (void)get_query_param(r, "iface", want_if, sizeof(want_if));
+  (void)get_query_param(r, "res", want_res, sizeof(want_res));
+  int res = -1, limit = 0;
+  for (int i = 0; i < TRAFFIC_NRES; i++) if (strcmp(want_res, traffic_res_name[i]) == 0) res = i;
+  if (strcmp(want_res, "1s") == 0) res = TRAFFIC_RES_SAMPLE;
+  if (get_query_param(r, "n", nbuf, sizeof(nbuf))) limit = atoi(nbuf);
+  traffic_iface_t *v = NULL;
+  int n = traffic_snapshot(&v);
+  if (n < 0) return -1;
+  traffic_stats_t st; traffic_get_stats(&st);
+  size_t cap = 4096, len = 0;
+  char *buf = malloc(cap);
+  if (!buf) { free(v); return -1; }
+  buf[0] = 0;
+  int rc = json_buf_append(&buf, &len, &cap, "{\"interval\":%d,\"source\":\"%s\",\"updated\":%ld,\"memory_bytes\":%zu,\"interfaces\":[",
+                           st.interval, st.source, (long)st.updated, st.memory_bytes) < 0 ? -1 : 0;
+  int first = 1;
+  for (int i = 0; rc == 0 && i < n; i++) {
+    const traffic_iface_t *it = &v[i];
+    if (want_if[0] && strcmp(want_if, it->name) != 0) continue;
+    rc = json_buf_append(&buf, &len, &cap, "%s{\"name\":", first ? "" : ",") < 0 ? -1 : 0;
+    if (rc == 0) rc = json_append_escaped(&buf, &len, &cap, it->name);
+    if (rc == 0) rc = json_buf_append(&buf, &len, &cap, ",\"ifindex\":%d,\"rx_bytes\":%llu,\"tx_bytes\":%llu,\"rx_packets\":%llu,\"tx_packets\":%llu,"
+                         "\"rx_errors\":%llu,\"tx_errors\":%llu,\"rx_dropped\":%llu,\"tx_dropped\":%llu",
+                         it->ifindex,
+                         (unsigned long long)it->rx_bytes, (unsigned long long)it->tx_bytes,
+                         (unsigned long long)it->rx_packets, (unsigned long long)it->tx_packets,
+                         (unsigned long long)it->rx_errors, (unsigned long long)it->tx_errors,
+                         (unsigned long long)it->rx_dropped, (unsigned long long)it->tx_dropped) < 0 ? -1 : 0;
+    first = 0;
+    const traffic_bucket_t *last = traffic_bucket_at(it, TRAFFIC_RES_SAMPLE, 0), *min = traffic_bucket_at(it, TRAFFIC_RES_MINUTE, 0);
+    if (rc == 0) rc = traffic_rate_json(&buf, &len, &cap, "rx_bps", last, 0, 0);
+    if (rc == 0) rc = traffic_rate_json(&buf, &len, &cap, "tx_bps", last, 1, 0);
+    if (rc == 0) rc = traffic_rate_json(&buf, &len, &cap, "rx_pps", last, 0, 1);
+    if (rc == 0) rc = traffic_rate_json(&buf, &len, &cap, "tx_pps", last, 1, 1);
+    if (rc == 0) rc = traffic_rate_json(&buf, &len, &cap, "rx_bps_1m", min, 0, 0);
+    if (rc == 0) rc = traffic_rate_json(&buf, &len, &cap, "tx_bps_1m", min, 1, 0);
+    if (rc == 0 && res >= 0) {
+      int cnt = it->ring[res].count;
+      if (limit > 0 && limit < cnt) cnt = limit;
+      rc = json_buf_append(&buf, &len, &cap, ",\"series\":{\"res\":\"%s\",", traffic_res_name[res]) < 0 ? -1 : 0;
+      /* the minute/hour still being filled */
+      if (rc == 0 && res != TRAFFIC_RES_SAMPLE && it->ring[res].acc.secs) {
+        rc = json_buf_append(&buf, &len, &cap, "\"partial\":") < 0 ? -1 : 0;
+        if (rc == 0) rc = traffic_bucket_json(&buf, &len, &cap, &it->ring[res].acc, 0);
+        if (rc == 0) rc = json_buf_append(&buf, &len, &cap, ",") < 0 ? -1 : 0;
+      }
+      if (rc == 0) rc = json_buf_append(&buf, &len, &cap, "\"buckets\":[") < 0 ? -1 : 0;
+      for (int k = 0; rc == 0 && k < cnt; k++) rc = traffic_bucket_json(&buf, &len, &cap, traffic_bucket_at(it, res, k), k);
+      if (rc == 0) rc = json_buf_append(&buf, &len, &cap, "]}") < 0 ? -1 : 0;
+    }
+    if (rc == 0) rc = json_buf_append(&buf, &len, &cap, "}") < 0 ? -1 : 0;
+  }
+  if (rc == 0) rc = json_buf_append(&buf, &len, &cap, "]}\n") < 0 ? -1 : 0;
+  free(v);
+  if (rc != 0) { free(buf); return -1; }
+  *out = buf; *outlen = len;
+  return 0;
+}
+
+/* /traffic.json; /traffic keeps serving the file dump it always did. */
+static int h_traffic_json(http_request_t *r) {
+  char *out=NULL; size_t n=0;
+  if (traffic_json(r, &out, &n) != 0) { send_json(r, "{\"interfaces\":[]}\n"); return 0; }
+  http_send_status(r, 200, "OK");
+  http_printf(r, "Content-Type: application/json; charset=utf-8\r\n\r\n");
+  http_write(r, out, n); free(out);
+  return 0;
+}
+
 static int h_traffic(http_request_t *r) {
   char *out=NULL; size_t n=0;
-  if (util_exec("ls -1 /tmp/traffic-*.dat 2>/dev/null | xargs -r -I{} sh -c 'echo ### {}; cat {}'", &out, &n)==0 && out) {
+  if (read_traffic_files(&out, &n)==0 && out) {
     http_send_status(r, 200, "OK");
     http_printf(r, "Content-Type: text/plain; charset=utf-8\r\n\r\n");
     http_write(r, out, n); free(out);
@@ -6222,6 +7921,153 @@ static int h_traffic(http_request_t *r) {
   return 0;
 }
 
+/* Numeric link field of one OLSR link object; -1 when absent or not a number
+ * (e.g. "INFINITE" costs).
+ */
+static double link_field_num(const char *obj, const char *key) {
+  char *v; size_t vlen; char tmp[32], *end;
+  if (!find_json_string_value(obj, key, &v, &vlen) || vlen == 0 || vlen >= sizeof(tmp)) return -1;
+  memcpy(tmp, v, vlen); tmp[vlen] = 0;
+  double d = strtod(tmp, &end);
+  return (end == tmp || !isfinite(d) || d < 0) ? -1 : d;
+}
+
+/* History collector: one sample per link from the local OLSR links endpoint,
+ * with the number of routes using the neighbour as gateway. Runs on the
+ * history thread.
+ */
+static int lq_history_collect(lqh_sample_t **out) {
+  static const char *const endpoints[] = { "http://127.0.0.1:9090/links", "http://127.0.0.1:2006/links", "http://127.0.0.1:8123/links", NULL };
+  char *links = NULL, *routes = NULL; size_t ln = 0, rn = 0;
+  for (const char *const *ep = endpoints; *ep; ++ep) {
+    if (util_http_get_url_local(*ep, &links, &ln, 1) == 0 && links && ln > 0 && strstr(links, "\"links\"")) break;
+    free(links); links = NULL; ln = 0;
+  }
+  if (!links) return -1;
+  if (util_http_get_url_local("http://127.0.0.1:9090/routes", &routes, &rn, 1) != 0) { free(routes); routes = NULL; }
+  const char *route_sec = routes ? strstr(routes, "\"routes\"") : NULL;
+  int n = 0, cap = 0; lqh_sample_t *v = NULL;
+  const char *p = strchr(strstr(links, "\"links\""), '[');
+  int depth = 0;
+  while (p && *p) {
+    if (*p == '[') { depth++; p++; continue; }
+    if (*p == ']') { if (--depth == 0) break; p++; continue; }
+    if (*p != '{') { p++; continue; }
+    const char *obj = p; int od = 1; p++;
+    while (*p && od > 0) { if (*p == '{') od++; else if (*p == '}') od--; p++; }
+    /* bounded copy so key lookups cannot run into the next link */
+    char one[2048]; size_t ol = (size_t)(p - obj);
+    if (ol >= sizeof(one)) continue;
+    memcpy(one, obj, ol); one[ol] = 0;
+    char *ip; size_t iplen;
+    if (!(find_json_string_value(one, "remoteIP", &ip, &iplen) || find_json_string_value(one, "remoteIp", &ip, &iplen) ||
+          find_json_string_value(one, "neighborIP", &ip, &iplen)) || iplen == 0 || iplen >= sizeof(v->ip)) continue;
+    if (n == cap) {
+      int nc = cap ? cap * 2 : 16;
+      lqh_sample_t *nv = realloc(v, (size_t)nc * sizeof(*v));
+      if (!nv) break;
+      v = nv; cap = nc;
+    }
+    lqh_sample_t *s = &v[n++];
+    memcpy(s->ip, ip, iplen); s->ip[iplen] = 0;
+    s->lq = link_field_num(one, "linkQuality");
+    s->nlq = link_field_num(one, "neighborLinkQuality");
+    s->cost = link_field_num(one, "linkCost");
+    s->routes = route_sec ? count_routes_for_ip(route_sec, s->ip) : -1;
+  }
+  free(links); free(routes);
+  *out = v;
+  return n;
+}
+
+static int history_num(char **buf, size_t *len, size_t *cap, double v, int prec) {
+  if (v < 0) return json_buf_append(buf, len, cap, ",null") < 0 ? -1 : 0;
+  return json_buf_append(buf, len, cap, ",%.*f", prec, v) < 0 ? -1 : 0;
+}
+
+static int history_point_json(char **buf, size_t *len, size_t *cap, const lqh_point_t *pt) {
+  int rc = json_buf_append(buf, len, cap, "[%lu", (unsigned long)pt->t) < 0 ? -1 : 0;
+  if (rc == 0) rc = history_num(buf, len, cap, lqh_ratio(pt->lq), 3);
+  if (rc == 0) rc = history_num(buf, len, cap, lqh_ratio(pt->nlq), 3);
+  if (rc == 0) rc = history_num(buf, len, cap, lqh_cost(pt->cost), 2);
+  if (rc == 0) rc = history_num(buf, len, cap, pt->routes == LQH_NONE ? -1 : pt->routes, 0);
+  if (rc == 0) rc = json_buf_append(buf, len, cap, "]") < 0 ? -1 : 0;
+  return rc;
+}
+
+/* "1h", "6h", "24h", "7d", "90m" or plain seconds; 0 when unparsable. */
+static long history_range_seconds(const char *s) {
+  char *end; long v = strtol(s, &end, 10);
+  if (end == s || v <= 0) return 0;
+  switch (*end) {
+    case 0: case 's': return v;
+    case 'm': return v * 60;
+    case 'h': return v * 3600;
+    case 'd': return v * 86400;
+    default: return 0;
+  }
+}
+
+/* /history: neighbours with their latest values, or with neighbor=IP the
+ * points of the tier covering range= as [t, lq, nlq, cost, routes], oldest
+ * first (null = unknown).
+ */
+static int h_history(http_request_t *r) {
+  lqh_stats_t st; lqh_get_stats(&st);
+  if (st.interval <= 0) { send_json(r, "{\"enabled\":false}\n"); return 0; }
+  char nb[64] = "", range[16] = "1h";
+  (void)get_query_param(r, "neighbor", nb, sizeof(nb));
+  (void)get_query_param(r, "range", range, sizeof(range));
+  size_t cap = 4096, len = 0;
+  char *buf = malloc(cap);
+  if (!buf) { send_json(r, "{}\n"); return 0; }
+  buf[0] = 0;
+  int rc = 0;
+  if (!nb[0]) {
+    lqh_neighbor_t *v = NULL;
+    int n = lqh_neighbors(&v);
+    rc = json_buf_append(&buf, &len, &cap, "{\"enabled\":true,\"interval\":%d,\"tiers\":[%d,%d,%d],\"memory_bytes\":%zu,\"neighbors\":[",
+                         st.interval, lqh_tier_seconds(LQH_TIER_RAW), lqh_tier_seconds(LQH_TIER_5M), lqh_tier_seconds(LQH_TIER_1H), st.memory_bytes) < 0 ? -1 : 0;
+    for (int i = 0; rc == 0 && i < n; i++) {
+      rc = json_buf_append(&buf, &len, &cap, "%s{\"ip\":", i ? "," : "") < 0 ? -1 : 0;
+      if (rc == 0) rc = json_append_escaped(&buf, &len, &cap, v[i].ip) < 0 ? -1 : 0;
+      if (rc == 0) rc = json_buf_append(&buf, &len, &cap, ",\"last_seen\":%ld,\"points\":[%d,%d,%d],\"last\":",
+                                        (long)v[i].last_seen, v[i].points[0], v[i].points[1], v[i].points[2]) < 0 ? -1 : 0;
+      if (rc == 0) rc = history_point_json(&buf, &len, &cap, &v[i].last);
+      if (rc == 0) rc = json_buf_append(&buf, &len, &cap, "}") < 0 ? -1 : 0;
+    }
+    free(v);
+    if (rc == 0) rc = json_buf_append(&buf, &len, &cap, "]}\n") < 0 ? -1 : 0;
+  } else {
+    long secs = history_range_seconds(range);
+    if (secs <= 0) secs = 3600;
+    int tier = lqh_tier_for_range(secs);
+    lqh_point_t *pts = NULL;
+    int n = lqh_query(nb, tier, time(NULL) - secs, &pts);
+    if (n < 0) {
+      free(buf);
+      http_send_status(r, 404, "Not Found");
+      http_printf(r, "Content-Type: application/json; charset=utf-8\r\n\r\n");
+      http_printf(r, "{\"error\":\"unknown neighbor\"}\n");
+      return 0;
+    }
+    rc = json_buf_append(&buf, &len, &cap, "{\"neighbor\":") < 0 ? -1 : 0;
+    if (rc == 0) rc = json_append_escaped(&buf, &len, &cap, nb) < 0 ? -1 : 0;
+    if (rc == 0) rc = json_buf_append(&buf, &len, &cap, ",\"range\":%ld,\"res\":%d,\"points\":[", secs, lqh_tier_seconds(tier)) < 0 ? -1 : 0;
+    for (int i = 0; rc == 0 && i < n; i++) {
+      if (i) rc = json_buf_append(&buf, &len, &cap, ",") < 0 ? -1 : 0;
+      if (rc == 0) rc = history_point_json(&buf, &len, &cap, &pts[i]);
+    }
+    free(pts);
+    if (rc == 0) rc = json_buf_append(&buf, &len, &cap, "]}\n") < 0 ? -1 : 0;
+  }
+  if (rc != 0) { free(buf); send_json(r, "{}\n"); return 0; }
+  http_send_status(r, 200, "OK");
+  http_printf(r, "Content-Type: application/json; charset=utf-8\r\n\r\n");
+  http_write(r, buf, len); free(buf);
+  return 0;
+}
+
 /* forward declarations used before including headers later in this file */
 int path_exists(const char *p);
 extern int g_is_edgerouter;
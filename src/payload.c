@@ -0,0 +1,45 @@
+#include "payload.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned long g_payload_gen;
+
+payload_t *payload_adopt(char *data, size_t len) {
+  if (!data) return NULL;
+  payload_t *p = malloc(sizeof(*p));
+  if (!p) { free(data); return NULL; }
+  data[len] = 0;
+  p->data = data; p->len = len; p->refs = 1;
+  p->gen = __atomic_add_fetch(&g_payload_gen, 1, __ATOMIC_RELAXED);
+  snprintf(p->etag, sizeof(p->etag), "\"%lx-%zx\"", p->gen, len);
+  return p;
+}
+
+payload_t *payload_new(const char *data, size_t len) {
+  char *d = malloc(len + 1);
+  if (!d) return NULL;
+  if (len) memcpy(d, data, len);
+  return payload_adopt(d, len);
+}
+
+payload_t *payload_ref(payload_t *p) {
+  if (p) __atomic_add_fetch(&p->refs, 1, __ATOMIC_RELAXED);
+  return p;
+}
+
+void payload_unref(payload_t *p) {
+  if (!p || __atomic_sub_fetch(&p->refs, 1, __ATOMIC_ACQ_REL) != 0) return;
+  free(p->data);
+  free(p);
+}
+
+void payload_swap(payload_t **slot, payload_t *p) {
+  payload_t *old = *slot;
+  *slot = p;
+  payload_unref(old);
+}
+
+payload_t *payload_get(payload_t *const *slot) {
+  return payload_ref(*slot);
+}
@@ -0,0 +1,39 @@
+#ifndef OLSRD_STATUS_PAYLOAD_H
+#define OLSRD_STATUS_PAYLOAD_H
+#include <stddef.h>
+
+/* Immutable, reference-counted response body. A cache publishes one and
+ * hands out references; readers write it to the socket after dropping the
+ * cache lock and release it when done. The bytes never change once the
+ * payload exists, and data[len] is always 0.
+ *
+ * Every payload gets a process-wide generation when it is created and a
+ * strong ETag (quoted, ready for the header) derived from it, so a
+ * republished cache entry always validates differently from its
+ * predecessor.
+ */
+typedef struct payload {
+  char *data;
+  size_t len;
+  unsigned long gen;
+  char etag[40];
+  int refs;
+} payload_t;
+
+/* Copy len bytes into a new payload (refs = 1). */
+payload_t *payload_new(const char *data, size_t len);
+/* Take over a malloc'ed buffer of len bytes plus room for the NUL; on
+ * failure the buffer is freed and NULL returned.
+ */
+payload_t *payload_adopt(char *data, size_t len);
+payload_t *payload_ref(payload_t *p);
+void payload_unref(payload_t *p);
+
+/* Replace *slot with p (which the slot now owns) and drop the previous
+ * payload. The caller holds whatever lock guards the slot; readers still
+ * holding a reference to the old payload keep it alive.
+ */
+void payload_swap(payload_t **slot, payload_t *p);
+/* Reference to *slot, or NULL; same locking rule as payload_swap(). */
+payload_t *payload_get(payload_t *const *slot);
+#endif
@@ -0,0 +1,123 @@
+#include "procscan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+/* getdents64 through syscall(): not every libc we build against wraps it */
+struct linux_dirent64 {
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[];
+};
+
+static ssize_t read_small(int dirfd, const char *path, char *buf, size_t len) {
+  int fd = openat(dirfd, path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return -1;
+  ssize_t n = read(fd, buf, len - 1);
+  close(fd);
+  if (n < 0) return -1;
+  buf[n] = '\0';
+  return n;
+}
+
+/* Parse the fields we report out of /proc/<pid>/stat. */
+static int parse_stat(const char *buf, procscan_info_t *info) {
+  const char *p = strrchr(buf, ')'); /* comm may contain spaces and parens */
+  if (!p) return -1;
+  p++;
+  /* after ')' comes field 3 (state); starttime is field 22, rss field 24 */
+  unsigned long long start = 0; long rss = 0;
+  int field = 2;
+  while (*p && field < 24) {
+    while (*p == ' ') p++;
+    field++;
+    if (field == 22) start = strtoull(p, NULL, 10);
+    else if (field == 24) rss = strtol(p, NULL, 10);
+    while (*p && *p != ' ') p++;
+  }
+  if (field < 24) return -1;
+  static long hz = 0, page_kb = 0;
+  if (!hz) { hz = sysconf(_SC_CLK_TCK); if (hz <= 0) hz = 100; }
+  if (!page_kb) { page_kb = sysconf(_SC_PAGESIZE) / 1024; if (page_kb <= 0) page_kb = 4; }
+  double up = 0;
+  char ub[64];
+  if (read_small(AT_FDCWD, "/proc/uptime", ub, sizeof(ub)) > 0) up = strtod(ub, NULL);
+  info->start_ticks = start;
+  info->uptime_s = (long)(up - (double)start / (double)hz);
+  if (info->uptime_s < 0) info->uptime_s = 0;
+  info->started = time(NULL) - info->uptime_s;
+  info->rss_kb = rss > 0 ? (unsigned long)rss * (unsigned long)page_kb : 0;
+  return 0;
+}
+
+int procscan_read(int pid, procscan_info_t *info) {
+  char path[32], buf[1024];
+  snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+  if (read_small(AT_FDCWD, path, buf, sizeof(buf)) <= 0) return -1;
+  procscan_info_t tmp; memset(&tmp, 0, sizeof(tmp));
+  if (parse_stat(buf, &tmp) != 0) return -1;
+  tmp.pid = pid;
+  if (info) *info = tmp;
+  return 0;
+}
+
+int procscan_comm(int pid, char *out, size_t outlen) {
+  char path[32], buf[64];
+  if (pid > 0) snprintf(path, sizeof(path), "/proc/%d/comm", pid); else snprintf(path, sizeof(path), "/proc/self/comm");
+  ssize_t n = read_small(AT_FDCWD, path, buf, sizeof(buf));
+  if (n <= 0) return -1;
+  if (buf[n - 1] == '\n') buf[n - 1] = '\0';
+  snprintf(out, outlen, "%s", buf);
+  return 0;
+}
+
+static int name_matches(int procfd, const char *pid, const char *const *names, int nnames, unsigned found) {
+  char path[64], comm[64];
+  snprintf(path, sizeof(path), "%s/comm", pid);
+  ssize_t n = read_small(procfd, path, comm, sizeof(comm));
+  if (n <= 0) return -1;
+  if (comm[n - 1] == '\n') comm[n - 1] = '\0';
+  for (int i = 0; i < nnames; i++) if (!(found & (1u << i)) && strcmp(comm, names[i]) == 0) return i;
+  /* wrappers and long names: fall back to argv[0] */
+  char cmd[256];
+  snprintf(path, sizeof(path), "%s/cmdline", pid);
+  if (read_small(procfd, path, cmd, sizeof(cmd)) <= 0) return -1;
+  const char *base = strrchr(cmd, '/'); base = base ? base + 1 : cmd;
+  for (int i = 0; i < nnames; i++) if (!(found & (1u << i)) && strcmp(base, names[i]) == 0) return i;
+  return -1;
+}
+
+unsigned procscan_find(const char *const *names, int nnames, procscan_info_t *out) {
+  unsigned found = 0, all = nnames >= 32 ? 0xFFFFFFFFu : ((1u << nnames) - 1);
+  int procfd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (procfd < 0) return 0;
+  char buf[8192] __attribute__((aligned(8)));  /* getdents64 records hold 64-bit fields */
+  for (;;) {
+    long n = syscall(SYS_getdents64, procfd, buf, sizeof(buf));
+    if (n <= 0) break;
+    for (long off = 0; off < n; ) {
+      struct linux_dirent64 *d = (struct linux_dirent64 *)(void *)(buf + off);
+      off += d->d_reclen;
+      if (d->d_name[0] < '1' || d->d_name[0] > '9') continue;
+      int i = name_matches(procfd, d->d_name, names, nnames, found);
+      if (i < 0) continue;
+      char path[64], st[1024];
+      snprintf(path, sizeof(path), "%s/stat", d->d_name);
+      if (read_small(procfd, path, st, sizeof(st)) <= 0) continue;
+      memset(&out[i], 0, sizeof(out[i]));
+      if (parse_stat(st, &out[i]) != 0) continue;
+      out[i].pid = atoi(d->d_name);
+      found |= 1u << i;
+      if (found == all) break;
+    }
+    if (found == all) break;
+  }
+  close(procfd);
+  return found;
+}
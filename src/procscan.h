@@ -0,0 +1,25 @@
+#ifndef OLSRD_STATUS_PROCSCAN_H
+#define OLSRD_STATUS_PROCSCAN_H
+#include <stddef.h>
+#include <time.h>
+
+/* In-process /proc walker (replaces pidof/ps). Fields come from one read of
+ * /proc/<pid>/stat, so looking up a process costs no fork or exec.
+ */
+typedef struct {
+  int pid;
+  unsigned long long start_ticks; /* starttime from stat; detects pid reuse */
+  time_t started;                 /* wall clock start time */
+  long uptime_s;
+  unsigned long rss_kb;
+} procscan_info_t;
+
+/* Walk /proc once and fill out[i] for the first process whose comm or
+ * basename(argv[0]) equals names[i]. Returns a bitmask of the names found.
+ */
+unsigned procscan_find(const char *const *names, int nnames, procscan_info_t *out);
+/* Re-read one pid's stat. Returns 0 and fills info, -1 if the pid is gone. */
+int procscan_read(int pid, procscan_info_t *info);
+/* comm of a pid (0 = self). Returns 0 on success. */
+int procscan_comm(int pid, char *out, size_t outlen);
+#endif
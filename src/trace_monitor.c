@@ -0,0 +1,131 @@
+#include "trace_monitor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_cv = PTHREAD_COND_INITIALIZER;
+static pthread_t g_thread;
+static int g_running = 0, g_stop = 0, g_unavailable = 0;
+static int g_interval = 60;
+static trace_opts_t g_opts;
+static void (*g_target_fn)(char *, size_t);
+
+static trace_sample_t *g_ring = NULL;   /* g_cap slots, g_head = next write */
+static int g_cap = 0, g_head = 0, g_count = 0;
+static trace_monitor_stats_t g_stats;
+
+/* A path changed when two runs disagree on a hop both saw, or when both
+ * reached the destination at a different distance. Silent hops do not count:
+ * a router skipping one ICMP reply is not a new path.
+ */
+static int path_differs(const trace_sample_t *a, const trace_sample_t *b) {
+  if (strcmp(a->target, b->target) != 0) return 1;
+  if (a->tr.reached && b->tr.reached && a->tr.nhops != b->tr.nhops) return 1;
+  int n = a->tr.nhops < b->tr.nhops ? a->tr.nhops : b->tr.nhops;
+  for (int i = 0; i < n; i++) {
+    const char *x = a->tr.hop[i].ip, *y = b->tr.hop[i].ip;
+    if (x[0] && y[0] && strcmp(x, y) != 0) return 1;
+  }
+  return 0;
+}
+
+static void *monitor_thread(void *arg) {
+  (void)arg;
+  trace_sample_t *s = malloc(sizeof(*s));
+  if (!s) return NULL;
+  pthread_mutex_lock(&g_lock);
+  while (!g_stop) {
+    pthread_mutex_unlock(&g_lock);
+    memset(s, 0, sizeof(*s));
+    if (g_target_fn) g_target_fn(s->target, sizeof(s->target));
+    int rc = s->target[0] ? trace_run(s->target, &g_opts, &s->tr) : -1;
+    s->ts = time(NULL);
+    pthread_mutex_lock(&g_lock);
+    g_stats.runs++;
+    if (rc != 0) {
+      g_stats.failures++;
+      /* no probe socket at all: let handlers fall back to tracing themselves */
+      if (!g_count) g_unavailable = 1;
+    } else {
+      g_unavailable = 0;
+      if (g_count) {
+        const trace_sample_t *prev = &g_ring[(g_head + g_cap - 1) % g_cap];
+        s->changed = path_differs(s, prev);
+        if (s->changed) { g_stats.changes++; g_stats.last_change = s->ts; }
+      }
+      g_ring[g_head] = *s;
+      g_head = (g_head + 1) % g_cap;
+      if (g_count < g_cap) g_count++;
+      if (s->changed)
+        fprintf(stderr, "[status-plugin] uplink path to %s changed (%d hops%s)\n", s->target, s->tr.nhops, s->tr.reached ? "" : ", destination silent");
+    }
+    struct timespec until; clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += g_interval;
+    while (!g_stop && pthread_cond_timedwait(&g_cv, &g_lock, &until) != ETIMEDOUT) { }
+  }
+  pthread_mutex_unlock(&g_lock);
+  free(s);
+  return NULL;
+}
+
+int trace_monitor_start(int interval_s, int history, const trace_opts_t *opts,
+                        void (*target_fn)(char *out, size_t outlen)) {
+  if (g_running || interval_s <= 0) return -1;
+  if (history < 1) history = 1;
+  trace_sample_t *ring = calloc((size_t)history, sizeof(*ring));
+  if (!ring) return -1;
+  pthread_mutex_lock(&g_lock);
+  g_ring = ring; g_cap = history; g_head = g_count = 0;
+  g_interval = interval_s; g_target_fn = target_fn; g_stop = 0; g_unavailable = 0;
+  if (opts) g_opts = *opts; else memset(&g_opts, 0, sizeof(g_opts));
+  memset(&g_stats, 0, sizeof(g_stats));
+  pthread_mutex_unlock(&g_lock);
+  if (pthread_create(&g_thread, NULL, monitor_thread, NULL) != 0) {
+    free(g_ring); g_ring = NULL; g_cap = 0;
+    return -1;
+  }
+  g_running = 1;
+  return 0;
+}
+
+void trace_monitor_stop(void) {
+  if (!g_running) return;
+  pthread_mutex_lock(&g_lock);
+  g_stop = 1;
+  pthread_cond_broadcast(&g_cv);
+  pthread_mutex_unlock(&g_lock);
+  pthread_join(g_thread, NULL);   /* a run in progress ends at its own deadline */
+  pthread_mutex_lock(&g_lock);
+  free(g_ring); g_ring = NULL; g_cap = g_count = g_head = 0;
+  g_running = 0;
+  pthread_mutex_unlock(&g_lock);
+}
+
+int trace_monitor_latest(trace_sample_t *out) {
+  pthread_mutex_lock(&g_lock);
+  int rc = (!g_running || g_unavailable) ? -1 : 0;
+  if (rc == 0 && g_count) { if (out) *out = g_ring[(g_head + g_cap - 1) % g_cap]; rc = 1; }
+  pthread_mutex_unlock(&g_lock);
+  return rc;
+}
+
+int trace_monitor_history(trace_sample_t *out, int max) {
+  pthread_mutex_lock(&g_lock);
+  int n = g_count < max ? g_count : max;
+  for (int i = 0; i < n; i++) out[i] = g_ring[(g_head + g_cap - 1 - i) % g_cap];
+  pthread_mutex_unlock(&g_lock);
+  return n;
+}
+
+void trace_monitor_get_stats(trace_monitor_stats_t *st) {
+  if (!st) return;
+  pthread_mutex_lock(&g_lock);
+  *st = g_stats;
+  st->interval = g_running ? g_interval : 0;
+  st->history = g_cap;
+  st->stored = g_count;
+  pthread_mutex_unlock(&g_lock);
+}
@@ -0,0 +1,35 @@
+#ifndef OLSRD_STATUS_TRACE_MONITOR_H
+#define OLSRD_STATUS_TRACE_MONITOR_H
+#include <time.h>
+#include "traceroute.h"
+
+/* Background uplink path monitor: traces the target every interval seconds
+ * and keeps the last N results in a ring, flagging runs whose hop sequence
+ * differs from the previous one. Handlers read the latest result instead of
+ * tracing on demand.
+ */
+typedef struct {
+  time_t ts;               /* when the run finished */
+  char target[256];
+  trace_result_t tr;
+  int changed;             /* path differs from the previous sample */
+} trace_sample_t;
+
+typedef struct {
+  unsigned long runs, failures, changes;
+  time_t last_change;      /* 0 = no change seen yet */
+  int interval, history, stored;
+} trace_monitor_stats_t;
+
+/* target_fn fills the current target (re-read every run); opts as trace_run(). */
+int trace_monitor_start(int interval_s, int history, const trace_opts_t *opts,
+                        void (*target_fn)(char *out, size_t outlen));
+void trace_monitor_stop(void);
+/* 1 and the newest sample, 0 while the first run is pending, -1 when the
+ * monitor is off or cannot trace (callers then trace on demand).
+ */
+int trace_monitor_latest(trace_sample_t *out);
+/* Copy up to max samples, newest first; returns the count. */
+int trace_monitor_history(trace_sample_t *out, int max);
+void trace_monitor_get_stats(trace_monitor_stats_t *st);
+#endif
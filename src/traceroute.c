@@ -0,0 +1,254 @@
+#include "traceroute.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/ip_icmp.h>
+#include <netinet/icmp6.h>
+#include <arpa/inet.h>
+#include <linux/errqueue.h>
+
+#define TRACE_BASE_PORT 33434   /* traceroute's traditional first port */
+#define TRACE_ATTEMPTS  2       /* initial burst plus one resend of silent hops */
+
+struct trace_state {
+  int s, family, proto, max_ttl;
+  struct sockaddr_storage dst;
+  socklen_t dstlen;
+  struct timespec sent[TRACE_ATTEMPTS][TRACE_MAX_HOPS];
+  unsigned char answered[TRACE_MAX_HOPS];
+  int end_ttl;                  /* destination or unreachable reply, 0 = not yet */
+  trace_result_t *res;
+};
+
+static double ms_between(const struct timespec *a, const struct timespec *b) {
+  return (double)(b->tv_sec - a->tv_sec) * 1000.0 + (double)(b->tv_nsec - a->tv_nsec) / 1e6;
+}
+
+static long mono_ms(void) {
+  struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long)ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+/* Probe key: attempt * max_ttl + (ttl - 1); carried in the UDP destination
+ * port or the ICMP echo sequence number.
+ */
+static int send_probe(struct trace_state *st, int ttl, int attempt) {
+  int key = attempt * st->max_ttl + (ttl - 1);
+  if (st->family == AF_INET6) {
+    if (setsockopt(st->s, IPPROTO_IPV6, IPV6_UNICAST_HOPS, &ttl, sizeof(ttl)) != 0) return -1;
+  } else if (setsockopt(st->s, IPPROTO_IP, IP_TTL, &ttl, sizeof(ttl)) != 0) return -1;
+  struct sockaddr_storage to = st->dst;
+  unsigned char pkt[16]; memset(pkt, 0, sizeof(pkt));
+  if (st->proto == TRACE_ICMP) {
+    pkt[0] = st->family == AF_INET6 ? ICMP6_ECHO_REQUEST : ICMP_ECHO;   /* id and checksum: kernel */
+    pkt[6] = (unsigned char)(key >> 8); pkt[7] = (unsigned char)key;
+  } else {
+    uint16_t port = htons((uint16_t)(TRACE_BASE_PORT + key));
+    if (st->family == AF_INET6) ((struct sockaddr_in6 *)&to)->sin6_port = port;
+    else ((struct sockaddr_in *)&to)->sin_port = port;
+  }
+  clock_gettime(CLOCK_REALTIME, &st->sent[attempt][ttl - 1]);
+  /* an ICMP error that already arrived can surface as this send's error once */
+  for (int tries = 0; tries < 2; tries++) {
+    if (sendto(st->s, pkt, sizeof(pkt), 0, (struct sockaddr *)&to, st->dstlen) >= 0) {
+      st->res->probes_sent++;
+      return 0;
+    }
+    if (errno != ECONNREFUSED && errno != EHOSTUNREACH && errno != ENETUNREACH && errno != EINTR) break;
+  }
+  return -1;
+}
+
+static int key_to_ttl(const struct trace_state *st, int key, int *attempt) {
+  if (key < 0 || key >= TRACE_ATTEMPTS * st->max_ttl) return 0;
+  *attempt = key / st->max_ttl;
+  return key % st->max_ttl + 1;
+}
+
+static void record_hop(struct trace_state *st, int ttl, int attempt, const struct sockaddr *from,
+                       const struct timespec *rx, char flag, int terminal) {
+  trace_hop_t *h = &st->res->hop[ttl - 1];
+  if (st->answered[ttl - 1]) return;
+  st->answered[ttl - 1] = 1;
+  if (from->sa_family == AF_INET6) inet_ntop(AF_INET6, &((const struct sockaddr_in6 *)from)->sin6_addr, h->ip, sizeof(h->ip));
+  else if (from->sa_family == AF_INET) inet_ntop(AF_INET, &((const struct sockaddr_in *)from)->sin_addr, h->ip, sizeof(h->ip));
+  h->rtt_ms = ms_between(&st->sent[attempt][ttl - 1], rx);
+  if (h->rtt_ms < 0) h->rtt_ms = 0;
+  h->flag = flag;
+  if (terminal && (!st->end_ttl || ttl < st->end_ttl)) {
+    st->end_ttl = ttl;
+    if (!flag) st->res->reached = 1;
+  }
+}
+
+/* Map an ICMP(v6) error to: 0 = time exceeded (intermediate hop), 1 = the
+ * destination answered, a traceroute-style flag char for other unreachables,
+ * -1 = ignore.
+ */
+static int classify(const struct sock_extended_err *ee) {
+  if (ee->ee_origin == SO_EE_ORIGIN_ICMP) {
+    if (ee->ee_type == ICMP_TIME_EXCEEDED) return 0;
+    if (ee->ee_type != ICMP_DEST_UNREACH) return -1;
+    switch (ee->ee_code) {
+      case ICMP_PORT_UNREACH: return 1;
+      case ICMP_NET_UNREACH: return 'N';
+      case ICMP_HOST_UNREACH: return 'H';
+      case ICMP_PROT_UNREACH: return 'P';
+      default: return 'A';
+    }
+  }
+  if (ee->ee_origin == SO_EE_ORIGIN_ICMP6) {
+    if (ee->ee_type == ICMP6_TIME_EXCEEDED) return 0;
+    if (ee->ee_type != ICMP6_DST_UNREACH) return -1;
+    switch (ee->ee_code) {
+      case ICMP6_DST_UNREACH_NOPORT: return 1;
+      case ICMP6_DST_UNREACH_NOROUTE: return 'N';
+      case ICMP6_DST_UNREACH_ADDR: return 'H';
+      default: return 'A';
+    }
+  }
+  return -1;
+}
+
+static void read_errqueue(struct trace_state *st) {
+  for (;;) {
+    unsigned char data[512];
+    char cbuf[512];
+    struct sockaddr_storage orig;
+    struct iovec iov = { data, sizeof(data) };
+    struct msghdr mh; memset(&mh, 0, sizeof(mh));
+    mh.msg_name = &orig; mh.msg_namelen = sizeof(orig);
+    mh.msg_iov = &iov; mh.msg_iovlen = 1;
+    mh.msg_control = cbuf; mh.msg_controllen = sizeof(cbuf);
+    ssize_t n = recvmsg(st->s, &mh, MSG_ERRQUEUE | MSG_DONTWAIT);
+    if (n < 0) return;
+    struct sock_extended_err *ee = NULL;
+    struct timespec rx = { 0, 0 };
+    for (struct cmsghdr *cm = CMSG_FIRSTHDR(&mh); cm; cm = CMSG_NXTHDR(&mh, cm)) {
+      if ((cm->cmsg_level == IPPROTO_IP && cm->cmsg_type == IP_RECVERR) ||
+          (cm->cmsg_level == IPPROTO_IPV6 && cm->cmsg_type == IPV6_RECVERR))
+        ee = (struct sock_extended_err *)(void *)CMSG_DATA(cm);
+      else if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TIMESTAMPNS)
+        memcpy(&rx, CMSG_DATA(cm), sizeof(rx));
+    }
+    if (!ee) continue;
+    int c = classify(ee);
+    if (c < 0) continue;
+    int key;
+    if (st->proto == TRACE_ICMP) {
+      if (n < 8) continue;   /* payload is the echo request that expired */
+      key = (data[6] << 8) | data[7];
+    } else if (orig.ss_family == AF_INET6) key = ntohs(((struct sockaddr_in6 *)&orig)->sin6_port) - TRACE_BASE_PORT;
+    else key = ntohs(((struct sockaddr_in *)&orig)->sin_port) - TRACE_BASE_PORT;
+    int attempt, ttl = key_to_ttl(st, key, &attempt);
+    if (!ttl) continue;
+    if (!rx.tv_sec) clock_gettime(CLOCK_REALTIME, &rx);
+    record_hop(st, ttl, attempt, SO_EE_OFFENDER(ee), &rx, c > 1 ? (char)c : 0, c != 0);
+  }
+}
+
+/* ICMP mode: echo replies from the destination arrive on the normal queue. */
+static void read_replies(struct trace_state *st) {
+  for (;;) {
+    unsigned char data[512];
+    char cbuf[128];
+    struct sockaddr_storage from;
+    struct iovec iov = { data, sizeof(data) };
+    struct msghdr mh; memset(&mh, 0, sizeof(mh));
+    mh.msg_name = &from; mh.msg_namelen = sizeof(from);
+    mh.msg_iov = &iov; mh.msg_iovlen = 1;
+    mh.msg_control = cbuf; mh.msg_controllen = sizeof(cbuf);
+    ssize_t n = recvmsg(st->s, &mh, MSG_DONTWAIT);
+    if (n < 0) return;
+    struct timespec rx = { 0, 0 };
+    for (struct cmsghdr *cm = CMSG_FIRSTHDR(&mh); cm; cm = CMSG_NXTHDR(&mh, cm))
+      if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TIMESTAMPNS) memcpy(&rx, CMSG_DATA(cm), sizeof(rx));
+    if (!rx.tv_sec) clock_gettime(CLOCK_REALTIME, &rx);
+    int attempt, ttl;
+    if (st->proto == TRACE_ICMP) {
+      if (n < 8 || data[0] != (st->family == AF_INET6 ? ICMP6_ECHO_REPLY : ICMP_ECHOREPLY)) continue;
+      ttl = key_to_ttl(st, (data[6] << 8) | data[7], &attempt);
+    } else {
+      /* something listens on a probe port and answered: that is the destination */
+      int port = ntohs(from.ss_family == AF_INET6 ? ((struct sockaddr_in6 *)&from)->sin6_port : ((struct sockaddr_in *)&from)->sin_port);
+      ttl = key_to_ttl(st, port - TRACE_BASE_PORT, &attempt);
+    }
+    if (ttl) record_hop(st, ttl, attempt, (struct sockaddr *)&from, &rx, 0, 1);
+  }
+}
+
+static int complete(const struct trace_state *st) {
+  if (!st->end_ttl) return 0;
+  for (int i = 0; i < st->end_ttl - 1; i++) if (!st->answered[i]) return 0;
+  return 1;
+}
+
+int trace_run(const char *target, const trace_opts_t *opt, trace_result_t *res) {
+  if (!target || !target[0] || !res) return -1;
+  memset(res, 0, sizeof(*res));
+  struct trace_state st; memset(&st, 0, sizeof(st));
+  st.res = res;
+  st.max_ttl = opt && opt->max_ttl > 0 ? opt->max_ttl : 30;
+  if (st.max_ttl > TRACE_MAX_HOPS) st.max_ttl = TRACE_MAX_HOPS;
+  int timeout_ms = opt && opt->timeout_ms > 0 ? opt->timeout_ms : 3000;
+  st.proto = opt ? opt->proto : TRACE_UDP;
+
+  struct addrinfo hints, *ai = NULL;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = opt && opt->family ? opt->family : AF_UNSPEC;
+  hints.ai_socktype = SOCK_DGRAM;
+  if (getaddrinfo(target, NULL, &hints, &ai) != 0 || !ai) return -1;
+  memcpy(&st.dst, ai->ai_addr, ai->ai_addrlen);
+  st.dstlen = ai->ai_addrlen;
+  st.family = ai->ai_family;
+  freeaddrinfo(ai);
+  if (st.family != AF_INET && st.family != AF_INET6) return -1;
+  res->family = st.family;
+  inet_ntop(st.family, st.family == AF_INET6 ? (void *)&((struct sockaddr_in6 *)&st.dst)->sin6_addr
+                                             : (void *)&((struct sockaddr_in *)&st.dst)->sin_addr,
+            res->target_ip, sizeof(res->target_ip));
+
+  int protocol = st.proto == TRACE_ICMP ? (st.family == AF_INET6 ? IPPROTO_ICMPV6 : IPPROTO_ICMP) : 0;
+  st.s = socket(st.family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol);
+  if (st.s < 0) return -1;
+  int one = 1;
+  if (st.family == AF_INET6) setsockopt(st.s, IPPROTO_IPV6, IPV6_RECVERR, &one, sizeof(one));
+  else setsockopt(st.s, IPPROTO_IP, IP_RECVERR, &one, sizeof(one));
+  setsockopt(st.s, SOL_SOCKET, SO_TIMESTAMPNS, &one, sizeof(one));
+  for (int i = 0; i < TRACE_MAX_HOPS; i++) { res->hop[i].ttl = i + 1; res->hop[i].rtt_ms = -1; }
+
+  long t0 = mono_ms(), deadline = t0 + timeout_ms, resend_at = t0 + timeout_ms / 2;
+  int sent_any = 0;
+  for (int ttl = 1; ttl <= st.max_ttl; ttl++) if (send_probe(&st, ttl, 0) == 0) sent_any = 1;
+  if (!sent_any) { close(st.s); return -1; }
+  int resent = 0;
+  for (;;) {
+    read_errqueue(&st);
+    read_replies(&st);
+    if (complete(&st)) break;
+    long now = mono_ms();
+    if (now >= deadline) break;
+    if (!resent && now >= resend_at) {
+      /* silent hops only: ICMP rate limiting often drops one burst reply */
+      int last = st.end_ttl ? st.end_ttl : st.max_ttl;
+      for (int ttl = 1; ttl <= last; ttl++) if (!st.answered[ttl - 1]) send_probe(&st, ttl, 1);
+      resent = 1;
+    }
+    struct pollfd p = { .fd = st.s, .events = POLLIN };
+    long wait = (resent ? deadline : resend_at) - now;
+    if (poll(&p, 1, (int)(wait > 0 ? wait : 0)) < 0 && errno != EINTR) break;
+  }
+  close(st.s);
+  if (st.end_ttl) res->nhops = st.end_ttl;
+  else for (int i = st.max_ttl; i > 0; i--) if (st.answered[i - 1]) { res->nhops = i; break; }
+  res->elapsed_ms = mono_ms() - t0;
+  return 0;
+}
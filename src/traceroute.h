@@ -0,0 +1,44 @@
+#ifndef OLSRD_STATUS_TRACEROUTE_H
+#define OLSRD_STATUS_TRACEROUTE_H
+#include <stddef.h>
+
+/* In-process traceroute. Every TTL is probed at once from one unprivileged
+ * socket; ICMP errors come back on the socket error queue (IP_RECVERR) and are
+ * matched to their probe by destination port (UDP) or echo sequence (ICMP).
+ * The run ends when the destination and every hop before it have answered or
+ * the shared deadline expires, so a path costs about one deadline at most.
+ */
+#define TRACE_MAX_HOPS 32
+
+enum { TRACE_UDP = 0, TRACE_ICMP = 1 };
+
+typedef struct {
+  int max_ttl;       /* 1..TRACE_MAX_HOPS, default 30 */
+  int timeout_ms;    /* shared deadline for the whole run, default 3000 */
+  int proto;         /* TRACE_UDP or TRACE_ICMP (ping socket, needs ping_group_range) */
+  int family;        /* 0 = any, AF_INET or AF_INET6 */
+} trace_opts_t;
+
+typedef struct {
+  int ttl;
+  char ip[46];       /* "" when the hop did not answer */
+  double rtt_ms;     /* < 0 when the hop did not answer */
+  char flag;         /* 0, or 'H'/'N'/'P'/'A' for an unreachable reply (like traceroute's !H) */
+} trace_hop_t;
+
+typedef struct {
+  char target_ip[46];
+  int family;
+  int reached;       /* destination answered */
+  int nhops;         /* hops up to the destination or the last one that answered */
+  int probes_sent;
+  long elapsed_ms;
+  trace_hop_t hop[TRACE_MAX_HOPS];
+} trace_result_t;
+
+/* target is a literal address or a host name (resolved with getaddrinfo).
+ * Returns 0 when probes were sent (check res->reached), -1 on socket or
+ * resolution errors so the caller can fall back to the traceroute binary.
+ */
+int trace_run(const char *target, const trace_opts_t *opt, trace_result_t *res);
+#endif
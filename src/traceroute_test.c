@@ -0,0 +1,66 @@
+/* In-process traceroute checks. Without arguments it traces the loopback
+ * addresses (run by `make test`); with arguments it traces a target and
+ * compares the hops, which scripts/test_traceroute_netns.sh uses inside a
+ * veth topology:
+ *
+ *   traceroute_test [--icmp] <target> <hop1> <hop2> ...   ("*" = silent hop)
+ */
+#include "traceroute.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+static int g_fail;
+
+#define CHECK(cond, ...) do { if (!(cond)) { fprintf(stderr, __VA_ARGS__); fputc('\n', stderr); g_fail++; } } while (0)
+
+static void print_result(const trace_result_t *r) {
+  printf("%s: reached=%d hops=%d probes=%d %ldms\n", r->target_ip, r->reached, r->nhops, r->probes_sent, r->elapsed_ms);
+  for (int i = 0; i < r->nhops; i++)
+    printf("  %2d %-16s %8.3f %c\n", r->hop[i].ttl, r->hop[i].ip[0] ? r->hop[i].ip : "*", r->hop[i].rtt_ms, r->hop[i].flag ? r->hop[i].flag : ' ');
+}
+
+static void test_loopback(const char *target, int family) {
+  trace_opts_t o = { .max_ttl = 8, .timeout_ms = 1000, .proto = TRACE_UDP, .family = family };
+  trace_result_t r;
+  if (trace_run(target, &o, &r) != 0) {
+    /* no IPv6 in this environment is not a failure */
+    if (family == AF_INET6) { printf("%s: skipped (no probe socket)\n", target); return; }
+    CHECK(0, "%s: trace_run failed", target);
+    return;
+  }
+  print_result(&r);
+  CHECK(r.reached && r.nhops == 1, "%s: want reached in 1 hop, got reached=%d hops=%d", target, r.reached, r.nhops);
+  CHECK(strcmp(r.hop[0].ip, target) == 0 && r.hop[0].rtt_ms >= 0, "%s: hop 1 is %s", target, r.hop[0].ip);
+  CHECK(r.elapsed_ms < 900, "%s: did not stop early (%ld ms)", target, r.elapsed_ms);
+}
+
+int main(int argc, char **argv) {
+  if (argc == 1) {
+    test_loopback("127.0.0.1", AF_INET);
+    test_loopback("::1", AF_INET6);
+    trace_result_t r;
+    trace_opts_t o = { .max_ttl = 4, .timeout_ms = 200 };
+    CHECK(trace_run("no-such-host.invalid", &o, &r) == -1, "unresolvable target should fail");
+  } else {
+    int a = 1, proto = TRACE_UDP;
+    if (strcmp(argv[a], "--icmp") == 0) { proto = TRACE_ICMP; a++; }
+    if (a >= argc) { fprintf(stderr, "usage: %s [--icmp] target hop...\n", argv[0]); return 2; }
+    const char *target = argv[a++];
+    int want = argc - a;
+    trace_opts_t o = { .max_ttl = want + 2 > 4 ? want + 2 : 4, .timeout_ms = 2000, .proto = proto };
+    trace_result_t r;
+    if (trace_run(target, &o, &r) != 0) { fprintf(stderr, "%s: trace_run failed\n", target); return 1; }
+    print_result(&r);
+    CHECK(r.reached, "%s: not reached", target);
+    CHECK(r.nhops == want, "%s: want %d hops, got %d", target, want, r.nhops);
+    for (int i = 0; i < want && i < r.nhops; i++) {
+      const char *w = argv[a + i], *got = r.hop[i].ip[0] ? r.hop[i].ip : "*";
+      CHECK(strcmp(w, got) == 0, "hop %d: want %s got %s", i + 1, w, got);
+    }
+  }
+  if (g_fail) { fprintf(stderr, "traceroute_test: %d failure(s)\n", g_fail); return 1; }
+  printf("traceroute_test: ok\n");
+  return 0;
+}
@@ -0,0 +1,278 @@
+#include "traffic.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+
+/* counters as read from the kernel in one pass */
+typedef struct {
+  char name[16];
+  int ifindex;
+  uint64_t c[8];           /* rx/tx bytes, rx/tx packets, rx/tx errors, rx/tx dropped */
+} raw_t;
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_cv = PTHREAD_COND_INITIALIZER;
+static pthread_t g_thread;
+static int g_running = 0, g_stop = 0, g_interval = 1;
+static traffic_iface_t *g_if[TRAFFIC_MAX_IFACES];
+static int g_nif = 0;
+static traffic_stats_t g_stats;
+static int g_nl = -1;
+static unsigned g_seq = 0;
+
+static const int ring_cap[TRAFFIC_NRES] = { TRAFFIC_RING_SAMPLES, TRAFFIC_RING_MINUTES, TRAFFIC_RING_HOURS };
+
+static traffic_bucket_t *ring_buf(traffic_iface_t *it, int res) {
+  return res == TRAFFIC_RES_SAMPLE ? it->sample : res == TRAFFIC_RES_MINUTE ? it->minute : it->hour;
+}
+
+const traffic_bucket_t *traffic_bucket_at(const traffic_iface_t *it, int res, int i) {
+  const traffic_ring_t *r = &it->ring[res];
+  if (i < 0 || i >= r->count) return NULL;
+  return &ring_buf((traffic_iface_t *)it, res)[(r->head + ring_cap[res] - 1 - i) % ring_cap[res]];
+}
+
+static void ring_push(traffic_iface_t *it, int res, const traffic_bucket_t *b) {
+  traffic_ring_t *r = &it->ring[res];
+  ring_buf(it, res)[r->head] = *b;
+  r->head = (r->head + 1) % ring_cap[res];
+  if (r->count < ring_cap[res]) r->count++;
+}
+
+/* Add a sample to the minute/hour bucket it falls in, closing the previous one. */
+static void ring_roll(traffic_iface_t *it, int res, time_t period, const traffic_bucket_t *d) {
+  traffic_bucket_t *acc = &it->ring[res].acc;
+  time_t start = d->t - d->t % period;
+  if (acc->t != start) {
+    if (acc->secs) ring_push(it, res, acc);
+    memset(acc, 0, sizeof(*acc));
+    acc->t = start;
+  }
+  acc->secs += d->secs;
+  acc->rx_bytes += d->rx_bytes; acc->tx_bytes += d->tx_bytes;
+  acc->rx_packets += d->rx_packets; acc->tx_packets += d->tx_packets;
+}
+
+static int raw_push(raw_t **v, int *n, int *cap, const raw_t *r) {
+  if (*n == *cap) {
+    int nc = *cap ? *cap * 2 : 32;
+    raw_t *nv = realloc(*v, sizeof(*nv) * (size_t)nc);
+    if (!nv) return -1;
+    *v = nv; *cap = nc;
+  }
+  (*v)[(*n)++] = *r;
+  return 0;
+}
+
+static int read_netlink(raw_t **v, int *n, int *cap) {
+  if (g_nl < 0) {
+    g_nl = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (g_nl < 0) return -1;
+    struct timeval tv = { 1, 0 };
+    setsockopt(g_nl, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  }
+  struct { struct nlmsghdr h; struct ifinfomsg ifi; } req;
+  memset(&req, 0, sizeof(req));
+  req.h.nlmsg_len = NLMSG_LENGTH(sizeof(req.ifi));
+  req.h.nlmsg_type = RTM_GETLINK;
+  req.h.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  req.h.nlmsg_seq = ++g_seq;
+  req.ifi.ifi_family = AF_UNSPEC;
+  struct sockaddr_nl k = { .nl_family = AF_NETLINK };
+  if (sendto(g_nl, &req, req.h.nlmsg_len, 0, (struct sockaddr *)&k, sizeof(k)) < 0) goto fail;
+  char buf[32768];
+  for (;;) {
+    ssize_t len = recv(g_nl, buf, sizeof(buf), 0);
+    if (len < 0) { if (errno == EINTR) continue; goto fail; }
+    int left = (int)len;
+    for (const struct nlmsghdr *h = (const struct nlmsghdr *)buf; NLMSG_OK(h, left); h = NLMSG_NEXT(h, left)) {
+      if (h->nlmsg_seq != g_seq) continue;
+      if (h->nlmsg_type == NLMSG_DONE) return 0;
+      if (h->nlmsg_type == NLMSG_ERROR) goto fail;
+      if (h->nlmsg_type != RTM_NEWLINK || h->nlmsg_len < NLMSG_LENGTH(sizeof(struct ifinfomsg))) continue;
+      const struct ifinfomsg *ifi = NLMSG_DATA(h);
+      raw_t r;
+      memset(&r, 0, sizeof(r));
+      r.ifindex = ifi->ifi_index;
+      int have_stats = 0;
+      int alen = (int)(h->nlmsg_len - NLMSG_LENGTH(sizeof(*ifi)));
+      for (const struct rtattr *a = IFLA_RTA(ifi); RTA_OK(a, alen); a = RTA_NEXT(a, alen)) {
+        if (a->rta_type == IFLA_IFNAME) {
+          snprintf(r.name, sizeof(r.name), "%.*s", (int)RTA_PAYLOAD(a), (const char *)RTA_DATA(a));
+        } else if (a->rta_type == IFLA_STATS64 && RTA_PAYLOAD(a) >= sizeof(struct rtnl_link_stats64)) {
+          struct rtnl_link_stats64 st;
+          memcpy(&st, RTA_DATA(a), sizeof(st));   /* attribute payload is only 4-byte aligned */
+          r.c[0] = st.rx_bytes; r.c[1] = st.tx_bytes; r.c[2] = st.rx_packets; r.c[3] = st.tx_packets;
+          r.c[4] = st.rx_errors; r.c[5] = st.tx_errors; r.c[6] = st.rx_dropped; r.c[7] = st.tx_dropped;
+          have_stats = 1;
+        }
+      }
+      if (have_stats && r.name[0] && raw_push(v, n, cap, &r) != 0) goto fail;
+    }
+  }
+fail:
+  /* a half-read dump would desynchronise the next one */
+  close(g_nl); g_nl = -1;
+  return -1;
+}
+
+static int read_proc(raw_t **v, int *n, int *cap) {
+  FILE *f = fopen("/proc/net/dev", "r");
+  if (!f) return -1;
+  char line[512];
+  while (fgets(line, sizeof(line), f)) {
+    char *colon = strchr(line, ':');
+    if (!colon) continue;   /* the two header lines */
+    *colon = 0;
+    char *name = line;
+    while (*name == ' ') name++;
+    raw_t r;
+    memset(&r, 0, sizeof(r));
+    snprintf(r.name, sizeof(r.name), "%.15s", name);
+    unsigned long long x[16];
+    if (sscanf(colon + 1, "%llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
+               &x[0], &x[1], &x[2], &x[3], &x[4], &x[5], &x[6], &x[7], &x[8], &x[9], &x[10], &x[11]) != 12) continue;
+    r.c[0] = x[0]; r.c[2] = x[1]; r.c[4] = x[2]; r.c[6] = x[3];
+    r.c[1] = x[8]; r.c[3] = x[9]; r.c[5] = x[10]; r.c[7] = x[11];
+    r.ifindex = (int)if_nametoindex(r.name);
+    if (raw_push(v, n, cap, &r) != 0) { fclose(f); return -1; }
+  }
+  fclose(f);
+  return 0;
+}
+
+static uint64_t delta(uint64_t now, uint64_t before) {
+  return now >= before ? now - before : 0;   /* counter reset: start over */
+}
+
+/* Fold one pass of counters into the slots; called with g_lock held. */
+static void apply_sample(const raw_t *v, int n, time_t now, uint32_t dt) {
+  unsigned char seen[TRAFFIC_MAX_IFACES] = {0};
+  for (int i = 0; i < n; i++) {
+    int s = -1;
+    for (int j = 0; j < g_nif; j++)
+      if (g_if[j]->ifindex == v[i].ifindex && strcmp(g_if[j]->name, v[i].name) == 0) { s = j; break; }
+    if (s < 0) {
+      if (g_nif == TRAFFIC_MAX_IFACES) continue;
+      traffic_iface_t *it = calloc(1, sizeof(*it));
+      if (!it) continue;
+      snprintf(it->name, sizeof(it->name), "%s", v[i].name);
+      it->ifindex = v[i].ifindex;
+      s = g_nif++;
+      g_if[s] = it;
+    } else {
+      traffic_iface_t *it = g_if[s];
+      traffic_bucket_t d = { .t = now, .secs = dt,
+                             .rx_bytes = delta(v[i].c[0], it->rx_bytes), .tx_bytes = delta(v[i].c[1], it->tx_bytes),
+                             .rx_packets = delta(v[i].c[2], it->rx_packets), .tx_packets = delta(v[i].c[3], it->tx_packets) };
+      ring_push(it, TRAFFIC_RES_SAMPLE, &d);
+      ring_roll(it, TRAFFIC_RES_MINUTE, 60, &d);
+      ring_roll(it, TRAFFIC_RES_HOUR, 3600, &d);
+    }
+    traffic_iface_t *it = g_if[s];
+    it->rx_bytes = v[i].c[0]; it->tx_bytes = v[i].c[1]; it->rx_packets = v[i].c[2]; it->tx_packets = v[i].c[3];
+    it->rx_errors = v[i].c[4]; it->tx_errors = v[i].c[5]; it->rx_dropped = v[i].c[6]; it->tx_dropped = v[i].c[7];
+    seen[s] = 1;
+  }
+  /* interfaces that went away take their history with them */
+  for (int j = g_nif - 1; j >= 0; j--) {
+    if (seen[j]) continue;
+    free(g_if[j]);
+    g_if[j] = g_if[--g_nif];
+    seen[j] = seen[g_nif];
+  }
+}
+
+static void *traffic_thread(void *arg) {
+  (void)arg;
+  raw_t *v = NULL; int cap = 0;
+  struct timespec prev = {0, 0};
+  pthread_mutex_lock(&g_lock);
+  while (!g_stop) {
+    pthread_mutex_unlock(&g_lock);
+    int n = 0;
+    const char *src = "netlink";
+    int rc = read_netlink(&v, &n, &cap);
+    if (rc != 0) { n = 0; src = "proc"; rc = read_proc(&v, &n, &cap); }
+    struct timespec mono; clock_gettime(CLOCK_MONOTONIC, &mono);
+    long ms = prev.tv_sec ? (mono.tv_sec - prev.tv_sec) * 1000 + (mono.tv_nsec - prev.tv_nsec) / 1000000 : 0;
+    uint32_t dt = ms > 0 ? (uint32_t)((ms + 500) / 1000) : 0;
+    time_t now = time(NULL);
+    pthread_mutex_lock(&g_lock);
+    g_stats.samples++;
+    if (rc != 0) {
+      g_stats.errors++;
+    } else {
+      apply_sample(v, n, now, dt ? dt : 1);
+      prev = mono;
+      g_stats.updated = now;
+      g_stats.source = src;
+    }
+    struct timespec until; clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += g_interval;
+    while (!g_stop && pthread_cond_timedwait(&g_cv, &g_lock, &until) != ETIMEDOUT) { }
+  }
+  pthread_mutex_unlock(&g_lock);
+  free(v);
+  if (g_nl >= 0) { close(g_nl); g_nl = -1; }
+  return NULL;
+}
+
+int traffic_start(int interval_s) {
+  if (g_running || interval_s <= 0) return -1;
+  pthread_mutex_lock(&g_lock);
+  g_interval = interval_s; g_stop = 0;
+  memset(&g_stats, 0, sizeof(g_stats));
+  g_stats.source = "";
+  pthread_mutex_unlock(&g_lock);
+  if (pthread_create(&g_thread, NULL, traffic_thread, NULL) != 0) return -1;
+  g_running = 1;
+  return 0;
+}
+
+void traffic_stop(void) {
+  if (!g_running) return;
+  pthread_mutex_lock(&g_lock);
+  g_stop = 1;
+  pthread_cond_broadcast(&g_cv);
+  pthread_mutex_unlock(&g_lock);
+  pthread_join(g_thread, NULL);
+  pthread_mutex_lock(&g_lock);
+  for (int i = 0; i < g_nif; i++) free(g_if[i]);
+  g_nif = 0;
+  g_running = 0;
+  pthread_mutex_unlock(&g_lock);
+}
+
+int traffic_snapshot(traffic_iface_t **out) {
+  *out = NULL;
+  pthread_mutex_lock(&g_lock);
+  if (!g_running) { pthread_mutex_unlock(&g_lock); return -1; }
+  traffic_iface_t *v = malloc(sizeof(*v) * (size_t)(g_nif ? g_nif : 1));
+  if (!v) { pthread_mutex_unlock(&g_lock); return -1; }
+  for (int i = 0; i < g_nif; i++) v[i] = *g_if[i];
+  int n = g_nif;
+  pthread_mutex_unlock(&g_lock);
+  *out = v;
+  return n;
+}
+
+void traffic_get_stats(traffic_stats_t *st) {
+  if (!st) return;
+  pthread_mutex_lock(&g_lock);
+  *st = g_stats;
+  st->interval = g_running ? g_interval : 0;
+  st->ifaces = g_nif;
+  st->memory_bytes = (size_t)g_nif * sizeof(traffic_iface_t);
+  if (!st->source) st->source = "";
+  pthread_mutex_unlock(&g_lock);
+}
@@ -0,0 +1,59 @@
+#ifndef OLSRD_STATUS_TRAFFIC_H
+#define OLSRD_STATUS_TRAFFIC_H
+#include <stdint.h>
+#include <time.h>
+
+/* Interface traffic sampler. A thread reads the per-interface counters every
+ * interval seconds (netlink RTM_GETLINK / IFLA_STATS64, else /proc/net/dev)
+ * and keeps the deltas in fixed rings at three resolutions: every sample,
+ * per minute and per hour. Memory is bounded by TRAFFIC_MAX_IFACES slots of
+ * fixed size, allocated as interfaces appear.
+ */
+#define TRAFFIC_MAX_IFACES 64
+#define TRAFFIC_RING_SAMPLES 60
+#define TRAFFIC_RING_MINUTES 60
+#define TRAFFIC_RING_HOURS 48
+
+enum { TRAFFIC_RES_SAMPLE = 0, TRAFFIC_RES_MINUTE = 1, TRAFFIC_RES_HOUR = 2, TRAFFIC_NRES = 3 };
+
+typedef struct {
+  time_t t;                /* start of the bucket (aligned for minutes/hours) */
+  uint32_t secs;           /* seconds of sampling it covers */
+  uint64_t rx_bytes, tx_bytes, rx_packets, tx_packets;
+} traffic_bucket_t;
+
+typedef struct {
+  int head, count;         /* head = next write */
+  traffic_bucket_t acc;    /* bucket being filled (minutes/hours) */
+} traffic_ring_t;
+
+typedef struct {
+  char name[16];
+  int ifindex;
+  /* absolute counters from the last sample */
+  uint64_t rx_bytes, tx_bytes, rx_packets, tx_packets;
+  uint64_t rx_errors, tx_errors, rx_dropped, tx_dropped;
+  traffic_ring_t ring[TRAFFIC_NRES];
+  traffic_bucket_t sample[TRAFFIC_RING_SAMPLES];
+  traffic_bucket_t minute[TRAFFIC_RING_MINUTES];
+  traffic_bucket_t hour[TRAFFIC_RING_HOURS];
+} traffic_iface_t;
+
+typedef struct {
+  unsigned long samples, errors;
+  time_t updated;          /* last successful sample */
+  int interval, ifaces;
+  size_t memory_bytes;     /* rings and slots currently allocated */
+  const char *source;      /* "netlink", "proc" or "" */
+} traffic_stats_t;
+
+int traffic_start(int interval_s);
+void traffic_stop(void);
+/* Copy the interfaces, rings included, into a malloc'ed array the caller
+ * frees. Returns the count, -1 when the sampler is not running.
+ */
+int traffic_snapshot(traffic_iface_t **out);
+/* i-th completed bucket of a resolution, newest first (0 <= i < ring count). */
+const traffic_bucket_t *traffic_bucket_at(const traffic_iface_t *it, int res, int i);
+void traffic_get_stats(traffic_stats_t *st);
+#endif
@@ -1,4 +1,5 @@
 #include "util.h"
+#include "exec.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -9,55 +10,21 @@
 #include <sys/select.h>
 #include <unistd.h>
 #include <sys/socket.h>
+#include <ctype.h>
+#include <strings.h>
+#include <stdint.h>
 
 
+/* Shell pipelines only; plain commands should call exec_argv() directly. Runs
+ * through the same spawn engine, so it gets the deadline and the statistics.
+ */
 int util_exec(const char *cmd, char **out, size_t *outlen) {
-  /* Cap total output to avoid unbounded memory consumption from spawns */
-  const size_t MAX_EXEC_OUTPUT = 1024 * 1024; /* 1 MiB */
   *out = NULL; *outlen = 0;
   if (!cmd) return -1;
-  FILE *fp = popen(cmd, "r");
-  if (!fp) return -1;
-  size_t cap = 8192;
-  if (cap > MAX_EXEC_OUTPUT) cap = MAX_EXEC_OUTPUT;
-  char *buf = (char*)malloc(cap);
-  if (!buf) { pclose(fp); return -1; }
-  size_t len = 0;
-  size_t n;
-  while (!feof(fp)) {
-    size_t want = 4096;
-    if (MAX_EXEC_OUTPUT - len == 0) {
-      /* reached maximum allowed output; stop reading further */
-      break;
-    }
-    if (want > MAX_EXEC_OUTPUT - len) want = MAX_EXEC_OUTPUT - len;
-    if (cap - len < want) {
-      size_t newcap = cap * 2;
-      if (newcap > MAX_EXEC_OUTPUT) newcap = MAX_EXEC_OUTPUT;
-      if (newcap <= cap) {
-        /* cannot grow further */
-        break;
-      }
-      char *nb = (char*)realloc(buf, newcap);
-      if (!nb) { free(buf); pclose(fp); return -1; }
-      buf = nb; cap = newcap;
-    }
-    n = fread(buf + len, 1, want, fp);
-    if (n == 0) break;
-    len += n;
-  }
-  pclose(fp);
-  /* null-terminate the returned buffer for safety */
-  if (len >= MAX_EXEC_OUTPUT) {
-    /* ensure last byte reserved for NUL */
-    len = MAX_EXEC_OUTPUT - 1;
-  }
-  char *nb = (char*)realloc(buf, len + 1);
-  if (nb) buf = nb;
-  buf[len] = '\0';
-  *out = buf;
-  *outlen = len;
-  return 0;
+  const char *argv[] = { "/bin/sh", "-c", cmd, NULL };
+  if (exec_argv(argv, 0, UTIL_EXEC_TIMEOUT_MS, out, outlen, NULL) == 0) return 0;
+  free(*out); *out = NULL; *outlen = 0;
+  return -1;
 }
 
 int util_read_file(const char *path, char **out, size_t *outlen) {
@@ -84,6 +51,83 @@ int util_read_file(const char *path, char **out, size_t *outlen) {
   return 0;
 }
 
+/* Streaming MD5 (RFC 1321) so file digests need no md5sum spawn. */
+typedef struct { uint32_t a, b, c, d; uint64_t len; unsigned char buf[64]; } util_md5_ctx;
+
+#define MD5_ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+static void md5_block(util_md5_ctx *c, const unsigned char *p) {
+  static const uint32_t K[64] = {
+    0xd76aa478,0xe8c7b756,0x242070db,0xc1bdceee,0xf57c0faf,0x4787c62a,0xa8304613,0xfd469501,
+    0x698098d8,0x8b44f7af,0xffff5bb1,0x895cd7be,0x6b901122,0xfd987193,0xa679438e,0x49b40821,
+    0xf61e2562,0xc040b340,0x265e5a51,0xe9b6c7aa,0xd62f105d,0x02441453,0xd8a1e681,0xe7d3fbc8,
+    0x21e1cde6,0xc33707d6,0xf4d50d87,0x455a14ed,0xa9e3e905,0xfcefa3f8,0x676f02d9,0x8d2a4c8a,
+    0xfffa3942,0x8771f681,0x6d9d6122,0xfde5380c,0xa4beea44,0x4bdecfa9,0xf6bb4b60,0xbebfbc70,
+    0x289b7ec6,0xeaa127fa,0xd4ef3085,0x04881d05,0xd9d4d039,0xe6db99e5,0x1fa27cf8,0xc4ac5665,
+    0xf4292244,0x432aff97,0xab9423a7,0xfc93a039,0x655b59c3,0x8f0ccc92,0xffeff47d,0x85845dd1,
+    0x6fa87e4f,0xfe2ce6e0,0xa3014314,0x4e0811a1,0xf7537e82,0xbd3af235,0x2ad7d2bb,0xeb86d391 };
+  static const unsigned char R[64] = {
+    7,12,17,22,7,12,17,22,7,12,17,22,7,12,17,22, 5,9,14,20,5,9,14,20,5,9,14,20,5,9,14,20,
+    4,11,16,23,4,11,16,23,4,11,16,23,4,11,16,23, 6,10,15,21,6,10,15,21,6,10,15,21,6,10,15,21 };
+  uint32_t M[16];
+  for (int i = 0; i < 16; i++) M[i] = (uint32_t)p[i*4] | ((uint32_t)p[i*4+1] << 8) | ((uint32_t)p[i*4+2] << 16) | ((uint32_t)p[i*4+3] << 24);
+  uint32_t a = c->a, b = c->b, cc = c->c, d = c->d;
+  for (int i = 0; i < 64; i++) {
+    uint32_t f; int g;
+    if (i < 16)      { f = (b & cc) | (~b & d); g = i; }
+    else if (i < 32) { f = (d & b) | (~d & cc); g = (5 * i + 1) & 15; }
+    else if (i < 48) { f = b ^ cc ^ d;          g = (3 * i + 5) & 15; }
+    else             { f = cc ^ (b | ~d);       g = (7 * i) & 15; }
+    uint32_t t = d; d = cc; cc = b;
+    b = b + MD5_ROTL(a + f + K[i] + M[g], R[i]);
+    a = t;
+  }
+  c->a += a; c->b += b; c->c += cc; c->d += d;
+}
+
+static void md5_init(util_md5_ctx *c) { c->a = 0x67452301; c->b = 0xefcdab89; c->c = 0x98badcfe; c->d = 0x10325476; c->len = 0; }
+
+static void md5_update(util_md5_ctx *c, const unsigned char *p, size_t n) {
+  size_t have = (size_t)(c->len & 63);
+  c->len += n;
+  if (have) {
+    size_t take = 64 - have < n ? 64 - have : n;
+    memcpy(c->buf + have, p, take); p += take; n -= take;
+    if (have + take < 64) return;
+    md5_block(c, c->buf);
+  }
+  for (; n >= 64; p += 64, n -= 64) md5_block(c, p);
+  if (n) memcpy(c->buf, p, n);
+}
+
+static void md5_final(util_md5_ctx *c, unsigned char out[16]) {
+  uint64_t bits = c->len * 8;
+  unsigned char pad[72] = { 0x80 };
+  size_t have = (size_t)(c->len & 63);
+  size_t padlen = (have < 56 ? 56 - have : 120 - have);
+  md5_update(c, pad, padlen);
+  unsigned char lb[8];
+  for (int i = 0; i < 8; i++) lb[i] = (unsigned char)(bits >> (8 * i));
+  md5_update(c, lb, 8);
+  uint32_t v[4] = { c->a, c->b, c->c, c->d };
+  for (int i = 0; i < 16; i++) out[i] = (unsigned char)(v[i / 4] >> (8 * (i % 4)));
+}
+
+int util_md5_file(const char *path, char *hex, size_t hexlen) {
+  if (!path || !hex || hexlen < 33) return -1;
+  FILE *f = fopen(path, "rb");
+  if (!f) return -1;
+  util_md5_ctx c; md5_init(&c);
+  unsigned char buf[16384]; size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) md5_update(&c, buf, n);
+  int err = ferror(f);
+  fclose(f);
+  if (err) return -1;
+  unsigned char d[16]; md5_final(&c, d);
+  for (int i = 0; i < 16; i++) snprintf(hex + i * 2, 3, "%02x", d[i]);
+  return 0;
+}
+
 int util_file_exists(const char *path) {
   struct stat st;
   return stat(path, &st) == 0;
@@ -158,31 +202,31 @@ int util_http_get_url_local(const char *url, char **out, size_t *outlen, int tim
   char *outb = malloc(len + 1); if (!outb) { free(buf); return -1; } memcpy(outb, buf, len); outb[len] = '\0'; *out = outb; *outlen = len; free(buf); return 0;
 }
 
-/* Generic HTTP GET helper for non-TLS URLs. This reuses the local loopback
- * implementation but accepts arbitrary hostnames/IPs (no TLS). It is a
- * lightweight replacement for spawning curl for plain http:// URLs.
- */
-int util_http_get_url(const char *url, char **out, size_t *outlen, int timeout_sec) {
-  if (!url || !out || !outlen) return -1;
-  *out = NULL; *outlen = 0;
+/* Split http://host[:port]/path into its parts. Returns 0 on success. */
+static int util_http_split_url(const char *url, char *host, size_t hostsz, char *path, size_t pathsz, int *port) {
   const char *p = url;
   if (strncmp(p, "http://", 7) == 0) p += 7; else return -1;
-  /* Extract host[:port] and path */
-  char host[256]; char path[512]; int port = 80;
   const char *slash = strchr(p, '/');
   size_t hostlen = slash ? (size_t)(slash - p) : strlen(p);
-  if (hostlen == 0 || hostlen >= sizeof(host)) return -1;
+  if (hostlen == 0 || hostlen >= hostsz) return -1;
   memcpy(host, p, hostlen);
   host[hostlen] = '\0';
   if (slash) {
     size_t pathlen = strlen(slash);
-    size_t copy = pathlen < (sizeof(path)-1) ? pathlen : (sizeof(path)-1);
+    size_t copy = pathlen < (pathsz-1) ? pathlen : (pathsz-1);
     memcpy(path, slash, copy);
     path[copy] = '\0';
-  } else strcpy(path, "/");
+  } else snprintf(path, pathsz, "/");
   /* parse optional :port */
-  char *colon = strchr(host, ':'); if (colon) { *colon = '\0'; port = atoi(colon+1); if (port<=0) port=80; }
+  *port = 80;
+  char *colon = strchr(host, ':'); if (colon) { *colon = '\0'; *port = atoi(colon+1); if (*port<=0) *port=80; }
+  return 0;
+}
 
+/* Resolve host and connect with a bounded non-blocking connect. Returns a
+ * blocking socket with SO_RCVTIMEO set, or -1.
+ */
+static int util_http_connect(const char *host, int port, int timeout_sec) {
   struct addrinfo hints; struct addrinfo *res = NULL; char sport[16]; int rv;
   memset(&hints,0,sizeof(hints)); hints.ai_family = AF_UNSPEC; hints.ai_socktype = SOCK_STREAM;
   snprintf(sport, sizeof(sport), "%d", port);
@@ -208,31 +252,120 @@ int util_http_get_url(const char *url, char **out, size_t *outlen, int timeout_s
     break;
   }
   freeaddrinfo(res);
-  if (sock < 0) return -1;
-
-  char req[1024]; int rn = snprintf(req, sizeof(req), "GET %s HTTP/1.0\r\nHost: %s\r\nConnection: close\r\nUser-Agent: status-plugin\r\nAccept: application/json\r\n\r\n", path, host);
-  if (rn < 0 || rn >= (int)sizeof(req)) { close(sock); return -1; }
-  if (send(sock, req, (size_t)rn, 0) != rn) { close(sock); return -1; }
+  return sock;
+}
 
-  const size_t MAX_BODY = 1024 * 1024; /* 1 MiB */
-  size_t cap = 8192; char *buf = malloc(cap); if(!buf){ close(sock); return -1; }
+/* Read the whole response (up to max bytes). Returns malloc'd buffer or NULL. */
+static char *util_http_read_all(int sock, size_t max, size_t *lenp) {
+  size_t cap = 8192; char *buf = malloc(cap); if(!buf) return NULL;
   size_t len = 0; ssize_t n;
   while ((n = recv(sock, buf + len, (ssize_t)(cap - len), 0)) > 0) {
     len += (size_t)n;
-    if (len >= MAX_BODY) break;
+    if (len >= max) break;
     if (cap - len < 4096) {
-      size_t newcap = cap * 2; if (newcap > MAX_BODY) newcap = MAX_BODY;
-      char *nb = realloc(buf, newcap); if (!nb) { free(buf); close(sock); return -1; } buf = nb; cap = newcap;
+      size_t newcap = cap * 2; if (newcap > max) newcap = max;
+      char *nb = realloc(buf, newcap); if (!nb) { free(buf); return NULL; } buf = nb; cap = newcap;
     }
   }
+  if (len == 0) { free(buf); return NULL; }
+  *lenp = len;
+  return buf;
+}
+
+/* Generic HTTP GET helper for non-TLS URLs. This reuses the local loopback
+ * implementation but accepts arbitrary hostnames/IPs (no TLS). It is a
+ * lightweight replacement for spawning curl for plain http:// URLs.
+ */
+int util_http_get_url(const char *url, char **out, size_t *outlen, int timeout_sec) {
+  if (!url || !out || !outlen) return -1;
+  *out = NULL; *outlen = 0;
+  char host[256]; char path[512]; int port = 80;
+  if (util_http_split_url(url, host, sizeof(host), path, sizeof(path), &port) != 0) return -1;
+  int sock = util_http_connect(host, port, timeout_sec);
+  if (sock < 0) return -1;
+
+  char req[1024]; int rn = snprintf(req, sizeof(req), "GET %s HTTP/1.0\r\nHost: %s\r\nConnection: close\r\nUser-Agent: status-plugin\r\nAccept: application/json\r\n\r\n", path, host);
+  if (rn < 0 || rn >= (int)sizeof(req)) { close(sock); return -1; }
+  if (send(sock, req, (size_t)rn, 0) != rn) { close(sock); return -1; }
+
+  const size_t MAX_BODY = 1024 * 1024; /* 1 MiB */
+  size_t len = 0; char *buf = util_http_read_all(sock, MAX_BODY, &len);
   close(sock);
-  if (len == 0) { free(buf); return -1; }
+  if (!buf) return -1;
   /* strip headers */
   char *body = NULL; for (size_t i = 0; i + 3 < len; ++i) { if (buf[i] == '\r' && buf[i+1] == '\n' && buf[i+2] == '\r' && buf[i+3] == '\n') { body = buf + i + 4; size_t body_len = len - (i + 4);
         char *outb = malloc(body_len + 1); if (!outb) { free(buf); return -1; } memcpy(outb, body, body_len); outb[body_len] = '\0'; *out = outb; *outlen = body_len; free(buf); return 0; } }
   char *outb = malloc(len + 1); if (!outb) { free(buf); return -1; } memcpy(outb, buf, len); outb[len] = '\0'; *out = outb; *outlen = len; free(buf); return 0;
 }
 
+int util_http_status_code(const char *hdrs, size_t hlen) {
+  if (!hdrs || hlen < 12 || strncmp(hdrs, "HTTP/", 5) != 0) return 0;
+  const char *sp = memchr(hdrs, ' ', hlen);
+  if (!sp || (size_t)(sp - hdrs) + 4 > hlen) return 0;
+  if (!isdigit((unsigned char)sp[1]) || !isdigit((unsigned char)sp[2]) || !isdigit((unsigned char)sp[3])) return 0;
+  return (sp[1]-'0')*100 + (sp[2]-'0')*10 + (sp[3]-'0');
+}
+
+int util_http_header_value(const char *hdrs, size_t hlen, const char *name, char *out, size_t outlen) {
+  if (!hdrs || !name || !out || outlen == 0) return 0;
+  out[0] = '\0';
+  size_t nlen = strlen(name);
+  const char *p = hdrs, *end = hdrs + hlen;
+  while (p < end) {
+    const char *nl = memchr(p, '\n', (size_t)(end - p));
+    size_t linelen = nl ? (size_t)(nl - p) : (size_t)(end - p);
+    if (linelen > nlen && p[nlen] == ':' && strncasecmp(p, name, nlen) == 0) {
+      const char *v = p + nlen + 1; size_t vlen = linelen - nlen - 1;
+      while (vlen && (*v == ' ' || *v == '\t')) { v++; vlen--; }
+      while (vlen && (v[vlen-1] == '\r' || v[vlen-1] == ' ' || v[vlen-1] == '\t')) vlen--;
+      if (vlen >= outlen) return 0; /* refuse to truncate validators */
+      memcpy(out, v, vlen); out[vlen] = '\0';
+      return 1;
+    }
+    if (!nl) break;
+    p = nl + 1;
+  }
+  return 0;
+}
+
+/* Conditional variant of util_http_get_url: sends the caller's validators and
+ * reports status plus the new validators. A 304 returns 0 with *out == NULL.
+ */
+int util_http_get_url_cond(const char *url, util_http_cond_t *cond, char **out, size_t *outlen, int timeout_sec) {
+  if (!url || !cond || !out || !outlen) return -1;
+  *out = NULL; *outlen = 0;
+  cond->status = 0; cond->etag[0] = '\0'; cond->last_modified[0] = '\0'; cond->wire_bytes = 0;
+  char host[256]; char path[512]; int port = 80;
+  if (util_http_split_url(url, host, sizeof(host), path, sizeof(path), &port) != 0) return -1;
+  int sock = util_http_connect(host, port, timeout_sec);
+  if (sock < 0) return -1;
+
+  char req[1536]; int rn = snprintf(req, sizeof(req), "GET %s HTTP/1.0\r\nHost: %s\r\nConnection: close\r\nUser-Agent: status-plugin\r\nAccept: application/json\r\n%s%s%s%s%s%s\r\n",
+    path, host,
+    (cond->if_none_match && cond->if_none_match[0]) ? "If-None-Match: " : "", (cond->if_none_match && cond->if_none_match[0]) ? cond->if_none_match : "", (cond->if_none_match && cond->if_none_match[0]) ? "\r\n" : "",
+    (cond->if_modified_since && cond->if_modified_since[0]) ? "If-Modified-Since: " : "", (cond->if_modified_since && cond->if_modified_since[0]) ? cond->if_modified_since : "", (cond->if_modified_since && cond->if_modified_since[0]) ? "\r\n" : "");
+  if (rn < 0 || rn >= (int)sizeof(req)) { close(sock); return -1; }
+  if (send(sock, req, (size_t)rn, 0) != rn) { close(sock); return -1; }
+
+  const size_t MAX_BODY = 1024 * 1024; /* 1 MiB */
+  size_t len = 0; char *buf = util_http_read_all(sock, MAX_BODY, &len);
+  close(sock);
+  if (!buf) return -1;
+  cond->wire_bytes = len;
+  const char *hend = memmem(buf, len, "\r\n\r\n", 4);
+  size_t hlen = hend ? (size_t)(hend - buf) : len;
+  cond->status = util_http_status_code(buf, hlen);
+  util_http_header_value(buf, hlen, "ETag", cond->etag, sizeof(cond->etag));
+  util_http_header_value(buf, hlen, "Last-Modified", cond->last_modified, sizeof(cond->last_modified));
+  if (cond->status == 304) { free(buf); return 0; }
+  if (cond->status != 200 || !hend) { free(buf); return -1; }
+  size_t body_len = len - (hlen + 4);
+  char *outb = malloc(body_len + 1); if (!outb) { free(buf); return -1; }
+  memcpy(outb, hend + 4, body_len); outb[body_len] = '\0';
+  *out = outb; *outlen = body_len; free(buf);
+  return 0;
+}
+
 int util_is_container(void) {
   if (util_file_exists("/.dockerenv")) return 1;
   char *c=NULL; size_t n=0;
@@ -1,6 +1,10 @@
 #ifndef OLSRD_STATUS_UTIL_H
 #define OLSRD_STATUS_UTIL_H
 #include <stddef.h>
+/* Run a shell command line with a UTIL_EXEC_TIMEOUT_MS deadline. Returns 0 and
+ * the captured stdout when the command finished, -1 on spawn error or timeout.
+ */
+#define UTIL_EXEC_TIMEOUT_MS 15000
 int util_exec(const char *cmd, char **out, size_t *outlen);
 int util_read_file(const char *path, char **out, size_t *outlen);
 /* Perform a simple HTTP GET for local loopback URLs (http://127.0.0.1:PORT/path).
@@ -13,6 +17,26 @@ int util_is_container(void);
  * For HTTPS URLs callers should fall back to an external fetch (curl) or implement TLS.
  */
 int util_http_get_url(const char *url, char **out, size_t *outlen, int timeout_sec);
+/* Conditional GET state: callers pass validators from a previous response,
+ * the call fills in the status, the new validators and the raw bytes read.
+ */
+typedef struct {
+  const char *if_none_match;     /* previous ETag or NULL */
+  const char *if_modified_since; /* previous Last-Modified or NULL */
+  int    status;                 /* HTTP status (0 if unparsable) */
+  char   etag[128];
+  char   last_modified[64];
+  size_t wire_bytes;             /* headers + body as received */
+} util_http_cond_t;
+/* Like util_http_get_url but honours validators. Returns 0 on 200 (body in *out)
+ * and on 304 (*out stays NULL); any other status is an error.
+ */
+int util_http_get_url_cond(const char *url, util_http_cond_t *cond, char **out, size_t *outlen, int timeout_sec);
+/* Helpers for raw HTTP response header blocks (status line first). */
+int util_http_status_code(const char *hdrs, size_t hlen);
+int util_http_header_value(const char *hdrs, size_t hlen, const char *name, char *out, size_t outlen);
+/* MD5 of a file as 32 lowercase hex chars (hexlen >= 33). Returns 0 on success. */
+int util_md5_file(const char *path, char *hex, size_t hexlen);
 int util_file_exists(const char *path);
 int path_exists(const char *p);
 int env_is_edgerouter(void);
@@ -0,0 +1,475 @@
+/* Microbenchmarks for the parsing and normalization hot paths.
+ *
+ * The plugin's helpers are file-static, so this translation unit includes
+ * olsrd_status_plugin.c and ubnt_discover.c directly and links the remaining
+ * modules. External inputs are replaced at the seams: `ip -4 r` and
+ * `ip route show default` return the case's route table, and reverse DNS
+ * only answers from the (per-case, freshly created) hostname cache.
+ *
+ * Every case runs once to check its output against tools/bench/golden/,
+ * then in a timed loop.  Usage (from the repository root):
+ *
+ *   make bench                  run all cases
+ *   make bench-golden           rewrite the golden files after an intended change
+ *   build/bench [substring]     only cases whose name contains substring
+ *
+ * BENCH_MIN_MS (default 300) is the minimum timed duration per case.
+ */
+#define exec_argv bench_exec_argv
+#define dns_async_running bench_dns_async_running
+#define dns_async_submit bench_dns_async_submit
+#include "../../src/olsrd_status_plugin.c"
+#undef _POSIX_C_SOURCE
+#include "../../rev/discover/ubnt_discover.c"
+
+/* --- allocation accounting --------------------------------------------- */
+
+static unsigned long g_allocs;
+static unsigned long long g_alloc_bytes;
+
+#ifdef __GLIBC__
+/* glibc routes its own allocations (strdup, vasprintf, ...) through these too */
+extern void *__libc_malloc(size_t n);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t n);
+void *malloc(size_t n) { g_allocs++; g_alloc_bytes += n; return __libc_malloc(n); }
+void *calloc(size_t n, size_t size) { g_allocs++; g_alloc_bytes += n * size; return __libc_calloc(n, size); }
+void *realloc(void *p, size_t n) { g_allocs++; g_alloc_bytes += n; return __libc_realloc(p, n); }
+#define BENCH_COUNTS_ALLOCS 1
+#endif
+
+/* --- seams ------------------------------------------------------------- */
+
+static const char *g_route_table = "";
+static char g_default_route[96] = "";
+
+int bench_exec_argv(const char *const argv[], int flags, int timeout_ms, char **out, size_t *outlen, int *exit_code) {
+  (void)flags; (void)timeout_ms;
+  if (exit_code) *exit_code = 0;
+  const char *text = NULL;
+  if (argv[0] && argv[1] && strcmp(argv[0], "ip") == 0) {
+    if (strcmp(argv[1], "-4") == 0 && argv[2] && strcmp(argv[2], "r") == 0) text = g_route_table;
+    else if (strcmp(argv[1], "route") == 0) text = g_default_route;
+  }
+  if (!text) return -1;
+  size_t n = strlen(text);
+  *out = malloc(n + 1);
+  if (!*out) return -1;
+  memcpy(*out, text, n + 1);
+  *outlen = n;
+  return 0;
+}
+
+int bench_dns_async_running(void) { return 1; }
+int bench_dns_async_submit(const char *ip) { (void)ip; return 0; }
+
+/* --- fixtures ---------------------------------------------------------- */
+
+static char *load_file(const char *path, size_t *len) {
+  FILE *f = fopen(path, "rb");
+  if (!f) return NULL;
+  char *b = NULL; size_t n = 0, cap = 0; size_t r;
+  char tmp[65536];
+  while ((r = fread(tmp, 1, sizeof(tmp), f)) > 0) {
+    if (n + r + 1 > cap) { cap = (n + r + 1) * 2; char *nb = realloc(b, cap); if (!nb) { free(b); fclose(f); return NULL; } b = nb; }
+    memcpy(b + n, tmp, r); n += r;
+  }
+  fclose(f);
+  if (!b) { b = malloc(1); if (!b) return NULL; }
+  b[n] = 0;
+  if (len) *len = n;
+  return b;
+}
+
+static char *need_file(const char *path, size_t *len) {
+  char *b = load_file(path, len);
+  if (!b) { fprintf(stderr, "bench: cannot read %s (run from the repository root)\n", path); exit(2); }
+  return b;
+}
+
+/* Value of the first "key": member in doc, as a new string. */
+static char *member(const char *doc, const char *key) {
+  char needle[64]; snprintf(needle, sizeof(needle), "\"%s\"", key);
+  const char *p = strstr(doc, needle);
+  if (!p) return NULL;
+  p += strlen(needle);
+  while (*p == ' ' || *p == ':') p++;
+  const char *e = json_value_end(p, p + strlen(p));
+  if (!e) return NULL;
+  char *v = malloc((size_t)(e - p) + 1);
+  if (!v) return NULL;
+  memcpy(v, p, (size_t)(e - p)); v[e - p] = 0;
+  return v;
+}
+
+static char *concat3(const char *a, const char *b, const char *c) {
+  size_t la = strlen(a), lb = strlen(b), lc = strlen(c);
+  char *r = malloc(la + lb + lc + 1);
+  if (!r) exit(2);
+  memcpy(r, a, la); memcpy(r + la, b, lb); memcpy(r + la + lb, c, lc + 1);
+  return r;
+}
+
+/* "dest via gw dev if" lines from a jsoninfo routes array */
+static char *route_table_from(const char *routes) {
+  jw_t w; jw_init(&w, 4096);
+  const char *p = routes;
+  while ((p = strstr(p, "\"destination\"")) != NULL) {
+    char *v; size_t vl; char dest[64] = "", gw[64] = "", mask[8] = "32";
+    const char *obj = p;
+    while (obj > routes && *obj != '{') obj--;
+    if (find_json_string_value(obj, "destination", &v, &vl)) snprintf(dest, sizeof(dest), "%.*s", (int)vl, v);
+    if (find_json_string_value(obj, "gateway", &v, &vl)) snprintf(gw, sizeof(gw), "%.*s", (int)vl, v);
+    if (find_json_string_value(obj, "genmask", &v, &vl)) snprintf(mask, sizeof(mask), "%.*s", (int)vl, v);
+    p++;
+    if (!dest[0] || !gw[0] || strcmp(dest, "0.0.0.0") == 0) continue;
+    char line[192];
+    int n = snprintf(line, sizeof(line), "%s%s%s via %s dev eth0 proto 42 metric 2 onlink\n",
+                     dest, strcmp(mask, "32") ? "/" : "", strcmp(mask, "32") ? mask : "", gw);
+    jw_text(&w, line, (size_t)n);
+  }
+  char *out; size_t len;
+  if (jw_finish(&w, &out, &len, NULL) != 0) exit(2);
+  return out;
+}
+
+/* --- synthetic variants ------------------------------------------------ */
+
+static void ip4(char *dst, size_t n, int a, int i) { snprintf(dst, n, "10.%d.%d.%d", a, (i / 250) % 250, 1 + i % 250); }
+
+/* nlinks neighbours; neighbour i is gateway for 1 + i % 32 destinations,
+ * each announced in the topology by that neighbour.
+ */
+static void synth_links(int nlinks, char **doc, char **rtable) {
+  jw_t d, r; jw_init(&d, 1 << 16); jw_init(&r, 1 << 16);
+  char rem[32], dst[32], line[160];
+  jw_begin_obj(&d);
+  JW_KEY(&d, "links"); jw_begin_arr(&d);
+  for (int i = 0; i < nlinks; i++) {
+    ip4(rem, sizeof(rem), 1, i);
+    jw_begin_obj(&d);
+    JW_KEY(&d, "localIP"); jw_str(&d, "10.0.0.1");
+    JW_KEY(&d, "remoteIP"); jw_str(&d, rem);
+    JW_KEY(&d, "olsrInterface"); jw_str(&d, i % 2 ? "wlan0" : "eth0");
+    JW_KEY(&d, "linkQuality"); jw_fixed(&d, 0.5 + (i % 50) / 100.0, 6);
+    JW_KEY(&d, "neighborLinkQuality"); jw_fixed(&d, 1.0, 6);
+    JW_KEY(&d, "linkCost"); jw_fixed(&d, 1.0 + (i % 9) / 8.0, 6);
+    jw_end_obj(&d);
+  }
+  jw_end_arr(&d);
+  JW_KEY(&d, "routes"); jw_begin_arr(&d);
+  int k = 0;
+  for (int i = 0; i < nlinks; i++) {
+    ip4(rem, sizeof(rem), 1, i);
+    for (int j = 0; j <= i % 32; j++, k++) {
+      ip4(dst, sizeof(dst), 2, k);
+      jw_begin_obj(&d);
+      JW_KEY(&d, "destination"); jw_str(&d, dst);
+      JW_KEY(&d, "genmask"); jw_u64(&d, 32);
+      JW_KEY(&d, "gateway"); jw_str(&d, rem);
+      JW_KEY(&d, "metric"); jw_u64(&d, (uint64_t)(1 + j % 5));
+      jw_end_obj(&d);
+      int n = snprintf(line, sizeof(line), "%s via %s dev eth0 proto 42 metric 2 onlink\n", dst, rem);
+      jw_text(&r, line, (size_t)n);
+    }
+  }
+  jw_end_arr(&d);
+  JW_KEY(&d, "topology"); jw_begin_arr(&d);
+  k = 0;
+  for (int i = 0; i < nlinks; i++) {
+    ip4(rem, sizeof(rem), 1, i);
+    for (int j = 0; j <= i % 32; j++, k++) {
+      ip4(dst, sizeof(dst), 2, k);
+      jw_begin_obj(&d);
+      JW_KEY(&d, "lastHopIP"); jw_str(&d, rem);
+      JW_KEY(&d, "destinationIP"); jw_str(&d, dst);
+      JW_KEY(&d, "tcEdgeCost"); jw_fixed(&d, 1.0, 6);
+      jw_end_obj(&d);
+    }
+  }
+  jw_end_arr(&d);
+  jw_end_obj(&d);
+  size_t l;
+  if (jw_finish(&d, doc, &l, NULL) != 0 || jw_finish(&r, rtable, &l, NULL) != 0) exit(2);
+}
+
+static char *synth_neighbors(int n) {
+  jw_t w; jw_init(&w, 1 << 16);
+  char ip[32];
+  jw_begin_obj(&w);
+  JW_KEY(&w, "neighbors"); jw_begin_arr(&w);
+  for (int i = 0; i < n; i++) {
+    ip4(ip, sizeof(ip), 1, i);
+    jw_begin_obj(&w);
+    JW_KEY(&w, "ipAddress"); jw_str(&w, ip);
+    JW_KEY(&w, "symmetric"); jw_bool(&w, 1);
+    JW_KEY(&w, "willingness"); jw_u64(&w, 3);
+    JW_KEY(&w, "linkcount"); jw_u64(&w, 1);
+    JW_KEY(&w, "twoHopNeighborCount"); jw_u64(&w, (uint64_t)(i % 17));
+    jw_end_obj(&w);
+  }
+  jw_end_arr(&w);
+  jw_end_obj(&w);
+  char *out; size_t l;
+  if (jw_finish(&w, &out, &l, NULL) != 0) exit(2);
+  return out;
+}
+
+static char *synth_devices(int n, int wrapped) {
+  jw_t w; jw_init(&w, 1 << 16);
+  char ip[32], mac[32], host[64];
+  if (wrapped) { jw_begin_obj(&w); JW_KEY(&w, "devices"); }
+  jw_begin_arr(&w);
+  for (int i = 0; i < n; i++) {
+    ip4(ip, sizeof(ip), 3, i);
+    snprintf(mac, sizeof(mac), "f0:9f:c2:%02x:%02x:%02x", (i >> 16) & 255, (i >> 8) & 255, i & 255);
+    snprintf(host, sizeof(host), i % 7 ? "ap-%d.mesh" : "ap \"%d\" \\ sector", i);
+    jw_begin_obj(&w);
+    JW_KEY(&w, "ipv4"); jw_str(&w, ip);
+    JW_KEY(&w, "hwaddr"); jw_str(&w, mac);
+    JW_KEY(&w, "hostname"); jw_str(&w, host);
+    JW_KEY(&w, "product"); jw_str(&w, i % 3 ? "LiteBeam 5AC Gen2" : "");
+    JW_KEY(&w, "uptime"); jw_str(&w, i % 2 ? "86400" : "");
+    JW_KEY(&w, "mode"); jw_str(&w, "sta");
+    JW_KEY(&w, "essid"); jw_str(&w, "funkfeuer");
+    JW_KEY(&w, "firmware"); jw_str(&w, "WA.ar934x.v8.7.11");
+    JW_KEY(&w, "signal"); jw_str(&w, "");
+    JW_KEY(&w, "source"); jw_str(&w, "ubnt-discover");
+    jw_end_obj(&w);
+  }
+  jw_end_arr(&w);
+  if (wrapped) jw_end_obj(&w);
+  char *out; size_t l;
+  if (jw_finish(&w, &out, &l, NULL) != 0) exit(2);
+  return out;
+}
+
+static char *synth_nodedb(int n) {
+  jw_t w; jw_init(&w, 1 << 20);
+  char ip[32], name[32];
+  jw_begin_obj(&w);
+  for (int i = 0; i < n; i++) {
+    ip4(ip, sizeof(ip), 2, i);
+    snprintf(name, sizeof(name), "node%d", i / 4);
+    jw_keyn(&w, ip, strlen(ip));
+    jw_begin_obj(&w);
+    JW_KEY(&w, "n"); jw_str(&w, name);
+    JW_KEY(&w, "i"); jw_u64_str(&w, (uint64_t)(i / 4));
+    JW_KEY(&w, "d"); jw_str(&w, i % 4 ? "hna" : "EdgeRouter");
+    jw_end_obj(&w);
+  }
+  for (int i = 0; i < n / 16; i++) {
+    char key[32]; snprintf(key, sizeof(key), "10.4.%d.0/24", i % 250);
+    snprintf(name, sizeof(name), "net%d", i);
+    jw_keyn(&w, key, strlen(key));
+    jw_begin_obj(&w); JW_KEY(&w, "n"); jw_str(&w, name); jw_end_obj(&w);
+  }
+  jw_end_obj(&w);
+  char *out; size_t l;
+  if (jw_finish(&w, &out, &l, NULL) != 0) exit(2);
+  return out;
+}
+
+static uint8_t *synth_tlv(size_t *len) {
+  static uint8_t b[512];
+  size_t n = 0;
+  const uint8_t mac[6] = { 0xf0, 0x9f, 0xc2, 0x12, 0x34, 0x56 };
+  const uint8_t ip[4] = { 10, 3, 0, 1 };
+  const uint8_t up[4] = { 0x80, 0x51, 0x01, 0x00 };
+  const char *strs[][2] = { { "\x0b", "ap-1.mesh" }, { "\x0c", "LiteBeam 5AC Gen2" }, { "\x0d", "WA.ar934x.v8.7.11.46972.220614.0419" },
+                            { "\x2a", "funkfeuer" }, { "\x30", "{\"wmode\":2}" }, { "\x31", "vendor blob" } };
+  b[n++] = 0x01; b[n++] = 6; memcpy(b + n, mac, 6); n += 6;
+  b[n++] = 0x02; b[n++] = 4; memcpy(b + n, ip, 4); n += 4;
+  b[n++] = 0x40; b[n++] = 4; memcpy(b + n, up, 4); n += 4;
+  for (size_t i = 0; i < sizeof(strs) / sizeof(strs[0]); i++) {
+    size_t l = strlen(strs[i][1]);
+    b[n++] = (uint8_t)strs[i][0][0]; b[n++] = (uint8_t)l; memcpy(b + n, strs[i][1], l); n += l;
+  }
+  *len = n;
+  return b;
+}
+
+/* --- cases ------------------------------------------------------------- */
+
+typedef struct bench_case {
+  const char *name;
+  const char *in; size_t in_len;   /* JSON input, or NULL for binary/lookup cases */
+  const char *rtable;              /* `ip -4 r` output for the links cases */
+  const uint8_t *bin; size_t bin_len;
+  char **ips; int nips;            /* lookups for the node DB case */
+  int (*run)(const struct bench_case *c, char **out, size_t *outlen);
+} bench_case_t;
+
+static int run_links(const bench_case_t *c, char **out, size_t *outlen) { return normalize_olsrd_links(c->in, out, outlen); }
+static int run_neighbors(const bench_case_t *c, char **out, size_t *outlen) { return normalize_olsrd_neighbors(c->in, out, outlen); }
+static int run_ubnt(const bench_case_t *c, char **out, size_t *outlen) { return normalize_ubnt_devices(c->in, out, outlen); }
+static int run_filter(const bench_case_t *c, char **out, size_t *outlen) {
+  *out = filter_devices_array(c->in, 1, 1, outlen);
+  return *out ? 0 : -1;
+}
+static int run_nodedb(const bench_case_t *c, char **out, size_t *outlen) {
+  jw_t w; jw_init(&w, 1024);
+  for (int i = 0; i < c->nips; i++) {
+    char name[256];
+    if (!find_best_nodename_in_nodedb(c->in, c->in_len, c->ips[i], name, sizeof(name))) name[0] = 0;
+    jw_text(&w, c->ips[i], strlen(c->ips[i])); jw_text(&w, "=", 1);
+    jw_text(&w, name, strlen(name)); jw_text(&w, "\n", 1);
+  }
+  return jw_finish(&w, out, outlen, NULL);
+}
+static int run_tlv(const bench_case_t *c, char **out, size_t *outlen) {
+  struct ubnt_kv kv[32];
+  size_t n = parse_tlv(c->bin, c->bin_len, kv, sizeof(kv) / sizeof(kv[0]));
+  jw_t w; jw_init(&w, 512);
+  for (size_t i = 0; i < n; i++) {
+    jw_text(&w, kv[i].key, strlen(kv[i].key)); jw_text(&w, "=", 1);
+    jw_text(&w, kv[i].value, strlen(kv[i].value)); jw_text(&w, "\n", 1);
+  }
+  return jw_finish(&w, out, outlen, NULL);
+}
+
+static double now_ns(void) {
+  struct timespec t; clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+static void fresh_host_cache(void) {
+  lru_cache_destroy(g_host_cache);
+  g_host_cache = lru_cache_create(4096, 16, 300, 60, 600);
+}
+
+/* Returns 0 when the output matches the golden file (or was written). */
+static int check_golden(const bench_case_t *c, const char *out, size_t len, int update) {
+  char path[256], fname[128];
+  snprintf(fname, sizeof(fname), "%s", c->name);
+  for (char *p = fname; *p; p++) if (*p == '/') *p = '.';
+  snprintf(path, sizeof(path), "tools/bench/golden/%s.out", fname);
+  if (update) {
+    FILE *f = fopen(path, "wb");
+    if (!f || fwrite(out, 1, len, f) != len) { fprintf(stderr, "bench: cannot write %s\n", path); if (f) fclose(f); return -1; }
+    fclose(f);
+    return 0;
+  }
+  size_t glen = 0;
+  char *g = load_file(path, &glen);
+  if (!g) { fprintf(stderr, "  %s: no golden file %s (make bench-golden)\n", c->name, path); return -1; }
+  int rc = 0;
+  if (glen != len || memcmp(g, out, len) != 0) {
+    size_t i = 0; while (i < len && i < glen && g[i] == out[i]) i++;
+    fprintf(stderr, "  %s: output differs from %s at byte %zu (%zu vs %zu bytes)\n", c->name, path, i, len, glen);
+    rc = -1;
+  }
+  free(g);
+  return rc;
+}
+
+static int run_case(const bench_case_t *c, double min_ns, int update) {
+  char *out = NULL; size_t len = 0;
+  if (c->rtable) g_route_table = c->rtable;
+  fresh_host_cache();
+  if (c->run(c, &out, &len) != 0 || !out) { fprintf(stderr, "  %s: failed\n", c->name); return -1; }
+  int rc = check_golden(c, out, len, update);
+  free(out);
+
+  long iters = 1; double el = 0;
+  unsigned long a0 = 0; unsigned long long b0 = 0;
+  for (;;) {
+    a0 = g_allocs; b0 = g_alloc_bytes;
+    double t0 = now_ns();
+    for (long i = 0; i < iters; i++) { c->run(c, &out, &len); free(out); }
+    el = now_ns() - t0;
+    if (el >= min_ns || iters >= (1L << 24)) break;
+    iters *= el > 0 && el < min_ns / 16 ? 8 : 2;
+  }
+  size_t in = c->in ? c->in_len : c->bin_len;
+#ifdef BENCH_COUNTS_ALLOCS
+  printf("%-38s %9zu %12.0f %10.0f %9.1f %8.1f %s\n", c->name, in, el / (double)iters,
+         (double)(g_alloc_bytes - b0) / (double)iters, (double)(g_allocs - a0) / (double)iters,
+         el > 0 ? (double)in * (double)iters / el * 1e3 : 0.0, rc ? "MISMATCH" : "ok");
+#else
+  (void)a0; (void)b0;
+  printf("%-38s %9zu %12.0f %10s %9s %8.1f %s\n", c->name, in, el / (double)iters, "n/a", "n/a",
+         el > 0 ? (double)in * (double)iters / el * 1e3 : 0.0, rc ? "MISMATCH" : "ok");
+#endif
+  return rc;
+}
+
+int main(int argc, char **argv) {
+  const char *only = argc > 1 ? argv[1] : NULL;
+  const char *e = getenv("BENCH_UPDATE");
+  int update = e && *e == '1';
+  e = getenv("BENCH_MIN_MS");
+  double min_ns = (e ? atof(e) : 300.0) * 1e6;
+
+  size_t n;
+  char *status = need_file("tools/remote/status.json", NULL);
+  char *links_fx = need_file("tools/remote/olsr_links.json", NULL);
+  char *nodedb = need_file("tools/remote/nodedb.json", &n);
+  size_t nodedb_len = n;
+  size_t tlv_len = 0;
+  uint8_t *tlv = (uint8_t *)need_file("tools/bench/fixtures/ubnt_reply.bin", &tlv_len);
+
+  /* node DB as the fetch worker would leave it */
+  g_nodedb = payload_new(nodedb, nodedb_len);
+  g_nodedb_index = nodedb_build_index(g_nodedb->data, g_nodedb->len);
+  g_nodedb_last_fetch = time(NULL);
+  g_nodedb_ttl = 1 << 30;
+
+  /* links: the fixture's link list with the captured routes and topology */
+  char *routes_raw = member(status, "olsr_routes_raw"), *topo_raw = member(status, "olsr_topology_raw");
+  char *links_arr = member(links_fx, "links");
+  char *routes = routes_raw ? member(routes_raw, "routes") : NULL, *topo = topo_raw ? member(topo_raw, "topology") : NULL;
+  if (!links_arr || !routes || !topo) { fprintf(stderr, "bench: fixture layout changed\n"); return 2; }
+  char *t1 = concat3("{\"links\":", links_arr, ",\"routes\":");
+  char *t2 = concat3(t1, routes, ",\"topology\":");
+  char *links_doc = concat3(t2, topo, "}");
+  char *rtable = route_table_from(routes);
+  snprintf(g_default_route, sizeof(g_default_route), "default via 193.238.158.170 dev eth0 proto 42 metric 2 onlink\n");
+  char *slinks = NULL, *srtable = NULL;
+  synth_links(64, &slinks, &srtable);
+
+  char *neigh = member(status, "olsr_neighbors_raw");
+  char *sneigh = synth_neighbors(1024);
+  char *devs = member(status, "devices");
+  char *devs_doc = concat3("{\"devices\":", devs ? devs : "[]", "}");
+  char *sdevs_doc = synth_devices(512, 1), *sdevs = synth_devices(512, 0);
+  char *snodedb = synth_nodedb(20000);
+
+  /* node DB lookups: every 8th route destination plus a few misses */
+  char *ips[80]; int nips = 0;
+  int seen = 0;
+  for (const char *p = routes; (p = strstr(p, "\"destination\"")) != NULL && nips < 72; p++) {
+    char *v; size_t vl;
+    if (seen++ % 8 == 0 && find_json_string_value(p, "destination", &v, &vl)) ips[nips++] = strndup(v, vl);
+  }
+  ips[nips++] = strdup("192.0.2.1"); ips[nips++] = strdup("10.4.17.9");
+  char *sips[64]; int nsips = 0;
+  for (int i = 0; i < 64; i++) { char ip[32]; ip4(ip, sizeof(ip), i % 8 ? 2 : 4, i * 311); sips[nsips++] = strdup(ip); }
+  size_t stlv_len; const uint8_t *stlv = synth_tlv(&stlv_len);
+
+  bench_case_t cases[] = {
+    { "normalize_olsrd_links/fixture", links_doc, strlen(links_doc), rtable, NULL, 0, NULL, 0, run_links },
+    { "normalize_olsrd_links/synthetic-64", slinks, strlen(slinks), srtable, NULL, 0, NULL, 0, run_links },
+    { "normalize_olsrd_neighbors/fixture", neigh, strlen(neigh), NULL, NULL, 0, NULL, 0, run_neighbors },
+    { "normalize_olsrd_neighbors/synthetic-1024", sneigh, strlen(sneigh), NULL, NULL, 0, NULL, 0, run_neighbors },
+    { "normalize_ubnt_devices/fixture", devs_doc, strlen(devs_doc), NULL, NULL, 0, NULL, 0, run_ubnt },
+    { "normalize_ubnt_devices/synthetic-512", sdevs_doc, strlen(sdevs_doc), NULL, NULL, 0, NULL, 0, run_ubnt },
+    { "filter_devices_array/fixture", devs ? devs : "[]", devs ? strlen(devs) : 2, NULL, NULL, 0, NULL, 0, run_filter },
+    { "filter_devices_array/synthetic-512", sdevs, strlen(sdevs), NULL, NULL, 0, NULL, 0, run_filter },
+    { "find_best_nodename_in_nodedb/fixture", nodedb, nodedb_len, NULL, NULL, 0, ips, nips, run_nodedb },
+    { "find_best_nodename_in_nodedb/synth-20k", snodedb, strlen(snodedb), NULL, NULL, 0, sips, nsips, run_nodedb },
+    { "parse_tlv/fixture", NULL, 0, NULL, tlv, tlv_len, NULL, 0, run_tlv },
+    { "parse_tlv/synthetic", NULL, 0, NULL, stlv, stlv_len, NULL, 0, run_tlv },
+  };
+  if (!neigh || !devs) { fprintf(stderr, "bench: fixture layout changed\n"); return 2; }
+
+  printf("%-38s %9s %12s %10s %9s %8s\n", "case", "in_bytes", "ns/op", "B/op", "allocs/op", "MB/s");
+  int fails = 0;
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    if (only && !strstr(cases[i].name, only)) continue;
+    if (run_case(&cases[i], min_ns, update) != 0) fails++;
+  }
+  printf("(find_best_nodename_in_nodedb: one op = %d / %d lookups)\n", nips, nsips);
+  if (update) printf("golden files written to tools/bench/golden/\n");
+  return fails ? 1 : 0;
+}
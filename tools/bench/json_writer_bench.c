@@ -0,0 +1,128 @@
+/* Emits the /olsr/links array for a synthetic mesh twice: once the way the
+ * emitters used to (a formatted append per token, escaping byte by byte)
+ * and once through the typed writer, and reports ns per link object.
+ *
+ *   make bench-json-writer && build/json_writer_bench [links] [iterations]
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include "json_writer.h"
+
+static int old_append(char **b, size_t *len, size_t *cap, const char *fmt, ...) {
+  va_list ap; char *t = NULL;
+  va_start(ap, fmt);
+  int n = vasprintf(&t, fmt, ap);
+  va_end(ap);
+  if (n < 0) return -1;
+  if (*len + (size_t)n + 1 > *cap) {
+    while (*cap < *len + (size_t)n + 1) *cap *= 2;
+    char *nb = realloc(*b, *cap);
+    if (!nb) { free(t); return -1; }
+    *b = nb;
+  }
+  memcpy(*b + *len, t, (size_t)n); *len += (size_t)n; (*b)[*len] = 0;
+  free(t);
+  return 0;
+}
+
+static int old_escaped(char **b, size_t *len, size_t *cap, const char *s) {
+  if (old_append(b, len, cap, "\"") < 0) return -1;
+  for (const unsigned char *p = (const unsigned char *)s; *p; ++p) {
+    if (*p == '"' || *p == '\\') { if (old_append(b, len, cap, "\\%c", *p) < 0) return -1; }
+    else if (*p < 0x20) { if (old_append(b, len, cap, "\\u%04x", *p) < 0) return -1; }
+    else { char t[2] = { (char)*p, 0 }; if (old_append(b, len, cap, "%s", t) < 0) return -1; }
+  }
+  return old_append(b, len, cap, "\"");
+}
+
+struct link { char intf[16], local[32], remote[32], host[64], lq[8], nlq[8], cost[16]; int routes, nodes, dflt; };
+
+static size_t emit_old(const struct link *l, int n, char **out) {
+  size_t cap = 4096, len = 0; char *b = malloc(cap); b[0] = 0;
+  old_append(&b, &len, &cap, "[");
+  for (int i = 0; i < n; i++) {
+    char rs[16], ns[16];
+    snprintf(rs, sizeof(rs), "%d", l[i].routes); snprintf(ns, sizeof(ns), "%d", l[i].nodes);
+    if (i) old_append(&b, &len, &cap, ",");
+    old_append(&b, &len, &cap, "{\"intf\":"); old_escaped(&b, &len, &cap, l[i].intf);
+    old_append(&b, &len, &cap, ",\"local\":"); old_escaped(&b, &len, &cap, l[i].local);
+    old_append(&b, &len, &cap, ",\"remote\":"); old_escaped(&b, &len, &cap, l[i].remote);
+    old_append(&b, &len, &cap, ",\"remote_host\":"); old_escaped(&b, &len, &cap, l[i].host);
+    old_append(&b, &len, &cap, ",\"lq\":"); old_escaped(&b, &len, &cap, l[i].lq);
+    old_append(&b, &len, &cap, ",\"nlq\":"); old_escaped(&b, &len, &cap, l[i].nlq);
+    old_append(&b, &len, &cap, ",\"cost\":"); old_escaped(&b, &len, &cap, l[i].cost);
+    old_append(&b, &len, &cap, ",\"routes\":"); old_escaped(&b, &len, &cap, rs);
+    old_append(&b, &len, &cap, ",\"nodes\":"); old_escaped(&b, &len, &cap, ns);
+    old_append(&b, &len, &cap, ",\"is_default\":%s}", l[i].dflt ? "true" : "false");
+  }
+  old_append(&b, &len, &cap, "]");
+  *out = b;
+  return len;
+}
+
+static size_t emit_jw(const struct link *l, int n, char **out) {
+  jw_t w; size_t len = 0;
+  jw_init(&w, 4096);
+  jw_begin_arr(&w);
+  for (int i = 0; i < n; i++) {
+    jw_begin_obj(&w);
+    JW_KEY(&w, "intf"); jw_str(&w, l[i].intf);
+    JW_KEY(&w, "local"); jw_str(&w, l[i].local);
+    JW_KEY(&w, "remote"); jw_str(&w, l[i].remote);
+    JW_KEY(&w, "remote_host"); jw_str(&w, l[i].host);
+    JW_KEY(&w, "lq"); jw_str(&w, l[i].lq);
+    JW_KEY(&w, "nlq"); jw_str(&w, l[i].nlq);
+    JW_KEY(&w, "cost"); jw_str(&w, l[i].cost);
+    JW_KEY(&w, "routes"); jw_u64_str(&w, (uint64_t)l[i].routes);
+    JW_KEY(&w, "nodes"); jw_u64_str(&w, (uint64_t)l[i].nodes);
+    JW_KEY(&w, "is_default"); jw_bool(&w, l[i].dflt);
+    jw_end_obj(&w);
+  }
+  jw_end_arr(&w);
+  if (jw_finish(&w, out, &len, NULL) != 0) { fprintf(stderr, "writer error\n"); exit(1); }
+  return len;
+}
+
+static double now_ns(void) {
+  struct timespec t; clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+int main(int argc, char **argv) {
+  int n = argc > 1 ? atoi(argv[1]) : 200, iters = argc > 2 ? atoi(argv[2]) : 200;
+  if (n < 1) n = 1;
+  if (iters < 1) iters = 1;
+  struct link *l = calloc((size_t)n, sizeof(*l));
+  for (int i = 0; i < n; i++) {
+    snprintf(l[i].intf, sizeof(l[i].intf), "wlan%d", i % 4);
+    snprintf(l[i].local, sizeof(l[i].local), "10.%d.0.1", i % 250);
+    snprintf(l[i].remote, sizeof(l[i].remote), "10.%d.%d.%d", i % 250, (i / 250) % 250, 1 + i % 250);
+    snprintf(l[i].host, sizeof(l[i].host), "node-%d.mesh \"site %d\"", i, i % 17);
+    snprintf(l[i].lq, sizeof(l[i].lq), "0.%02d", i % 100);
+    snprintf(l[i].nlq, sizeof(l[i].nlq), "1.0");
+    snprintf(l[i].cost, sizeof(l[i].cost), "%d.%03d", 1 + i % 9, i % 1000);
+    l[i].routes = i * 7 % 300; l[i].nodes = i * 3 % 120; l[i].dflt = i == 0;
+  }
+  char *a, *b;
+  size_t la = emit_old(l, n, &a), lb = emit_jw(l, n, &b);
+  if (la != lb || memcmp(a, b, la) != 0) { fprintf(stderr, "outputs differ (%zu vs %zu bytes)\n", la, lb); return 1; }
+  free(a); free(b);
+
+  double t0 = now_ns();
+  for (int i = 0; i < iters; i++) { emit_old(l, n, &a); free(a); }
+  double t1 = now_ns();
+  for (int i = 0; i < iters; i++) { emit_jw(l, n, &b); free(b); }
+  double t2 = now_ns();
+  double per_old = (t1 - t0) / ((double)iters * n), per_jw = (t2 - t1) / ((double)iters * n);
+  printf("links=%d bytes=%zu\n", n, la);
+  printf("json_buf_append  %9.1f ns/link\n", per_old);
+  printf("jw_*             %9.1f ns/link  (%.1fx)\n", per_jw, per_jw > 0 ? per_old / per_jw : 0.0);
+  free(l);
+  return 0;
+}
@@ -0,0 +1,487 @@
+/* Open-loop HTTP load generator for the plugin endpoints.
+ *
+ * Requests are started on a fixed schedule (--rate per second, evenly spaced
+ * or with --poisson exponential gaps) whether or not earlier ones have
+ * answered, so a slow server shows up as latency instead of as a lower
+ * request rate. Latency is taken from the scheduled start, which keeps the
+ * time a request waited for a free slot in the number. Paths are drawn from
+ * a weighted mix; the default follows what an open dashboard polls
+ * (/status/lite every 5 s, the 10 s ping, /status, /nodedb.json and
+ * /devices.json on load and tab switches).
+ *
+ * At the end it prints per-path and total p50/p90/p99/p99.9/max latency,
+ * throughput, errors by kind and bytes. With --metrics-every S it also
+ * fetches /metrics every S seconds (outside the measured mix), optionally
+ * writes every sample to --metrics-out as "t_s name value" lines, and
+ * reports which counters moved during the run.
+ *
+ *   make loadgen
+ *   build/loadgen --url http://127.0.0.1:11080 --rate 15 --duration 60 --metrics-every 5
+ *   build/loadgen --mix '/status=1,/status/lite=4' --rate 200 --poisson
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <netdb.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#define MAX_PATHS 16
+
+static const char *g_url = "http://127.0.0.1:11080";
+static const char *g_mix = "/status/lite=60,/status=10,/nodedb.json=10,/devices.json=10,/status/ping=10";
+static double g_rate = 15, g_duration = 30;
+static int g_poisson, g_max_inflight = 1000, g_timeout_ms = 10000;
+static double g_metrics_every;
+static const char *g_metrics_out, *g_metrics_match = "olsrd_status_";
+static unsigned long g_seed = 1;
+
+static char g_host[256];
+static struct sockaddr_storage g_addr;
+static socklen_t g_addrlen;
+
+/* --- endpoint mix and results ---------------------------------------------- */
+
+enum { E_CONNECT, E_TIMEOUT, E_STATUS, E_IO, E_SHORT, E_OVERLOAD, E_COUNT };
+static const char *const k_err_names[E_COUNT] = { "connect", "timeout", "http", "io", "short", "overload" };
+
+typedef struct {
+  char path[256];
+  double weight;
+  uint64_t sent, ok, bytes, err[E_COUNT];
+  uint32_t *lat_us;          /* completed requests, ok or not */
+  size_t nlat, caplat;
+} path_t;
+
+static path_t g_paths[MAX_PATHS];
+static int g_npaths;
+static double g_weight_sum;
+
+static int parse_mix(const char *mix) {
+  char buf[2048];
+  snprintf(buf, sizeof(buf), "%s", mix);
+  for (char *save = NULL, *t = strtok_r(buf, ",", &save); t; t = strtok_r(NULL, ",", &save)) {
+    if (g_npaths == MAX_PATHS) return -1;
+    path_t *p = &g_paths[g_npaths];
+    char *eq = strrchr(t, '=');
+    p->weight = 1;
+    if (eq) { *eq = 0; p->weight = atof(eq + 1); }
+    if (t[0] != '/' || p->weight <= 0) return -1;
+    snprintf(p->path, sizeof(p->path), "%s", t);
+    g_weight_sum += p->weight;
+    g_npaths++;
+  }
+  return g_npaths ? 0 : -1;
+}
+
+static void record(path_t *p, int64_t lat_ns) {
+  if (p->nlat == p->caplat) {
+    size_t nc = p->caplat ? p->caplat * 2 : 1024;
+    uint32_t *nl = realloc(p->lat_us, nc * sizeof(*nl));
+    if (!nl) return;
+    p->lat_us = nl; p->caplat = nc;
+  }
+  int64_t us = lat_ns / 1000;
+  p->lat_us[p->nlat++] = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+}
+
+/* --- rng --------------------------------------------------------------------- */
+
+static uint64_t g_rng;
+static double rndf(void) {
+  uint64_t z = (g_rng += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return (double)((z ^ (z >> 31)) >> 11) / 9007199254740992.0;
+}
+
+static int pick_path(void) {
+  double x = rndf() * g_weight_sum;
+  for (int i = 0; i < g_npaths; i++) { if (x < g_paths[i].weight) return i; x -= g_paths[i].weight; }
+  return g_npaths - 1;
+}
+
+/* --- connections ------------------------------------------------------------ */
+
+typedef struct req {
+  int fd;
+  int path;                  /* index into g_paths, or -1 for a /metrics sample */
+  int64_t sched_ns, deadline_ns;
+  int connected;
+  char out[512];
+  size_t outlen, outoff;
+  char *in;                  /* whole response, for /metrics; headers only otherwise */
+  size_t inlen, incap;
+  size_t hdr_end;            /* offset of the body once the header is complete */
+  long long clen;            /* Content-Length or -1 */
+  uint64_t body;             /* body bytes received */
+  int status;
+  struct req *prev, *next;   /* in-flight list */
+} req_t;
+
+static req_t *g_inflight;
+static int g_ninflight, g_ep;
+static volatile sig_atomic_t g_stop;
+
+static int64_t now_ns(void) {
+  struct timespec t; clock_gettime(CLOCK_MONOTONIC, &t);
+  return (int64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+static int parse_url(const char *url) {
+  const char *p = url;
+  if (strncmp(p, "http://", 7) == 0) p += 7;
+  size_t n = strcspn(p, "/");
+  if (!n || n >= sizeof(g_host)) return -1;
+  memcpy(g_host, p, n); g_host[n] = 0;
+  char host[256], port[16] = "80";
+  snprintf(host, sizeof(host), "%s", g_host);
+  char *colon = strrchr(host, ':');
+  if (colon && !strchr(colon, ']')) { *colon = 0; snprintf(port, sizeof(port), "%s", colon + 1); }
+  if (host[0] == '[') { memmove(host, host + 1, strlen(host)); host[strcspn(host, "]")] = 0; }
+  struct addrinfo hints, *res = NULL;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo(host, port, &hints, &res) != 0 || !res) return -1;
+  memcpy(&g_addr, res->ai_addr, res->ai_addrlen);
+  g_addrlen = res->ai_addrlen;
+  freeaddrinfo(res);
+  return 0;
+}
+
+static void req_free(req_t *r) {
+  if (r->prev) r->prev->next = r->next; else g_inflight = r->next;
+  if (r->next) r->next->prev = r->prev;
+  g_ninflight--;
+  if (r->fd >= 0) { epoll_ctl(g_ep, EPOLL_CTL_DEL, r->fd, NULL); close(r->fd); }
+  free(r->in);
+  free(r);
+}
+
+static void on_metrics(req_t *r, int64_t now);
+
+/* Finishes a request: err < 0 means it completed; otherwise it failed with E_*. */
+static void req_done(req_t *r, int err, int64_t now) {
+  if (r->path < 0) {
+    if (err < 0) on_metrics(r, now);
+    req_free(r);
+    return;
+  }
+  path_t *p = &g_paths[r->path];
+  if (err < 0) {
+    if (r->status < 200 || r->status > 299) err = E_STATUS;
+    else if (r->clen >= 0 && r->body < (uint64_t)r->clen) err = E_SHORT;
+  }
+  p->bytes += r->body;
+  if (err < 0) p->ok++; else p->err[err]++;
+  if (err != E_CONNECT) record(p, now - r->sched_ns);
+  req_free(r);
+}
+
+static int start(int path, int64_t sched, const char *target) {
+  req_t *r = calloc(1, sizeof(*r));
+  if (!r) return -1;
+  r->path = path; r->sched_ns = sched; r->deadline_ns = sched + (int64_t)g_timeout_ms * 1000000; r->clen = -1;
+  r->outlen = (size_t)snprintf(r->out, sizeof(r->out), "GET %s HTTP/1.0\r\nHost: %s\r\nUser-Agent: olsrd-status-loadgen\r\nAccept: */*\r\nConnection: close\r\n\r\n", target, g_host);
+  r->next = g_inflight; if (g_inflight) g_inflight->prev = r; g_inflight = r; g_ninflight++;
+  r->fd = socket(g_addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (r->fd < 0) { req_done(r, E_CONNECT, now_ns()); return -1; }
+  int one = 1;
+  setsockopt(r->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  if (connect(r->fd, (struct sockaddr *)&g_addr, g_addrlen) < 0 && errno != EINPROGRESS) { req_done(r, E_CONNECT, now_ns()); return -1; }
+  struct epoll_event ev = { .events = EPOLLOUT, .data.ptr = r };
+  if (epoll_ctl(g_ep, EPOLL_CTL_ADD, r->fd, &ev) < 0) { req_done(r, E_IO, now_ns()); return -1; }
+  return 0;
+}
+
+static int append_in(req_t *r, const char *b, size_t n) {
+  if (r->inlen + n + 1 > r->incap) {
+    size_t nc = r->incap ? r->incap * 2 : 4096;
+    while (nc < r->inlen + n + 1) nc *= 2;
+    char *ni = realloc(r->in, nc);
+    if (!ni) return -1;
+    r->in = ni; r->incap = nc;
+  }
+  memcpy(r->in + r->inlen, b, n);
+  r->inlen += n;
+  r->in[r->inlen] = 0;
+  return 0;
+}
+
+static void parse_header(req_t *r) {
+  char *end = strstr(r->in, "\r\n\r\n");
+  if (!end) return;
+  r->hdr_end = (size_t)(end - r->in) + 4;
+  if (strncmp(r->in, "HTTP/", 5) == 0) { const char *sp = strchr(r->in, ' '); if (sp) r->status = atoi(sp + 1); }
+  for (char *l = strstr(r->in, "\r\n"); l && l < end; l = strstr(l + 2, "\r\n"))
+    if (strncasecmp(l + 2, "Content-Length:", 15) == 0) r->clen = atoll(l + 17);
+  r->body = r->inlen - r->hdr_end;
+}
+
+static void on_event(req_t *r, uint32_t events, int64_t now) {
+  if (!r->connected) {
+    int err = 0; socklen_t el = sizeof(err);
+    if (getsockopt(r->fd, SOL_SOCKET, SO_ERROR, &err, &el) < 0 || err) { req_done(r, E_CONNECT, now); return; }
+    r->connected = 1;
+  }
+  if (r->outoff < r->outlen) {
+    ssize_t n = send(r->fd, r->out + r->outoff, r->outlen - r->outoff, MSG_NOSIGNAL);
+    if (n < 0 && errno != EAGAIN && errno != EINTR) { req_done(r, E_IO, now); return; }
+    if (n > 0) r->outoff += (size_t)n;
+    if (r->outoff == r->outlen) {
+      struct epoll_event ev = { .events = EPOLLIN | EPOLLRDHUP, .data.ptr = r };
+      epoll_ctl(g_ep, EPOLL_CTL_MOD, r->fd, &ev);
+    }
+    return;
+  }
+  (void)events;
+  char buf[65536];
+  for (;;) {
+    ssize_t n = recv(r->fd, buf, sizeof(buf), 0);
+    if (n > 0) {
+      /* the body is only counted, except for /metrics samples */
+      if (!r->hdr_end || r->path < 0) {
+        if (append_in(r, buf, (size_t)n) < 0) { req_done(r, E_IO, now); return; }
+        if (!r->hdr_end) parse_header(r);
+        else r->body += (uint64_t)n;
+      } else r->body += (uint64_t)n;
+      continue;
+    }
+    if (n == 0) { req_done(r, r->hdr_end ? -1 : E_IO, now); return; }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+    if (errno == EINTR) continue;
+    req_done(r, E_IO, now);
+    return;
+  }
+}
+
+/* --- /metrics sampling -------------------------------------------------------- */
+
+typedef struct { char name[160]; double first, last; } metric_t;
+static metric_t *g_metrics;
+static size_t g_nmetrics, g_capmetrics;
+static int g_nsamples;
+static FILE *g_metrics_fp;
+static int64_t g_t0;
+
+static metric_t *metric_slot(const char *name) {
+  for (size_t i = 0; i < g_nmetrics; i++) if (strcmp(g_metrics[i].name, name) == 0) return &g_metrics[i];
+  if (g_nmetrics == g_capmetrics) {
+    size_t nc = g_capmetrics ? g_capmetrics * 2 : 64;
+    metric_t *nm = realloc(g_metrics, nc * sizeof(*nm));
+    if (!nm) return NULL;
+    g_metrics = nm; g_capmetrics = nc;
+  }
+  metric_t *m = &g_metrics[g_nmetrics++];
+  snprintf(m->name, sizeof(m->name), "%s", name);
+  m->first = NAN;
+  return m;
+}
+
+static void on_metrics(req_t *r, int64_t now) {
+  if (r->status != 200 || !r->hdr_end) return;
+  double t = (double)(now - g_t0) / 1e9;
+  g_nsamples++;
+  for (char *line = r->in + r->hdr_end, *nl; line && *line; line = nl) {
+    nl = strchr(line, '\n');
+    if (nl) *nl++ = 0;
+    if (*line == '#' || strncmp(line, g_metrics_match, strlen(g_metrics_match)) != 0) continue;
+    char *sp = strrchr(line, ' ');
+    if (!sp) continue;
+    *sp = 0;
+    double v = strtod(sp + 1, NULL);
+    metric_t *m = metric_slot(line);
+    if (!m) continue;
+    if (isnan(m->first)) m->first = v;
+    m->last = v;
+    if (g_metrics_fp) fprintf(g_metrics_fp, "%.3f %s %.17g\n", t, line, v);
+  }
+}
+
+/* --- report ------------------------------------------------------------------- */
+
+static int cmp_u32(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  return x < y ? -1 : x > y;
+}
+
+static double pct(const uint32_t *v, size_t n, double q) {
+  if (!n) return 0;
+  size_t i = (size_t)ceil(q * (double)n);
+  if (i) i--;
+  if (i >= n) i = n - 1;
+  return v[i] / 1000.0;
+}
+
+static void report_line(const char *name, path_t *p, double secs) {
+  qsort(p->lat_us, p->nlat, sizeof(*p->lat_us), cmp_u32);
+  uint64_t errs = 0;
+  for (int e = 0; e < E_COUNT; e++) errs += p->err[e];
+  printf("%-22s %8llu %8llu %7llu %9.2f %9.2f %9.2f %9.2f %9.2f %9.1f %11.1f\n", name,
+         (unsigned long long)p->sent, (unsigned long long)p->ok, (unsigned long long)errs,
+         pct(p->lat_us, p->nlat, 0.50), pct(p->lat_us, p->nlat, 0.90), pct(p->lat_us, p->nlat, 0.99),
+         pct(p->lat_us, p->nlat, 0.999), p->nlat ? p->lat_us[p->nlat - 1] / 1000.0 : 0.0,
+         (double)p->ok / secs, (double)p->bytes / 1024.0 / secs);
+}
+
+static void report(double secs) {
+  path_t total; memset(&total, 0, sizeof(total));
+  for (int i = 0; i < g_npaths; i++) {
+    path_t *p = &g_paths[i];
+    total.sent += p->sent; total.ok += p->ok; total.bytes += p->bytes;
+    for (int e = 0; e < E_COUNT; e++) total.err[e] += p->err[e];
+    for (size_t k = 0; k < p->nlat; k++) record(&total, (int64_t)p->lat_us[k] * 1000);
+  }
+  printf("target %s, %.1f req/s %s for %.1f s\n", g_url, g_rate, g_poisson ? "(poisson)" : "(constant)", secs);
+  printf("%-22s %8s %8s %7s %9s %9s %9s %9s %9s %9s %11s\n", "path", "sent", "ok", "err",
+         "p50 ms", "p90 ms", "p99 ms", "p99.9 ms", "max ms", "ok/s", "KiB/s");
+  for (int i = 0; i < g_npaths; i++) report_line(g_paths[i].path, &g_paths[i], secs);
+  report_line("total", &total, secs);
+  printf("bytes %llu", (unsigned long long)total.bytes);
+  for (int e = 0; e < E_COUNT; e++) printf(", %s %llu", k_err_names[e], (unsigned long long)total.err[e]);
+  printf("\n");
+  free(total.lat_us);
+
+  if (g_nsamples) {
+    int w = 0;
+    for (size_t i = 0; i < g_nmetrics; i++)
+      if (g_metrics[i].first != g_metrics[i].last && (int)strlen(g_metrics[i].name) > w) w = (int)strlen(g_metrics[i].name);
+    printf("/metrics: %d samples; counters that moved (first -> last):\n", g_nsamples);
+    for (size_t i = 0; i < g_nmetrics; i++) {
+      metric_t *m = &g_metrics[i];
+      if (m->first != m->last) printf("  %-*s %14.6g -> %-14.6g (%+.6g)\n", w, m->name, m->first, m->last, m->last - m->first);
+    }
+  }
+}
+
+/* --- main --------------------------------------------------------------------- */
+
+static void on_signal(int sig) { (void)sig; g_stop = 1; }
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "  --url URL            server base (default http://127.0.0.1:11080)\n"
+          "  --rate R             requests started per second (default 15)\n"
+          "  --duration S         seconds of load (default 30)\n"
+          "  --poisson            exponential gaps instead of even spacing\n"
+          "  --mix LIST           path=weight,... (default %s)\n"
+          "  --max-inflight N     arrivals beyond N open requests count as overload (default 1000)\n"
+          "  --timeout-ms MS      per request, from its scheduled start (default 10000)\n"
+          "  --metrics-every S    sample /metrics every S seconds\n"
+          "  --metrics-match P    metric name prefix to keep (default olsrd_status_)\n"
+          "  --metrics-out FILE   write every sample as \"t_s name value\"\n"
+          "  --seed N             path mix / arrival seed (default 1)\n",
+          argv0, g_mix);
+}
+
+int main(int argc, char **argv) {
+  static const struct option opts[] = {
+    { "url", required_argument, NULL, 'u' },
+    { "rate", required_argument, NULL, 'r' },
+    { "duration", required_argument, NULL, 'd' },
+    { "poisson", no_argument, NULL, 'p' },
+    { "mix", required_argument, NULL, 'm' },
+    { "max-inflight", required_argument, NULL, 'c' },
+    { "timeout-ms", required_argument, NULL, 't' },
+    { "metrics-every", required_argument, NULL, 'M' },
+    { "metrics-match", required_argument, NULL, 'P' },
+    { "metrics-out", required_argument, NULL, 'o' },
+    { "seed", required_argument, NULL, 's' },
+    { "help", no_argument, NULL, 'h' },
+    { NULL, 0, NULL, 0 },
+  };
+  int o;
+  while ((o = getopt_long(argc, argv, "u:r:d:pm:c:t:s:h", opts, NULL)) != -1) {
+    switch (o) {
+      case 'u': g_url = optarg; break;
+      case 'r': g_rate = atof(optarg); break;
+      case 'd': g_duration = atof(optarg); break;
+      case 'p': g_poisson = 1; break;
+      case 'm': g_mix = optarg; break;
+      case 'c': g_max_inflight = atoi(optarg); break;
+      case 't': g_timeout_ms = atoi(optarg); break;
+      case 'M': g_metrics_every = atof(optarg); break;
+      case 'P': g_metrics_match = optarg; break;
+      case 'o': g_metrics_out = optarg; break;
+      case 's': g_seed = strtoul(optarg, NULL, 10); break;
+      default: usage(argv[0]); return o == 'h' ? 0 : 2;
+    }
+  }
+  if (g_rate <= 0 || g_duration <= 0 || g_max_inflight < 1) { usage(argv[0]); return 2; }
+  if (parse_mix(g_mix) != 0) { fprintf(stderr, "loadgen: bad --mix '%s'\n", g_mix); return 2; }
+  if (parse_url(g_url) != 0) { fprintf(stderr, "loadgen: cannot resolve '%s'\n", g_url); return 2; }
+  if (g_metrics_out && !(g_metrics_fp = fopen(g_metrics_out, "w"))) { perror(g_metrics_out); return 2; }
+  g_rng = g_seed;
+
+  signal(SIGPIPE, SIG_IGN);
+  signal(SIGINT, on_signal);
+  g_ep = epoll_create1(EPOLL_CLOEXEC);
+  if (g_ep < 0) { perror("epoll_create1"); return 1; }
+
+  const double gap_ns = 1e9 / g_rate;
+  g_t0 = now_ns();
+  const int64_t end = g_t0 + (int64_t)(g_duration * 1e9);
+  int64_t next_arrival = g_t0, next_sample = g_metrics_every > 0 ? g_t0 : INT64_MAX;
+  int64_t next_progress = g_t0 + 1000000000;
+  uint64_t started = 0;
+  struct epoll_event evs[256];
+
+  for (;;) {
+    int64_t now = now_ns();
+    int loading = now < end && !g_stop;
+    if (!loading && !g_ninflight) break;
+    /* every arrival that is due, even if the loop itself fell behind */
+    while (loading && next_arrival <= now) {
+      int pi = pick_path();
+      g_paths[pi].sent++; started++;
+      if (g_ninflight >= g_max_inflight) g_paths[pi].err[E_OVERLOAD]++;
+      else start(pi, next_arrival, g_paths[pi].path);
+      next_arrival += (int64_t)(g_poisson ? -log(1.0 - rndf()) * gap_ns : gap_ns);
+    }
+    if (loading && next_sample <= now) {
+      start(-1, now, "/metrics");
+      next_sample = now + (int64_t)(g_metrics_every * 1e9);
+    }
+    if (now >= next_progress) {
+      uint64_t done = 0, errs = 0;
+      for (int i = 0; i < g_npaths; i++) { done += g_paths[i].ok; for (int e = 0; e < E_COUNT; e++) errs += g_paths[i].err[e]; }
+      fprintf(stderr, "t=%.0fs started=%llu ok=%llu err=%llu inflight=%d\n", (double)(now - g_t0) / 1e9,
+              (unsigned long long)started, (unsigned long long)done, (unsigned long long)errs, g_ninflight);
+      next_progress += 1000000000;
+    }
+    for (req_t *r = g_inflight, *nx; r; r = nx) {
+      nx = r->next;
+      if (r->deadline_ns <= now) req_done(r, E_TIMEOUT, now);
+    }
+
+    int64_t wake = loading ? next_arrival : INT64_MAX;
+    if (loading && next_sample < wake) wake = next_sample;
+    if (next_progress < wake) wake = next_progress;
+    for (req_t *r = g_inflight; r; r = r->next) if (r->deadline_ns < wake) wake = r->deadline_ns;
+    int timeout = wake <= now ? 0 : (int)((wake - now + 999999) / 1000000);
+    int n = epoll_wait(g_ep, evs, 256, timeout);
+    if (n < 0 && errno != EINTR) { perror("epoll_wait"); break; }
+    now = now_ns();
+    for (int i = 0; i < n; i++) on_event(evs[i].data.ptr, evs[i].events, now);
+  }
+  double secs = (double)(now_ns() - g_t0) / 1e9;
+  if (secs > g_duration) secs = g_duration;
+  report(secs);
+  if (g_metrics_fp) fclose(g_metrics_fp);
+  return 0;
+}
@@ -0,0 +1,1022 @@
+/* Mock olsrd info server over a synthetic mesh, for load-testing the plugin
+ * without a real olsrd behind it.
+ *
+ * The mesh is grown by preferential attachment (most nodes bring one to
+ * three links, a few hubs end up with dozens), every link gets LQ/NLQ, a
+ * share of the nodes announce HNA subnets, and the node DB names all of it.
+ * Routes are the local node's ETX shortest paths. Served as:
+ *
+ *   jsoninfo  :9090  /links /neighbors /routes /topology /hna /mid /interfaces
+ *                    /gateways /version /all, or several joined (/links/routes)
+ *   txtinfo   :2006  /links /neigh /routes /topology /hna /mid /ver /all
+ *   node DB   :8099  any path: {"<ip>":{"n":..,"i":..,"d":..[,"h":..]},..}
+ *
+ * Every response is held for --latency-ms plus a uniform 0..--jitter-ms.
+ * --churn re-rolls that fraction of the links once a second (a tenth of them
+ * go down for 5-30 s instead) and recomputes routes and topology. --fail-rate
+ * answers that fraction of requests with one of --fail-modes: reset (RST, no
+ * reply), error (503), truncate (half the promised body) or stall (held for
+ * --stall-ms, then closed without a reply).
+ *
+ *   make mock_olsrd && build/mock_olsrd --nodes 5000 --jitter-ms 20 --churn 0.01
+ *   OLSRD_STATUS_PLUGIN_NODEDB_URL=http://127.0.0.1:8099/node_db.json olsrd -d 0 ...
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include "json_writer.h"
+
+/* --- options ------------------------------------------------------------ */
+
+static int g_nodes = 200;
+static int g_local_degree = 12;
+static double g_hna_frac = 0.3;
+static unsigned long g_seed = 1;
+static const char *g_bind = "127.0.0.1";
+static int g_port_json = 9090, g_port_txt = 2006, g_port_ndb = 8099;
+static int g_latency_ms, g_jitter_ms, g_stall_ms = 5000;
+static double g_churn, g_fail_rate;
+static unsigned g_fail_modes = 0xf;
+static int g_stats_s = 10;
+
+enum { FAIL_RESET = 1, FAIL_ERROR = 2, FAIL_TRUNCATE = 4, FAIL_STALL = 8 };
+static const char *const k_fail_names[] = { "reset", "error", "truncate", "stall" };
+
+/* --- rng (splitmix64; one stream for the mesh, one for the serving side) - */
+
+static uint64_t g_mesh_rng, g_serve_rng;
+
+static uint64_t rnd64(uint64_t *s) {
+  uint64_t z = (*s += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+static double rndf(uint64_t *s) { return (double)(rnd64(s) >> 11) / 9007199254740992.0; }
+static unsigned rndn(uint64_t *s, unsigned n) { return n ? (unsigned)(rnd64(s) % n) : 0; }
+
+/* --- mesh ----------------------------------------------------------------- */
+
+#define MAX_HNA 4
+
+typedef struct {
+  uint32_t ip;                 /* host order */
+  int hna_n;
+  uint32_t hna[MAX_HNA];       /* /28 subnets, host order */
+  char name[24];
+} node_t;
+
+typedef struct {
+  int a, b;
+  double lq_ab, lq_ba;         /* hello quality a hears from b, and b from a */
+  int up;
+  int back_at;                 /* churn tick a flapped link comes back */
+} edge_t;
+
+static node_t *g_node;
+static edge_t *g_edge;
+static int g_nedges;
+static int *g_adj_off, *g_adj;  /* CSR: edge indices per node */
+static int g_local;
+
+/* shortest-path state, recomputed on churn */
+static double *g_dist;
+static int *g_hops, *g_first_hop;  /* first hop: neighbour node index */
+
+static void ip_str(uint32_t ip, char *dst) {
+  sprintf(dst, "%u.%u.%u.%u", ip >> 24, (ip >> 16) & 255, (ip >> 8) & 255, ip & 255);
+}
+
+static double roll_lq(void) {
+  /* mostly good links, a long tail of poor ones */
+  double u = rndf(&g_mesh_rng);
+  double q = 1.0 - 0.7 * u * u * u;
+  return (double)(int)(q * 1000.0 + 0.5) / 1000.0;
+}
+
+static double edge_etx(const edge_t *e) {
+  double p = e->lq_ab * e->lq_ba;
+  return p > 0 ? 1.0 / p : 1e9;
+}
+
+static const char *const k_words[] = {
+  "bruno", "donau", "falke", "goodcars", "hof", "kirche", "lager", "markt", "nord", "ost",
+  "park", "rathaus", "schule", "sued", "turm", "west", "wien", "zentrum", "berg", "gasse",
+};
+
+static void mesh_generate(void) {
+  int n = g_nodes;
+  g_node = calloc((size_t)n, sizeof(*g_node));
+  /* at most six links per joining node */
+  size_t emax = (size_t)n * 6;
+  g_edge = calloc(emax, sizeof(*g_edge));
+  int *ends = malloc(emax * 2 * sizeof(int)); /* each edge endpoint once: degree-weighted pick */
+  size_t nends = 0;
+  int *deg = calloc((size_t)n, sizeof(int));
+
+  for (int i = 0; i < n; i++) {
+    node_t *nd = &g_node[i];
+    nd->ip = (10u << 24) | ((uint32_t)(1 + i / 250) << 16) | ((uint32_t)(1 + i % 250) << 8) | 1u;
+    snprintf(nd->name, sizeof(nd->name), "%d%s", 1000 + i % 9000, k_words[rndn(&g_mesh_rng, sizeof(k_words) / sizeof(k_words[0]))]);
+    if (rndf(&g_mesh_rng) < g_hna_frac) {
+      nd->hna_n = 1 + (int)rndn(&g_mesh_rng, MAX_HNA);
+      for (int k = 0; k < nd->hna_n; k++) nd->hna[k] = (172u << 24 | 16u << 16) + (uint32_t)(i * MAX_HNA + k) * 16u;
+    }
+    if (i == 0) continue;
+    /* 45% leaves, 35% two links, 14% three, the rest four to six */
+    double u = rndf(&g_mesh_rng);
+    int m = u < 0.45 ? 1 : u < 0.80 ? 2 : u < 0.94 ? 3 : 4 + (int)rndn(&g_mesh_rng, 3);
+    if (m > i) m = i;
+    int picked[6], np = 0;
+    for (int tries = 0; np < m && tries < 64; tries++) {
+      int t = nends ? ends[rndn(&g_mesh_rng, (unsigned)nends)] : 0;
+      /* a little uniform attachment keeps the hubs realistic */
+      if (rndf(&g_mesh_rng) < 0.3) t = (int)rndn(&g_mesh_rng, (unsigned)i);
+      int dup = 0;
+      for (int k = 0; k < np; k++) if (picked[k] == t) dup = 1;
+      if (dup) continue;
+      picked[np++] = t;
+      edge_t *e = &g_edge[g_nedges++];
+      e->a = i; e->b = t; e->lq_ab = roll_lq(); e->lq_ba = roll_lq(); e->up = 1;
+      ends[nends++] = i; ends[nends++] = t;
+      deg[i]++; deg[t]++;
+    }
+  }
+  free(ends);
+
+  g_adj_off = calloc((size_t)n + 1, sizeof(int));
+  for (int i = 0; i < n; i++) g_adj_off[i + 1] = g_adj_off[i] + deg[i];
+  g_adj = malloc((size_t)g_adj_off[n] * sizeof(int) + 1);
+  int *fill = calloc((size_t)n, sizeof(int));
+  for (int e = 0; e < g_nedges; e++) {
+    g_adj[g_adj_off[g_edge[e].a] + fill[g_edge[e].a]++] = e;
+    g_adj[g_adj_off[g_edge[e].b] + fill[g_edge[e].b]++] = e;
+  }
+  free(fill);
+
+  /* the local node: the one whose degree is closest to --local-degree */
+  g_local = 0;
+  for (int i = 1; i < n; i++)
+    if (abs(deg[i] - g_local_degree) < abs(deg[g_local] - g_local_degree)) g_local = i;
+  free(deg);
+
+  g_dist = malloc((size_t)n * sizeof(double));
+  g_hops = malloc((size_t)n * sizeof(int));
+  g_first_hop = malloc((size_t)n * sizeof(int));
+}
+
+static int other_end(const edge_t *e, int v) { return e->a == v ? e->b : e->a; }
+/* quality v hears from the other end, and the other end from v */
+static double lq_at(const edge_t *e, int v) { return e->a == v ? e->lq_ab : e->lq_ba; }
+static double nlq_at(const edge_t *e, int v) { return e->a == v ? e->lq_ba : e->lq_ab; }
+
+/* binary heap of (dist, node) for Dijkstra */
+typedef struct { double d; int v; } hent_t;
+
+static void heap_push(hent_t *h, int *n, hent_t x) {
+  int i = (*n)++;
+  while (i > 0) {
+    int p = (i - 1) / 2;
+    if (h[p].d <= x.d) break;
+    h[i] = h[p]; i = p;
+  }
+  h[i] = x;
+}
+
+static hent_t heap_pop(hent_t *h, int *n) {
+  hent_t top = h[0], x = h[--(*n)];
+  if (!*n) return top;
+  int i = 0;
+  for (;;) {
+    int c = 2 * i + 1;
+    if (c >= *n) break;
+    if (c + 1 < *n && h[c + 1].d < h[c].d) c++;
+    if (x.d <= h[c].d) break;
+    h[i] = h[c]; i = c;
+  }
+  h[i] = x;
+  return top;
+}
+
+static void mesh_routes(void) {
+  int n = g_nodes;
+  for (int i = 0; i < n; i++) { g_dist[i] = -1; g_hops[i] = 0; g_first_hop[i] = -1; }
+  hent_t *h = malloc(((size_t)g_nedges * 2 + 1) * sizeof(*h));
+  int hn = 0;
+  double *best = malloc((size_t)n * sizeof(double));
+  for (int i = 0; i < n; i++) best[i] = 1e300;
+  best[g_local] = 0;
+  heap_push(h, &hn, (hent_t){ 0, g_local });
+  while (hn) {
+    hent_t x = heap_pop(h, &hn);
+    if (g_dist[x.v] >= 0) continue;
+    g_dist[x.v] = x.d;
+    for (int k = g_adj_off[x.v]; k < g_adj_off[x.v + 1]; k++) {
+      const edge_t *e = &g_edge[g_adj[k]];
+      if (!e->up) continue;
+      int w = other_end(e, x.v);
+      double nd = x.d + edge_etx(e);
+      if (g_dist[w] >= 0 || nd >= best[w]) continue;
+      best[w] = nd;
+      g_hops[w] = g_hops[x.v] + 1;
+      g_first_hop[w] = x.v == g_local ? w : g_first_hop[x.v];
+      heap_push(h, &hn, (hent_t){ nd, w });
+    }
+  }
+  free(best);
+  free(h);
+}
+
+static int g_churn_down, g_churn_up, g_churn_lq, g_tick;
+
+static void mesh_churn(void) {
+  int changed = 0;
+  g_tick++;
+  for (int e = 0; e < g_nedges; e++)
+    if (!g_edge[e].up && g_edge[e].back_at <= g_tick) { g_edge[e].up = 1; g_churn_up++; changed = 1; }
+  int k = (int)(g_churn * g_nedges + rndf(&g_mesh_rng)); /* fractional part by chance */
+  for (int i = 0; i < k; i++) {
+    edge_t *e = &g_edge[rndn(&g_mesh_rng, (unsigned)g_nedges)];
+    if (!e->up) continue;
+    if (rndf(&g_mesh_rng) < 0.1) {
+      /* down for 5 to 30 seconds */
+      e->up = 0;
+      e->back_at = g_tick + 5 + (int)rndn(&g_mesh_rng, 26);
+      g_churn_down++;
+    } else {
+      e->lq_ab = roll_lq(); e->lq_ba = roll_lq();
+      g_churn_lq++;
+    }
+    changed = 1;
+  }
+  if (changed) mesh_routes();
+}
+
+static const char *intf_of(int nb) {
+  static const char *const ifs[] = { "wlan0", "wlan1", "eth0", "eth1.1100" };
+  return ifs[(unsigned)nb % 4];
+}
+
+/* --- bodies ----------------------------------------------------------------
+ * Built once per mesh generation. The jsoninfo sections are kept as member
+ * fragments ("links":[...]) and joined per request; txtinfo tables and the
+ * node DB are complete bodies.
+ */
+
+enum { S_LINKS, S_NEIGHBORS, S_ROUTES, S_TOPOLOGY, S_HNA, S_MID, S_INTERFACES, S_GATEWAYS, S_VERSION, S_COUNT };
+static const char *const k_json_sections[S_COUNT] = {
+  "links", "neighbors", "routes", "topology", "hna", "mid", "interfaces", "gateways", "version",
+};
+/* txtinfo table names, same order (interfaces/gateways have no table here) */
+static const char *const k_txt_sections[S_COUNT] = {
+  "links", "neigh", "routes", "topology", "hna", "mid", NULL, NULL, "ver",
+};
+
+typedef struct { char *p; size_t n; } blob_t;
+static blob_t g_json[S_COUNT], g_txt[S_COUNT], g_ndb;
+static unsigned g_generation;
+static time_t g_started;
+
+static void blob_set(blob_t *b, char *p, size_t n) { free(b->p); b->p = p; b->n = n; }
+
+static void jw_ip(jw_t *w, uint32_t ip) { char s[16]; ip_str(ip, s); jw_str(w, s); }
+
+static void members_begin(jw_t *w, const char *key) {
+  jw_init(w, 4096);
+  jw_begin_obj(w);   /* dropped again below: only the member is kept */
+  jw_key(w, key);
+}
+
+static void members_end(jw_t *w, blob_t *dst) {
+  char *p; size_t n;
+  jw_end_obj(w);
+  if (jw_finish(w, &p, &n, NULL) != 0) { fprintf(stderr, "mock_olsrd: out of memory\n"); exit(1); }
+  /* strip the surrounding braces */
+  memmove(p, p + 1, n - 2);
+  p[n - 2] = 0;
+  blob_set(dst, p, n - 2);
+}
+
+static void build_json(void) {
+  jw_t w;
+  const int L = g_local;
+  char ls[16]; ip_str(g_node[L].ip, ls);
+
+  members_begin(&w, "links");
+  jw_begin_arr(&w);
+  for (int k = g_adj_off[L]; k < g_adj_off[L + 1]; k++) {
+    const edge_t *e = &g_edge[g_adj[k]];
+    if (!e->up) continue;
+    int nb = other_end(e, L);
+    jw_begin_obj(&w);
+    JW_KEY(&w, "localIP"); jw_str(&w, ls);
+    JW_KEY(&w, "remoteIP"); jw_ip(&w, g_node[nb].ip);
+    JW_KEY(&w, "olsrInterface"); jw_str(&w, intf_of(nb));
+    JW_KEY(&w, "ifName"); jw_str(&w, intf_of(nb));
+    JW_KEY(&w, "validityTime"); jw_u64(&w, 39000 + rndn(&g_mesh_rng, 1000));
+    JW_KEY(&w, "symmetryTime"); jw_u64(&w, 39000 + rndn(&g_mesh_rng, 1000));
+    JW_KEY(&w, "asymmetryTime"); jw_u64(&w, 39000 + rndn(&g_mesh_rng, 1000));
+    JW_KEY(&w, "vtime"); jw_u64(&w, 40000);
+    JW_KEY(&w, "currentLinkStatus"); jw_str(&w, "SYMMETRIC");
+    JW_KEY(&w, "previousLinkStatus"); jw_str(&w, "SYMMETRIC");
+    JW_KEY(&w, "hysteresis"); jw_u64(&w, 0);
+    JW_KEY(&w, "pending"); jw_bool(&w, 0);
+    JW_KEY(&w, "lostLinkTime"); jw_u64(&w, 0);
+    JW_KEY(&w, "helloTime"); jw_u64(&w, 0);
+    JW_KEY(&w, "lastHelloTime"); jw_u64(&w, 0);
+    JW_KEY(&w, "seqnoValid"); jw_bool(&w, 0);
+    JW_KEY(&w, "seqno"); jw_u64(&w, 0);
+    JW_KEY(&w, "lossHelloInterval"); jw_u64(&w, 2000);
+    JW_KEY(&w, "lossTime"); jw_u64(&w, 4000);
+    JW_KEY(&w, "lossMultiplier"); jw_u64(&w, 65536);
+    JW_KEY(&w, "linkCost"); jw_fixed(&w, edge_etx(e), 3);
+    JW_KEY(&w, "linkQuality"); jw_fixed(&w, lq_at(e, L), 3);
+    JW_KEY(&w, "neighborLinkQuality"); jw_fixed(&w, nlq_at(e, L), 3);
+    jw_end_obj(&w);
+  }
+  jw_end_arr(&w);
+  members_end(&w, &g_json[S_LINKS]);
+
+  members_begin(&w, "neighbors");
+  jw_begin_arr(&w);
+  for (int k = g_adj_off[L]; k < g_adj_off[L + 1]; k++) {
+    const edge_t *e = &g_edge[g_adj[k]];
+    if (!e->up) continue;
+    int nb = other_end(e, L);
+    int n2 = 0;
+    for (int j = g_adj_off[nb]; j < g_adj_off[nb + 1]; j++)
+      if (g_edge[g_adj[j]].up && other_end(&g_edge[g_adj[j]], nb) != L) n2++;
+    jw_begin_obj(&w);
+    JW_KEY(&w, "ipAddress"); jw_ip(&w, g_node[nb].ip);
+    JW_KEY(&w, "symmetric"); jw_bool(&w, 1);
+    JW_KEY(&w, "willingness"); jw_u64(&w, 3);
+    JW_KEY(&w, "isMultiPointRelay"); jw_bool(&w, n2 > 2);
+    JW_KEY(&w, "wasMultiPointRelay"); jw_bool(&w, n2 > 2);
+    JW_KEY(&w, "multiPointRelaySelector"); jw_bool(&w, n2 > 0);
+    JW_KEY(&w, "skip"); jw_bool(&w, 0);
+    JW_KEY(&w, "neighbor2nocov"); jw_u64(&w, 0);
+    JW_KEY(&w, "twoHopNeighborCount"); jw_u64(&w, (uint64_t)n2);
+    JW_KEY(&w, "twoHopNeighbors"); jw_begin_arr(&w);
+    for (int j = g_adj_off[nb]; j < g_adj_off[nb + 1]; j++) {
+      const edge_t *e2 = &g_edge[g_adj[j]];
+      int t = other_end(e2, nb);
+      if (!e2->up || t == L) continue;
+      jw_begin_obj(&w); JW_KEY(&w, "ipAddress"); jw_ip(&w, g_node[t].ip); jw_end_obj(&w);
+    }
+    jw_end_arr(&w);
+    jw_end_obj(&w);
+  }
+  jw_end_arr(&w);
+  members_end(&w, &g_json[S_NEIGHBORS]);
+
+  members_begin(&w, "routes");
+  jw_begin_arr(&w);
+  for (int v = 0; v < g_nodes; v++) {
+    if (v == L || g_dist[v] < 0) continue;
+    const node_t *nd = &g_node[v];
+    for (int k = -1; k < nd->hna_n; k++) {
+      jw_begin_obj(&w);
+      JW_KEY(&w, "destination"); jw_ip(&w, k < 0 ? nd->ip : nd->hna[k]);
+      JW_KEY(&w, "genmask"); jw_u64(&w, k < 0 ? 32 : 28);
+      JW_KEY(&w, "gateway"); jw_ip(&w, g_node[g_first_hop[v]].ip);
+      JW_KEY(&w, "metric"); jw_u64(&w, (uint64_t)g_hops[v]);
+      JW_KEY(&w, "etx"); jw_fixed(&w, g_dist[v], 3);
+      JW_KEY(&w, "rtpMetricCost"); jw_u64(&w, (uint64_t)(g_dist[v] * 1024.0));
+      JW_KEY(&w, "networkInterface"); jw_str(&w, intf_of(g_first_hop[v]));
+      jw_end_obj(&w);
+    }
+  }
+  jw_end_arr(&w);
+  members_end(&w, &g_json[S_ROUTES]);
+
+  /* every reachable node advertises its symmetric neighbours */
+  members_begin(&w, "topology");
+  jw_begin_arr(&w);
+  for (int v = 0; v < g_nodes; v++) {
+    if (v == L || g_dist[v] < 0) continue;
+    for (int k = g_adj_off[v]; k < g_adj_off[v + 1]; k++) {
+      const edge_t *e = &g_edge[g_adj[k]];
+      if (!e->up) continue;
+      jw_begin_obj(&w);
+      JW_KEY(&w, "lastHopIP"); jw_ip(&w, g_node[v].ip);
+      JW_KEY(&w, "destinationIP"); jw_ip(&w, g_node[other_end(e, v)].ip);
+      JW_KEY(&w, "linkQuality"); jw_fixed(&w, lq_at(e, v), 3);
+      JW_KEY(&w, "neighborLinkQuality"); jw_fixed(&w, nlq_at(e, v), 3);
+      JW_KEY(&w, "tcEdgeCost"); jw_u64(&w, (uint64_t)(edge_etx(e) * 1024.0));
+      JW_KEY(&w, "refreshTimer"); jw_u64(&w, 0);
+      JW_KEY(&w, "validityTime"); jw_u64(&w, 280000 + rndn(&g_mesh_rng, 20000));
+      jw_end_obj(&w);
+    }
+  }
+  jw_end_arr(&w);
+  members_end(&w, &g_json[S_TOPOLOGY]);
+
+  members_begin(&w, "hna");
+  jw_begin_arr(&w);
+  for (int v = 0; v < g_nodes; v++) {
+    if (g_dist[v] < 0) continue;
+    for (int k = 0; k < g_node[v].hna_n; k++) {
+      jw_begin_obj(&w);
+      JW_KEY(&w, "destination"); jw_ip(&w, g_node[v].hna[k]);
+      JW_KEY(&w, "genmask"); jw_u64(&w, 28);
+      JW_KEY(&w, "gateway"); jw_ip(&w, g_node[v].ip);
+      JW_KEY(&w, "validityTime"); jw_u64(&w, 280000 + rndn(&g_mesh_rng, 20000));
+      jw_end_obj(&w);
+    }
+  }
+  jw_end_arr(&w);
+  members_end(&w, &g_json[S_HNA]);
+
+  members_begin(&w, "mid"); jw_begin_arr(&w); jw_end_arr(&w); members_end(&w, &g_json[S_MID]);
+  members_begin(&w, "gateways"); jw_begin_arr(&w); jw_end_arr(&w); members_end(&w, &g_json[S_GATEWAYS]);
+
+  members_begin(&w, "interfaces");
+  jw_begin_arr(&w);
+  for (int i = 0; i < 4; i++) {
+    const char *ifn = intf_of(i);
+    jw_begin_obj(&w);
+    JW_KEY(&w, "name"); jw_str(&w, ifn);
+    JW_KEY(&w, "configured"); jw_bool(&w, 1);
+    JW_KEY(&w, "hostEmulation"); jw_bool(&w, 0);
+    JW_KEY(&w, "olsrInterface"); jw_begin_obj(&w);
+    JW_KEY(&w, "up"); jw_bool(&w, 1);
+    JW_KEY(&w, "ipAddress"); jw_str(&w, ls);
+    jw_end_obj(&w);
+    jw_end_obj(&w);
+  }
+  jw_end_arr(&w);
+  members_end(&w, &g_json[S_INTERFACES]);
+
+  members_begin(&w, "version");
+  jw_begin_obj(&w);
+  JW_KEY(&w, "version"); jw_str(&w, "olsr.org - 0.9.8-mock");
+  JW_KEY(&w, "globalVersion"); jw_str(&w, "olsr.org - 0.9.8-mock");
+  JW_KEY(&w, "buildDate"); jw_str(&w, "2025-01-01 00:00:00");
+  JW_KEY(&w, "buildHost"); jw_str(&w, "mock_olsrd");
+  jw_end_obj(&w);
+  members_end(&w, &g_json[S_VERSION]);
+}
+
+/* printf into a growing buffer, for the txtinfo tables */
+typedef struct { char *p; size_t n, cap; } tbuf_t;
+
+__attribute__((format(printf, 2, 3)))
+static void tb_printf(tbuf_t *b, const char *fmt, ...) {
+  for (;;) {
+    va_list ap;
+    va_start(ap, fmt);
+    int k = vsnprintf(b->p + b->n, b->cap - b->n, fmt, ap);
+    va_end(ap);
+    if (k < 0) return;
+    if ((size_t)k < b->cap - b->n) { b->n += (size_t)k; return; }
+    b->cap = (b->cap + (size_t)k + 1) * 2;
+    b->p = realloc(b->p, b->cap);
+    if (!b->p) { fprintf(stderr, "mock_olsrd: out of memory\n"); exit(1); }
+  }
+}
+
+static void tb_begin(tbuf_t *b, const char *title) {
+  b->cap = 4096; b->n = 0; b->p = malloc(b->cap);
+  if (!b->p) { fprintf(stderr, "mock_olsrd: out of memory\n"); exit(1); }
+  b->p[0] = 0;
+  tb_printf(b, "Table: %s\n", title);
+}
+
+static void tb_end(tbuf_t *b, blob_t *dst) { tb_printf(b, "\n"); blob_set(dst, b->p, b->n); }
+
+static void build_txt(void) {
+  const int L = g_local;
+  char a[16], c[16];
+  tbuf_t b;
+
+  tb_begin(&b, "Links");
+  tb_printf(&b, "Local IP\tRemote IP\tHyst.\tLQ\tNLQ\tCost\n");
+  ip_str(g_node[L].ip, a);
+  for (int k = g_adj_off[L]; k < g_adj_off[L + 1]; k++) {
+    const edge_t *e = &g_edge[g_adj[k]];
+    if (!e->up) continue;
+    ip_str(g_node[other_end(e, L)].ip, c);
+    tb_printf(&b, "%s\t%s\t0.00\t%.3f\t%.3f\t%.3f\n", a, c, lq_at(e, L), nlq_at(e, L), edge_etx(e));
+  }
+  tb_end(&b, &g_txt[S_LINKS]);
+
+  tb_begin(&b, "Neighbors");
+  tb_printf(&b, "IP address\tSYM\tMPR\tMPRS\tWill.\t2 Hop Neighbors\n");
+  for (int k = g_adj_off[L]; k < g_adj_off[L + 1]; k++) {
+    const edge_t *e = &g_edge[g_adj[k]];
+    if (!e->up) continue;
+    int nb = other_end(e, L), n2 = 0;
+    for (int j = g_adj_off[nb]; j < g_adj_off[nb + 1]; j++)
+      if (g_edge[g_adj[j]].up && other_end(&g_edge[g_adj[j]], nb) != L) n2++;
+    ip_str(g_node[nb].ip, c);
+    tb_printf(&b, "%s\tYES\t%s\t%s\t3\t%d\n", c, n2 > 2 ? "YES" : "NO", n2 > 0 ? "YES" : "NO", n2);
+  }
+  tb_end(&b, &g_txt[S_NEIGHBORS]);
+
+  tb_begin(&b, "Topology");
+  tb_printf(&b, "Dest. IP\tLast hop IP\tLQ\tNLQ\tCost\n");
+  for (int v = 0; v < g_nodes; v++) {
+    if (v == L || g_dist[v] < 0) continue;
+    ip_str(g_node[v].ip, a);
+    for (int k = g_adj_off[v]; k < g_adj_off[v + 1]; k++) {
+      const edge_t *e = &g_edge[g_adj[k]];
+      if (!e->up) continue;
+      ip_str(g_node[other_end(e, v)].ip, c);
+      tb_printf(&b, "%s\t%s\t%.3f\t%.3f\t%.3f\n", c, a, lq_at(e, v), nlq_at(e, v), edge_etx(e));
+    }
+  }
+  tb_end(&b, &g_txt[S_TOPOLOGY]);
+
+  tb_begin(&b, "HNA");
+  tb_printf(&b, "Destination\tGateway\n");
+  for (int v = 0; v < g_nodes; v++) {
+    if (g_dist[v] < 0) continue;
+    ip_str(g_node[v].ip, c);
+    for (int k = 0; k < g_node[v].hna_n; k++) { ip_str(g_node[v].hna[k], a); tb_printf(&b, "%s/28\t%s\n", a, c); }
+  }
+  tb_end(&b, &g_txt[S_HNA]);
+
+  tb_begin(&b, "MID");
+  tb_printf(&b, "IP address\tAliases\n");
+  tb_end(&b, &g_txt[S_MID]);
+
+  tb_begin(&b, "Routes");
+  tb_printf(&b, "Destination\tGateway IP\tMetric\tETX\tInterface\n");
+  for (int v = 0; v < g_nodes; v++) {
+    if (v == L || g_dist[v] < 0) continue;
+    ip_str(g_node[g_first_hop[v]].ip, c);
+    for (int k = -1; k < g_node[v].hna_n; k++) {
+      ip_str(k < 0 ? g_node[v].ip : g_node[v].hna[k], a);
+      tb_printf(&b, "%s/%d\t%s\t%d\t%.3f\t%s\n", a, k < 0 ? 32 : 28, c, g_hops[v], g_dist[v], intf_of(g_first_hop[v]));
+    }
+  }
+  tb_end(&b, &g_txt[S_ROUTES]);
+
+  b.cap = 256; b.n = 0; b.p = malloc(b.cap); b.p[0] = 0;
+  tb_printf(&b, "Version: olsr.org - 0.9.8-mock (built on 2025-01-01 00:00:00 on mock_olsrd)\n");
+  blob_set(&g_txt[S_VERSION], b.p, b.n);
+}
+
+static void build_nodedb(void) {
+  jw_t w;
+  jw_init(&w, (size_t)g_nodes * 64);
+  jw_begin_obj(&w);
+  char ip[16], id[16];
+  for (int v = 0; v < g_nodes; v++) {
+    const node_t *nd = &g_node[v];
+    snprintf(id, sizeof(id), "%d", 100 + v);
+    ip_str(nd->ip, ip);
+    jw_key(&w, ip);
+    jw_begin_obj(&w);
+    JW_KEY(&w, "n"); jw_str(&w, nd->name);
+    JW_KEY(&w, "i"); jw_str(&w, id);
+    JW_KEY(&w, "d"); jw_str(&w, "router");
+    jw_end_obj(&w);
+    for (int k = 0; k < nd->hna_n; k++) {
+      char h[16], d[8];
+      ip_str(nd->hna[k] + 1, h);
+      snprintf(d, sizeof(d), "hna%d", k + 2);
+      jw_key(&w, h);
+      jw_begin_obj(&w);
+      JW_KEY(&w, "n"); jw_str(&w, nd->name);
+      JW_KEY(&w, "i"); jw_str(&w, id);
+      JW_KEY(&w, "d"); jw_str(&w, d);
+      JW_KEY(&w, "h"); jw_str(&w, ip);
+      jw_end_obj(&w);
+    }
+  }
+  jw_end_obj(&w);
+  char *p; size_t n;
+  if (jw_finish(&w, &p, &n, NULL) != 0) { fprintf(stderr, "mock_olsrd: out of memory\n"); exit(1); }
+  blob_set(&g_ndb, p, n);
+}
+
+static void build_bodies(void) {
+  build_json();
+  build_txt();
+  g_generation++;
+}
+
+/* --- serving -------------------------------------------------------------- */
+
+enum { SRV_JSON, SRV_TXT, SRV_NDB };
+
+typedef struct conn {
+  int fd, srv;
+  char in[4096];
+  size_t inlen;
+  int64_t due_ms;      /* > 0 while the reply is being held back */
+  int fail;            /* FAIL_* chosen for this request, or 0 */
+  char *out;
+  size_t outlen, outoff;
+  struct conn *next;   /* held list */
+} conn_t;
+
+static conn_t *g_held;
+static volatile sig_atomic_t g_stop;
+static int g_ep;
+
+static struct {
+  uint64_t requests, bytes, by_fail[4], notfound;
+} g_stats;
+
+static int64_t now_ms(void) {
+  struct timespec t; clock_gettime(CLOCK_MONOTONIC, &t);
+  return (int64_t)t.tv_sec * 1000 + t.tv_nsec / 1000000;
+}
+
+static int listen_on(int port) {
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) return -1;
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  struct sockaddr_in sa; memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET; sa.sin_port = htons((uint16_t)port);
+  if (inet_pton(AF_INET, g_bind, &sa.sin_addr) != 1 || bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0 || listen(fd, 512) < 0) {
+    fprintf(stderr, "mock_olsrd: cannot listen on %s:%d: %s\n", g_bind, port, strerror(errno));
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static void conn_close(conn_t *c, int reset) {
+  if (reset) {
+    struct linger lg = { 1, 0 };
+    setsockopt(c->fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+  }
+  epoll_ctl(g_ep, EPOLL_CTL_DEL, c->fd, NULL);
+  close(c->fd);
+  free(c->out);
+  free(c);
+}
+
+static void held_remove(conn_t *c) {
+  for (conn_t **pp = &g_held; *pp; pp = &(*pp)->next)
+    if (*pp == c) { *pp = c->next; return; }
+}
+
+/* Joins the requested jsoninfo sections (/links/routes, /all) into one body. */
+static int json_body(const char *path, char **out, size_t *outlen) {
+  int want[S_COUNT] = { 0 }, any = 0;
+  char tok[32];
+  const char *p = path;
+  while (*p) {
+    while (*p == '/') p++;
+    size_t n = strcspn(p, "/? ");
+    if (!n) break;
+    snprintf(tok, sizeof(tok), "%.*s", (int)n, p);
+    p += n;
+    if (*p == '?' || *p == ' ') break;
+    if (strcmp(tok, "all") == 0) { for (int s = 0; s < S_COUNT; s++) want[s] = 1; any = 1; continue; }
+    if (strcmp(tok, "neighbours") == 0) snprintf(tok, sizeof(tok), "neighbors");
+    for (int s = 0; s < S_COUNT; s++) if (strcmp(tok, k_json_sections[s]) == 0) { want[s] = 1; any = 1; }
+  }
+  if (!any) return -1;
+  size_t total = 128;
+  for (int s = 0; s < S_COUNT; s++) if (want[s]) total += g_json[s].n + 1;
+  char *b = malloc(total);
+  if (!b) return -1;
+  int n = snprintf(b, total, "{\"pid\":%d,\"systemTime\":%ld,\"timeSinceStartup\":%ld",
+                   (int)getpid(), (long)time(NULL), (long)(time(NULL) - g_started) * 1000);
+  size_t len = (size_t)n;
+  for (int s = 0; s < S_COUNT; s++) {
+    if (!want[s]) continue;
+    b[len++] = ',';
+    memcpy(b + len, g_json[s].p, g_json[s].n); len += g_json[s].n;
+  }
+  b[len++] = '}';
+  *out = b; *outlen = len;
+  return 0;
+}
+
+static int txt_body(const char *path, char **out, size_t *outlen) {
+  int want[S_COUNT] = { 0 }, any = 0;
+  const char *p = path;
+  while (*p == '/') p++;
+  size_t n = strcspn(p, "/? ");
+  if (n == 3 && strncmp(p, "all", 3) == 0) {
+    for (int s = 0; s < S_COUNT; s++) want[s] = s != S_VERSION && k_txt_sections[s] != NULL;
+    any = 1;
+  } else {
+    for (int s = 0; s < S_COUNT; s++)
+      if (k_txt_sections[s] && strlen(k_txt_sections[s]) == n && strncmp(p, k_txt_sections[s], n) == 0) { want[s] = 1; any = 1; }
+    if (n == 9 && strncmp(p, "neighbors", 9) == 0) { want[S_NEIGHBORS] = 1; any = 1; }
+  }
+  if (!any) return -1;
+  size_t total = 1;
+  for (int s = 0; s < S_COUNT; s++) if (want[s]) total += g_txt[s].n;
+  char *b = malloc(total), *q = b;
+  if (!b) return -1;
+  for (int s = 0; s < S_COUNT; s++) if (want[s]) { memcpy(q, g_txt[s].p, g_txt[s].n); q += g_txt[s].n; }
+  *out = b; *outlen = (size_t)(q - b);
+  return 0;
+}
+
+static void respond(conn_t *c) {
+  char path[512] = "/";
+  char *sp = memchr(c->in, ' ', c->inlen);
+  if (sp) {
+    size_t n = strcspn(sp + 1, " \r\n");
+    if (n >= sizeof(path)) n = sizeof(path) - 1;
+    memcpy(path, sp + 1, n); path[n] = 0;
+  }
+  char *body = NULL; size_t blen = 0;
+  int status = 200;
+  const char *ctype = "application/json";
+  char etag[32];
+  snprintf(etag, sizeof(etag), "\"mock-%d-%lu\"", g_nodes, g_seed);
+  if (c->srv == SRV_JSON) {
+    if (json_body(path, &body, &blen) != 0) status = 400;
+  } else if (c->srv == SRV_TXT) {
+    ctype = "text/plain";
+    if (txt_body(path, &body, &blen) != 0) status = 400;
+  } else {
+    /* static node DB: honour conditional GETs like the real mirror does */
+    c->in[c->inlen < sizeof(c->in) ? c->inlen : sizeof(c->in) - 1] = 0;
+    const char *inm = strcasestr(c->in, "\r\nIf-None-Match:");
+    if (inm && strstr(inm, etag)) status = 304;
+    else {
+      body = malloc(g_ndb.n);
+      if (body) { memcpy(body, g_ndb.p, g_ndb.n); blen = g_ndb.n; }
+    }
+  }
+  if (status == 400) g_stats.notfound++;
+  if (c->fail == FAIL_ERROR) { status = 503; free(body); body = NULL; blen = 0; }
+
+  const char *reason = status == 200 ? "OK" : status == 304 ? "Not Modified" : status == 400 ? "Bad Request" : "Service Unavailable";
+  char hdr[256];
+  int hn = snprintf(hdr, sizeof(hdr), "HTTP/1.0 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n%s%s%sConnection: close\r\n\r\n",
+                    status, reason, ctype, blen, c->srv == SRV_NDB ? "ETag: " : "", c->srv == SRV_NDB ? etag : "",
+                    c->srv == SRV_NDB ? "\r\n" : "");
+  size_t send_body = c->fail == FAIL_TRUNCATE ? blen / 2 : blen;
+  c->out = malloc((size_t)hn + send_body + 1);
+  if (!c->out) { free(body); conn_close(c, 1); return; }
+  memcpy(c->out, hdr, (size_t)hn);
+  if (send_body) memcpy(c->out + hn, body, send_body);
+  c->outlen = (size_t)hn + send_body;
+  c->outoff = 0;
+  free(body);
+  struct epoll_event ev = { .events = EPOLLOUT, .data.ptr = c };
+  epoll_ctl(g_ep, EPOLL_CTL_MOD, c->fd, &ev);
+}
+
+static int pick_fail(void) {
+  if (g_fail_rate <= 0 || rndf(&g_serve_rng) >= g_fail_rate) return 0;
+  int modes[4], n = 0;
+  for (int i = 0; i < 4; i++) if (g_fail_modes & (1u << i)) modes[n++] = 1 << i;
+  return n ? modes[rndn(&g_serve_rng, (unsigned)n)] : 0;
+}
+
+static void on_request(conn_t *c) {
+  g_stats.requests++;
+  c->fail = pick_fail();
+  for (int i = 0; i < 4; i++) if (c->fail == 1 << i) g_stats.by_fail[i]++;
+  if (c->fail == FAIL_RESET) { conn_close(c, 1); return; }
+  int64_t delay = g_latency_ms + (g_jitter_ms > 0 ? (int64_t)rndn(&g_serve_rng, (unsigned)g_jitter_ms + 1) : 0);
+  if (c->fail == FAIL_STALL) delay = g_stall_ms;
+  /* stop watching reads until the reply is due */
+  struct epoll_event ev = { .events = 0, .data.ptr = c };
+  epoll_ctl(g_ep, EPOLL_CTL_MOD, c->fd, &ev);
+  if (delay <= 0) { respond(c); return; }
+  c->due_ms = now_ms() + delay;
+  c->next = g_held; g_held = c;
+}
+
+static void on_readable(conn_t *c) {
+  for (;;) {
+    if (c->inlen >= sizeof(c->in) - 1) { on_request(c); return; }
+    ssize_t n = recv(c->fd, c->in + c->inlen, sizeof(c->in) - 1 - c->inlen, 0);
+    if (n > 0) {
+      c->inlen += (size_t)n;
+      c->in[c->inlen] = 0;
+      if (strstr(c->in, "\r\n\r\n") || strstr(c->in, "\n\n")) { on_request(c); return; }
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+    if (n < 0 && errno == EINTR) continue;
+    conn_close(c, 0);
+    return;
+  }
+}
+
+static void on_writable(conn_t *c) {
+  while (c->outoff < c->outlen) {
+    ssize_t n = send(c->fd, c->out + c->outoff, c->outlen - c->outoff, MSG_NOSIGNAL);
+    if (n > 0) { c->outoff += (size_t)n; g_stats.bytes += (uint64_t)n; continue; }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+    if (n < 0 && errno == EINTR) continue;
+    break;
+  }
+  conn_close(c, 0);
+}
+
+static void on_accept(int lfd, int srv) {
+  for (;;) {
+    int fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) return;
+    conn_t *c = calloc(1, sizeof(*c));
+    if (!c) { close(fd); continue; }
+    c->fd = fd; c->srv = srv;
+    struct epoll_event ev = { .events = EPOLLIN | EPOLLRDHUP, .data.ptr = c };
+    if (epoll_ctl(g_ep, EPOLL_CTL_ADD, fd, &ev) < 0) { close(fd); free(c); }
+  }
+}
+
+static void fire_due(int64_t now) {
+  conn_t **pp = &g_held;
+  while (*pp) {
+    conn_t *c = *pp;
+    if (c->due_ms > now) { pp = &c->next; continue; }
+    *pp = c->next;
+    c->due_ms = 0;
+    if (c->fail == FAIL_STALL) conn_close(c, 0);
+    else respond(c);
+  }
+}
+
+static void print_summary(void) {
+  int *deg = calloc((size_t)g_nodes, sizeof(int)), maxd = 0, reach = 0, up = 0, routes = 0, hna = 0;
+  for (int e = 0; e < g_nedges; e++) if (g_edge[e].up) { deg[g_edge[e].a]++; deg[g_edge[e].b]++; up++; }
+  int hist[8] = { 0 };
+  for (int v = 0; v < g_nodes; v++) {
+    if (deg[v] > maxd) maxd = deg[v];
+    hist[deg[v] < 7 ? deg[v] : 7]++;
+    if (g_dist[v] >= 0 && v != g_local) { reach++; routes += 1 + g_node[v].hna_n; }
+    hna += g_node[v].hna_n;
+  }
+  char ip[16]; ip_str(g_node[g_local].ip, ip);
+  fprintf(stderr, "mock_olsrd: %d nodes, %d/%d links up, %d HNA; local %s with %d neighbours; %d reachable, %d routes\n",
+          g_nodes, up, g_nedges, hna, ip, deg[g_local], reach, routes);
+  fprintf(stderr, "mock_olsrd: degree 0:%d 1:%d 2:%d 3:%d 4:%d 5:%d 6:%d 7+:%d max:%d\n",
+          hist[0], hist[1], hist[2], hist[3], hist[4], hist[5], hist[6], hist[7], maxd);
+  fprintf(stderr, "mock_olsrd: bytes links=%zu neighbors=%zu routes=%zu topology=%zu hna=%zu nodedb=%zu\n",
+          g_json[S_LINKS].n, g_json[S_NEIGHBORS].n, g_json[S_ROUTES].n, g_json[S_TOPOLOGY].n, g_json[S_HNA].n, g_ndb.n);
+  free(deg);
+}
+
+static void print_stats(void) {
+  fprintf(stderr, "mock_olsrd: gen=%u requests=%llu bytes=%llu bad_path=%llu reset=%llu error=%llu truncate=%llu stall=%llu churn(lq=%d down=%d up=%d)\n",
+          g_generation, (unsigned long long)g_stats.requests, (unsigned long long)g_stats.bytes, (unsigned long long)g_stats.notfound,
+          (unsigned long long)g_stats.by_fail[0], (unsigned long long)g_stats.by_fail[1],
+          (unsigned long long)g_stats.by_fail[2], (unsigned long long)g_stats.by_fail[3],
+          g_churn_lq, g_churn_down, g_churn_up);
+}
+
+static void on_signal(int sig) { (void)sig; g_stop = 1; }
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "  --nodes N           mesh size (default 200)\n"
+          "  --local-degree D    serve from the node whose degree is closest to D (default 12)\n"
+          "  --hna-frac F        share of nodes announcing 1-4 HNA /28s (default 0.3)\n"
+          "  --seed S            mesh seed (default 1)\n"
+          "  --bind ADDR         listen address (default 127.0.0.1)\n"
+          "  --jsoninfo-port P   (default 9090, 0 disables)\n"
+          "  --txtinfo-port P    (default 2006, 0 disables)\n"
+          "  --nodedb-port P     (default 8099, 0 disables)\n"
+          "  --latency-ms MS     fixed delay before every reply\n"
+          "  --jitter-ms MS      plus a uniform 0..MS\n"
+          "  --churn F           share of links re-rolled per second (a tenth go down for 5-30 s)\n"
+          "  --fail-rate F       share of requests that fail\n"
+          "  --fail-modes LIST   comma list of reset,error,truncate,stall (default all)\n"
+          "  --stall-ms MS       how long a stalled request is held (default 5000)\n"
+          "  --stats-s S         counters to stderr every S seconds (default 10, 0 off)\n",
+          argv0);
+}
+
+static int parse_fail_modes(const char *s) {
+  unsigned m = 0;
+  char buf[128]; snprintf(buf, sizeof(buf), "%s", s);
+  for (char *save = NULL, *t = strtok_r(buf, ",", &save); t; t = strtok_r(NULL, ",", &save)) {
+    int found = 0;
+    for (int i = 0; i < 4; i++) if (strcmp(t, k_fail_names[i]) == 0) { m |= 1u << i; found = 1; }
+    if (!found) return -1;
+  }
+  g_fail_modes = m;
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  static const struct option opts[] = {
+    { "nodes", required_argument, NULL, 'n' },
+    { "local-degree", required_argument, NULL, 'd' },
+    { "hna-frac", required_argument, NULL, 'H' },
+    { "seed", required_argument, NULL, 's' },
+    { "bind", required_argument, NULL, 'b' },
+    { "jsoninfo-port", required_argument, NULL, 'j' },
+    { "txtinfo-port", required_argument, NULL, 't' },
+    { "nodedb-port", required_argument, NULL, 'N' },
+    { "latency-ms", required_argument, NULL, 'l' },
+    { "jitter-ms", required_argument, NULL, 'J' },
+    { "churn", required_argument, NULL, 'c' },
+    { "fail-rate", required_argument, NULL, 'f' },
+    { "fail-modes", required_argument, NULL, 'F' },
+    { "stall-ms", required_argument, NULL, 'S' },
+    { "stats-s", required_argument, NULL, 'i' },
+    { "help", no_argument, NULL, 'h' },
+    { NULL, 0, NULL, 0 },
+  };
+  int o;
+  while ((o = getopt_long(argc, argv, "n:d:s:l:J:c:f:h", opts, NULL)) != -1) {
+    switch (o) {
+      case 'n': g_nodes = atoi(optarg); break;
+      case 'd': g_local_degree = atoi(optarg); break;
+      case 'H': g_hna_frac = atof(optarg); break;
+      case 's': g_seed = strtoul(optarg, NULL, 10); break;
+      case 'b': g_bind = optarg; break;
+      case 'j': g_port_json = atoi(optarg); break;
+      case 't': g_port_txt = atoi(optarg); break;
+      case 'N': g_port_ndb = atoi(optarg); break;
+      case 'l': g_latency_ms = atoi(optarg); break;
+      case 'J': g_jitter_ms = atoi(optarg); break;
+      case 'c': g_churn = atof(optarg); break;
+      case 'f': g_fail_rate = atof(optarg); break;
+      case 'F': if (parse_fail_modes(optarg) != 0) { usage(argv[0]); return 2; } break;
+      case 'S': g_stall_ms = atoi(optarg); break;
+      case 'i': g_stats_s = atoi(optarg); break;
+      default: usage(argv[0]); return o == 'h' ? 0 : 2;
+    }
+  }
+  if (g_nodes < 2) g_nodes = 2;
+  if (g_nodes > 250 * 250) g_nodes = 250 * 250;  /* 10.1-250.1-250.1 */
+  if (g_latency_ms < 0) g_latency_ms = 0;
+  if (g_jitter_ms < 0) g_jitter_ms = 0;
+
+  g_mesh_rng = g_seed;
+  g_serve_rng = g_seed ^ 0x5bd1e995ULL;
+  g_started = time(NULL);
+  mesh_generate();
+  mesh_routes();
+  build_bodies();
+  build_nodedb();
+  print_summary();
+
+  signal(SIGPIPE, SIG_IGN);
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+
+  g_ep = epoll_create1(EPOLL_CLOEXEC);
+  if (g_ep < 0) { perror("epoll_create1"); return 1; }
+  /* listening sockets are tagged with small integers, connections with pointers */
+  const int ports[3] = { g_port_json, g_port_txt, g_port_ndb };
+  int lfd[3] = { -1, -1, -1 };
+  for (int i = 0; i < 3; i++) {
+    if (ports[i] <= 0) continue;
+    if ((lfd[i] = listen_on(ports[i])) < 0) return 1;
+    struct epoll_event ev = { .events = EPOLLIN, .data.u64 = (uint64_t)i + 1 };
+    epoll_ctl(g_ep, EPOLL_CTL_ADD, lfd[i], &ev);
+    fprintf(stderr, "mock_olsrd: %s on %s:%d\n", i == SRV_JSON ? "jsoninfo" : i == SRV_TXT ? "txtinfo" : "nodedb", g_bind, ports[i]);
+  }
+
+  int64_t next_churn = now_ms() + 1000, next_stats = g_stats_s > 0 ? now_ms() + g_stats_s * 1000 : INT64_MAX;
+  struct epoll_event evs[256];
+  while (!g_stop) {
+    int64_t now = now_ms(), wake = next_stats;
+    if (g_churn > 0 && next_churn < wake) wake = next_churn;
+    for (conn_t *c = g_held; c; c = c->next) if (c->due_ms < wake) wake = c->due_ms;
+    int timeout = wake == INT64_MAX ? -1 : wake <= now ? 0 : (int)(wake - now);
+    int n = epoll_wait(g_ep, evs, 256, timeout);
+    if (n < 0 && errno != EINTR) { perror("epoll_wait"); break; }
+    for (int i = 0; i < n; i++) {
+      uint64_t tag = evs[i].data.u64;
+      if (tag >= 1 && tag <= 3) { on_accept(lfd[tag - 1], (int)tag - 1); continue; }
+      conn_t *c = evs[i].data.ptr;
+      if (c->out) on_writable(c);
+      else if (evs[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+        /* a client that goes away while held is simply dropped */
+        if (c->due_ms) { held_remove(c); conn_close(c, 0); }
+        else on_readable(c);
+      }
+    }
+    now = now_ms();
+    fire_due(now);
+    if (g_churn > 0 && now >= next_churn) {
+      mesh_churn();
+      build_bodies();
+      next_churn = now + 1000;
+    }
+    if (now >= next_stats) { print_stats(); next_stats = now + g_stats_s * 1000; }
+  }
+  print_stats();
+  for (int i = 0; i < 3; i++) if (lfd[i] >= 0) close(lfd[i]);
+  return 0;
+}